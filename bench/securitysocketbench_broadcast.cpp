@@ -0,0 +1,89 @@
+#include "securitysocketbench_helper.hpp"
+
+#include <memory>
+
+// One SocketBroadcastServer::write() delivered to N connected clients. An
+// iteration ends once every client has read the whole message.
+static void BM_BroadcastFanOut(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    auto config = makeBenchConfiguration(kBenchBroadcastPort);
+    int32_t num_of_clients = static_cast<int32_t>(state.range(0));
+    size_t message_size = static_cast<size_t>(state.range(1));
+
+    BenchCountingHandler handler;
+    SocketBroadcastServer server{ config };
+    auto opened = server.open(&handler, num_of_clients);
+    if (opened.code() != SocketCode::SUCCESS)
+    {
+        state.SkipWithError(opened.message());
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::unique_ptr<SocketClient>> clients;
+    for (int32_t i = 0; i < num_of_clients; i++)
+    {
+        clients.emplace_back(new SocketClient{ config });
+        if (clients.back()->open().code() != SocketCode::SUCCESS || clients.back()->connect().code() != SocketCode::SUCCESS)
+        {
+            state.SkipWithError("cannot connect to the broadcast server");
+            break;
+        }
+    }
+
+    // write() only reaches the clients the server thread has accepted.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (handler.connected.load() < num_of_clients && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (handler.connected.load() < num_of_clients)
+        state.SkipWithError("the broadcast server did not accept every client");
+
+    std::vector<char> message(message_size, 'x');
+    std::vector<char> received(message_size);
+    if (!state.error_occurred())
+    {
+        for (auto _ : state)
+        {
+            if (server.write(message.data(), message.size()).code() != SocketCode::SUCCESS)
+            {
+                state.SkipWithError("broadcast write failed");
+                break;
+            }
+
+            bool is_delivered{ true };
+            for (auto& client : clients)
+            {
+                size_t total{ 0 };
+                while (total < message_size)
+                {
+                    auto result = client->read(received.data() + total, message_size - total);
+                    if (result.code() != SocketCode::SUCCESS)
+                    {
+                        is_delivered = false;
+                        break;
+                    }
+                    total += result.bytes();
+                }
+                if (!is_delivered)
+                    break;
+            }
+            if (!is_delivered)
+            {
+                state.SkipWithError("a client missed the broadcast");
+                break;
+            }
+        }
+    }
+
+    for (auto& client : clients)
+        client->close();
+    server.close();
+
+    state.SetItemsProcessed(state.iterations() * num_of_clients);
+    state.SetBytesProcessed(state.iterations() * num_of_clients * static_cast<int64_t>(message_size));
+}
+BENCHMARK(BM_BroadcastFanOut)
+    ->ArgNames({ "clients", "size" })
+    ->ArgsProduct({ { 1, 8, 64 }, { 64, 4096 } })
+    ->UseRealTime();
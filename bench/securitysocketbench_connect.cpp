@@ -0,0 +1,91 @@
+#include "securitysocketbench_helper.hpp"
+
+namespace
+{
+    SharedEchoServer* connect_server{ nullptr };
+    SharedEchoServer* tls_server{ nullptr };
+}
+
+// open() + connect() + close() of a plain client; the server accepts each one.
+static void BM_ConnectAccept(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    auto config = makeBenchConfiguration(kBenchConnectPort);
+    if (!acquireSharedEchoServer(state, connect_server, config))
+        return;
+
+    for (auto _ : state)
+    {
+        SocketClient client{ config };
+        if (client.open().code() != SocketCode::SUCCESS || client.connect().code() != SocketCode::SUCCESS)
+        {
+            state.SkipWithError("cannot connect to the server");
+            break;
+        }
+        client.close();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConnectAccept)->UseRealTime();
+
+// Full and resumed TLS handshakes against a SocketRequestServer, each followed
+// by one small round trip: TLS 1.3 tickets arrive after the handshake and are
+// single-use, so a client that never reads has nothing to resume next time.
+// Fast connect skips the TLS 1.3 post-handshake probe, which would otherwise
+// dominate the measurement.
+static void BM_TLSHandshake(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    auto version = state.range(0) == 12 ? SocketTLSVersion::TLS1_2 : SocketTLSVersion::TLS1_3;
+    bool is_resumed = state.range(1) != 0;
+
+    if (!generateBenchCertificate())
+    {
+        state.SkipWithError("openssl CLI is not available");
+        return;
+    }
+    auto config = makeBenchConfiguration(kBenchTLSPort);
+    SocketTLSServerConfiguration tls_config{
+        { SocketTLSVersion::TLS1_2, SocketTLSVersion::TLS1_3 },
+        {}, {},
+        kBenchCertPath, kBenchKeyPath
+    };
+    if (!acquireSharedEchoServer(state, tls_server, config, tls_config))
+        return;
+
+    SocketTLSClientConfiguration client_config{ { version } };
+    client_config.setSessionResumption(is_resumed);
+    client_config.setFastConnect(true);
+
+    auto request = makeEchoRequest(16);
+    std::vector<char> response(16);
+    auto connectOnce = [&]() {
+        SocketClient client{ config, client_config };
+        bool is_connected = client.open().code() == SocketCode::SUCCESS &&
+            client.connect().code() == SocketCode::SUCCESS &&
+            runEchoRoundTrip(client, request, response);
+        client.close();
+        return is_connected;
+    };
+
+    // Leaves a session to resume in the cache.
+    if (is_resumed && !connectOnce())
+    {
+        state.SkipWithError("cannot connect to the TLS server");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        if (!connectOnce())
+        {
+            state.SkipWithError("cannot connect to the TLS server");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TLSHandshake)
+    ->ArgNames({ "version", "resumed" })
+    ->ArgsProduct({ { 12, 13 }, { 0, 1 } })
+    ->UseRealTime();
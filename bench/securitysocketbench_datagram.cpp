@@ -0,0 +1,76 @@
+#include "securitysocketbench_helper.hpp"
+
+// Datagrams per second from one SocketDatagramClient to a SocketDatagramServer
+// over loopback. An iteration is one writeBatch() of kDatagramsPerIteration
+// datagrams. items_per_second counts those sent, "received" those the server's
+// handler got and "delivered" their share, as UDP drops what the receive
+// buffer cannot hold.
+static constexpr size_t kDatagramsPerIteration = 256;
+
+struct BenchDatagramCounter : public Bn3Monkey::SocketDatagramHandler
+{
+    void onDatagramsReceived(const Bn3Monkey::SocketDatagram* datagrams, size_t count) override {
+        (void)datagrams;
+        received.fetch_add(count, std::memory_order_relaxed);
+    }
+    std::atomic<uint64_t> received{ 0 };
+};
+
+static void BM_DatagramThroughput(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    auto config = makeBenchConfiguration(kBenchDatagramPort);
+    config.setDatagramBatchSize(static_cast<uint32_t>(state.range(0)));
+    config.setSegmentationOffload(state.range(2) != 0);
+    size_t datagram_size = static_cast<size_t>(state.range(1));
+
+    BenchDatagramCounter handler;
+    SocketDatagramServer server{ config };
+    auto opened = server.open(&handler);
+    if (opened.code() != SocketCode::SUCCESS)
+    {
+        state.SkipWithError(opened.message());
+        return;
+    }
+    SocketDatagramClient client{ config };
+    opened = client.open();
+    if (opened.code() != SocketCode::SUCCESS)
+    {
+        server.close();
+        state.SkipWithError(opened.message());
+        return;
+    }
+
+    std::vector<char> payload(datagram_size, 'x');
+    std::vector<SocketIOBuffer> datagrams(kDatagramsPerIteration);
+    for (auto& datagram : datagrams)
+    {
+        datagram.data = payload.data();
+        datagram.size = payload.size();
+    }
+
+    for (auto _ : state)
+    {
+        auto result = client.writeBatch(datagrams.data(), datagrams.size());
+        if (result.code() != SocketCode::SUCCESS)
+        {
+            state.SkipWithError(result.message());
+            break;
+        }
+    }
+
+    // Whatever is still in flight.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    client.close();
+    server.close();
+
+    int64_t sent = state.iterations() * static_cast<int64_t>(kDatagramsPerIteration);
+    state.SetItemsProcessed(sent);
+    state.SetBytesProcessed(sent * static_cast<int64_t>(datagram_size));
+    state.counters["received"] = benchmark::Counter(static_cast<double>(handler.received.load()), benchmark::Counter::kIsRate);
+    state.counters["delivered"] = sent > 0 ? static_cast<double>(handler.received.load()) / static_cast<double>(sent) : 0.0;
+}
+BENCHMARK(BM_DatagramThroughput)
+    ->ArgNames({ "batch", "size", "offload" })
+    ->ArgsProduct({ { 1, 32 }, { 64, 1200 }, { 0, 1 } })
+    ->UseRealTime();
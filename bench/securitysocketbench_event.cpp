@@ -0,0 +1,69 @@
+#include "securitysocketbench_helper.hpp"
+
+#include <memory>
+
+// Cost of the server's event wait against the number of registered
+// descriptors: echo round trips of one client while N others stay connected
+// and silent. poll() scans every one of them on each wait.
+static void BM_EventWaitIdleConnections(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    int32_t num_of_idle_clients = static_cast<int32_t>(state.range(0));
+    auto backend = state.range(1) == 0 ? SocketEventBackend::POLL : SocketEventBackend::IO_URING;
+
+    auto config = makeBenchConfiguration(kBenchEventPort);
+    config.setEventBackend(backend);
+
+    BenchEchoHandler handler;
+    SocketRequestServer server{ config };
+    auto opened = server.open(&handler, num_of_idle_clients + 1);
+    if (opened.code() != SocketCode::SUCCESS)
+    {
+        state.SkipWithError(opened.message());
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::unique_ptr<SocketClient>> idle_clients;
+    for (int32_t i = 0; i < num_of_idle_clients; i++)
+    {
+        idle_clients.emplace_back(new SocketClient{ config });
+        if (idle_clients.back()->open().code() != SocketCode::SUCCESS || idle_clients.back()->connect().code() != SocketCode::SUCCESS)
+        {
+            state.SkipWithError("cannot connect an idle client");
+            break;
+        }
+    }
+
+    SocketClient client{ config };
+    if (!state.error_occurred() &&
+        (client.open().code() != SocketCode::SUCCESS || client.connect().code() != SocketCode::SUCCESS))
+    {
+        state.SkipWithError("cannot connect to the echo server");
+    }
+
+    auto request = makeEchoRequest(16);
+    std::vector<char> response(16);
+    if (!state.error_occurred())
+    {
+        for (auto _ : state)
+        {
+            if (!runEchoRoundTrip(client, request, response))
+            {
+                state.SkipWithError("echo round trip failed");
+                break;
+            }
+        }
+    }
+
+    client.close();
+    for (auto& idle_client : idle_clients)
+        idle_client->close();
+    server.close();
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventWaitIdleConnections)
+    ->ArgNames({ "idle", "io_uring" })
+    ->ArgsProduct({ { 0, 8, 30 }, { 0, 1 } })
+    ->UseRealTime();
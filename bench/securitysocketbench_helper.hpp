@@ -0,0 +1,201 @@
+#if !defined(__SECURITY_SOCKET_BENCH_HELPER__)
+#define __SECURITY_SOCKET_BENCH_HELPER__
+
+#include <benchmark/benchmark.h>
+#include <SecuritySocket.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Ports of the benchmark servers. Kept apart from the test ports (21345 ~ 21373)
+// so both can run on the same machine.
+constexpr uint32_t kBenchEchoPort = 21400;
+constexpr uint32_t kBenchConnectPort = 21401;
+constexpr uint32_t kBenchTLSPort = 21402;
+constexpr uint32_t kBenchBroadcastPort = 21403;
+constexpr uint32_t kBenchEventPort = 21404;
+constexpr uint32_t kBenchDatagramPort = 21405;
+// Unix domain socket of the shared-memory benchmark.
+constexpr const char* kBenchUnixPath = "/tmp/securitysocketbench_unix.sock";
+
+inline Bn3Monkey::SocketConfiguration makeBenchConfiguration(uint32_t port)
+{
+    return Bn3Monkey::SocketConfiguration{ "127.0.0.1", port, false, 5, 1000, 1000, 10, 65536 };
+}
+
+// Request: BenchEchoHeader followed by payload_size bytes.
+// Response: the payload, unchanged.
+struct BenchEchoHeader
+{
+    uint32_t payload_size{ 0 };
+};
+
+struct BenchEchoHandler : public Bn3Monkey::SocketRequestHandler
+{
+    size_t getHeaderSize() override {
+        return sizeof(BenchEchoHeader);
+    }
+    size_t getPayloadSize(const char* header) override {
+        return reinterpret_cast<const BenchEchoHeader*>(header)->payload_size;
+    }
+    Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+        (void)header;
+        return Bn3Monkey::SocketRequestMode::FAST;
+    }
+    void onClientConnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+        connected++;
+    }
+    void onClientDisconnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+        disconnected++;
+    }
+    void onProcessed(
+        const char* header,
+        const char* input_buffer,
+        size_t input_size,
+        char* output_buffer,
+        size_t* output_size
+    ) override {
+        (void)header;
+        memcpy(output_buffer, input_buffer, input_size);
+        *output_size = input_size;
+    }
+    void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+
+    std::atomic<int32_t> connected{ 0 };
+    std::atomic<int32_t> disconnected{ 0 };
+};
+
+struct BenchCountingHandler : public Bn3Monkey::SocketBroadcastHandler
+{
+    void onClientConnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+        connected++;
+    }
+    void onClientDisconnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+        disconnected++;
+    }
+    std::atomic<int32_t> connected{ 0 };
+    std::atomic<int32_t> disconnected{ 0 };
+};
+
+// Servers that every run of a benchmark shares, so threaded runs do not race
+// each other to open them. Opened on first use and closed by main().
+inline std::vector<std::function<void()>>& getSharedServerClosers()
+{
+    static std::vector<std::function<void()>> closers;
+    return closers;
+}
+inline std::mutex& getSharedServerMutex()
+{
+    static std::mutex mtx;
+    return mtx;
+}
+inline void closeSharedServers()
+{
+    std::lock_guard<std::mutex> lock(getSharedServerMutex());
+    auto& closers = getSharedServerClosers();
+    for (auto iter = closers.rbegin(); iter != closers.rend(); ++iter)
+        (*iter)();
+    closers.clear();
+}
+
+struct SharedEchoServer
+{
+    BenchEchoHandler handler;
+    Bn3Monkey::SocketRequestServer server;
+    Bn3Monkey::SocketResult result;
+
+    explicit SharedEchoServer(const Bn3Monkey::SocketConfiguration& configuration) : server(configuration) {}
+    SharedEchoServer(const Bn3Monkey::SocketConfiguration& configuration, const Bn3Monkey::SocketTLSServerConfiguration& tls_configuration)
+        : server(configuration, tls_configuration) {}
+};
+
+// nullptr after SkipWithError() if the server cannot be opened.
+template<class... Args>
+inline SharedEchoServer* acquireSharedEchoServer(benchmark::State& state, SharedEchoServer*& slot, Args&&... args)
+{
+    {
+        std::lock_guard<std::mutex> lock(getSharedServerMutex());
+        if (!slot)
+        {
+            slot = new SharedEchoServer(std::forward<Args>(args)...);
+            slot->result = slot->server.open(&slot->handler, 32);
+            auto** owner = &slot;
+            getSharedServerClosers().push_back([owner]() {
+                (*owner)->server.close();
+                delete *owner;
+                *owner = nullptr;
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    if (slot->result.code() != Bn3Monkey::SocketCode::SUCCESS)
+    {
+        state.SkipWithError(slot->result.message());
+        return nullptr;
+    }
+    return slot;
+}
+
+// One request / response round trip. false if the connection failed.
+inline bool runEchoRoundTrip(Bn3Monkey::SocketClient& client, std::vector<char>& request, std::vector<char>& response)
+{
+    using namespace Bn3Monkey;
+    if (client.write(request.data(), request.size()).code() != SocketCode::SUCCESS)
+        return false;
+
+    size_t received{ 0 };
+    while (received < response.size())
+    {
+        auto result = client.read(response.data() + received, response.size() - received);
+        if (result.code() != SocketCode::SUCCESS)
+            return false;
+        received += result.bytes();
+    }
+    return true;
+}
+
+// Header and payload in one buffer, so Nagle does not hold the payload back.
+inline std::vector<char> makeEchoRequest(size_t payload_size)
+{
+    std::vector<char> request(sizeof(BenchEchoHeader) + payload_size, 'x');
+    BenchEchoHeader header{ static_cast<uint32_t>(payload_size) };
+    memcpy(request.data(), &header, sizeof(header));
+    return request;
+}
+
+constexpr const char* kBenchCertPath = "securitysocketbench_tls_server.crt";
+constexpr const char* kBenchKeyPath = "securitysocketbench_tls_server.key";
+
+// Self-signed P-256 certificate generated with the openssl CLI, as the TLS
+// server tests do.
+inline bool generateBenchCertificate()
+{
+    static int result = std::system(
+        "openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 "
+        "-subj /CN=127.0.0.1 -keyout securitysocketbench_tls_server.key "
+        "-out securitysocketbench_tls_server.crt"
+#if defined(_WIN32)
+        " > NUL 2>&1"
+#else
+        " > /dev/null 2>&1"
+#endif
+    );
+    return result == 0;
+}
+
+#endif // __SECURITY_SOCKET_BENCH_HELPER__
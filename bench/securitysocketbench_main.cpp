@@ -0,0 +1,47 @@
+#include "securitysocketbench_helper.hpp"
+
+#include <string>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#endif
+
+// Google Benchmark's main(), with the library initialized around the run and
+// the results also written as JSON to securitysocket_bench.json unless
+// --benchmark_out / --benchmark_out_format say otherwise. The JSON files of
+// two releases can be compared with tools/compare.py from Google Benchmark.
+int main(int argc, char** argv)
+{
+    std::vector<char*> args(argv, argv + argc);
+    bool has_output{ false };
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--benchmark_out", 15) == 0)
+            has_output = true;
+    }
+    std::string output_arg = "--benchmark_out=securitysocket_bench.json";
+    std::string format_arg = "--benchmark_out_format=json";
+    if (!has_output)
+    {
+        args.push_back(&output_arg[0]);
+        args.push_back(&format_arg[0]);
+    }
+    int32_t num_of_args = static_cast<int32_t>(args.size());
+
+    benchmark::Initialize(&num_of_args, args.data());
+    if (benchmark::ReportUnrecognizedArguments(num_of_args, args.data()))
+        return 1;
+
+#if !defined(_WIN32)
+    // OpenSSL writes close_notify with plain send(); a server that already
+    // dropped the connection must not kill the run.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    Bn3Monkey::initializeSecuritySocket();
+    benchmark::RunSpecifiedBenchmarks();
+    closeSharedServers();
+    Bn3Monkey::releaseSecuritySocket();
+
+    benchmark::Shutdown();
+    return 0;
+}
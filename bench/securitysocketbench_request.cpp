@@ -0,0 +1,99 @@
+#include "securitysocketbench_helper.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    SharedEchoServer* echo_server{ nullptr };
+    SharedEchoServer* unix_echo_server{ nullptr };
+
+    Bn3Monkey::SocketConfiguration makeUnixBenchConfiguration(bool shared_memory)
+    {
+        Bn3Monkey::SocketConfiguration config{ kBenchUnixPath, 0, true, 5, 1000, 1000, 10, 65536 };
+        if (shared_memory)
+        {
+            config.setSharedMemorySize(1 << 20);
+            config.setBusyPollTime(50);
+        }
+        return config;
+    }
+}
+
+// Request / response echo over loopback. Each benchmark thread is one client
+// with its own connection; every thread shares the same server thread.
+static void BM_RequestEcho(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    auto config = makeBenchConfiguration(kBenchEchoPort);
+    if (!acquireSharedEchoServer(state, echo_server, config))
+        return;
+
+    size_t payload_size = static_cast<size_t>(state.range(0));
+    auto request = makeEchoRequest(payload_size);
+    std::vector<char> response(payload_size);
+
+    SocketClient client{ config };
+    if (client.open().code() != SocketCode::SUCCESS || client.connect().code() != SocketCode::SUCCESS)
+    {
+        state.SkipWithError("cannot connect to the echo server");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        if (!runEchoRoundTrip(client, request, response))
+        {
+            state.SkipWithError("echo round trip failed");
+            break;
+        }
+    }
+    client.close();
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(request.size() + response.size()));
+}
+BENCHMARK(BM_RequestEcho)
+    ->ArgName("payload")
+    ->RangeMultiplier(16)->Range(16, 65536)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// The same echo over a unix domain socket, with the stream on the socket
+// (shm:0) or in shared memory (shm:1). The server has shared memory on and
+// busy-polls either way; only the client decides.
+static void BM_UnixEcho(benchmark::State& state)
+{
+    using namespace Bn3Monkey;
+    if (!unix_echo_server)
+        std::remove(kBenchUnixPath);
+    if (!acquireSharedEchoServer(state, unix_echo_server, makeUnixBenchConfiguration(true)))
+        return;
+
+    size_t payload_size = static_cast<size_t>(state.range(0));
+    auto request = makeEchoRequest(payload_size);
+    std::vector<char> response(payload_size);
+
+    SocketClient client{ makeUnixBenchConfiguration(state.range(1) != 0) };
+    if (client.open().code() != SocketCode::SUCCESS || client.connect().code() != SocketCode::SUCCESS)
+    {
+        state.SkipWithError("cannot connect to the echo server");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        if (!runEchoRoundTrip(client, request, response))
+        {
+            state.SkipWithError("echo round trip failed");
+            break;
+        }
+    }
+    client.close();
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(request.size() + response.size()));
+}
+BENCHMARK(BM_UnixEcho)
+    ->ArgNames({ "payload", "shm" })
+    ->ArgsProduct({ { 16, 4096, 65536 }, { 0, 1 } })
+    ->UseRealTime();
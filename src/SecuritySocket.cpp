@@ -1,9 +1,17 @@
 #include "SecuritySocket.hpp"
 #include "implementation/SocketBroadcastServer.hpp"
 #include "implementation/SocketRequestServer.hpp"
+#include "implementation/SocketDatagramClient.hpp"
+#include "implementation/SocketDatagramServer.hpp"
 #include "implementation/SocketClient.hpp"
+#include "implementation/SocketClientPool.hpp"
+#include "implementation/SocketMultiplexClient.hpp"
+#include "implementation/AsyncSocketClient.hpp"
+#include "implementation/SocketEventLoop.hpp"
 #include "implementation/SocketResult.hpp"
 #include "implementation/TLSHelper.hpp"
+#include "implementation/TLSContext.hpp"
+#include "implementation/SocketTrace.hpp"
 
 #if defined _WIN32
 #include <Winsock2.h>
@@ -25,10 +33,20 @@ bool Bn3Monkey::initializeSecuritySocket()
 }
 void Bn3Monkey::releaseSecuritySocket()
 {
+	TLSClientContextCache::flush();
 #ifdef _WIN32
 	WSACleanup();
 #endif
 }
+bool Bn3Monkey::dumpSecuritySocketTrace(const char* path)
+{
+#if defined(SECURITYSOCKET_TRACE)
+	return SocketTrace::dump(path);
+#else
+	(void)path;
+	return false;
+#endif
+}
 
 const char* Bn3Monkey::SocketResult::message() {
 	return getMessage(_code);
@@ -67,6 +85,11 @@ Bn3Monkey::SocketResult Bn3Monkey::SocketClient::connect()
 	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
 	return impl->connect();
 }
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::connect(const void* early_data, size_t size)
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->connect(early_data, size);
+}
 Bn3Monkey::SocketResult Bn3Monkey::SocketClient::read(void* buffer, size_t size)
 {
 	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
@@ -77,11 +100,215 @@ Bn3Monkey::SocketResult Bn3Monkey::SocketClient::write(const void* buffer, size_
 	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
 	return impl->write(buffer, size);
 }
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::writev(const SocketIOBuffer* buffers, size_t count)
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->writev(buffers, count);
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::readv(const SocketIOBuffer* buffers, size_t count)
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->readv(buffers, count);
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::sendDescriptor(int32_t descriptor, const void* buffer, size_t size)
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->sendDescriptor(descriptor, buffer, size);
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::receiveDescriptor(void* buffer, size_t size, int32_t* descriptor)
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->receiveDescriptor(buffer, size, descriptor);
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::flush()
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->flush();
+}
 Bn3Monkey::SocketResult Bn3Monkey::SocketClient::isConnected()
 {
 	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
 	return impl->isConnected();
 }
+Bn3Monkey::SocketResult Bn3Monkey::SocketClient::isAlive()
+{
+	SocketClientImpl* impl = static_cast<SocketClientImpl*>((void*)_container);
+	return impl->isAlive();
+}
+
+static_assert(sizeof(SocketClientPoolImpl) <= Bn3Monkey::SocketClientPool::IMPLEMENTATION_SIZE, "SocketClientPool::IMPLEMENTATION_SIZE is too small");
+
+Bn3Monkey::SocketClientPool::SocketClientPool(const SocketConfiguration& configuration, size_t min_idle, size_t max_idle)
+{
+	new (_container) SocketClientPoolImpl(configuration, min_idle, max_idle);
+}
+Bn3Monkey::SocketClientPool::SocketClientPool(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, size_t min_idle, size_t max_idle)
+{
+	new (_container) SocketClientPoolImpl(configuration, tls_configuration, min_idle, max_idle);
+}
+Bn3Monkey::SocketClientPool::~SocketClientPool()
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	impl->~SocketClientPoolImpl();
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClientPool::open()
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	return impl->open();
+}
+void Bn3Monkey::SocketClientPool::close()
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	return impl->close();
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketClientPool::acquire(SocketClient** client)
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	return impl->acquire(client);
+}
+void Bn3Monkey::SocketClientPool::release(SocketClient* client)
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	return impl->release(client);
+}
+void Bn3Monkey::SocketClientPool::discard(SocketClient* client)
+{
+	SocketClientPoolImpl* impl = static_cast<SocketClientPoolImpl*>((void*)_container);
+	return impl->discard(client);
+}
+
+static_assert(sizeof(SocketMultiplexClientImpl) <= Bn3Monkey::SocketMultiplexClient::IMPLEMENTATION_SIZE, "SocketMultiplexClient::IMPLEMENTATION_SIZE is too small");
+
+Bn3Monkey::SocketMultiplexClient::SocketMultiplexClient(const SocketConfiguration& configuration, SocketMultiplexCodec* codec, size_t window)
+{
+	new (_container) SocketMultiplexClientImpl(configuration, codec, window);
+}
+Bn3Monkey::SocketMultiplexClient::SocketMultiplexClient(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, SocketMultiplexCodec* codec, size_t window)
+{
+	new (_container) SocketMultiplexClientImpl(configuration, tls_configuration, codec, window);
+}
+Bn3Monkey::SocketMultiplexClient::~SocketMultiplexClient()
+{
+	SocketMultiplexClientImpl* impl = static_cast<SocketMultiplexClientImpl*>((void*)_container);
+	impl->~SocketMultiplexClientImpl();
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketMultiplexClient::open()
+{
+	SocketMultiplexClientImpl* impl = static_cast<SocketMultiplexClientImpl*>((void*)_container);
+	return impl->open();
+}
+void Bn3Monkey::SocketMultiplexClient::close()
+{
+	SocketMultiplexClientImpl* impl = static_cast<SocketMultiplexClientImpl*>((void*)_container);
+	return impl->close();
+}
+std::future<Bn3Monkey::SocketMultiplexResponse> Bn3Monkey::SocketMultiplexClient::request(const void* request, size_t size)
+{
+	SocketMultiplexClientImpl* impl = static_cast<SocketMultiplexClientImpl*>((void*)_container);
+	return impl->request(request, size);
+}
+size_t Bn3Monkey::SocketMultiplexClient::outstanding()
+{
+	SocketMultiplexClientImpl* impl = static_cast<SocketMultiplexClientImpl*>((void*)_container);
+	return impl->outstanding();
+}
+
+static_assert(sizeof(SocketEventLoopImpl) <= Bn3Monkey::SocketEventLoop::IMPLEMENTATION_SIZE, "SocketEventLoop::IMPLEMENTATION_SIZE is too small");
+static_assert(sizeof(AsyncSocketClientImpl) <= Bn3Monkey::AsyncSocketClient::IMPLEMENTATION_SIZE, "AsyncSocketClient::IMPLEMENTATION_SIZE is too small");
+
+Bn3Monkey::SocketEventLoop::SocketEventLoop()
+{
+	new (_container) SocketEventLoopImpl();
+}
+Bn3Monkey::SocketEventLoop::~SocketEventLoop()
+{
+	SocketEventLoopImpl* impl = static_cast<SocketEventLoopImpl*>((void*)_container);
+	impl->~SocketEventLoopImpl();
+}
+Bn3Monkey::SocketResult Bn3Monkey::SocketEventLoop::open()
+{
+	SocketEventLoopImpl* impl = static_cast<SocketEventLoopImpl*>((void*)_container);
+	return impl->open();
+}
+void Bn3Monkey::SocketEventLoop::close()
+{
+	SocketEventLoopImpl* impl = static_cast<SocketEventLoopImpl*>((void*)_container);
+	return impl->close();
+}
+
+Bn3Monkey::AsyncSocketClient::AsyncSocketClient(SocketEventLoop& loop, const SocketConfiguration& configuration)
+{
+	SocketEventLoopImpl* loop_impl = static_cast<SocketEventLoopImpl*>((void*)loop._container);
+	new (_container) AsyncSocketClientImpl(*loop_impl, configuration);
+}
+Bn3Monkey::AsyncSocketClient::AsyncSocketClient(SocketEventLoop& loop, const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration)
+{
+	SocketEventLoopImpl* loop_impl = static_cast<SocketEventLoopImpl*>((void*)loop._container);
+	new (_container) AsyncSocketClientImpl(*loop_impl, configuration, tls_configuration);
+}
+Bn3Monkey::AsyncSocketClient::~AsyncSocketClient()
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	impl->~AsyncSocketClientImpl();
+}
+Bn3Monkey::SocketResult Bn3Monkey::AsyncSocketClient::open()
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	return impl->open();
+}
+void Bn3Monkey::AsyncSocketClient::close()
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	return impl->close();
+}
+void Bn3Monkey::AsyncSocketClient::connectAsync(SocketCompletionCallback callback)
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	impl->connectAsync(std::move(callback));
+}
+void Bn3Monkey::AsyncSocketClient::readAsync(void* buffer, size_t size, SocketCompletionCallback callback)
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	impl->readAsync(buffer, size, std::move(callback));
+}
+void Bn3Monkey::AsyncSocketClient::writeAsync(const void* buffer, size_t size, SocketCompletionCallback callback)
+{
+	AsyncSocketClientImpl* impl = static_cast<AsyncSocketClientImpl*>((void*)_container);
+	impl->writeAsync(buffer, size, std::move(callback));
+}
+std::future<Bn3Monkey::SocketResult> Bn3Monkey::AsyncSocketClient::connectAsync()
+{
+	auto promise = std::make_shared<std::promise<SocketResult>>();
+	auto future = promise->get_future();
+	connectAsync([promise](SocketResult result) { promise->set_value(result); });
+	return future;
+}
+std::future<Bn3Monkey::SocketResult> Bn3Monkey::AsyncSocketClient::readAsync(void* buffer, size_t size)
+{
+	auto promise = std::make_shared<std::promise<SocketResult>>();
+	auto future = promise->get_future();
+	readAsync(buffer, size, [promise](SocketResult result) { promise->set_value(result); });
+	return future;
+}
+std::future<Bn3Monkey::SocketResult> Bn3Monkey::AsyncSocketClient::writeAsync(const void* buffer, size_t size)
+{
+	auto promise = std::make_shared<std::promise<SocketResult>>();
+	auto future = promise->get_future();
+	writeAsync(buffer, size, [promise](SocketResult result) { promise->set_value(result); });
+	return future;
+}
+
+Bn3Monkey::SocketResult Bn3Monkey::SocketRequestCompletion::complete(const void* response, size_t size) const
+{
+	if (!_state)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+	return _state->complete(response, size);
+}
+
+static_assert(sizeof(SocketRequestServerImpl) <= Bn3Monkey::SocketRequestServer::IMPLEMENTATION_SIZE, "SocketRequestServer::IMPLEMENTATION_SIZE is too small");
+static_assert(sizeof(SocketBroadcastServerImpl) <= Bn3Monkey::SocketBroadcastServer::IMPLEMENTATION_SIZE, "SocketBroadcastServer::IMPLEMENTATION_SIZE is too small");
 
 Bn3Monkey::SocketRequestServer::SocketRequestServer(const SocketConfiguration& configuration)
 {
@@ -108,6 +335,41 @@ void Bn3Monkey::SocketRequestServer::close()
 	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
 	return impl->close();
 }
+SocketServerMetrics Bn3Monkey::SocketRequestServer::snapshot()
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	SocketServerMetrics metrics;
+	impl->snapshot(metrics);
+	return metrics;
+}
+SocketEventBackend Bn3Monkey::SocketRequestServer::eventBackend()
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	return impl->eventBackend();
+}
+
+uint64_t Bn3Monkey::SocketRequestServer::addTimer(uint32_t delay_ms, SocketTimerCallback callback)
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	return impl->addTimer(delay_ms, std::move(callback));
+}
+
+void Bn3Monkey::SocketRequestServer::cancelTimer(uint64_t timer_id)
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	impl->cancelTimer(timer_id);
+}
+
+SocketResult Bn3Monkey::SocketRequestServer::post(std::function<void()> task)
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	return impl->post(std::move(task));
+}
+SocketResult Bn3Monkey::SocketRequestServer::adopt(int32_t descriptor)
+{
+	SocketRequestServerImpl* impl = static_cast<SocketRequestServerImpl*>((void*)_container);
+	return impl->adopt(descriptor);
+}
 
 Bn3Monkey::SocketBroadcastServer::SocketBroadcastServer(const SocketConfiguration& configuration)
 {
@@ -138,6 +400,18 @@ SocketResult Bn3Monkey::SocketBroadcastServer::write(const void* buffer, size_t
 	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
 	return impl->write(buffer, size);
 }
+SocketServerMetrics Bn3Monkey::SocketBroadcastServer::snapshot()
+{
+	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
+	SocketServerMetrics metrics;
+	impl->snapshot(metrics);
+	return metrics;
+}
+SocketEventBackend Bn3Monkey::SocketBroadcastServer::eventBackend()
+{
+	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
+	return impl->eventBackend();
+}
 SocketResult Bn3Monkey::SocketBroadcastServer::await(uint64_t timeout_ms)
 {
 	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
@@ -153,6 +427,82 @@ void Bn3Monkey::SocketBroadcastServer::dropAll()
 	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
 	impl->dropAll();
 }
+SocketResult Bn3Monkey::SocketBroadcastServer::post(std::function<void()> task)
+{
+	SocketBroadcastServerImpl* impl = static_cast<SocketBroadcastServerImpl*>((void*)_container);
+	return impl->post(std::move(task));
+}
+
+static_assert(sizeof(SocketDatagramClientImpl) <= Bn3Monkey::SocketDatagramClient::IMPLEMENTATION_SIZE, "SocketDatagramClient::IMPLEMENTATION_SIZE is too small");
+static_assert(sizeof(SocketDatagramServerImpl) <= Bn3Monkey::SocketDatagramServer::IMPLEMENTATION_SIZE, "SocketDatagramServer::IMPLEMENTATION_SIZE is too small");
+static_assert(Bn3Monkey::SocketDatagramClient::MAX_DATAGRAM_SIZE == DatagramSocket::MAX_DATAGRAM_SIZE, "");
+
+Bn3Monkey::SocketDatagramClient::SocketDatagramClient(const SocketConfiguration& configuration)
+{
+	new (_container) SocketDatagramClientImpl(configuration);
+}
+Bn3Monkey::SocketDatagramClient::~SocketDatagramClient()
+{
+	SocketDatagramClientImpl* impl = static_cast<SocketDatagramClientImpl*>((void*)_container);
+	impl->~SocketDatagramClientImpl();
+}
+SocketResult Bn3Monkey::SocketDatagramClient::open()
+{
+	SocketDatagramClientImpl* impl = static_cast<SocketDatagramClientImpl*>((void*)_container);
+	return impl->open();
+}
+void Bn3Monkey::SocketDatagramClient::close()
+{
+	SocketDatagramClientImpl* impl = static_cast<SocketDatagramClientImpl*>((void*)_container);
+	return impl->close();
+}
+SocketResult Bn3Monkey::SocketDatagramClient::write(const void* buffer, size_t size)
+{
+	SocketDatagramClientImpl* impl = static_cast<SocketDatagramClientImpl*>((void*)_container);
+	return impl->write(buffer, size);
+}
+SocketResult Bn3Monkey::SocketDatagramClient::writeBatch(const SocketIOBuffer* datagrams, size_t count)
+{
+	SocketDatagramClientImpl* impl = static_cast<SocketDatagramClientImpl*>((void*)_container);
+	return impl->writeBatch(datagrams, count);
+}
+
+Bn3Monkey::SocketDatagramServer::SocketDatagramServer(const SocketConfiguration& configuration)
+{
+	new (_container) SocketDatagramServerImpl(configuration);
+}
+Bn3Monkey::SocketDatagramServer::~SocketDatagramServer()
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	impl->~SocketDatagramServerImpl();
+}
+SocketResult Bn3Monkey::SocketDatagramServer::open(SocketDatagramHandler* handler)
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	return impl->open(handler);
+}
+void Bn3Monkey::SocketDatagramServer::close()
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	return impl->close();
+}
+SocketServerMetrics Bn3Monkey::SocketDatagramServer::snapshot()
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	SocketServerMetrics metrics;
+	impl->snapshot(metrics);
+	return metrics;
+}
+SocketEventBackend Bn3Monkey::SocketDatagramServer::eventBackend()
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	return impl->eventBackend();
+}
+SocketResult Bn3Monkey::SocketDatagramServer::post(std::function<void()> task)
+{
+	SocketDatagramServerImpl* impl = static_cast<SocketDatagramServerImpl*>((void*)_container);
+	return impl->post(std::move(task));
+}
 
 static size_t appendCipherString(const char* cipher_str, size_t offset, char* dest)
 {
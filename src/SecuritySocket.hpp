@@ -23,13 +23,17 @@
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <utility>
 #include <initializer_list>
+#include <functional>
+#include <future>
+#include <vector>
 
 #define WIN32_LEAN_AND_MEAN
 
 #define BN3MONKEY_SECURITYSOCKET_VERSION_MAJOR 2
-#define BN3MONKEY_SECURITYSOCKET_VERSION_MINOR 3
-#define BN3MONKEY_SECURITYSOCKET_VERSION_REVISION 1
+#define BN3MONKEY_SECURITYSOCKET_VERSION_MINOR 4
+#define BN3MONKEY_SECURITYSOCKET_VERSION_REVISION 0
 
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
@@ -121,6 +125,17 @@ namespace Bn3Monkey
     };
 
 
+    // How SocketRequestServer and SocketBroadcastServer wait for socket events.
+    //   POLL     : poll(), on every platform.
+    //   IO_URING : Linux io_uring. Registered descriptors stay in the kernel
+    //              between waits, so a wait costs the same however many
+    //              connections are idle. Falls back to POLL when the kernel
+    //              lacks io_uring or it is disabled (e.g. by seccomp).
+    enum class SocketEventBackend {
+        POLL,
+        IO_URING
+    };
+
     class SECURITYSOCKET_API SocketConfiguration {
     public:
         constexpr static size_t MAX_PDU_SIZE = 65536;
@@ -133,6 +148,58 @@ namespace Bn3Monkey
         inline uint32_t read_timeout() { return _read_timeout; } 
         inline uint32_t write_timeout() { return _write_timeout; }
         inline uint32_t time_between_retries() { return _time_between_retries;  }
+        inline SocketEventBackend event_backend() { return _event_backend; }
+        inline void setEventBackend(SocketEventBackend event_backend) { _event_backend = event_backend; }
+
+        // Deadlines SocketRequestServer enforces on each connection, in ms;
+        // 0 (the default) turns one off. A connection past one is closed.
+        // idle : no bytes moved while waiting on the client, between requests
+        //        (keep-alive) or in the middle of one.
+        // request read : from the first byte of a request until its header
+        //        and payload are all read, so a client trickling bytes
+        //        (slowloris) cannot hold the connection.
+        // processing : a SLOW-mode request the handler has not completed.
+        inline uint32_t idle_timeout() { return _idle_timeout; }
+        inline void setIdleTimeout(uint32_t idle_timeout) { _idle_timeout = idle_timeout; }
+        inline uint32_t request_read_timeout() { return _request_read_timeout; }
+        inline void setRequestReadTimeout(uint32_t request_read_timeout) { _request_read_timeout = request_read_timeout; }
+        inline uint32_t processing_timeout() { return _processing_timeout; }
+        inline void setProcessingTimeout(uint32_t processing_timeout) { _processing_timeout = processing_timeout; }
+
+        // SocketDatagramClient / SocketDatagramServer: datagrams moved per
+        // system call (sendmmsg() / recvmmsg() on Linux), 1 ~ 1024. The server
+        // takes in datagrams of up to pdu_size() bytes and cuts longer ones.
+        inline uint32_t datagram_batch_size() { return _datagram_batch_size; }
+        inline void setDatagramBatchSize(uint32_t datagram_batch_size) { _datagram_batch_size = datagram_batch_size; }
+        // UDP segmentation offload (Linux). The client hands the kernel runs of
+        // equal-sized datagrams as one buffer (GSO), and the server takes in a
+        // flow's datagrams coalesced (GRO), split again before the handler sees
+        // them. Ignored where the kernel cannot.
+        inline bool segmentation_offload() { return _segmentation_offload; }
+        inline void setSegmentationOffload(bool segmentation_offload) { _segmentation_offload = segmentation_offload; }
+        // SocketClient / SocketRequestServer over a unix domain socket
+        // (Linux, without TLS): bytes of shared memory per direction, 0 (the
+        // default) for none. The client offers a memfd right after connect(),
+        // and the server moves the connection's stream into it, keeping the
+        // socket for wakeups. A client may only offer to a server that has it
+        // set too; such a server still serves clients that do not offer, but
+        // reports a connection only once its offer or first request arrives,
+        // within read_timeout() * max_retries().
+        inline uint32_t shared_memory_size() { return _shared_memory_size; }
+        inline void setSharedMemorySize(uint32_t shared_memory_size) { _shared_memory_size = shared_memory_size; }
+        // Microseconds a SocketClient's shared-memory reader spins on an empty
+        // ring before it sleeps on the socket. While it spins the writer sends
+        // no wakeup. A server never spins: its one thread serves every
+        // connection. Ignored when the process can only run on one CPU.
+        inline uint32_t busy_poll_time() { return _busy_poll_time; }
+        inline void setBusyPollTime(uint32_t busy_poll_time) { _busy_poll_time = busy_poll_time; }
+        // SocketRequestServer over a unix domain socket (not on Windows, TLS
+        // or shared memory): a descriptor a client passes with
+        // SocketClient::sendDescriptor() is served as a connection of its
+        // own, as adopt() does. The bytes it came with are read as usual.
+        // Off by default: the kernel then closes passed descriptors unread.
+        inline bool descriptor_passing() { return _descriptor_passing; }
+        inline void setDescriptorPassing(bool descriptor_passing) { _descriptor_passing = descriptor_passing; }
 
 
         explicit SocketConfiguration(
@@ -165,6 +232,15 @@ namespace Bn3Monkey
         uint32_t _write_timeout{ 0 };
         uint32_t _time_between_retries{ 0 };
         bool _is_unix_domain{ false };
+        SocketEventBackend _event_backend{ SocketEventBackend::POLL };
+        uint32_t _idle_timeout{ 0 };
+        uint32_t _request_read_timeout{ 0 };
+        uint32_t _processing_timeout{ 0 };
+        uint32_t _datagram_batch_size{ 32 };
+        bool _segmentation_offload{ false };
+        uint32_t _shared_memory_size{ 0 };
+        uint32_t _busy_poll_time{ 0 };
+        bool _descriptor_passing{ false };
     };
 
 
@@ -237,6 +313,68 @@ namespace Bn3Monkey
             return _on_tls_event;
         }
 
+        // Keep the session of each connection and offer it on the next
+        // connect() to the same host and port, so reconnecting clients skip the
+        // full handshake (TLS 1.2 session ID / ticket, TLS 1.3 PSK ticket).
+        // The TlsEventCallback tells resumed and full handshakes apart.
+        inline void setSessionResumption(bool resume_session) {
+            _resume_session = resume_session;
+        }
+        inline bool shouldResumeSession() const { return _resume_session; }
+
+        // Let the Linux kernel (kTLS) encrypt and decrypt records once the
+        // handshake is done, so read()/write() skip the user-space copy. Used
+        // only where the kernel, OpenSSL and the negotiated cipher support it;
+        // otherwise OpenSSL keeps doing it, with no difference to the caller.
+        // The TlsEventCallback reports which directions were offloaded.
+        inline void setKernelTLS(bool use_kernel_tls) {
+            _use_kernel_tls = use_kernel_tls;
+        }
+        inline bool shouldUseKernelTLS() const { return _use_kernel_tls; }
+
+        // Hold writes smaller than flush_threshold bytes and send them together
+        // as full records once the threshold is reached, instead of one record
+        // (and one syscall) per write(). Held data is also sent before read()
+        // and by flush(). 0 (the default) sends every write() immediately.
+        inline void setWriteCoalescing(uint32_t flush_threshold) {
+            _write_coalescing_threshold = flush_threshold;
+        }
+        inline uint32_t writeCoalescingThreshold() const { return _write_coalescing_threshold; }
+
+        // Send small records (one TCP segment each) while the connection is
+        // fresh or has been idle, and 16 KB records once about 1 MB has gone
+        // out. Lowers time-to-first-byte without giving up bulk throughput.
+        inline void setDynamicRecordSizing(bool use_dynamic_record_sizing) {
+            _use_dynamic_record_sizing = use_dynamic_record_sizing;
+        }
+        inline bool shouldUseDynamicRecordSizing() const { return _use_dynamic_record_sizing; }
+
+        // Let OpenSSL free its record buffers while the connection is idle
+        // (SSL_MODE_RELEASE_BUFFERS). Saves about 34 KB per idle connection at
+        // the cost of reallocating them on the next read / write.
+        inline void setReleaseBuffers(bool release_buffers) {
+            _release_buffers = release_buffers;
+        }
+        inline bool shouldReleaseBuffers() const { return _release_buffers; }
+
+        // TLS 1.3 servers reject a client certificate only after the client's
+        // handshake has finished, so connect() waits for such an alert before
+        // it returns (the post-handshake probe). With fast connect it returns
+        // as soon as the handshake is done. A rejection then comes out of the
+        // first read() or write() as TLS_CLIENT_CERT_REJECTED (or the matching
+        // TLS error) instead.
+        inline void setFastConnect(bool fast_connect) {
+            _fast_connect = fast_connect;
+        }
+        inline bool shouldFastConnect() const { return _fast_connect; }
+
+        // Upper bound of the whole post-handshake probe. 0 (the default) uses
+        // the read timeout of the SocketConfiguration.
+        inline void setHandshakeProbeTimeout(uint32_t timeout_ms) {
+            _handshake_probe_timeout = timeout_ms;
+        }
+        inline uint32_t handshakeProbeTimeout() const { return _handshake_probe_timeout; }
+
 
         inline bool valid() const { return _tls_versions != 0; }
         inline bool isVersionSupported(SocketTLSVersion version) const { return _tls_versions & static_cast<int32_t>(version); }
@@ -258,7 +396,13 @@ namespace Bn3Monkey
         bool _verify_server{ false };
         bool _verify_hostname{ false };
         bool _use_client_certificate{ false };
-        bool _reserved{ false };
+        bool _resume_session{ false };
+        bool _use_kernel_tls{ false };
+        bool _use_dynamic_record_sizing{ false };
+        bool _release_buffers{ false };
+        uint32_t _write_coalescing_threshold{ 0 };
+        bool _fast_connect{ false };
+        uint32_t _handshake_probe_timeout{ 0 };
 
         char _server_trust_store_path[256]{ 0 };
         char _client_cert_file_path[256]{ 0 };
@@ -310,6 +454,66 @@ namespace Bn3Monkey
         inline TlsEventCallback getOnTLSEvent() const {
             return _on_tls_event;
         }
+
+        // Kernel TLS offload for accepted connections. See
+        // SocketTLSClientConfiguration::setKernelTLS().
+        inline void setKernelTLS(bool use_kernel_tls) {
+            _use_kernel_tls = use_kernel_tls;
+        }
+        inline bool shouldUseKernelTLS() const { return _use_kernel_tls; }
+
+        // Number of threads that run handshakes of new connections, so
+        // accepting scales past one core. 0 (the default) runs them on the
+        // server thread. Established connections are served by the server
+        // thread either way.
+        inline void setHandshakeThreads(uint32_t num_of_threads) {
+            _handshake_threads = num_of_threads;
+        }
+        inline uint32_t handshakeThreads() const { return _handshake_threads; }
+
+        // Record sizing and buffer release for accepted connections. See
+        // SocketTLSClientConfiguration::setDynamicRecordSizing() and
+        // setReleaseBuffers(). Servers already write each response with a
+        // single call, so there is no write coalescing knob here.
+        inline void setDynamicRecordSizing(bool use_dynamic_record_sizing) {
+            _use_dynamic_record_sizing = use_dynamic_record_sizing;
+        }
+        inline bool shouldUseDynamicRecordSizing() const { return _use_dynamic_record_sizing; }
+        inline void setReleaseBuffers(bool release_buffers) {
+            _release_buffers = release_buffers;
+        }
+        inline bool shouldReleaseBuffers() const { return _release_buffers; }
+
+        // Run OpenSSL over memory buffers and move the ciphertext with the
+        // library's own batched recv() / send(): one recv() picks up several
+        // records, and decrypting them costs no further syscalls. Ignored when
+        // kernel TLS is enabled, which needs OpenSSL to own the socket.
+        // Server connections only; clients keep OpenSSL's socket BIO.
+        inline void setMemoryBIO(bool use_memory_bio) {
+            _use_memory_bio = use_memory_bio;
+        }
+        inline bool shouldUseMemoryBIO() const { return _use_memory_bio; }
+
+        // TLS 1.3 early data (0-RTT). A client that resumes a session may send
+        // its first request along with the ClientHello, and the server answers
+        // it before the handshake has finished. Up to max_early_data bytes are
+        // accepted; 0 (the default) rejects early data, and the client then
+        // sends the request again after the handshake.
+        //
+        // An attacker can record a ClientHello and send it again, so early data
+        // may be delivered twice. Only accept it when every request clients
+        // send this way is idempotent. Anti-replay (on by default) makes each
+        // session ticket good for early data once, which stops replays against
+        // this server but not against other servers resuming the same tickets.
+        inline void setMaxEarlyData(uint32_t max_early_data) {
+            _max_early_data = max_early_data;
+        }
+        inline uint32_t maxEarlyData() const { return _max_early_data; }
+        inline void setEarlyDataAntiReplay(bool use_anti_replay) {
+            _use_early_data_anti_replay = use_anti_replay;
+        }
+        inline bool shouldPreventEarlyDataReplay() const { return _use_early_data_anti_replay; }
+
         inline bool valid() const { return _tls_versions != 0; }
         inline bool isVersionSupported(SocketTLSVersion version) const { return _tls_versions & static_cast<int32_t>(version); }
         void generateTLS12CipherSuites(char* ret) const;
@@ -325,6 +529,13 @@ namespace Bn3Monkey
 		int32_t _tls_1_2_cipher_suites{ 0 };
 		int32_t _tls_1_3_cipher_suites{ 0 };
 		SocketTLSClientAuthenticationMode _client_authentication_mode{ SocketTLSClientAuthenticationMode::AUTH_MODE_NONE };
+		bool _use_kernel_tls{ false };
+		uint32_t _handshake_threads{ 0 };
+		bool _use_dynamic_record_sizing{ false };
+		bool _release_buffers{ false };
+		bool _use_memory_bio{ false };
+		uint32_t _max_early_data{ 0 };
+		bool _use_early_data_anti_replay{ true };
 
         char _client_trust_store_path[256]{ 0 };
         char _server_cert_file_path[256]{ 0 };
@@ -333,6 +544,13 @@ namespace Bn3Monkey
         TlsEventCallback _on_tls_event{ nullptr };
     };
 
+    // One piece of a scatter / gather write or read (SocketClient::writev(),
+    // readv()). Laid out like POSIX iovec.
+    struct SocketIOBuffer
+    {
+        void* data{ nullptr };
+        size_t size{ 0 };
+    };
 
     class SECURITYSOCKET_API SocketClient
     {
@@ -347,14 +565,188 @@ namespace Bn3Monkey
         void close();
 
         SocketResult connect();
+        // connect(), then `early_data` as the first bytes of the stream. When
+        // a TLS 1.3 session is resumed and the server accepts early data (see
+        // SocketTLSServerConfiguration::setMaxEarlyData()), it travels with
+        // the ClientHello and saves a round trip; otherwise it is written right
+        // after the handshake. bytes() is the size sent as early data, 0 if it
+        // was written normally. Early data can be replayed by an attacker, so
+        // only send idempotent requests this way.
+        SocketResult connect(const void* early_data, size_t size);
         SocketResult read(void* buffer, size_t size);
         SocketResult write(const void* buffer, size_t size);
+        // write() of the buffers one after another, without copying them into
+        // one: a header and its body go out in one system call (up to
+        // MAX_IO_BUFFERS pieces at a time). Over TLS, small pieces are gathered
+        // into full records. bytes() is the total written.
+        SocketResult writev(const SocketIOBuffer* buffers, size_t count);
+        // read() into the buffers one after another. Like read(), it returns
+        // what one read brings in, which may fill only some of them.
+        SocketResult readv(const SocketIOBuffer* buffers, size_t count);
+        static constexpr size_t MAX_IO_BUFFERS = 64;
+        // Unix domain sockets only (not on Windows, TLS or shared memory).
+        // write() of buffer with descriptor attached to its first byte
+        // (SCM_RIGHTS), so size must be at least 1. The peer gets a copy of
+        // the descriptor; the caller still owns its own. A SocketRequestServer
+        // with SocketConfiguration::setDescriptorPassing() serves a passed
+        // connection as one of its own.
+        SocketResult sendDescriptor(int32_t descriptor, const void* buffer, size_t size);
+        // read() that also takes a descriptor passed with the bytes it reads.
+        // *descriptor is -1 if none came, otherwise the caller owns it
+        // (close-on-exec) and may hand it to SocketRequestServer::adopt().
+        SocketResult receiveDescriptor(void* buffer, size_t size, int32_t* descriptor);
+        // Sends writes held back by SocketTLSClientConfiguration::setWriteCoalescing().
+        // SUCCESS at once when nothing is held.
+        SocketResult flush();
         SocketResult isConnected();
+        // Cheap, non-blocking check that an idle connection is still usable.
+        // Unlike isConnected(), it never waits for data.
+        // - SUCCESS, bytes() == 0 : open, nothing unread
+        // - SUCCESS, bytes() > 0  : open, but unread data is waiting
+        // - otherwise             : closed by the peer or broken
+        SocketResult isAlive();
+
+    private:
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
+
+
+    // Connected SocketClients to one endpoint (the pool's configuration), kept
+    // ready for reuse so a request does not pay for a TCP / TLS handshake.
+    // A background thread pre-warms up to min_idle connections and drops idle
+    // ones the peer has closed; at most max_idle are kept once released.
+    class SECURITYSOCKET_API SocketClientPool
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+
+        explicit SocketClientPool(const SocketConfiguration& configuration, size_t min_idle = 1, size_t max_idle = 8);
+        explicit SocketClientPool(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, size_t min_idle = 1, size_t max_idle = 8);
+        virtual ~SocketClientPool();
+
+        SocketResult open();
+        // Destroys the idle clients. Clients still acquired stay valid and are
+        // destroyed when released.
+        void close();
+
+        // Hands out a connected client: a healthy idle one if there is one,
+        // otherwise a new connection made on the calling thread.
+        SocketResult acquire(SocketClient** client);
+        // Gives a client back. It is kept only if it is healthy with nothing
+        // unread and the pool has room; otherwise it is closed and destroyed.
+        void release(SocketClient* client);
+        // Destroys a client that must not be reused (e.g. after a protocol error).
+        void discard(SocketClient* client);
 
     private:
         char _container[IMPLEMENTATION_SIZE]{ 0 };
     };
 
+    // Tells SocketMultiplexClient where the correlation id lives in the
+    // application's messages. The server must copy the id of each request
+    // into its response; responses may then come back in any order.
+    struct SECURITYSOCKET_API SocketMultiplexCodec
+    {
+        virtual ~SocketMultiplexCodec() = default;
+
+        virtual size_t getResponseHeaderSize() = 0;
+        virtual size_t getResponsePayloadSize(const char* header) = 0;
+        virtual uint64_t getResponseId(const char* header) = 0;
+        // Stamp `id` into an outgoing request (a private copy of the caller's bytes).
+        virtual void setRequestId(char* request, size_t size, uint64_t id) = 0;
+    };
+
+    struct SocketMultiplexResponse
+    {
+        // bytes() is the payload size on success.
+        SocketResult result;
+        std::vector<char> header;
+        std::vector<char> payload;
+    };
+
+    // Many in-flight requests on a single connection. Requests are written as
+    // they come (from any number of threads), one reader thread hands each
+    // response to the future of the request carrying the same id.
+    // Once `window` requests are outstanding, request() blocks until one
+    // completes (for at most max_retries * write_timeout, then SOCKET_TIMEOUT).
+    class SECURITYSOCKET_API SocketMultiplexClient
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+
+        explicit SocketMultiplexClient(const SocketConfiguration& configuration, SocketMultiplexCodec* codec, size_t window = 64);
+        explicit SocketMultiplexClient(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, SocketMultiplexCodec* codec, size_t window = 64);
+        virtual ~SocketMultiplexClient();
+
+        // Opens and connects.
+        SocketResult open();
+        // Outstanding requests complete with SOCKET_CLOSED.
+        void close();
+
+        // `request` holds a whole message (header and payload); it is copied.
+        std::future<SocketMultiplexResponse> request(const void* request, size_t size);
+        size_t outstanding();
+
+    private:
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
+
+    // Completion of an AsyncSocketClient operation. Runs on the thread of the
+    // SocketEventLoop the client belongs to, so it must not block; chaining the
+    // next operation from inside the callback is the intended usage.
+    using SocketCompletionCallback = std::function<void(SocketResult)>;
+
+    // One thread driving any number of AsyncSocketClients through a single
+    // event listener. Close every client before closing the loop; operations
+    // still pending when the loop closes complete with SOCKET_CLOSED.
+    class SECURITYSOCKET_API SocketEventLoop
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 1024;
+
+        SocketEventLoop();
+        virtual ~SocketEventLoop();
+
+        SocketResult open();
+        void close();
+
+    private:
+        friend class AsyncSocketClient;
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
+
+    // Non-blocking SocketClient. connectAsync / readAsync / writeAsync return
+    // immediately and complete later on the loop thread, either through the
+    // callback or through the returned future (never wait on such a future
+    // from inside a completion callback).
+    // - readAsync completes as soon as any bytes arrive, like SocketClient::read.
+    // - writeAsync completes once every byte has been written.
+    // - Operations of one kind complete in submission order.
+    // - Buffers must stay valid until the operation completes.
+    class SECURITYSOCKET_API AsyncSocketClient
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+
+        explicit AsyncSocketClient(SocketEventLoop& loop, const SocketConfiguration& configuration);
+        explicit AsyncSocketClient(SocketEventLoop& loop, const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration);
+        virtual ~AsyncSocketClient();
+
+        SocketResult open();
+        // Pending operations complete with SOCKET_CLOSED before close() returns.
+        void close();
+
+        void connectAsync(SocketCompletionCallback callback);
+        void readAsync(void* buffer, size_t size, SocketCompletionCallback callback);
+        void writeAsync(const void* buffer, size_t size, SocketCompletionCallback callback);
+
+        std::future<SocketResult> connectAsync();
+        std::future<SocketResult> readAsync(void* buffer, size_t size);
+        std::future<SocketResult> writeAsync(const void* buffer, size_t size);
+
+    private:
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
 
     /*
     struct SECURITYSOCKET_API SocketRequestHandler
@@ -396,6 +788,40 @@ namespace Bn3Monkey
         WRITE_STREAM
     };
 
+    struct SocketRequestCompletionState;
+
+    // Finishes one SLOW-mode request handed to SocketRequestHandler::onProcessedAsync().
+    // Copyable, and safe to use from any thread.
+    class SECURITYSOCKET_API SocketRequestCompletion
+    {
+    public:
+        SocketRequestCompletion() = default;
+        explicit SocketRequestCompletion(std::shared_ptr<SocketRequestCompletionState> state) : _state(std::move(state)) {}
+
+        // Copies `size` bytes of response and queues them for the client.
+        // size == 0 finishes the request without a response.
+        // - SOCKET_INVALID_ARGUMENT : size is larger than pdu_size.
+        // - SOCKET_CLOSED : already completed, or the server closed.
+        SocketResult complete(const void* response, size_t size) const;
+
+    private:
+        std::shared_ptr<SocketRequestCompletionState> _state;
+    };
+
+    // The part of a READ_STREAM response the server streams from a file
+    // descriptor. See SocketRequestHandler::onFileRequested().
+    struct SocketFileRange
+    {
+        // A regular file, or the read end of a pipe.
+        int32_t fd{ -1 };
+        // Where the range starts; ignored for pipes, which are read from
+        // wherever they are.
+        int64_t offset{ 0 };
+        uint64_t size{ 0 };
+        // Closes fd once the range is sent or the connection drops.
+        bool close_after{ false };
+    };
+
     struct SECURITYSOCKET_API SocketRequestHandler
     {
         virtual size_t getHeaderSize() = 0;
@@ -421,8 +847,108 @@ namespace Bn3Monkey
             const char* input_buffer,
             size_t input_size
         ) = 0;
+
+        // SLOW mode. Return true to take ownership of the request and finish it
+        // later, from any thread, through completion.complete(); the server
+        // keeps serving other clients meanwhile. header and input_buffer are
+        // only valid during this call.
+        // Return false (the default) to process it through onProcessed() like FAST.
+        virtual bool onProcessedAsync(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            SocketRequestCompletion completion
+        ) {
+            (void)header;
+            (void)input_buffer;
+            (void)input_size;
+            (void)completion;
+            return false;
+        }
+
+        // READ_STREAM mode. Return true to answer with output_buffer[0, *output_size)
+        // (a header of your protocol, or nothing) followed by file->size bytes of
+        // file->fd, which the server streams without copying them through user
+        // space where it can: sendfile() for files and splice() for pipes on
+        // Linux, SSL_sendfile() over kernel TLS. The server thread never blocks
+        // on the descriptor; an empty pipe is waited for like a socket.
+        // A file or pipe that ends before file->size bytes closes the connection.
+        // Return false (the default) to answer through onProcessed().
+        virtual bool onFileRequested(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size,
+            SocketFileRange* file
+        ) {
+            (void)header;
+            (void)input_buffer;
+            (void)input_size;
+            (void)output_buffer;
+            (void)output_size;
+            (void)file;
+            return false;
+        }
     };
 
+    // Latency distribution in nanoseconds. Each power of two is split into
+    // linear buckets no wider than 1/32 of their values, so a percentile is
+    // at most about 3% above the true value. Values of 2^37 ns (about 137 s)
+    // and more land in the last bucket.
+    struct SECURITYSOCKET_API SocketLatencyHistogram
+    {
+        static constexpr size_t SUB_BUCKET_BITS = 6;
+        static constexpr size_t NUM_OF_BUCKETS = (37 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+        uint64_t count{ 0 };
+        uint64_t sum_ns{ 0 };
+        uint64_t max_ns{ 0 };
+        uint64_t buckets[NUM_OF_BUCKETS]{ 0 };
+
+        // Upper bound of the bucket holding the percentile-th (0 ~ 100)
+        // value. 0 when nothing was recorded.
+        uint64_t percentile(double percentile) const;
+        inline uint64_t mean() const { return count > 0 ? sum_ns / count : 0; }
+
+        static size_t bucketOf(uint64_t ns);
+        static uint64_t upperBoundOf(size_t bucket);
+    };
+
+    // What a server has done since it was constructed, summed over every
+    // thread that worked for it. Counters never go back, so the rate of
+    // anything is the difference of two snapshots.
+    struct SECURITYSOCKET_API SocketServerMetrics
+    {
+        uint64_t accepted_connections{ 0 };
+        // Closed for any reason, including clients turned away right after
+        // accept. accepted - closed is the number of open connections.
+        uint64_t closed_connections{ 0 };
+        // Closed for missing a deadline: the TLS handshake's, or the idle,
+        // request read or processing timeout of SocketConfiguration. Also
+        // counted in closed_connections.
+        uint64_t timed_out_connections{ 0 };
+        uint64_t bytes_received{ 0 };
+        uint64_t bytes_sent{ 0 };
+        // Requests by SocketRequestMode, e.g. requests[static_cast<size_t>(SocketRequestMode::SLOW)].
+        uint64_t requests[4]{ 0 };
+        // Handed to the SocketDatagramHandler of a SocketDatagramServer.
+        uint64_t datagrams_received{ 0 };
+        // Returns from the server thread's event wait, timeouts included.
+        uint64_t event_loop_wakeups{ 0 };
+        // Time spent in onProcessed(), onProcessedWithoutResponse() and
+        // onProcessedAsync() of the SocketRequestHandler.
+        uint64_t processing_time_ns{ 0 };
+
+        // SocketRequestServer: from the first byte of a request to the last
+        // byte of its response (or the handler's return, without a response).
+        SocketLatencyHistogram request_service_time;
+        // SocketBroadcastServer: one write() to every client.
+        SocketLatencyHistogram broadcast_fanout_time;
+    };
+
+    using SocketTimerCallback = std::function<void()>;
+
     struct SECURITYSOCKET_API SocketBroadcastHandler {
         virtual ~SocketBroadcastHandler() = default;
         virtual void onClientConnected(const char* ip, int port) = 0;
@@ -434,15 +960,45 @@ namespace Bn3Monkey
     class SECURITYSOCKET_API SocketRequestServer
     {
     public:
-        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+        static constexpr size_t IMPLEMENTATION_SIZE = 4096;
 
         explicit SocketRequestServer(const SocketConfiguration& configuration);
         explicit SocketRequestServer(const SocketConfiguration& configuration, const SocketTLSServerConfiguration& tls_configuration);
         virtual ~SocketRequestServer();
 
+        // Serves up to num_of_clients connections at once (at least 32).
+        // Clients beyond that are disconnected right after accept.
         SocketResult open(SocketRequestHandler* handler, size_t num_of_clients);
         void close();
 
+        // Safe from any thread, at any time. Recording costs the server a few
+        // nanoseconds per counter and a clock read per timing; only
+        // snapshot() pays for adding the threads up.
+        SocketServerMetrics snapshot();
+        // The backend the open server waits on: POLL where IO_URING was asked
+        // for but the kernel could not run it, and while the server is closed.
+        SocketEventBackend eventBackend();
+
+        // Runs callback on the server thread once delay_ms has passed, and
+        // returns the id cancelTimer() takes (0 if the server is not open).
+        // close() drops every timer.
+        uint64_t addTimer(uint32_t delay_ms, SocketTimerCallback callback);
+        // Does nothing if the timer has already run.
+        void cancelTimer(uint64_t timer_id);
+
+        // Runs task on the server thread as soon as it is free, waking it if
+        // it is waiting for events. Tasks run in the order they were posted;
+        // those still queued when the server closes never run.
+        // SOCKET_CLOSED if the server is not open.
+        SocketResult post(std::function<void()> task);
+
+        // Serves descriptor, a connected stream socket, as if the server had
+        // accepted it: a TCP connection another process accepted and passed
+        // over a unix domain socket, for example. The server owns it on
+        // SUCCESS. SOCKET_INVALID_ARGUMENT if it is not a connected stream
+        // socket (a listening one is not) and SOCKET_CLOSED if the server is not open; the caller keeps it then.
+        SocketResult adopt(int32_t descriptor);
+
     private:
         char _container[IMPLEMENTATION_SIZE]{ 0 };
     };
@@ -461,13 +1017,21 @@ namespace Bn3Monkey
 
         SocketResult write(const void* buffer, size_t size);
 
+        // See SocketRequestServer::snapshot().
+        SocketServerMetrics snapshot();
+        // See SocketRequestServer::eventBackend().
+        SocketEventBackend eventBackend();
+
         // Block until at least one healthy client is connected, or until timeout_ms
         // elapses. Stale clients (peer already closed) are detected and pruned as
         // part of the wait, so each successful return reflects a live peer.
         SocketResult await(uint64_t timeout_ms);
-        // Block until every currently-active client has closed (peer FIN received),
-        // or until timeout_ms elapses. Use as an explicit barrier between broadcast
-        // rounds so the next await() starts from a clean active list.
+        // Block until every client that was active when await() last returned
+        // has closed (peer FIN received) or been dropped, or until timeout_ms
+        // elapses; without an await() since the last awaitClose(), every client
+        // active now. Clients that connect after that are not waited for. Use as
+        // an explicit barrier between broadcast rounds so the next await() only
+        // sees clients of the next round.
         SocketResult awaitClose(uint64_t timeout_ms);
 
         // Forcibly disconnect every currently-active client. Closes each socket,
@@ -475,8 +1039,81 @@ namespace Bn3Monkey
         // when a peer is known to have abandoned its socket without sending FIN
         // (e.g., reconnecting via a fresh socket without closing the old one) —
         // the kernel reports no POLLHUP for those, so the accept-monitor has no
-        // signal to clean them up on its own.
+        // signal to clean them up on its own. The handler is called on the
+        // server thread, and dropAll() returns once it is done.
         void dropAll();
+
+        // See SocketRequestServer::post().
+        SocketResult post(std::function<void()> task);
+    private:
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
+
+    // One UDP (or unix-domain) datagram.
+    struct SocketDatagram
+    {
+        const char* data{ nullptr };
+        size_t size{ 0 };
+        // The sender. Empty and 0 for unix-domain datagrams.
+        const char* ip{ nullptr };
+        int port{ 0 };
+    };
+
+    struct SECURITYSOCKET_API SocketDatagramHandler {
+        virtual ~SocketDatagramHandler() = default;
+        // On the server thread, with what one receive took in (up to
+        // SocketConfiguration::datagram_batch_size() datagrams, more with
+        // segmentation offload). The datagrams are valid during the call only.
+        virtual void onDatagramsReceived(const SocketDatagram* datagrams, size_t count) = 0;
+    };
+
+    // Sends fire-and-forget datagrams (UDP, or a unix-domain SOCK_DGRAM socket)
+    // to the address of its configuration. Nothing tells it whether they
+    // arrived.
+    class SECURITYSOCKET_API SocketDatagramClient
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+        // The largest UDP payload over IPv4.
+        static constexpr size_t MAX_DATAGRAM_SIZE = 65507;
+
+        explicit SocketDatagramClient(const SocketConfiguration& configuration);
+        virtual ~SocketDatagramClient();
+
+        SocketResult open();
+        void close();
+
+        // One datagram. bytes() is size.
+        SocketResult write(const void* buffer, size_t size);
+        // One datagram per buffer, up to datagram_batch_size() per system call.
+        // bytes() is the number of datagrams sent, fewer than count only
+        // alongside an error.
+        SocketResult writeBatch(const SocketIOBuffer* datagrams, size_t count);
+
+    private:
+        char _container[IMPLEMENTATION_SIZE]{ 0 };
+    };
+
+    // Takes in datagrams at the address of its configuration on a server
+    // thread, and hands them to the SocketDatagramHandler in batches.
+    class SECURITYSOCKET_API SocketDatagramServer
+    {
+    public:
+        static constexpr size_t IMPLEMENTATION_SIZE = 2048;
+
+        explicit SocketDatagramServer(const SocketConfiguration& configuration);
+        virtual ~SocketDatagramServer();
+
+        SocketResult open(SocketDatagramHandler* handler);
+        void close();
+
+        // See SocketRequestServer::snapshot().
+        SocketServerMetrics snapshot();
+        // See SocketRequestServer::eventBackend().
+        SocketEventBackend eventBackend();
+        // See SocketRequestServer::post().
+        SocketResult post(std::function<void()> task);
+
     private:
         char _container[IMPLEMENTATION_SIZE]{ 0 };
     };
@@ -484,6 +1121,10 @@ namespace Bn3Monkey
 
     bool SECURITYSOCKET_API initializeSecuritySocket();
     void SECURITYSOCKET_API releaseSecuritySocket();
+    // Writes the trace points recorded so far as Chrome trace-event JSON
+    // (chrome://tracing, Perfetto). false if the library was built without
+    // SECURITYSOCKET_USING_TRACE or the file cannot be written.
+    bool SECURITYSOCKET_API dumpSecuritySocketTrace(const char* path);
 }
 
 #endif
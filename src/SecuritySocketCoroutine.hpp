@@ -0,0 +1,272 @@
+#if !defined(__BN3MONKEY_SECURITY_SOCKET_COROUTINE__)
+#define __BN3MONKEY_SECURITY_SOCKET_COROUTINE__
+
+// Opt-in C++20 coroutine layer over AsyncSocketClient and the SLOW request mode.
+// Header-only: the library itself is still built as C++17, so including this
+// header is the only thing a C++20 consumer has to do.
+
+#if !defined(__cpp_impl_coroutine)
+#error "SecuritySocketCoroutine.hpp requires C++20 coroutines (e.g. -std=c++20)"
+#endif
+
+#include "SecuritySocket.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace Bn3Monkey
+{
+    template<typename T>
+    class SocketTask;
+
+    namespace detail
+    {
+        template<typename T>
+        struct SocketTaskPromiseBase
+        {
+            std::coroutine_handle<> continuation;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    auto continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            // The library reports failures through SocketResult, never by throwing.
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+        template<typename T>
+        struct SocketTaskPromise : public SocketTaskPromiseBase<T>
+        {
+            std::optional<T> value;
+
+            SocketTask<T> get_return_object() noexcept;
+            void return_value(T result) { value = std::move(result); }
+            T take() { return std::move(*value); }
+        };
+
+        template<>
+        struct SocketTaskPromise<void> : public SocketTaskPromiseBase<void>
+        {
+            SocketTask<void> get_return_object() noexcept;
+            void return_void() noexcept {}
+            void take() noexcept {}
+        };
+
+        // Fire-and-forget frame used by spawnSocketTask(). Starts eagerly and
+        // frees itself when it finishes.
+        struct SocketDetachedTask
+        {
+            struct promise_type
+            {
+                SocketDetachedTask get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+    }
+
+    // Lazily started coroutine. It runs when it is co_await-ed (or passed to
+    // spawnSocketTask()) and resumes the awaiting coroutine when it finishes,
+    // on whichever thread completed its last I/O.
+    template<typename T = void>
+    class SocketTask
+    {
+    public:
+        using promise_type = detail::SocketTaskPromise<T>;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        SocketTask() = default;
+        explicit SocketTask(handle_type handle) : _handle(handle) {}
+        SocketTask(SocketTask&& other) noexcept : _handle(other._handle) { other._handle = nullptr; }
+        SocketTask& operator=(SocketTask&& other) noexcept {
+            if (this != &other) {
+                if (_handle)
+                    _handle.destroy();
+                _handle = other._handle;
+                other._handle = nullptr;
+            }
+            return *this;
+        }
+        SocketTask(const SocketTask&) = delete;
+        SocketTask& operator=(const SocketTask&) = delete;
+        ~SocketTask() {
+            if (_handle)
+                _handle.destroy();
+        }
+
+        bool await_ready() const noexcept { return !_handle || _handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            _handle.promise().continuation = awaiting;
+            return _handle;
+        }
+        T await_resume() { return _handle.promise().take(); }
+
+    private:
+        handle_type _handle{ nullptr };
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        inline SocketTask<T> SocketTaskPromise<T>::get_return_object() noexcept {
+            return SocketTask<T>{ std::coroutine_handle<SocketTaskPromise<T>>::from_promise(*this) };
+        }
+        inline SocketTask<void> SocketTaskPromise<void>::get_return_object() noexcept {
+            return SocketTask<void>{ std::coroutine_handle<SocketTaskPromise<void>>::from_promise(*this) };
+        }
+    }
+
+    // Start a task without awaiting it. on_finished receives the task's result
+    // (nothing for SocketTask<void>) on the thread the task finished on.
+    template<typename T, typename Callback>
+    inline void spawnSocketTask(SocketTask<T> task, Callback on_finished)
+    {
+        [](SocketTask<T> task, Callback on_finished) -> detail::SocketDetachedTask {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                on_finished();
+            }
+            else {
+                on_finished(co_await task);
+            }
+        }(std::move(task), std::move(on_finished));
+    }
+
+    // Awaits one AsyncSocketClient operation. The launcher starts the operation
+    // with a completion callback; the coroutine resumes on the loop thread.
+    template<typename Launcher>
+    class SocketOperationAwaiter
+    {
+    public:
+        explicit SocketOperationAwaiter(Launcher launcher) : _launcher(std::move(launcher)) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            _handle = handle;
+            _launcher([this](SocketResult result) {
+                _result = result;
+                // Whoever comes second resumes: the callback if the coroutine
+                // is already suspended, await_suspend() otherwise.
+                if (_is_ready.exchange(true, std::memory_order_acq_rel))
+                    _handle.resume();
+            });
+            return !_is_ready.exchange(true, std::memory_order_acq_rel);
+        }
+        SocketResult await_resume() const noexcept { return _result; }
+
+    private:
+        Launcher _launcher;
+        std::coroutine_handle<> _handle;
+        SocketResult _result;
+        std::atomic<bool> _is_ready{ false };
+    };
+
+    // AsyncSocketClient with co_await-able operations.
+    //
+    //     SocketTask<SocketResult> echo(SocketCoroutineClient& client) {
+    //         co_await client.connect();
+    //         co_await client.write("ping", 4);
+    //         char buffer[4];
+    //         co_return co_await client.readFully(buffer, 4);
+    //     }
+    class SocketCoroutineClient
+    {
+    public:
+        explicit SocketCoroutineClient(SocketEventLoop& loop, const SocketConfiguration& configuration)
+            : _client(loop, configuration) {}
+        explicit SocketCoroutineClient(SocketEventLoop& loop, const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration)
+            : _client(loop, configuration, tls_configuration) {}
+
+        SocketResult open() { return _client.open(); }
+        void close() { _client.close(); }
+
+        auto connect() {
+            return makeAwaiter([this](SocketCompletionCallback callback) {
+                _client.connectAsync(std::move(callback));
+            });
+        }
+        // Resumes as soon as any bytes arrive, like SocketClient::read().
+        auto read(void* buffer, size_t size) {
+            return makeAwaiter([this, buffer, size](SocketCompletionCallback callback) {
+                _client.readAsync(buffer, size, std::move(callback));
+            });
+        }
+        // Resumes once every byte has been written.
+        auto write(const void* buffer, size_t size) {
+            return makeAwaiter([this, buffer, size](SocketCompletionCallback callback) {
+                _client.writeAsync(buffer, size, std::move(callback));
+            });
+        }
+
+        // Reads until `size` bytes arrived. On failure, bytes() is what was read so far.
+        SocketTask<SocketResult> readFully(void* buffer, size_t size) {
+            size_t received{ 0 };
+            while (received < size) {
+                auto result = co_await read(static_cast<char*>(buffer) + received, size - received);
+                if (result.code() != SocketCode::SUCCESS)
+                    co_return SocketResult(result.code(), static_cast<int32_t>(received));
+                received += static_cast<size_t>(result.bytes());
+            }
+            co_return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(received));
+        }
+
+        AsyncSocketClient& client() { return _client; }
+
+    private:
+        template<typename Launcher>
+        static SocketOperationAwaiter<Launcher> makeAwaiter(Launcher launcher) {
+            return SocketOperationAwaiter<Launcher>{ std::move(launcher) };
+        }
+
+        AsyncSocketClient _client;
+    };
+
+    // SocketRequestHandler whose SLOW-mode requests are coroutines. The
+    // coroutine starts on the server thread and may suspend on downstream
+    // I/O (e.g. a SocketCoroutineClient), so one server thread keeps many
+    // requests in flight without a thread per request.
+    // FAST / READ_STREAM / WRITE_STREAM requests still go through
+    // onProcessed() / onProcessedWithoutResponse().
+    struct SocketCoroutineRequestHandler : public SocketRequestHandler
+    {
+        // header and payload are copies owned by the coroutine. co_return the
+        // response bytes (at most pdu_size); an empty response sends nothing.
+        virtual SocketTask<std::vector<char>> onProcessedCoroutine(
+            std::vector<char> header,
+            std::vector<char> payload
+        ) = 0;
+
+        bool onProcessedAsync(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            SocketRequestCompletion completion
+        ) override {
+            std::vector<char> header_copy(header, header + getHeaderSize());
+            std::vector<char> payload_copy(input_buffer, input_buffer + input_size);
+            spawnSocketTask(
+                onProcessedCoroutine(std::move(header_copy), std::move(payload_copy)),
+                [completion](std::vector<char> response) {
+                    completion.complete(response.data(), response.size());
+                });
+            return true;
+        }
+    };
+}
+
+#endif // __BN3MONKEY_SECURITY_SOCKET_COROUTINE__
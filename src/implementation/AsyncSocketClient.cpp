@@ -0,0 +1,470 @@
+#include "AsyncSocketClient.hpp"
+#include "SocketResult.hpp"
+#include "SocketHelper.hpp"
+
+using namespace Bn3Monkey;
+
+AsyncSocketClientImpl::~AsyncSocketClientImpl()
+{
+	close();
+}
+
+SocketResult AsyncSocketClientImpl::open()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (_state != State::CLOSED)
+	{
+		return SocketResult(SocketCode::SOCKET_ALREADY_CONNECTED);
+	}
+
+	_container = ClientActiveSocketContainer(
+		_tls_configuration.valid(),
+		_configuration.is_unix_domain(),
+		_tls_configuration,
+		_configuration.ip());
+	_socket = _container.get();
+	auto result = _socket->valid();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	setNonBlockingMode(_socket->descriptor());
+	// A write completes once it is on the wire; nothing would flush held data.
+	_socket->setWriteCoalescing(0);
+	fd = _socket->descriptor();
+
+	result = _loop.attach(this);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		_socket->close();
+		return result;
+	}
+	_attached = true;
+	_state = State::OPENED;
+	return result;
+}
+
+void AsyncSocketClientImpl::close()
+{
+	// Detach first and without _mtx: a foreign-thread detach waits for the
+	// loop iteration to end, and that iteration may be waiting for _mtx.
+	_loop.detach(this);
+
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_attached = false;
+		failAll(SocketResult(SocketCode::SOCKET_CLOSED), completions);
+		if (_state != State::CLOSED && _socket)
+		{
+			_socket->disconnect();
+			_socket->close();
+		}
+		_state = State::CLOSED;
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::connectAsync(SocketCompletionCallback callback)
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		if (_state != State::OPENED)
+		{
+			auto code = (_state == State::CLOSED || _state == State::FAILED) ? SocketCode::SOCKET_CLOSED : SocketCode::SOCKET_ALREADY_CONNECTED;
+			completions.emplace_back(std::move(callback), SocketResult(code));
+		}
+		else
+		{
+			_connect = Operation{};
+			_connect.deadline = deadline(_configuration.read_timeout());
+			_connect.callback = std::move(callback);
+			_is_connect_pending = true;
+
+			SocketAddress address{ _configuration.ip(), _configuration.port(), false, _configuration.is_unix_domain() };
+			SocketResult result = address;
+			if (result.code() == SocketCode::SUCCESS)
+			{
+				result = _socket->connect(address, _configuration.read_timeout(), _configuration.write_timeout());
+				// ClientActiveSocket::connect() leaves the socket in blocking mode.
+				setNonBlockingMode(_socket->descriptor());
+			}
+
+			if (result.code() == SocketCode::SUCCESS)
+			{
+				// Connected synchronously (unix domain). The handshake, if any,
+				// starts on the loop thread.
+				_state = _tls_configuration.valid() ? State::HANDSHAKING : State::CONNECTED;
+				if (_state == State::CONNECTED)
+				{
+					_is_connect_pending = false;
+					completions.emplace_back(std::move(_connect.callback), SocketResult(SocketCode::SUCCESS));
+				}
+				_loop.schedule(this);
+			}
+			else if (result.code() == SocketCode::SOCKET_CONNECTION_IN_PROGRESS ||
+				result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				_state = State::CONNECTING;
+			}
+			else
+			{
+				failConnect(result, completions);
+			}
+			updateWatch();
+		}
+
+		if (_attached && !completions.empty())
+		{
+			// Keep the "callbacks run on the loop thread" contract even for
+			// failures detected up front.
+			for (auto& completion : completions)
+			{
+				_deferred.push_back(std::move(completion));
+			}
+			completions.clear();
+			_loop.schedule(this);
+		}
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::readAsync(void* buffer, size_t size, SocketCompletionCallback callback)
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		if (_state == State::CLOSED || _state == State::FAILED || _state == State::OPENED)
+		{
+			completions.emplace_back(std::move(callback), SocketResult(SocketCode::SOCKET_CLOSED));
+		}
+		else
+		{
+			Operation operation;
+			operation.buffer = static_cast<char*>(buffer);
+			operation.size = size;
+			operation.deadline = deadline(_configuration.read_timeout());
+			operation.callback = std::move(callback);
+			_reads.push_back(std::move(operation));
+			updateWatch();
+			// TLS may already hold decrypted bytes that poll() cannot see.
+			_loop.schedule(this);
+		}
+
+		if (_attached && !completions.empty())
+		{
+			for (auto& completion : completions)
+			{
+				_deferred.push_back(std::move(completion));
+			}
+			completions.clear();
+			_loop.schedule(this);
+		}
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::writeAsync(const void* buffer, size_t size, SocketCompletionCallback callback)
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		if (_state == State::CLOSED || _state == State::FAILED || _state == State::OPENED)
+		{
+			completions.emplace_back(std::move(callback), SocketResult(SocketCode::SOCKET_CLOSED));
+		}
+		else
+		{
+			Operation operation;
+			operation.buffer = static_cast<char*>(const_cast<void*>(buffer));
+			operation.size = size;
+			operation.deadline = deadline(_configuration.write_timeout());
+			operation.callback = std::move(callback);
+			_writes.push_back(std::move(operation));
+			updateWatch();
+			_loop.schedule(this);
+		}
+
+		if (_attached && !completions.empty())
+		{
+			for (auto& completion : completions)
+			{
+				_deferred.push_back(std::move(completion));
+			}
+			completions.clear();
+			_loop.schedule(this);
+		}
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::onEvent(SocketEventType type)
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		completions.swap(_deferred);
+
+		if (_state == State::CONNECTING)
+			progressConnect(type, completions);
+		if (_state == State::HANDSHAKING)
+			progressHandshake(completions);
+		if (_state == State::CONNECTED)
+		{
+			progressRead(completions);
+			progressWrite(completions);
+
+			// POLLHUP / POLLERR with operations still parked on
+			// NEED_TO_BE_BLOCKED would fire again on every wait().
+			if (type == SocketEventType::DISCONNECTED && (!_reads.empty() || !_writes.empty()))
+			{
+				_state = State::FAILED;
+				failAll(SocketResult(SocketCode::SOCKET_CLOSED), completions);
+			}
+		}
+		updateWatch();
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::onTick(std::chrono::steady_clock::time_point now)
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		if (_is_connect_pending && now >= _connect.deadline)
+		{
+			failConnect(SocketResult(SocketCode::SOCKET_TIMEOUT), completions);
+		}
+
+		for (auto iter = _reads.begin(); iter != _reads.end(); )
+		{
+			if (now >= iter->deadline)
+			{
+				completions.emplace_back(std::move(iter->callback), SocketResult(SocketCode::SOCKET_TIMEOUT));
+				iter = _reads.erase(iter);
+			}
+			else
+				++iter;
+		}
+
+		// Only the head of the write queue may have put bytes on the wire; a
+		// queued write behind it keeps its place until the head completes.
+		if (!_writes.empty() && now >= _writes.front().deadline)
+		{
+			auto& operation = _writes.front();
+			completions.emplace_back(std::move(operation.callback),
+				SocketResult(SocketCode::SOCKET_TIMEOUT, static_cast<int32_t>(operation.transferred)));
+			_writes.pop_front();
+		}
+		updateWatch();
+	}
+	complete(completions);
+}
+
+void AsyncSocketClientImpl::onLoopClosed()
+{
+	Completions completions;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_attached = false;
+		if (_state != State::CLOSED)
+			_state = State::FAILED;
+		failAll(SocketResult(SocketCode::SOCKET_CLOSED), completions);
+	}
+	complete(completions);
+}
+
+std::chrono::steady_clock::time_point AsyncSocketClientImpl::deadline(uint32_t timeout_ms)
+{
+	// Same budget the blocking SocketClient spends: one timeout per retry.
+	uint32_t retries = _configuration.max_retries() > 0 ? _configuration.max_retries() : 1;
+	return std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<uint64_t>(timeout_ms) * retries);
+}
+
+void AsyncSocketClientImpl::progressConnect(SocketEventType type, Completions& completions)
+{
+	// Only an fd event tells us the non-blocking connect() finished.
+	if (type == SocketEventType::UNDEFINED)
+		return;
+
+	int error{ 0 };
+	socklen_t len = sizeof(error);
+	getsockopt(_socket->descriptor(), SOL_SOCKET, SO_ERROR, (char*)&error, &len);
+	if (error != 0)
+	{
+		failConnect(createResultFromSocketError(error), completions);
+		return;
+	}
+	if (type == SocketEventType::DISCONNECTED)
+	{
+		failConnect(SocketResult(SocketCode::SOCKET_CLOSED), completions);
+		return;
+	}
+
+	if (_tls_configuration.valid())
+	{
+		_state = State::HANDSHAKING;
+		return;
+	}
+
+	_state = State::CONNECTED;
+	_is_connect_pending = false;
+	completions.emplace_back(std::move(_connect.callback), SocketResult(SocketCode::SUCCESS));
+}
+
+void AsyncSocketClientImpl::progressHandshake(Completions& completions)
+{
+	// reconnect(false) drives SSL_connect() one step on the non-blocking fd.
+	// The TLS 1.3 post-handshake probe is skipped on purpose: a deferred
+	// client-certificate rejection surfaces as a typed error on the first
+	// read instead of stalling the connect for a whole read_timeout.
+	auto result = _socket->reconnect(false);
+	if (result.code() == SocketCode::SUCCESS)
+	{
+		_state = State::CONNECTED;
+		_is_connect_pending = false;
+		completions.emplace_back(std::move(_connect.callback), SocketResult(SocketCode::SUCCESS));
+	}
+	else if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+	{
+		failConnect(result, completions);
+	}
+}
+
+void AsyncSocketClientImpl::progressRead(Completions& completions)
+{
+	while (!_reads.empty())
+	{
+		auto& operation = _reads.front();
+		auto result = _socket->read(operation.buffer, operation.size);
+		if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED ||
+			result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			return;
+		}
+		if (result.code() == SocketCode::SUCCESS && result.bytes() == 0)
+		{
+			result = SocketResult(SocketCode::SOCKET_CLOSED, 0);
+		}
+		completions.emplace_back(std::move(operation.callback), result);
+		_reads.pop_front();
+	}
+}
+
+void AsyncSocketClientImpl::progressWrite(Completions& completions)
+{
+	while (!_writes.empty())
+	{
+		auto& operation = _writes.front();
+		SocketResult result{ SocketCode::SUCCESS };
+		while (operation.transferred < operation.size)
+		{
+			result = _socket->write(operation.buffer + operation.transferred, operation.size - operation.transferred);
+			if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED ||
+				result.code() == SocketCode::SOCKET_TIMEOUT)
+			{
+				return;
+			}
+			if (result.code() != SocketCode::SUCCESS)
+			{
+				break;
+			}
+			operation.transferred += static_cast<size_t>(result.bytes());
+		}
+		completions.emplace_back(std::move(operation.callback),
+			SocketResult(result.code(), static_cast<int32_t>(operation.transferred)));
+		_writes.pop_front();
+	}
+}
+
+void AsyncSocketClientImpl::failConnect(SocketResult result, Completions& completions)
+{
+	_state = State::FAILED;
+	if (_is_connect_pending)
+	{
+		_is_connect_pending = false;
+		completions.emplace_back(std::move(_connect.callback), result);
+	}
+	failAll(SocketResult(SocketCode::SOCKET_CLOSED), completions);
+}
+
+void AsyncSocketClientImpl::failAll(SocketResult result, Completions& completions)
+{
+	for (auto& completion : _deferred)
+	{
+		completions.push_back(std::move(completion));
+	}
+	_deferred.clear();
+
+	if (_is_connect_pending)
+	{
+		_is_connect_pending = false;
+		completions.emplace_back(std::move(_connect.callback), result);
+	}
+	for (auto& operation : _reads)
+	{
+		completions.emplace_back(std::move(operation.callback), result);
+	}
+	_reads.clear();
+	for (auto& operation : _writes)
+	{
+		completions.emplace_back(std::move(operation.callback),
+			SocketResult(result.code(), static_cast<int32_t>(operation.transferred)));
+	}
+	_writes.clear();
+}
+
+void AsyncSocketClientImpl::updateWatch()
+{
+	if (!_attached)
+		return;
+
+	bool want_read{ false };
+	bool want_write{ false };
+	switch (_state)
+	{
+	case State::CONNECTING:
+		want_write = true;
+		break;
+	case State::HANDSHAKING:
+		if (_socket->pendingEvent() == SocketEventType::WRITE)
+			want_write = true;
+		else
+			want_read = true;
+		break;
+	case State::CONNECTED:
+		if (!_reads.empty())
+		{
+			if (_socket->pendingEvent() == SocketEventType::WRITE)
+				want_write = true;
+			else
+				want_read = true;
+		}
+		if (!_writes.empty())
+			want_write = true;
+		break;
+	default:
+		break;
+	}
+
+	SocketEventType type{ SocketEventType::UNDEFINED };
+	if (want_read && want_write)
+		type = SocketEventType::READ_WRITE;
+	else if (want_read)
+		type = SocketEventType::READ;
+	else if (want_write)
+		type = SocketEventType::WRITE;
+	_loop.watch(this, type);
+}
+
+void AsyncSocketClientImpl::complete(Completions& completions)
+{
+	for (auto& completion : completions)
+	{
+		if (completion.first)
+			completion.first(completion.second);
+	}
+}
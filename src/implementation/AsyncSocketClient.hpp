@@ -0,0 +1,97 @@
+#if !defined(__BN3MONKEY__ASYNCSOCKETCLIENT__)
+#define __BN3MONKEY__ASYNCSOCKETCLIENT__
+
+#include "../SecuritySocket.hpp"
+#include "ClientActiveSocket.hpp"
+#include "SocketEventLoop.hpp"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+namespace Bn3Monkey
+{
+	// Non-blocking counterpart of SocketClientImpl. Every operation is queued
+	// and progressed by the SocketEventLoopImpl it is attached to; completion
+	// callbacks always run on the loop thread, except for the ones failed by
+	// close().
+	class AsyncSocketClientImpl : public SocketEventLoopClient
+	{
+	public:
+		explicit AsyncSocketClientImpl(SocketEventLoopImpl& loop, const SocketConfiguration& configuration)
+			: _loop(loop), _configuration(configuration) {}
+		explicit AsyncSocketClientImpl(SocketEventLoopImpl& loop, const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration)
+			: _loop(loop), _configuration(configuration), _tls_configuration(tls_configuration) {}
+
+		virtual ~AsyncSocketClientImpl();
+
+		SocketResult open();
+		void close();
+
+		void connectAsync(SocketCompletionCallback callback);
+		void readAsync(void* buffer, size_t size, SocketCompletionCallback callback);
+		void writeAsync(const void* buffer, size_t size, SocketCompletionCallback callback);
+
+		void onEvent(SocketEventType type) override;
+		void onTick(std::chrono::steady_clock::time_point now) override;
+		void onLoopClosed() override;
+
+	private:
+		enum class State
+		{
+			CLOSED,
+			OPENED,
+			CONNECTING,
+			HANDSHAKING,
+			CONNECTED,
+			FAILED
+		};
+
+		struct Operation
+		{
+			char* buffer{ nullptr };
+			size_t size{ 0 };
+			size_t transferred{ 0 };
+			std::chrono::steady_clock::time_point deadline;
+			SocketCompletionCallback callback;
+		};
+
+		using Completion = std::pair<SocketCompletionCallback, SocketResult>;
+		using Completions = std::vector<Completion>;
+
+		std::chrono::steady_clock::time_point deadline(uint32_t timeout_ms);
+
+		void progressConnect(SocketEventType type, Completions& completions);
+		void progressHandshake(Completions& completions);
+		void progressRead(Completions& completions);
+		void progressWrite(Completions& completions);
+
+		void failConnect(SocketResult result, Completions& completions);
+		void failAll(SocketResult result, Completions& completions);
+		void updateWatch();
+		static void complete(Completions& completions);
+
+		SocketEventLoopImpl& _loop;
+
+		ClientActiveSocketContainer _container{};
+		ClientActiveSocket* _socket{ nullptr };
+
+		SocketConfiguration _configuration;
+		SocketTLSClientConfiguration _tls_configuration;
+
+		// Guards everything below. Never held while a callback runs.
+		std::mutex _mtx;
+		State _state{ State::CLOSED };
+		bool _attached{ false };
+		Operation _connect;
+		bool _is_connect_pending{ false };
+		std::deque<Operation> _reads;
+		std::deque<Operation> _writes;
+		// Completions decided off the loop thread, handed to it via schedule().
+		Completions _deferred;
+	};
+}
+
+#endif // __BN3MONKEY__ASYNCSOCKETCLIENT__
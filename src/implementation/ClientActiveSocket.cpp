@@ -1,8 +1,14 @@
 #include "ClientActiveSocket.hpp"
+#include "TLSContext.hpp"
+#include "SharedMemoryChannel.hpp"
+#include "SocketDescriptor.hpp"
 
 #include "SocketResult.hpp"
 #include "SocketHelper.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #ifdef _WIN32
 #include <Winsock2.h>
 #include <WS2tcpip.h>
@@ -15,6 +21,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
 #endif
 
 using namespace Bn3Monkey;
@@ -48,6 +55,8 @@ Bn3Monkey::ClientActiveSocket::~ClientActiveSocket()
 }
 
 void ClientActiveSocket::close() {
+	delete _channel;
+	_channel = nullptr;
 #ifdef _WIN32
 	::closesocket(_socket);
 #else
@@ -98,8 +107,75 @@ SocketResult Bn3Monkey::ClientActiveSocket::isConnected()
 	return SocketResult(SocketCode::SOCKET_CLOSED);
 }
 
+SocketResult Bn3Monkey::ClientActiveSocket::isAlive()
+{
+	if (_channel)
+	{
+		// The socket only carries wakeups and the peer's FIN.
+		size_t size = _channel->pending(_socket);
+		if (size > 0)
+		{
+			return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+		}
+	}
+
+	pollfd handle{};
+	handle.fd = _socket;
+	handle.events = POLLIN;
+#ifdef _WIN32
+	int32_t ret = WSAPoll(&handle, 1, 0);
+#else
+	int32_t ret = ::poll(&handle, 1, 0);
+#endif
+	if (ret < 0)
+	{
+		return createResult(ret);
+	}
+	if (ret == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	if (handle.revents & (POLLERR | POLLNVAL))
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+
+	// Readable: either the peer's FIN or bytes nobody asked for. The socket
+	// has data, so a peek cannot block.
+	if (_channel)
+	{
+		// A wakeup that came after pending() looked, or the FIN.
+		size_t size = _channel->pending(_socket);
+		if (size > 0)
+		{
+			return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+		}
+#ifndef _WIN32
+		char wakeup[1];
+		if (::recv(_socket, wakeup, 1, MSG_PEEK | MSG_DONTWAIT) == 0)
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+		}
+#endif
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	char buf[1];
+	ret = ::recv(_socket, buf, 1, MSG_PEEK);
+	if (ret == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+	if (ret < 0)
+	{
+		return createResult(ret);
+	}
+	return SocketResult(SocketCode::SUCCESS, ret);
+}
+
 SocketResult Bn3Monkey::ClientActiveSocket::write(const void* buffer, size_t size)
 {
+	if (_channel)
+		return _channel->write(_socket, buffer, size);
 	int32_t ret{0};
 #ifdef __linux__
 	ret = send(_socket, buffer, size, MSG_NOSIGNAL);
@@ -113,6 +189,8 @@ SocketResult Bn3Monkey::ClientActiveSocket::write(const void* buffer, size_t siz
 
 SocketResult Bn3Monkey::ClientActiveSocket::read(void* buffer, size_t size)
 {
+	if (_channel)
+		return _channel->read(_socket, buffer, size);
 	int32_t ret{ 0 };
 	ret = ::recv(_socket, static_cast<char*>(buffer), static_cast<int32_t>(size), 0);
 	if (ret == 0)
@@ -120,40 +198,188 @@ SocketResult Bn3Monkey::ClientActiveSocket::read(void* buffer, size_t size)
 	return createResult(ret);
 }
 
-static void trackTLSInfo(const SSL* ssl, int where, int ret)
+SocketResult Bn3Monkey::ClientActiveSocket::writev(const SocketIOBuffer* buffers, size_t count, size_t offset)
 {
-	char buffer[2048]{ 0 };
-
-	int w = where & ~SSL_ST_MASK;
-
-	if (where & SSL_CB_LOOP)
+	count = std::min(count, SocketClient::MAX_IO_BUFFERS);
+	if (_channel)
 	{
-		const char* header = "";
-		if (w & SSL_ST_CONNECT) header = "SSL_connect";
-		else if (w & SSL_ST_ACCEPT) header = "SSL_accept";
-		snprintf(buffer, sizeof(buffer), "[%s] %s", header, SSL_state_string_long(ssl));
+		// One copy per buffer into the ring, up to the first that does not fit.
+		size_t written{ 0 };
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t skipped = i == 0 ? offset : 0;
+			auto result = _channel->write(_socket, static_cast<char*>(buffers[i].data) + skipped, buffers[i].size - skipped);
+			if (result.code() != SocketCode::SUCCESS)
+				return written > 0 ? SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written)) : result;
+			written += static_cast<size_t>(result.bytes());
+			if (static_cast<size_t>(result.bytes()) < buffers[i].size - skipped)
+				break;
+		}
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written));
 	}
-	else if (where & SSL_CB_ALERT)
+	int32_t ret{ 0 };
+#ifdef _WIN32
+	WSABUF pieces[SocketClient::MAX_IO_BUFFERS];
+	for (size_t i = 0; i < count; i++)
 	{
-		snprintf(buffer, sizeof(buffer), "[ALERT] : %s :%s", SSL_alert_type_string_long(ret), SSL_alert_desc_string_long(ret));
+		pieces[i].buf = static_cast<char*>(buffers[i].data);
+		pieces[i].len = static_cast<ULONG>(buffers[i].size);
 	}
-	else if (where & SSL_CB_EXIT)
+	pieces[0].buf += offset;
+	pieces[0].len -= static_cast<ULONG>(offset);
+	DWORD sent{ 0 };
+	ret = WSASend(_socket, pieces, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr);
+	if (ret == 0)
+		ret = static_cast<int32_t>(sent);
+#else
+	iovec pieces[SocketClient::MAX_IO_BUFFERS];
+	for (size_t i = 0; i < count; i++)
 	{
-		if (ret <= 0) {
-			snprintf(buffer, sizeof(buffer), "%s", ret == 0 ? "Handshake failed" : "Handshake error");
+		pieces[i].iov_base = buffers[i].data;
+		pieces[i].iov_len = buffers[i].size;
+	}
+	pieces[0].iov_base = static_cast<char*>(pieces[0].iov_base) + offset;
+	pieces[0].iov_len -= offset;
+	msghdr message{};
+	message.msg_iov = pieces;
+	message.msg_iovlen = count;
+#ifdef __linux__
+	ret = static_cast<int32_t>(::sendmsg(_socket, &message, MSG_NOSIGNAL));
+#else
+	ret = static_cast<int32_t>(::sendmsg(_socket, &message, 0));
+#endif
+#endif
+	if (ret == 0)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	return createResult(ret);
+}
+
+SocketResult Bn3Monkey::ClientActiveSocket::readv(const SocketIOBuffer* buffers, size_t count)
+{
+	count = std::min(count, SocketClient::MAX_IO_BUFFERS);
+	if (_channel)
+	{
+		size_t received{ 0 };
+		for (size_t i = 0; i < count; i++)
+		{
+			auto result = _channel->read(_socket, buffers[i].data, buffers[i].size);
+			if (result.code() != SocketCode::SUCCESS)
+				return received > 0 ? SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(received)) : result;
+			received += static_cast<size_t>(result.bytes());
+			if (static_cast<size_t>(result.bytes()) < buffers[i].size || _channel->readable() == 0)
+				break;
 		}
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(received));
 	}
-	else if (where & SSL_CB_HANDSHAKE_START) {
-		snprintf(buffer, sizeof(buffer), "Handshake start");
+	int32_t ret{ 0 };
+#ifdef _WIN32
+	WSABUF pieces[SocketClient::MAX_IO_BUFFERS];
+	for (size_t i = 0; i < count; i++)
+	{
+		pieces[i].buf = static_cast<char*>(buffers[i].data);
+		pieces[i].len = static_cast<ULONG>(buffers[i].size);
+	}
+	DWORD received{ 0 };
+	DWORD flags{ 0 };
+	ret = WSARecv(_socket, pieces, static_cast<DWORD>(count), &received, &flags, nullptr, nullptr);
+	if (ret == 0)
+		ret = static_cast<int32_t>(received);
+#else
+	iovec pieces[SocketClient::MAX_IO_BUFFERS];
+	for (size_t i = 0; i < count; i++)
+	{
+		pieces[i].iov_base = buffers[i].data;
+		pieces[i].iov_len = buffers[i].size;
+	}
+	msghdr message{};
+	message.msg_iov = pieces;
+	message.msg_iovlen = count;
+	ret = static_cast<int32_t>(::recvmsg(_socket, &message, 0));
+#endif
+	if (ret == 0)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	return createResult(ret);
+}
+
+SocketResult Bn3Monkey::ClientActiveSocket::flush()
+{
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void Bn3Monkey::ClientActiveSocket::setWriteCoalescing(uint32_t flush_threshold)
+{
+	(void)flush_threshold;
+}
+
+void Bn3Monkey::ClientActiveSocket::setEarlyData(const void* buffer, size_t size)
+{
+	(void)buffer;
+	(void)size;
+}
+
+bool Bn3Monkey::ClientActiveSocket::isEarlyDataAccepted()
+{
+	return false;
+}
+
+SocketEventType Bn3Monkey::ClientActiveSocket::pendingEvent()
+{
+	return SocketEventType::READ;
+}
+
+size_t Bn3Monkey::ClientActiveSocket::pending()
+{
+	return _channel ? _channel->pending(_socket) : 0;
+}
+
+SocketEventType Bn3Monkey::ClientActiveSocket::writeEvent()
+{
+	return _channel && _channel->isWriteBlocked() ? SocketEventType::READ : SocketEventType::WRITE;
+}
+
+SocketResult Bn3Monkey::ClientActiveSocket::openSharedMemory(size_t ring_size, uint32_t busy_poll_us, uint32_t timeout_ms)
+{
+	if (_channel)
+	{
+		return SocketResult(SocketCode::SUCCESS);
 	}
-	else if (where & SSL_CB_HANDSHAKE_DONE) {
-		snprintf(buffer, sizeof(buffer), "Handshake done");
+
+	auto* channel = new SharedMemoryChannel();
+	// Nothing has been sent yet: the connection just stays on the socket.
+	if (channel->create(ring_size).code() != SocketCode::SUCCESS)
+	{
+		delete channel;
+		return SocketResult(SocketCode::SUCCESS);
 	}
-	
-    auto* onTLSEvent = reinterpret_cast<SocketTLSClientConfiguration::TlsEventCallback>(SSL_get_ex_data(ssl, 0));
-	if (onTLSEvent) {
-		onTLSEvent(buffer);
+	auto result = channel->offer(_socket, timeout_ms);
+	if (result.code() != SocketCode::SUCCESS || !channel->isOpen())
+	{
+		delete channel;
+		return result;
 	}
+	channel->setBusyPoll(busy_poll_us);
+	_channel = channel;
+	return result;
+}
+
+SocketResult Bn3Monkey::ClientActiveSocket::writeDescriptor(int32_t descriptor, const void* buffer, size_t size)
+{
+	// The stream is in the rings; the socket only carries wakeups.
+	if (_channel)
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	return sendDescriptor(_socket, descriptor, buffer, size);
+}
+
+SocketResult Bn3Monkey::ClientActiveSocket::readDescriptor(void* buffer, size_t size, int32_t& descriptor)
+{
+	descriptor = -1;
+	if (_channel)
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	size_t count{ 0 };
+	auto result = receiveDescriptors(_socket, buffer, size, &descriptor, 1, count);
+	if (count == 0)
+		descriptor = -1;
+	return result;
 }
 
 Bn3Monkey::TLSClientActiveSocket::TLSClientActiveSocket(bool is_unix_domain, const SocketTLSClientConfiguration& tls_configuration, const char* hostname)
@@ -162,65 +388,14 @@ Bn3Monkey::TLSClientActiveSocket::TLSClientActiveSocket(bool is_unix_domain, con
 	if (_result.code() != SocketCode::SUCCESS)
 		return;
 
-	_context = SSL_CTX_new(TLS_client_method());
+	// Cipher lists, trust store and client certificate are prepared once per
+	// configuration and shared; only the handshake is paid per connection.
+	_context = TLSClientContextCache::acquire(tls_configuration);
 	if (!_context) {
 		_result = SocketResult(SocketCode::TLS_CONTEXT_INITIALIZATION_FAIL);
 		return;
 	}
 
-	// [1] TLS 버전 범위 설정 : TLS 1.3 우선, 실패 시 TLS 1.2 자동 협상
-	{
-		bool has12 = tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_2);
-		bool has13 = tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_3);
-		int min_ver = has12 ? TLS1_2_VERSION : TLS1_3_VERSION;
-		int max_ver = has13 ? TLS1_3_VERSION : TLS1_2_VERSION;
-		SSL_CTX_set_min_proto_version(_context, min_ver);
-		SSL_CTX_set_max_proto_version(_context, max_ver);
-	}
-
-	// [2] Cipher Suite 등록
-	{
-		char cipher_list[512]{ 0 };
-		tls_configuration.generateTLS12CipherSuites(cipher_list);
-		if (cipher_list[0] != '\0')
-			SSL_CTX_set_cipher_list(_context, cipher_list);
-
-		char ciphersuites[512]{ 0 };
-		tls_configuration.generateTLS13CipherSuites(ciphersuites);
-		if (ciphersuites[0] != '\0')
-			SSL_CTX_set_ciphersuites(_context, ciphersuites);
-	}
-
-	// [3] 서버 인증서 검증
-	if (tls_configuration.shouldVerifyServer()) {
-		SSL_CTX_set_verify(_context, SSL_VERIFY_PEER, nullptr);
-		const char* trust_store = tls_configuration.serverTrustStorePath();
-		if (trust_store[0] != '\0')
-			SSL_CTX_load_verify_locations(_context, trust_store, nullptr);
-		else
-			SSL_CTX_set_default_verify_paths(_context);
-	}
-	else {
-		SSL_CTX_set_verify(_context, SSL_VERIFY_NONE, nullptr);
-	}
-
-	// [4] 클라이언트 인증서 등록
-	if (tls_configuration.shouldUseClientCertificate()) {
-		const char* key_password = tls_configuration.clientKeyPassword();
-		if (key_password[0] != '\0') {
-			SSL_CTX_set_default_passwd_cb(_context, [](char* buf, int size, int /*rwflag*/, void* userdata) -> int {
-				const char* pw = static_cast<const char*>(userdata);
-				int len = static_cast<int>(strlen(pw));
-				if (len > size) len = size;
-				memcpy(buf, pw, static_cast<size_t>(len));
-				return len;
-			});
-			SSL_CTX_set_default_passwd_cb_userdata(_context, const_cast<char*>(key_password));
-		}
-		SSL_CTX_use_certificate_file(_context, tls_configuration.clientCertFilePath(), SSL_FILETYPE_PEM);
-		SSL_CTX_use_PrivateKey_file(_context, tls_configuration.clientKeyFilePath(), SSL_FILETYPE_PEM);
-	}
-
 	// hostname 저장 (shouldVerifyHostname이 true인 경우에만)
 	if (tls_configuration.shouldVerifyHostname() && hostname != nullptr && hostname[0] != '\0')
 		_hostname = hostname;
@@ -237,8 +412,14 @@ Bn3Monkey::TLSClientActiveSocket::TLSClientActiveSocket(bool is_unix_domain, con
 	auto on_tls_event = tls_configuration.getOnTLSEvent();
 	if (on_tls_event) {
         SSL_set_ex_data(_ssl, 0, reinterpret_cast<void*>(on_tls_event));
-		SSL_CTX_set_info_callback(_context, trackTLSInfo);
 	}
+
+	// Record layer tuning. Set per connection: the SSL_CTX is shared by
+	// configurations that differ only in these knobs.
+	if (tls_configuration.shouldReleaseBuffers())
+		SSL_set_mode(_ssl, SSL_MODE_RELEASE_BUFFERS);
+	_record_sizer.enable(tls_configuration.shouldUseDynamicRecordSizing());
+	_coalescing_threshold = tls_configuration.writeCoalescingThreshold();
 }
 
 Bn3Monkey::TLSClientActiveSocket::~TLSClientActiveSocket()
@@ -247,6 +428,11 @@ Bn3Monkey::TLSClientActiveSocket::~TLSClientActiveSocket()
 
 void Bn3Monkey::TLSClientActiveSocket::close()
 {
+	delete[] _coalescing_buffer;
+	_coalescing_buffer = nullptr;
+	_coalesced_size = 0;
+	delete[] _gather_buffer;
+	_gather_buffer = nullptr;
 	if (_ssl) {
 		SSL_free(_ssl);
 		_ssl = nullptr;
@@ -286,8 +472,14 @@ SocketResult Bn3Monkey::TLSClientActiveSocket::reconnect(bool after_handshake)
 		return SocketResult(SocketCode::SUCCESS);
 	}
 
-	if (SSL_set_fd(_ssl, _socket) == 0)
-		return SocketResult(SocketCode::TLS_SETFD_ERROR);
+	// reconnect(false) is re-entered after every WANT_READ/WANT_WRITE while the
+	// handshake is in flight. Only attach the fd on the first call; replacing
+	// the BIO mid-handshake would throw away data OpenSSL has already buffered.
+	bool is_attached = SSL_get_fd(_ssl) == _socket;
+	if (!is_attached) {
+		if (SSL_set_fd(_ssl, _socket) == 0)
+			return SocketResult(SocketCode::TLS_SETFD_ERROR);
+	}
 
 	// Set SNI extension so the server can select the correct virtual-host
 	// certificate, and enable X.509 hostname / IP-address verification so that
@@ -296,13 +488,31 @@ SocketResult Bn3Monkey::TLSClientActiveSocket::reconnect(bool after_handshake)
 		SSL_set_tlsext_host_name(_ssl, _hostname);  // SNI ClientHello extension
 		SSL_set1_host(_ssl, _hostname);              // X.509 hostname verification
 	}
+	// Offer the previous session with this peer, if resumption is enabled.
+	// Sessions are kept by SNI, so after it is set.
+	if (!is_attached)
+		TLSClientContextCache::restoreSession(_ssl);
+
+	// 0-RTT: the early data leaves right behind the ClientHello. Only a
+	// resumed TLS 1.3 session whose ticket allows this much is eligible;
+	// anything else is sent by the caller once the handshake is done.
+	if (_early_data != nullptr && !SSL_is_init_finished(_ssl)) {
+		SSL_SESSION* session = SSL_get_session(_ssl);
+		if (session != nullptr && SSL_SESSION_get_max_early_data(session) >= _early_data_size) {
+			size_t written{ 0 };
+			auto res = SSL_write_early_data(_ssl, _early_data, _early_data_size, &written);
+			if (res != 1)
+				return createTLSResult(_ssl, res);
+		}
+		_early_data = nullptr;
+	}
 
 	// Perform the TLS handshake.  Returns 1 on success, ≤0 on failure.
 	auto res = SSL_connect(_ssl);
 	if (res != 1)
 		return createTLSResult(_ssl, res);
 
-
+	reportKernelTLS(_ssl);
 	return SocketResult(SocketCode::SUCCESS);
 }
 
@@ -358,6 +568,10 @@ SocketResult Bn3Monkey::TLSClientActiveSocket::postHandshakeProbe()
 void Bn3Monkey::TLSClientActiveSocket::disconnect()
 {
 	if (_ssl) {
+		// Best effort: held writes were reported as written.
+		if (SSL_is_init_finished(_ssl))
+			flush();
+		_coalesced_size = 0;
 		SSL_shutdown(_ssl);
 		SSL_free(_ssl);
 		_ssl = nullptr;
@@ -368,18 +582,266 @@ SocketResult Bn3Monkey::TLSClientActiveSocket::isConnected()
 {
 	return ClientActiveSocket::isConnected();
 }
+SocketResult Bn3Monkey::TLSClientActiveSocket::isAlive()
+{
+	int32_t pending = SSL_pending(_ssl);
+	if (pending > 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, pending);
+	}
+
+	auto result = ClientActiveSocket::isAlive();
+	if (result.code() != SocketCode::SUCCESS || result.bytes() == 0)
+	{
+		return result;
+	}
+
+	// An idle TLS connection is routinely readable without any application
+	// data: TLS 1.3 servers send session tickets after the handshake. Let
+	// OpenSSL consume such records without blocking on what follows.
+	char buf[1];
+	setNonBlockingMode(_socket);
+	int32_t ret = SSL_peek(_ssl, buf, 1);
+	int32_t error = ret > 0 ? 0 : SSL_get_error(_ssl, ret);
+	setBlockingMode(_socket);
+
+	if (ret > 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, ret);
+	}
+	if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE)
+	{
+		ERR_clear_error();
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	ERR_clear_error();
+	return SocketResult(SocketCode::SOCKET_CLOSED);
+}
+
 SocketResult Bn3Monkey::TLSClientActiveSocket::write(const void* buffer, size_t size)
 {
+	if (_coalescing_threshold == 0)
+		return writeRecords(buffer, size);
+
+	if (!_coalescing_buffer)
+		_coalescing_buffer = new char[_coalescing_threshold];
+
+	// Bytes copied into the buffer count as written. On failure the caller
+	// retries from the returned count, which OpenSSL needs to see the same
+	// pointer again for a direct write.
+	auto* data = static_cast<const char*>(buffer);
+	size_t remaining = size;
+	while (remaining > 0)
+	{
+		if (_coalesced_size == _coalescing_threshold)
+		{
+			auto result = flush();
+			if (result.code() != SocketCode::SUCCESS)
+				return SocketResult(result.code(), static_cast<int32_t>(size - remaining));
+		}
+
+		// Already a full batch on its own: no point copying it.
+		if (_coalesced_size == 0 && remaining >= _coalescing_threshold)
+		{
+			auto result = writeRecords(data, remaining);
+			if (result.code() != SocketCode::SUCCESS)
+				return SocketResult(result.code(), static_cast<int32_t>(size - remaining));
+			return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+		}
+
+		size_t copied = std::min(remaining, _coalescing_threshold - _coalesced_size);
+		memcpy(_coalescing_buffer + _coalesced_size, data, copied);
+		_coalesced_size += copied;
+		data += copied;
+		remaining -= copied;
+	}
+
+	// A failure here is retried by the next write(), read() or flush().
+	if (_coalesced_size == _coalescing_threshold)
+		flush();
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+}
+
+SocketResult Bn3Monkey::TLSClientActiveSocket::writev(const SocketIOBuffer* buffers, size_t count, size_t offset)
+{
+	count = std::min(count, SocketClient::MAX_IO_BUFFERS);
+	size_t written{ 0 };
+
+	// write() already gathers small writes.
+	if (_coalescing_threshold > 0)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t skipped = i == 0 ? offset : 0;
+			auto result = write(static_cast<const char*>(buffers[i].data) + skipped, buffers[i].size - skipped);
+			if (result.code() != SocketCode::SUCCESS)
+				return SocketResult(result.code(), static_cast<int32_t>(written + std::max(result.bytes(), 0)));
+			written += buffers[i].size - skipped;
+		}
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written));
+	}
+
+	if (!_gather_buffer)
+		_gather_buffer = new char[GATHER_BUFFER_SIZE];
+
+	size_t gathered{ 0 };
+	for (size_t i = 0; i < count; i++)
+	{
+		auto* data = static_cast<const char*>(buffers[i].data) + (i == 0 ? offset : 0);
+		size_t remaining = buffers[i].size - (i == 0 ? offset : 0);
+		while (remaining > 0)
+		{
+			// Already a full record on its own: no point copying it.
+			if (gathered == 0 && remaining >= GATHER_BUFFER_SIZE)
+			{
+				auto result = writeRecords(data, remaining);
+				if (result.code() != SocketCode::SUCCESS)
+					return SocketResult(result.code(), static_cast<int32_t>(written));
+				written += remaining;
+				break;
+			}
+
+			size_t copied = std::min(remaining, GATHER_BUFFER_SIZE - gathered);
+			memcpy(_gather_buffer + gathered, data, copied);
+			gathered += copied;
+			data += copied;
+			remaining -= copied;
+
+			if (gathered == GATHER_BUFFER_SIZE)
+			{
+				auto result = writeRecords(_gather_buffer, gathered);
+				if (result.code() != SocketCode::SUCCESS)
+					return SocketResult(result.code(), static_cast<int32_t>(written));
+				written += gathered;
+				gathered = 0;
+			}
+		}
+	}
+	if (gathered > 0)
+	{
+		auto result = writeRecords(_gather_buffer, gathered);
+		if (result.code() != SocketCode::SUCCESS)
+			return SocketResult(result.code(), static_cast<int32_t>(written));
+		written += gathered;
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written));
+}
+
+SocketResult Bn3Monkey::TLSClientActiveSocket::flush()
+{
+	if (_coalesced_size == 0)
+		return SocketResult(SocketCode::SUCCESS);
+
+	// Without SSL_MODE_ENABLE_PARTIAL_WRITE, SSL_write() sends all or nothing.
+	auto result = writeRecords(_coalescing_buffer, _coalesced_size);
+	if (result.code() != SocketCode::SUCCESS)
+		return result;
+	_coalesced_size = 0;
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void Bn3Monkey::TLSClientActiveSocket::setWriteCoalescing(uint32_t flush_threshold)
+{
+	flush();
+	delete[] _coalescing_buffer;
+	_coalescing_buffer = nullptr;
+	_coalesced_size = 0;
+	_coalescing_threshold = flush_threshold;
+}
+
+void Bn3Monkey::TLSClientActiveSocket::setEarlyData(const void* buffer, size_t size)
+{
+	_early_data = static_cast<const char*>(buffer);
+	_early_data_size = size;
+}
+
+bool Bn3Monkey::TLSClientActiveSocket::isEarlyDataAccepted()
+{
+	return _ssl && SSL_get_early_data_status(_ssl) == SSL_EARLY_DATA_ACCEPTED;
+}
+
+SocketResult Bn3Monkey::TLSClientActiveSocket::writeRecords(const void* buffer, size_t size)
+{
+	_record_sizer.prepare(_ssl, size);
 	int32_t ret = SSL_write(_ssl, buffer, static_cast<int32_t>(size));
 	return createTLSResult(_ssl, ret);
 }
 
 SocketResult Bn3Monkey::TLSClientActiveSocket::read(void* buffer, size_t size)
 {
+	// A response cannot arrive before its request has left.
+	auto result = flush();
+	if (result.code() != SocketCode::SUCCESS)
+		return result;
+
 	int32_t ret = SSL_read(_ssl, buffer, static_cast<int32_t>(size));
 	return createTLSResult(_ssl, ret);
 }
 
+SocketResult Bn3Monkey::TLSClientActiveSocket::readv(const SocketIOBuffer* buffers, size_t count)
+{
+	auto result = flush();
+	if (result.code() != SocketCode::SUCCESS)
+		return result;
+
+	count = std::min(count, SocketClient::MAX_IO_BUFFERS);
+	size_t received{ 0 };
+	for (size_t i = 0; i < count; i++)
+	{
+		if (buffers[i].size == 0)
+			continue;
+		// Only the first read may wait for the socket.
+		if (received > 0 && SSL_pending(_ssl) <= 0)
+			break;
+
+		int32_t ret = SSL_read(_ssl, buffers[i].data, static_cast<int32_t>(buffers[i].size));
+		if (ret <= 0)
+		{
+			if (received > 0)
+			{
+				ERR_clear_error();
+				break;
+			}
+			return createTLSResult(_ssl, ret);
+		}
+		received += static_cast<size_t>(ret);
+		if (static_cast<size_t>(ret) < buffers[i].size)
+			break;
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(received));
+}
+
+SocketEventType Bn3Monkey::TLSClientActiveSocket::pendingEvent()
+{
+	// A TLS read can stall on a write (and vice versa) while OpenSSL is
+	// flushing handshake or key-update records.
+	if (_ssl && SSL_want_write(_ssl))
+		return SocketEventType::WRITE;
+	return SocketEventType::READ;
+}
+
+size_t Bn3Monkey::TLSClientActiveSocket::pending()
+{
+	// The post-handshake probe can pull in a response that was sent behind
+	// the server's flight, such as the answer to early data.
+	return _ssl ? static_cast<size_t>(SSL_pending(_ssl)) : 0;
+}
+
+SocketResult Bn3Monkey::TLSClientActiveSocket::writeDescriptor(int32_t descriptor, const void* buffer, size_t size)
+{
+	(void)descriptor;
+	(void)buffer;
+	(void)size;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+}
+SocketResult Bn3Monkey::TLSClientActiveSocket::readDescriptor(void* buffer, size_t size, int32_t& descriptor)
+{
+	(void)buffer;
+	(void)size;
+	descriptor = -1;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+}
+
 
 /*
 #if !defined(_WIN32) && !defined(__linux__)
@@ -5,12 +5,15 @@
 #include "SocketAddress.hpp"
 #include "BaseSocket.hpp"
 #include "SocketHelper.hpp"
+#include "SocketEvent.hpp"
 
 #include <cstdint>
 #include "TLSHelper.hpp"
+#include "TLSContext.hpp"
 
 namespace Bn3Monkey
 {
+	class SharedMemoryChannel;
 
 	class ClientActiveSocket : public BaseSocket
 	{
@@ -25,10 +28,51 @@ namespace Bn3Monkey
 
 		virtual void disconnect(); 
 		virtual SocketResult isConnected();
+		// Non-blocking health check of an idle connection.
+		// SUCCESS, bytes() == 0 : open, nothing unread
+		// SUCCESS, bytes() > 0  : open, unread data is waiting
+		// otherwise             : closed by the peer or broken
+		virtual SocketResult isAlive();
 		virtual SocketResult read(void* buffer, size_t size);
 		virtual SocketResult write(const void* buffer, size_t size);
+		// Up to SocketClient::MAX_IO_BUFFERS buffers, the first `offset` bytes
+		// of which are already written. bytes() counts from there.
+		virtual SocketResult writev(const SocketIOBuffer* buffers, size_t count, size_t offset);
+		virtual SocketResult readv(const SocketIOBuffer* buffers, size_t count);
+		// Sends whatever write() is still holding back. SUCCESS once nothing is.
+		virtual SocketResult flush();
+		// 0 turns write coalescing off (held data must be flushed first).
+		virtual void setWriteCoalescing(uint32_t flush_threshold);
+		// Data the next handshake offers as TLS 1.3 early data. The buffer must
+		// stay valid until the handshake is over; nullptr clears it.
+		virtual void setEarlyData(const void* buffer, size_t size);
+		// true if the server accepted the early data of the last handshake.
+		virtual bool isEarlyDataAccepted();
+
+		// Event to wait for before retrying an operation that returned
+		// SOCKET_CONNECTION_NEED_TO_BE_BLOCKED on a non-blocking socket.
+		virtual SocketEventType pendingEvent();
+		// Bytes already decrypted in memory, which poll() will not report.
+		virtual size_t pending();
+		// Event to wait for before writing again: READ after a write found the
+		// shared-memory ring full, as the reader wakes the writer through the
+		// socket.
+		SocketEventType writeEvent();
+
+		// Unix domain only, once connected: offers the server a shared-memory
+		// channel and moves the stream onto it if the server takes it. Any
+		// failure to set it up leaves the connection on the socket.
+		virtual SocketResult openSharedMemory(size_t ring_size, uint32_t busy_poll_us, uint32_t timeout_ms);
+
+		// Unix domain only: write() / read() that pass a descriptor along
+		// (see SocketDescriptor.hpp). descriptor is -1 when none came.
+		virtual SocketResult writeDescriptor(int32_t descriptor, const void* buffer, size_t size);
+		virtual SocketResult readDescriptor(void* buffer, size_t size, int32_t& descriptor);
 
 	protected:
+		// Raw pointer for the same reason as the TLS buffers below; released
+		// by close().
+		SharedMemoryChannel* _channel{ nullptr };
 	};
 
 
@@ -44,18 +88,55 @@ namespace Bn3Monkey
 		virtual SocketResult reconnect(bool after_handshake) override;
 		void disconnect() override;
 		SocketResult isConnected() override;
+		// Assumes a blocking socket: it is switched to non-blocking mode only
+		// for the duration of the probe.
+		SocketResult isAlive() override;
 		SocketResult read(void* buffer, size_t size) override;
+		// With write coalescing, small writes are copied into a buffer that
+		// goes out as full records when it fills up, on flush() or before read().
 		SocketResult write(const void* buffer, size_t size) override;
+		// Copies runs of small buffers into one record. A failed record is
+		// not counted, so retrying from bytes() gathers the same record into
+		// the same buffer again, as SSL_write() requires.
+		SocketResult writev(const SocketIOBuffer* buffers, size_t count, size_t offset) override;
+		// Reads on into the next buffer only while OpenSSL holds decrypted data.
+		SocketResult readv(const SocketIOBuffer* buffers, size_t count) override;
+		SocketResult flush() override;
+		void setWriteCoalescing(uint32_t flush_threshold) override;
+		void setEarlyData(const void* buffer, size_t size) override;
+		bool isEarlyDataAccepted() override;
+		SocketEventType pendingEvent() override;
+		size_t pending() override;
+		// Descriptors cannot travel inside TLS records.
+		SocketResult writeDescriptor(int32_t descriptor, const void* buffer, size_t size) override;
+		SocketResult readDescriptor(void* buffer, size_t size, int32_t& descriptor) override;
 
 	private:
+		// One SSL_write(), with the record size chosen by _record_sizer.
+		SocketResult writeRecords(const void* buffer, size_t size);
+
 		// Detects deferred client-certificate rejection alerts that arrive after
 		// SSL_connect() has already returned success in TLS 1.3.
 		// Must only be called when the negotiated version is TLS 1.3.
 		SocketResult postHandshakeProbe();
 
-		SSL_CTX* _context{ nullptr };
+		SSL_CTX* _context{ nullptr };     // one reference to a context shared through TLSClientContextCache
 		SSL* _ssl{ nullptr };
 		const char* _hostname{ nullptr };  // points to SocketConfiguration._ip (externally owned)
+
+		TLSRecordSizer _record_sizer;
+		// Raw buffer rather than std::vector: SocketContainer copies sockets
+		// with memcpy. Allocated on first use and released by close().
+		char* _coalescing_buffer{ nullptr };
+		size_t _coalescing_threshold{ 0 };
+		// writev() gathers small buffers here; allocated like the one above.
+		char* _gather_buffer{ nullptr };
+		static constexpr size_t GATHER_BUFFER_SIZE = 16384;
+		size_t _coalesced_size{ 0 };
+
+		// Points into the caller's buffer for the duration of connect().
+		const char* _early_data{ nullptr };
+		size_t _early_data_size{ 0 };
 	};
 
 	using ClientActiveSocketContainer = SocketContainer<ClientActiveSocket, TLSClientActiveSocket>;
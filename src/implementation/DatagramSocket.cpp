@@ -0,0 +1,331 @@
+#include "DatagramSocket.hpp"
+#include "SocketResult.hpp"
+#include "SocketHelper.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#include <WS2tcpip.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#if !defined(UDP_GRO)
+#define UDP_GRO 104
+#endif
+#endif
+
+using namespace Bn3Monkey;
+
+// The kernel's limit on datagrams per GSO send (UDP_MAX_SEGMENTS).
+static constexpr size_t MAX_SEGMENTS = 64;
+
+void DatagramBatch::resize(size_t capacity, size_t slot_size)
+{
+	_capacity = capacity;
+	_slot_size = slot_size;
+	_buffer.assign(capacity * slot_size, 0);
+	_addresses.assign(capacity, sockaddr_storage{});
+	_senders.assign(capacity, Sender{});
+	_datagrams.clear();
+	_datagrams.reserve(capacity);
+#if defined(__linux__)
+	_headers.assign(capacity, mmsghdr{});
+	_iovecs.assign(capacity, iovec{});
+	_controls.assign(capacity, Control{});
+	for (size_t slot = 0; slot < capacity; slot++)
+	{
+		_iovecs[slot].iov_base = _buffer.data() + slot * slot_size;
+		_iovecs[slot].iov_len = slot_size;
+	}
+#endif
+}
+
+void DatagramBatch::describeSender(size_t slot, size_t address_size)
+{
+	auto& sender = _senders[slot];
+	const auto& address = _addresses[slot];
+	if (address_size >= sizeof(sockaddr_in) && address.ss_family == AF_INET)
+	{
+		const auto* ipv4 = reinterpret_cast<const sockaddr_in*>(&address);
+		inet_ntop(AF_INET, &ipv4->sin_addr, sender.ip, sizeof(sender.ip));
+		sender.port = ntohs(ipv4->sin_port);
+	}
+	else
+	{
+		// Unix-domain senders seldom have a name.
+		sender.ip[0] = '\0';
+		sender.port = 0;
+	}
+}
+
+void DatagramBatch::split(size_t slot, size_t length, size_t segment)
+{
+	const char* data = _buffer.data() + slot * _slot_size;
+	const auto& sender = _senders[slot];
+	size_t offset = 0;
+	do
+	{
+		SocketDatagram datagram;
+		datagram.data = data + offset;
+		datagram.size = std::min(segment, length - offset);
+		datagram.ip = sender.ip;
+		datagram.port = sender.port;
+		_datagrams.push_back(datagram);
+		offset += segment;
+	} while (offset < length);
+}
+
+DatagramSocket::DatagramSocket(bool is_unix_domain) : _is_unix_domain(is_unix_domain)
+{
+	if (is_unix_domain) {
+		auto temp_socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+		_socket = static_cast<int32_t>(temp_socket);
+	}
+	else {
+		auto temp_socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		_socket = static_cast<int32_t>(temp_socket);
+	}
+	if (_socket < 0)
+	{
+		_result = createResult(_socket);
+		return;
+	}
+
+	setNonBlockingMode(_socket);
+}
+
+void DatagramSocket::close()
+{
+	if (_socket < 0)
+		return;
+#ifdef _WIN32
+	::closesocket(_socket);
+#else
+	::close(_socket);
+#endif
+	_socket = -1;
+}
+
+SocketResult DatagramSocket::bind(const SocketAddress& address)
+{
+	SocketResult res;
+	int ret = ::bind(_socket, address.address(), address.size());
+	if (ret < 0) {
+		res = createResult(ret);
+	}
+	return res;
+}
+
+SocketResult DatagramSocket::connect(const SocketAddress& address)
+{
+	SocketResult res;
+	int ret = ::connect(_socket, address.address(), address.size());
+	if (ret < 0) {
+		res = createResult(ret);
+	}
+	return res;
+}
+
+bool DatagramSocket::enableSegmentationOffload(bool is_receiver)
+{
+#if defined(__linux__)
+	if (_is_unix_domain)
+		return false;
+	if (is_receiver)
+	{
+		int on = 1;
+		return setsockopt(_socket, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+	}
+	// GSO is asked for per send. Probing the option keeps kernels without it
+	// from ever seeing the control message.
+	int segment = 0;
+	socklen_t length = sizeof(segment);
+	_use_gso = getsockopt(_socket, SOL_UDP, UDP_SEGMENT, &segment, &length) == 0;
+	return _use_gso;
+#else
+	(void)is_receiver;
+	return false;
+#endif
+}
+
+SocketResult DatagramSocket::send(const void* buffer, size_t size)
+{
+#ifdef _WIN32
+	int ret = ::send(_socket, static_cast<const char*>(buffer), static_cast<int>(size), 0);
+#else
+	auto ret = ::send(_socket, buffer, size, 0);
+#endif
+	// An empty datagram is still a datagram.
+	if (ret >= 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(ret));
+	}
+	return createResult(static_cast<int32_t>(ret));
+}
+
+SocketResult DatagramSocket::sendBatch(const SocketIOBuffer* datagrams, size_t count)
+{
+	if (count == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+#if defined(__linux__)
+	if (_headers.size() < count)
+	{
+		_headers.resize(count);
+		_iovecs.resize(count);
+		_controls.resize(count);
+		_segments.resize(count);
+	}
+
+	size_t messages = 0;
+	bool is_segmented = false;
+	for (size_t index = 0; index < count; )
+	{
+		// A GSO run: datagrams of one size, the last of which may be shorter,
+		// within what the kernel takes in one send.
+		size_t run = 1;
+		size_t segment = datagrams[index].size;
+		if (_use_gso && segment > 0)
+		{
+			size_t total = segment;
+			while (index + run < count && run < MAX_SEGMENTS)
+			{
+				size_t next = datagrams[index + run].size;
+				if (next == 0 || next > segment || total + next > MAX_DATAGRAM_SIZE)
+					break;
+				total += next;
+				run++;
+				if (next < segment)
+					break;
+			}
+		}
+
+		auto& header = _headers[messages].msg_hdr;
+		memset(&_headers[messages], 0, sizeof(mmsghdr));
+		for (size_t i = 0; i < run; i++)
+		{
+			_iovecs[index + i].iov_base = datagrams[index + i].data;
+			_iovecs[index + i].iov_len = datagrams[index + i].size;
+		}
+		header.msg_iov = &_iovecs[index];
+		header.msg_iovlen = run;
+		if (run > 1)
+		{
+			header.msg_control = _controls[messages].data;
+			header.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+			cmsghdr* control = CMSG_FIRSTHDR(&header);
+			control->cmsg_level = SOL_UDP;
+			control->cmsg_type = UDP_SEGMENT;
+			control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			uint16_t segment_size = static_cast<uint16_t>(segment);
+			memcpy(CMSG_DATA(control), &segment_size, sizeof(segment_size));
+			is_segmented = true;
+		}
+		_segments[messages] = run;
+		messages++;
+		index += run;
+	}
+
+	int ret = ::sendmmsg(_socket, _headers.data(), static_cast<unsigned int>(messages), 0);
+	if (ret < 0)
+	{
+		// Devices without checksum offload refuse GSO; go without it.
+		if (is_segmented && (errno == EIO || errno == EINVAL))
+		{
+			_use_gso = false;
+			return sendBatch(datagrams, count);
+		}
+		return createResult(ret);
+	}
+
+	size_t sent = 0;
+	for (int i = 0; i < ret; i++)
+		sent += _segments[i];
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(sent));
+#else
+	size_t sent = 0;
+	for (; sent < count; sent++)
+	{
+		auto result = send(datagrams[sent].data, datagrams[sent].size);
+		if (result.code() != SocketCode::SUCCESS)
+		{
+			if (sent == 0)
+				return result;
+			break;
+		}
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(sent));
+#endif
+}
+
+SocketResult DatagramSocket::receive(DatagramBatch& batch)
+{
+	batch._datagrams.clear();
+#if defined(__linux__)
+	for (size_t slot = 0; slot < batch._capacity; slot++)
+	{
+		auto& header = batch._headers[slot].msg_hdr;
+		header.msg_name = &batch._addresses[slot];
+		header.msg_namelen = sizeof(sockaddr_storage);
+		header.msg_iov = &batch._iovecs[slot];
+		header.msg_iovlen = 1;
+		header.msg_control = batch._controls[slot].data;
+		header.msg_controllen = sizeof(batch._controls[slot].data);
+		header.msg_flags = 0;
+	}
+
+	int ret = ::recvmmsg(_socket, batch._headers.data(), static_cast<unsigned int>(batch._capacity), MSG_DONTWAIT, nullptr);
+	if (ret < 0)
+	{
+		return createResult(ret);
+	}
+
+	for (int slot = 0; slot < ret; slot++)
+	{
+		auto& header = batch._headers[slot].msg_hdr;
+		size_t length = batch._headers[slot].msg_len;
+		// Datagrams GRO coalesced arrive with the size they had on the wire.
+		size_t segment = length;
+		for (cmsghdr* control = CMSG_FIRSTHDR(&header); control != nullptr; control = CMSG_NXTHDR(&header, control))
+		{
+			if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO)
+			{
+				int segment_size = 0;
+				memcpy(&segment_size, CMSG_DATA(control), sizeof(segment_size));
+				if (segment_size > 0)
+					segment = static_cast<size_t>(segment_size);
+			}
+		}
+		batch.describeSender(slot, header.msg_namelen);
+		batch.split(slot, length, segment);
+	}
+#else
+	for (size_t slot = 0; slot < batch._capacity; slot++)
+	{
+		socklen_t address_size = sizeof(sockaddr_storage);
+		char* data = batch._buffer.data() + slot * batch._slot_size;
+		auto ret = ::recvfrom(_socket, data, static_cast<int>(batch._slot_size), 0,
+			reinterpret_cast<sockaddr*>(&batch._addresses[slot]), &address_size);
+		if (ret < 0)
+		{
+			if (slot == 0)
+				return createResult(static_cast<int32_t>(ret));
+			break;
+		}
+		batch.describeSender(slot, address_size);
+		batch.split(slot, static_cast<size_t>(ret), static_cast<size_t>(ret));
+	}
+#endif
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(batch._datagrams.size()));
+}
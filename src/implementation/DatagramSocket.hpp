@@ -0,0 +1,105 @@
+#if !defined(__BN3MONKEY_DATAGRAMSOCKET__)
+#define __BN3MONKEY_DATAGRAMSOCKET__
+
+#include "../SecuritySocket.hpp"
+#include "SocketAddress.hpp"
+#include "BaseSocket.hpp"
+
+#include <vector>
+
+namespace Bn3Monkey
+{
+	// Where one receive() lands: capacity slots of slot_size bytes, and the
+	// datagrams the last receive() found in them. A slot filled by GRO holds
+	// several datagrams, so there may be more datagrams than slots.
+	class DatagramBatch
+	{
+	public:
+		void resize(size_t capacity, size_t slot_size);
+
+		inline const SocketDatagram* datagrams() const { return _datagrams.data(); }
+		inline size_t size() const { return _datagrams.size(); }
+
+	private:
+		friend class DatagramSocket;
+
+		struct Sender
+		{
+			char ip[46]{ 0 };
+			int port{ 0 };
+		};
+		// Fills _senders[slot] from _addresses[slot].
+		void describeSender(size_t slot, size_t address_size);
+		// The slot's length bytes, cut at every segment bytes.
+		void split(size_t slot, size_t length, size_t segment);
+
+		size_t _capacity{ 0 };
+		size_t _slot_size{ 0 };
+		std::vector<char> _buffer;
+		std::vector<sockaddr_storage> _addresses;
+		std::vector<Sender> _senders;
+		std::vector<SocketDatagram> _datagrams;
+#if defined(__linux__)
+		union Control
+		{
+			cmsghdr header;
+			char data[CMSG_SPACE(sizeof(int))];
+		};
+		std::vector<mmsghdr> _headers;
+		std::vector<iovec> _iovecs;
+		std::vector<Control> _controls;
+#endif
+	};
+
+	// A SOCK_DGRAM socket: UDP, or a unix-domain datagram socket. Always
+	// non-blocking; calls that would block return
+	// SOCKET_CONNECTION_NEED_TO_BE_BLOCKED.
+	class DatagramSocket : public BaseSocket
+	{
+	public:
+		// The largest UDP payload over IPv4, and so the most one GSO send
+		// may carry.
+		static constexpr size_t MAX_DATAGRAM_SIZE = 65507;
+		// recvmmsg() and sendmmsg() take at most UIO_MAXIOV messages.
+		static constexpr size_t MAX_BATCH_SIZE = 1024;
+		// SocketConfiguration::datagram_batch_size() within 1 ~ MAX_BATCH_SIZE.
+		static inline size_t batchSize(uint32_t configured) {
+			return configured < 1 ? 1 : (configured > MAX_BATCH_SIZE ? MAX_BATCH_SIZE : configured);
+		}
+
+		explicit DatagramSocket(bool is_unix_domain);
+
+		void close();
+		SocketResult bind(const SocketAddress& address);
+		// Sets the peer send() and sendBatch() go to.
+		SocketResult connect(const SocketAddress& address);
+
+		// Linux UDP only. For a receiver, lets the kernel coalesce datagrams
+		// of one flow (GRO), which receive() splits again. For a sender, lets
+		// sendBatch() pass runs of equal-sized datagrams as one buffer (GSO).
+		// false where the kernel cannot.
+		bool enableSegmentationOffload(bool is_receiver);
+
+		SocketResult send(const void* buffer, size_t size);
+		// One datagram per buffer, in one system call (sendmmsg()) where the
+		// platform has it. bytes() is the number of datagrams sent, which
+		// may be fewer than count.
+		SocketResult sendBatch(const SocketIOBuffer* datagrams, size_t count);
+		// As many datagrams as the batch has slots for, in one system call
+		// (recvmmsg()) where the platform has it. bytes() is batch.size().
+		SocketResult receive(DatagramBatch& batch);
+
+	private:
+		bool _is_unix_domain{ false };
+		bool _use_gso{ false };
+#if defined(__linux__)
+		std::vector<mmsghdr> _headers;
+		std::vector<iovec> _iovecs;
+		std::vector<DatagramBatch::Control> _controls;
+		// Datagrams carried by each of _headers.
+		std::vector<size_t> _segments;
+#endif
+	};
+}
+
+#endif // __BN3MONKEY_DATAGRAMSOCKET__
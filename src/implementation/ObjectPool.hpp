@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <queue>
+#include <map>
+#include <memory>
 
 namespace Bn3Monkey
 {
@@ -10,13 +12,30 @@ namespace Bn3Monkey
     class ObjectPool
     {
     public:
-        ObjectPool(size_t initial_size) : _objects(initial_size, std::allocator<Container>())
+        ObjectPool(size_t initial_size)
         {
-            for (auto& object : _objects)
+            reserve(initial_size);
+        }
+
+        // Grows the pool to at least `size` objects. Objects already handed
+        // out stay where they are.
+        void reserve(size_t size)
+        {
+            if (size <= _capacity)
+            {
+                return;
+            }
+
+            size_t added = size - _capacity;
+            _chunks.emplace_back(new Container[added]);
+            _chunk_ends[_chunks.back().get()] = _chunks.back().get() + added;
+            for (size_t i = 0; i < added; i++)
             {
-                _availables.push(&object);
+                _availables.push(&_chunks.back()[i]);
             }
+            _capacity = size;
         }
+        inline size_t capacity() const { return _capacity; }
 
         template<class ...Args>
         ObjectType* acquire(Args&&... args)
@@ -35,15 +54,17 @@ namespace Bn3Monkey
 
         void release(ObjectType* object)
         {
-            auto* pos = static_cast<ObjectType*>(object);
-            auto* start_ptr = reinterpret_cast<ObjectType*>(_objects.data());
-            auto* end_ptr = reinterpret_cast<ObjectType*>(_objects.data()) + _objects.size();
-
-
-            if (start_ptr<=pos && pos < end_ptr)
+            auto* ptr = reinterpret_cast<Container*>(object);
+            // Only the last chunk that starts at or before ptr can hold it.
+            auto chunk = _chunk_ends.upper_bound(ptr);
+            if (chunk == _chunk_ends.begin())
+            {
+                return;
+            }
+            --chunk;
+            if (ptr < chunk->second)
             {
                 object->~ObjectType();
-                auto* ptr = reinterpret_cast<Container*>(object);
                 _availables.push(ptr);
             }
         }
@@ -51,10 +72,14 @@ namespace Bn3Monkey
     private:
         class Container
         {
-            char buffer[sizeof(ObjectType)]{ 0 };
+            alignas(ObjectType) char buffer[sizeof(ObjectType)]{ 0 };
         };
 
-        std::vector<Container> _objects;
+        // Chunks are never reallocated, so reserve() keeps objects in place.
+        std::vector<std::unique_ptr<Container[]>> _chunks;
+        // Start of each chunk to its end, for release() to look up.
+        std::map<Container*, Container*> _chunk_ends;
+        size_t _capacity{ 0 };
         std::queue<Container*> _availables;
 
     };
@@ -2,8 +2,9 @@
 
 #include "SocketResult.hpp"
 #include "SocketHelper.hpp"
+#include "TLSContext.hpp"
 
-#include <stdexcept>
+#include <cstring>
 
 #ifdef _WIN32
 #include <Winsock2.h>
@@ -39,6 +40,12 @@ static inline void loadAcceptExFunction(int32_t socket, LPFN_ACCEPTEX* function_
 }
 #endif
 
+PassiveSocket::PassiveSocket(bool is_unix_domain, const SocketTLSServerConfiguration& tls_configuration)
+    : PassiveSocket(is_unix_domain)
+{
+    (void)tls_configuration;
+}
+
 PassiveSocket::PassiveSocket(bool is_unix_domain)
 {
     if (is_unix_domain) {
@@ -99,39 +106,81 @@ SocketResult PassiveSocket::listen()
 
 
 
-ServerActiveSocketContainer PassiveSocket::accept()
+int32_t PassiveSocket::acceptDescriptor(void* address)
 {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
+    socklen_t client_len = sizeof(struct sockaddr_storage);
+    return static_cast<int32_t>(::accept(_socket, (struct sockaddr*)address, &client_len));
+}
 
-    int sock = static_cast<int32_t>(::accept(_socket, (struct sockaddr*)&client_addr, &client_len));
-    if (sock == 0) {
-        // Do nothing
-    }
+ServerActiveSocketContainer PassiveSocket::accept()
+{
+    struct sockaddr_storage client_addr{};
+    int sock = acceptDescriptor(&client_addr);
     ServerActiveSocketContainer container{false, sock, (void*)&client_addr, nullptr};
     return container;   
 }
+ServerActiveSocketContainer PassiveSocket::adopt(int32_t sock)
+{
+    struct sockaddr_storage client_addr;
+    peerAddress(sock, &client_addr);
+    ServerActiveSocketContainer container{false, sock, (void*)&client_addr, nullptr};
+    return container;
+}
+void PassiveSocket::peerAddress(int32_t sock, void* address)
+{
+    memset(address, 0, sizeof(struct sockaddr_storage));
+    socklen_t client_len = sizeof(struct sockaddr_storage);
+    ::getpeername(sock, (struct sockaddr*)address, &client_len);
+}
 
 
-TLSPassiveSocket::TLSPassiveSocket(bool is_unix_domain)
+TLSPassiveSocket::TLSPassiveSocket(bool is_unix_domain, const SocketTLSServerConfiguration& tls_configuration)
+    : PassiveSocket(is_unix_domain, tls_configuration)
 {
-	(void)is_unix_domain;
-    throw std::runtime_error("Not Implemented");
+    if (_result.code() != SocketCode::SUCCESS)
+        return;
+
+    _context = createTLSServerContext(tls_configuration);
+    if (!_context) {
+        _result = SocketResult(SocketCode::TLS_CONTEXT_INITIALIZATION_FAIL);
+        return;
+    }
+    _use_dynamic_record_sizing = tls_configuration.shouldUseDynamicRecordSizing();
+    // kTLS needs OpenSSL to own the descriptor.
+    _use_memory_bio = tls_configuration.shouldUseMemoryBIO() && !tls_configuration.shouldUseKernelTLS();
+    _max_early_data = tls_configuration.maxEarlyData();
 }
 void TLSPassiveSocket::close()
 {
-    throw std::runtime_error("Not Implemented");
+    // Connections still open keep the context alive through their SSL objects.
+    if (_context) {
+        SSL_CTX_free(_context);
+        _context = nullptr;
+    }
+    PassiveSocket::close();
 }
-SocketResult TLSPassiveSocket::bind(const SocketAddress& address)
+ServerActiveSocketContainer TLSPassiveSocket::accept()
 {
-	(void)address;
-    throw std::runtime_error("Not Implemented");
+    struct sockaddr_storage client_addr{};
+    int sock = acceptDescriptor(&client_addr);
+    ServerActiveSocketContainer container{true, sock, (void*)&client_addr, (void*)_context};
+    prepare(container);
+    return container;
 }
-SocketResult TLSPassiveSocket::listen()
+ServerActiveSocketContainer TLSPassiveSocket::adopt(int32_t sock)
 {
-    throw std::runtime_error("Not Implemented");
+    struct sockaddr_storage client_addr;
+    peerAddress(sock, &client_addr);
+    ServerActiveSocketContainer container{true, sock, (void*)&client_addr, (void*)_context};
+    prepare(container);
+    return container;
 }
-ServerActiveSocketContainer TLSPassiveSocket::accept()
+void TLSPassiveSocket::prepare(ServerActiveSocketContainer& container)
 {
-    throw std::runtime_error("Not Implemented");
+    if (_use_dynamic_record_sizing)
+        static_cast<TLSServerActiveSocket*>(container.get())->enableDynamicRecordSizing();
+    if (_use_memory_bio)
+        static_cast<TLSServerActiveSocket*>(container.get())->enableMemoryBIO();
+    if (_max_early_data > 0)
+        static_cast<TLSServerActiveSocket*>(container.get())->enableEarlyData(_max_early_data);
 }
\ No newline at end of file
@@ -17,24 +17,40 @@ namespace Bn3Monkey {
 	class PassiveSocket  : public BaseSocket {
 	public:
 		PassiveSocket(bool is_unix_domain = false);
+		PassiveSocket(bool is_unix_domain, const SocketTLSServerConfiguration& tls_configuration);
 		virtual void close();
 
 		virtual SocketResult bind(const SocketAddress& address);
 		virtual SocketResult listen();
 		virtual ServerActiveSocketContainer accept();
-
-	private:
+		// A connected socket from elsewhere, taken as if accept() had returned it.
+		virtual ServerActiveSocketContainer adopt(int32_t sock);
+
+	protected:
+		// address is a sockaddr_storage, of whatever family the peer has.
+		int32_t acceptDescriptor(void* address);
+		// Where the connected sock comes from, as accept() would report it.
+		void peerAddress(int32_t sock, void* address);
 	};
 
 	class TLSPassiveSocket : public PassiveSocket
 	{
 	public:
-		TLSPassiveSocket(bool is_unix_domain = false);
+		TLSPassiveSocket(bool is_unix_domain, const SocketTLSServerConfiguration& tls_configuration);
 		virtual void close();
 
-		virtual SocketResult bind(const SocketAddress& address);
-		virtual SocketResult listen();
+		// The connection starts in the handshake; see ServerActiveSocket::handshake().
 		virtual ServerActiveSocketContainer accept();
+		virtual ServerActiveSocketContainer adopt(int32_t sock);
+
+	private:
+		// The per-connection TLS options of the configuration.
+		void prepare(ServerActiveSocketContainer& container);
+
+		SSL_CTX* _context{ nullptr };
+		bool _use_dynamic_record_sizing{ false };
+		bool _use_memory_bio{ false };
+		uint32_t _max_early_data{ 0 };
 	};
 
 	using PassiveSocketContainer = SocketContainer<PassiveSocket, TLSPassiveSocket>;
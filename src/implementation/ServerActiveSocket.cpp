@@ -1,7 +1,12 @@
 #include "ServerActiveSocket.hpp"
+#include "TLSContext.hpp"
 #include "SocketResult.hpp"
 #include "SocketHelper.hpp"
-#include <stdexcept>
+#include "SocketFile.hpp"
+#include "SharedMemoryChannel.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 #ifdef _WIN32
 #include <Winsock2.h>
@@ -23,7 +28,6 @@ ServerActiveSocket::ServerActiveSocket(int32_t sock, void* addr, void* ssl_conte
 {
 	(void)ssl_context;
 
-    struct sockaddr_in* address = (struct sockaddr_in*)addr;
     _socket = sock;
     _result = createResult(_socket);
     if (_result.code() != SocketCode::SUCCESS)
@@ -32,9 +36,27 @@ ServerActiveSocket::ServerActiveSocket(int32_t sock, void* addr, void* ssl_conte
     }
 
 	if (sock >= 0) {
-		
-		inet_ntop(AF_INET, &(address->sin_addr), _client_ip, sizeof(_client_ip));
-		_client_port = ntohs(address->sin_port);
+		// A sockaddr_storage from accept() or getpeername().
+		switch (static_cast<const sockaddr_storage*>(addr)->ss_family)
+		{
+		case AF_INET:
+		{
+			auto* address = static_cast<const sockaddr_in*>(addr);
+			inet_ntop(AF_INET, &(address->sin_addr), _client_ip, sizeof(_client_ip));
+			_client_port = ntohs(address->sin_port);
+		}
+		break;
+		case AF_INET6:
+		{
+			auto* address = static_cast<const sockaddr_in6*>(addr);
+			inet_ntop(AF_INET6, &(address->sin6_addr), _client_ip, sizeof(_client_ip));
+			_client_port = ntohs(address->sin6_port);
+		}
+		break;
+		default:
+			// Unix domain peers are rarely bound, and have no port: "" and 0.
+			break;
+		}
 		// printf("Connected client ip : %s port : %d\n", _client_ip, _client_port);
 	}
 
@@ -46,6 +68,10 @@ ServerActiveSocket::~ServerActiveSocket()
 }
 void ServerActiveSocket::close()
 {
+	delete _channel;
+	_channel = nullptr;
+	_accepts_shared_memory = false;
+	closeDescriptor(takeDescriptor());
 #ifdef _WIN32
 	::closesocket(_socket);
 #else
@@ -55,6 +81,13 @@ void ServerActiveSocket::close()
 }
 SocketResult ServerActiveSocket::read(void* buffer, size_t size)
 {
+	if (_channel)
+		return _channel->read(_socket, buffer, size);
+	if (_receives_descriptors)
+	{
+		size_t count{ 0 };
+		return Bn3Monkey::receiveDescriptors(_socket, buffer, size, &_descriptor, _descriptor < 0 ? 1 : 0, count);
+	}
 	int32_t ret{ 0 };
 	ret = ::recv(_socket, static_cast<char*>(buffer), static_cast<int32_t>(size), 0);
 	if (ret == 0)
@@ -63,6 +96,8 @@ SocketResult ServerActiveSocket::read(void* buffer, size_t size)
 }
 SocketResult ServerActiveSocket::write(const void* buffer, size_t size)
 {
+	if (_channel)
+		return _channel->write(_socket, buffer, size);
 	int32_t ret{0};
 #ifdef __linux__
 	ret = send(_socket, buffer, size, MSG_NOSIGNAL);
@@ -73,6 +108,45 @@ SocketResult ServerActiveSocket::write(const void* buffer, size_t size)
 		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
 	return createResult(ret);
 }
+SocketResult ServerActiveSocket::sendFile(int32_t fd, int64_t offset, size_t size)
+{
+	// The file has to be copied into the ring.
+	if (_channel)
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	return Bn3Monkey::sendFile(_socket, fd, offset, size);
+}
+
+SocketResult ServerActiveSocket::handshake()
+{
+	if (!_accepts_shared_memory)
+		return SocketResult(SocketCode::SUCCESS);
+
+	if (!_channel)
+		_channel = new SharedMemoryChannel();
+	auto result = _channel->acceptOffer(_socket);
+	if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+		return result;
+
+	_accepts_shared_memory = false;
+	if (!_channel->isOpen())
+	{
+		delete _channel;
+		_channel = nullptr;
+	}
+	return result;
+}
+SocketEventType ServerActiveSocket::pendingEvent()
+{
+	return SocketEventType::READ;
+}
+size_t ServerActiveSocket::pending()
+{
+	return _channel ? _channel->pending(_socket) : 0;
+}
+SocketEventType ServerActiveSocket::writeEvent()
+{
+	return _channel && _channel->isWriteBlocked() ? SocketEventType::READ : SocketEventType::WRITE;
+}
 
 void ServerActiveSocket::setSocketBufferSize(size_t size)
 {
@@ -85,32 +159,231 @@ void ServerActiveSocket::setNoDelay()
 	::setNoDelay(_socket);
 }
 
+int32_t ServerActiveSocket::takeDescriptor()
+{
+	int32_t descriptor = _descriptor;
+	_descriptor = -1;
+	return descriptor;
+}
+
 TLSServerActiveSocket::TLSServerActiveSocket(int32_t sock, void* addr, void* ssl_context)
+	: ServerActiveSocket(sock, addr, ssl_context)
 {
-	(void)sock;
-	(void)addr;
-	(void)ssl_context;
+	if (_result.code() != SocketCode::SUCCESS)
+		return;
 
-	throw std::runtime_error("Not Implemented");
+	auto* context = static_cast<SSL_CTX*>(ssl_context);
+	ssl = SSL_new(context);
+	if (!ssl) {
+		_result = SocketResult(SocketCode::TLS_INITIALIZATION_FAIL);
+		return;
+	}
+	if (SSL_set_fd(ssl, _socket) == 0) {
+		SSL_free(ssl);
+		ssl = nullptr;
+		_result = SocketResult(SocketCode::TLS_SETFD_ERROR);
+		return;
+	}
+	SSL_set_accept_state(ssl);
+	// TLS info tracking
+	SSL_set_ex_data(ssl, 0, SSL_CTX_get_ex_data(context, 0));
 }
 TLSServerActiveSocket::~TLSServerActiveSocket()
 {
-	printf("Not Implemeneted\n");
+}
+
+void TLSServerActiveSocket::enableMemoryBIO()
+{
+	if (ssl)
+		_engine.open(ssl, _socket);
+}
+
+void TLSServerActiveSocket::enableEarlyData(uint32_t max_size)
+{
+	if (!ssl || max_size == 0)
+		return;
+	_early_data_capacity = max_size;
+	_early_data_state = EarlyDataState::HANDSHAKING;
 }
 
 void TLSServerActiveSocket::close()
 {
-	throw std::runtime_error("Not Implemented");
+	if (ssl) {
+		// Best-effort close_notify; the socket is non-blocking, so this never waits.
+		if (SSL_is_init_finished(ssl))
+			SSL_shutdown(ssl);
+		if (_engine.isOpened())
+			_engine.close();
+		SSL_free(ssl);
+		ssl = nullptr;
+	}
+	releaseEarlyData();
+	ServerActiveSocket::close();
 }
 SocketResult TLSServerActiveSocket::read(void* buffer, size_t size)
 {
-	(void)buffer;
-	(void)size;
-	throw std::runtime_error("Not Implemented");
+	if (!ssl)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	if (_early_data_state == EarlyDataState::READING || _early_data_state == EarlyDataState::DRAINING)
+	{
+		if (_early_data_offset < _early_data_size)
+		{
+			size_t copied = std::min<size_t>(size, _early_data_size - _early_data_offset);
+			memcpy(buffer, _early_data + _early_data_offset, copied);
+			_early_data_offset += static_cast<uint32_t>(copied);
+			return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(copied));
+		}
+		if (_early_data_state == EarlyDataState::READING)
+		{
+			bool is_finished{ false };
+			auto result = readEarlyData(buffer, size, is_finished);
+			if (!is_finished)
+				return result;
+		}
+		// SSL_read() below finishes the handshake.
+		releaseEarlyData();
+	}
+	if (_engine.isOpened())
+		return _engine.read(buffer, size);
+	ERR_clear_error();
+	int32_t ret = SSL_read(ssl, buffer, static_cast<int32_t>(size));
+	// EOF without close_notify
+	if (ret == 0 && SSL_get_error(ssl, ret) == SSL_ERROR_SYSCALL)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	return createTLSResult(ssl, ret);
 }
 SocketResult TLSServerActiveSocket::write(const void* buffer, size_t size)
 {
-	(void)buffer;
-	(void)size;
-	throw std::runtime_error("Not Implemented");
+	if (!ssl)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	_record_sizer.prepare(ssl, size);
+	if (_early_data_state == EarlyDataState::READING)
+	{
+		// A response sent before the client's Finished (0.5-RTT data).
+		if (_engine.isOpened())
+			return _engine.writeEarlyData(buffer, size);
+		ERR_clear_error();
+		size_t written{ 0 };
+		if (SSL_write_early_data(ssl, buffer, size, &written) != 1)
+			return createTLSResult(ssl, 0);
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written));
+	}
+	if (_engine.isOpened())
+		return _engine.write(buffer, size);
+	ERR_clear_error();
+	int32_t ret = SSL_write(ssl, buffer, static_cast<int32_t>(size));
+	return createTLSResult(ssl, ret);
+}
+SocketResult TLSServerActiveSocket::sendFile(int32_t fd, int64_t offset, size_t size)
+{
+	// Anything else has to go through SSL_write() to be encrypted.
+	if (!ssl || _engine.isOpened() || _early_data_state != EarlyDataState::NONE ||
+		!BIO_get_ktls_send(SSL_get_wbio(ssl)) || !isRegularFile(fd))
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	ERR_clear_error();
+	auto ret = SSL_sendfile(ssl, fd, static_cast<off_t>(offset), std::min<size_t>(size, 1 << 30), 0);
+	if (ret == 0)
+		return SocketResult(SocketCode::SUCCESS, 0);
+	return createTLSResult(ssl, static_cast<int32_t>(ret));
+}
+SocketResult TLSServerActiveSocket::handshake()
+{
+	if (!ssl)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	if (_early_data_state == EarlyDataState::READING || _early_data_state == EarlyDataState::DRAINING)
+		return SocketResult(SocketCode::SUCCESS);
+	if (_early_data_state == EarlyDataState::HANDSHAKING)
+	{
+		auto result = receiveEarlyData();
+		if (_early_data_state != EarlyDataState::NONE)
+			return result;
+		// No early data, or all of it came with the client's Finished.
+	}
+	if (_engine.isOpened())
+		return _engine.handshake();
+	ERR_clear_error();
+	int32_t ret = SSL_accept(ssl);
+	if (ret == 1)
+		reportKernelTLS(ssl);
+	return createTLSResult(ssl, ret);
+}
+SocketEventType TLSServerActiveSocket::pendingEvent()
+{
+	if (_engine.isOpened())
+		return _engine.pendingEvent();
+	if (ssl && SSL_want_write(ssl))
+		return SocketEventType::WRITE;
+	return SocketEventType::READ;
+}
+size_t TLSServerActiveSocket::pending()
+{
+	size_t early_data = _early_data_size - _early_data_offset;
+	if (_engine.isOpened())
+		return early_data + _engine.pending();
+	return early_data + (ssl ? static_cast<size_t>(SSL_pending(ssl)) : 0);
+}
+SocketResult TLSServerActiveSocket::receiveEarlyData()
+{
+	while (_early_data_size < _early_data_capacity)
+	{
+		char chunk[4096];
+		size_t chunk_size = std::min<size_t>(sizeof(chunk), _early_data_capacity - _early_data_size);
+		bool is_finished{ false };
+		auto result = readEarlyData(chunk, chunk_size, is_finished);
+		if (is_finished)
+		{
+			// The client's Finished came with it; read() hands the buffer out first.
+			if (_early_data_size > 0)
+			{
+				_early_data_state = EarlyDataState::DRAINING;
+				return SocketResult(SocketCode::SUCCESS);
+			}
+			releaseEarlyData();
+			return result;
+		}
+		if (result.code() != SocketCode::SUCCESS)
+		{
+			// Serve what came; read() picks up the rest of the handshake.
+			bool is_waiting = result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED ||
+				result.code() == SocketCode::SOCKET_CONNECTION_INTERRUPTED;
+			if (is_waiting && _early_data_size > 0)
+			{
+				_early_data_state = EarlyDataState::READING;
+				return SocketResult(SocketCode::SUCCESS);
+			}
+			return result;
+		}
+
+		if (!_early_data)
+			_early_data = new char[_early_data_capacity];
+		memcpy(_early_data + _early_data_size, chunk, static_cast<size_t>(result.bytes()));
+		_early_data_size += static_cast<uint32_t>(result.bytes());
+	}
+	_early_data_state = EarlyDataState::READING;
+	return SocketResult(SocketCode::SUCCESS);
+}
+SocketResult TLSServerActiveSocket::readEarlyData(void* buffer, size_t size, bool& is_finished)
+{
+	if (_engine.isOpened())
+		return _engine.readEarlyData(buffer, size, is_finished);
+	is_finished = false;
+	ERR_clear_error();
+	size_t read_size{ 0 };
+	int32_t ret = SSL_read_early_data(ssl, buffer, size, &read_size);
+	if (ret == SSL_READ_EARLY_DATA_SUCCESS)
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(read_size));
+	if (ret == SSL_READ_EARLY_DATA_FINISH)
+	{
+		is_finished = true;
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	return createTLSResult(ssl, ret);
+}
+void TLSServerActiveSocket::releaseEarlyData()
+{
+	delete[] _early_data;
+	_early_data = nullptr;
+	_early_data_size = 0;
+	_early_data_offset = 0;
+	_early_data_state = EarlyDataState::NONE;
 }
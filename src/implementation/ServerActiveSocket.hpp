@@ -4,14 +4,19 @@
 #include "../SecuritySocket.hpp"
 #include "BaseSocket.hpp"
 #include "SocketHelper.hpp"
+#include "SocketEvent.hpp"
+#include "SocketDescriptor.hpp"
 
 #include <cstdint>
 
 #include "TLSHelper.hpp"
+#include "TLSContext.hpp"
+#include "TLSEngine.hpp"
 
 namespace Bn3Monkey
 {
-    
+    class SharedMemoryChannel;
+
     class ServerActiveSocket : public BaseSocket
     {
     public:
@@ -23,19 +28,58 @@ namespace Bn3Monkey
         virtual void close();
 		virtual SocketResult read(void* buffer, size_t size);
         virtual SocketResult write(const void* buffer, size_t size);
+        // Up to size bytes of fd from offset, as Bn3Monkey::sendFile().
+        // SOCKET_INVALID_ARGUMENT when fd has to be copied through write().
+        virtual SocketResult sendFile(int32_t fd, int64_t offset, size_t size);
 
         inline const char* ip() const { return _client_ip; }
         inline int port() const { return _client_port; }
 
+        // Drives the connection's handshake without blocking. SUCCESS once it
+        // is ready for read()/write(); SOCKET_CONNECTION_NEED_TO_BE_BLOCKED
+        // while it waits for pendingEvent(); anything else means it failed.
+        virtual SocketResult handshake();
+        // The event the last incomplete handshake / read / write waits for.
+        virtual SocketEventType pendingEvent();
+        // Bytes already received and decrypted that the socket will not
+        // signal again through poll().
+        virtual size_t pending();
+
         void setSocketBufferSize(size_t size);
         // Disable Nagle's algorithm on this connection. Call right after accept()
         // for latency-sensitive servers (e.g. broadcast/event delivery) so each
         // write() flushes immediately instead of being coalesced by the kernel.
         void setNoDelay();
+        // Unix domain only, before the handshake: handshake() takes a
+        // shared-memory offer if the client opens with one, and read(),
+        // write() and pending() go through the channel from then on.
+        // pending() never spins there: it runs on the server's event loop.
+        inline void acceptSharedMemory() { _accepts_shared_memory = true; }
+        // The event a write that returned SOCKET_CONNECTION_NEED_TO_BE_BLOCKED
+        // waits for: READ for a full shared-memory ring, whose reader wakes
+        // the writer through the socket.
+        SocketEventType writeEvent();
+        // Unix domain only: read() keeps a descriptor passed with the bytes
+        // (SCM_RIGHTS) for takeDescriptor(). Plain connections only. One is
+        // kept at a time; others that come before it is taken are closed.
+        inline void receiveDescriptors() { _receives_descriptors = true; }
+        // The descriptor read() has kept, now the caller's; -1 if none.
+        int32_t takeDescriptor();
 
     protected:
-        char _client_ip[22]{ 0 };
+        // INET6_ADDRSTRLEN, for IPv6 peers.
+        char _client_ip[46]{ 0 };
+        // In the padding behind _client_ip: SocketContainer holds sockets
+        // of up to 192 bytes.
+        bool _accepts_shared_memory{ false };
+        bool _receives_descriptors{ false };
         int _client_port = 0;
+
+        // Raw pointer: SocketContainer copies sockets with memcpy. Released
+        // by close().
+        SharedMemoryChannel* _channel{ nullptr };
+        // Closed by close() unless taken.
+        int32_t _descriptor{ -1 };
     };
 
     class TLSServerActiveSocket : public ServerActiveSocket
@@ -48,8 +92,49 @@ namespace Bn3Monkey
         virtual void close();
 		virtual SocketResult read(void* buffer, size_t size);
         virtual SocketResult write(const void* buffer, size_t size);
+        // SSL_sendfile() while kernel TLS sends for this connection.
+        SocketResult sendFile(int32_t fd, int64_t offset, size_t size) override;
+
+        SocketResult handshake() override;
+        SocketEventType pendingEvent() override;
+        size_t pending() override;
+
+        // Small records while the connection is fresh; see TLSRecordSizer.
+        inline void enableDynamicRecordSizing() { _record_sizer.enable(true); }
+        // Moves ciphertext through a TLSEngine instead of the descriptor's BIO.
+        // Call before the handshake starts.
+        void enableMemoryBIO();
+        // Reads TLS 1.3 early data of up to max_size bytes. handshake() then
+        // reports SUCCESS as soon as early data has arrived, so the request is
+        // served before the client's Finished; read() and write() complete the
+        // handshake later. Call before the handshake starts.
+        void enableEarlyData(uint32_t max_size);
     private:
+        enum class EarlyDataState : uint8_t
+        {
+            NONE,           // not enabled, or over
+            HANDSHAKING,    // handshake() reads it
+            READING,        // handshake() is done; read() reads the rest
+            DRAINING,       // all of it arrived; read() hands out the buffer
+        };
+
+        // Keeps what handshake() reads for read() to hand out.
+        SocketResult receiveEarlyData();
+        // `is_finished` turns true, with 0 bytes, once no more early data will come.
+        SocketResult readEarlyData(void* buffer, size_t size, bool& is_finished);
+        void releaseEarlyData();
+
         SSL* ssl {nullptr};
+        TLSRecordSizer _record_sizer;
+        TLSEngine _engine;
+
+        // Raw buffer rather than std::vector: SocketContainer copies sockets
+        // with memcpy. Allocated when early data arrives.
+        char* _early_data{ nullptr };
+        uint32_t _early_data_capacity{ 0 };
+        uint32_t _early_data_size{ 0 };
+        uint32_t _early_data_offset{ 0 };
+        EarlyDataState _early_data_state{ EarlyDataState::NONE };
     };
 
     using ServerActiveSocketContainer = SocketContainer<ServerActiveSocket, TLSServerActiveSocket>;
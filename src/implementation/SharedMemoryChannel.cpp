@@ -0,0 +1,472 @@
+#include "SharedMemoryChannel.hpp"
+#include "SocketResult.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#define SECURITYSOCKET_HAS_MEMFD
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#endif
+
+using namespace Bn3Monkey;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The rings need lock-free 64-bit atomics");
+
+// "BN3SHM01"
+static constexpr uint64_t SHARED_MEMORY_MAGIC = 0x313048534d334e42ull;
+static constexpr size_t MIN_RING_SIZE = 4096;
+static constexpr size_t MAX_RING_SIZE = size_t(1) << 30;
+
+// The first message of a client that offers shared memory, with the memfd.
+struct SharedMemoryOffer
+{
+	uint64_t magic{ SHARED_MEMORY_MAGIC };
+	uint64_t size{ 0 };
+};
+static constexpr char OFFER_ACCEPTED = 'Y';
+static constexpr char OFFER_DECLINED = 'N';
+
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+static inline void relaxCPU()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+#endif
+
+SocketResult SharedMemoryChannel::create(size_t ring_size)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	size_t size = MIN_RING_SIZE;
+	while (size < ring_size && size < MAX_RING_SIZE)
+		size <<= 1;
+
+	int fd = ::memfd_create("securitysocket", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0)
+	{
+		return SocketResult(SocketCode::SOCKET_CANNOT_ALLOC);
+	}
+	size_t mapping_size = sizeof(Header) + 2 * size;
+	if (::ftruncate(fd, static_cast<off_t>(mapping_size)) < 0)
+	{
+		::close(fd);
+		return SocketResult(SocketCode::SOCKET_CANNOT_ALLOC);
+	}
+	// The server maps it too; it must never shrink under either of them.
+	::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+	void* mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		::close(fd);
+		return SocketResult(SocketCode::SOCKET_CANNOT_ALLOC);
+	}
+	auto* header = new (mapping) Header();
+	header->magic = SHARED_MEMORY_MAGIC;
+	header->ring_size = size;
+
+	_mapping = mapping;
+	_mapping_size = mapping_size;
+	_fd = fd;
+	if (!map(fd, mapping_size, false))
+	{
+		close();
+		return SocketResult(SocketCode::SOCKET_CANNOT_ALLOC);
+	}
+	return SocketResult(SocketCode::SUCCESS);
+#else
+	(void)ring_size;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+#endif
+}
+
+SocketResult SharedMemoryChannel::offer(int32_t socket, uint32_t timeout_ms)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	SharedMemoryOffer offer;
+	offer.size = _mapping_size;
+
+	iovec piece{ &offer, sizeof(offer) };
+	union
+	{
+		cmsghdr header;
+		char data[CMSG_SPACE(sizeof(int))];
+	} control{};
+	msghdr message{};
+	message.msg_iov = &piece;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data;
+	message.msg_controllen = sizeof(control.data);
+	cmsghdr* rights = CMSG_FIRSTHDR(&message);
+	rights->cmsg_level = SOL_SOCKET;
+	rights->cmsg_type = SCM_RIGHTS;
+	rights->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(rights), &_fd, sizeof(int));
+
+	auto ret = ::sendmsg(socket, &message, MSG_NOSIGNAL);
+	if (ret != static_cast<ssize_t>(sizeof(offer)))
+	{
+		close();
+		return ret < 0 ? createResult(static_cast<int32_t>(ret)) : SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+
+	pollfd handle{};
+	handle.fd = socket;
+	handle.events = POLLIN;
+	ret = ::poll(&handle, 1, static_cast<int>(timeout_ms));
+	if (ret <= 0)
+	{
+		close();
+		return ret == 0 ? SocketResult(SocketCode::SOCKET_TIMEOUT) : createResult(static_cast<int32_t>(ret));
+	}
+
+	char answer{ 0 };
+	ret = ::recv(socket, &answer, 1, MSG_DONTWAIT);
+	if (ret <= 0)
+	{
+		close();
+		return ret == 0 ? SocketResult(SocketCode::SOCKET_CLOSED) : createResult(static_cast<int32_t>(ret));
+	}
+	// The server has its own mapping now.
+	::close(_fd);
+	_fd = -1;
+	if (answer != OFFER_ACCEPTED)
+	{
+		close();
+	}
+	return SocketResult(SocketCode::SUCCESS);
+#else
+	(void)socket;
+	(void)timeout_ms;
+	return SocketResult(SocketCode::SUCCESS);
+#endif
+}
+
+SocketResult SharedMemoryChannel::acceptOffer(int32_t socket)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	SharedMemoryOffer offer;
+	auto ret = ::recv(socket, &offer, sizeof(offer), MSG_PEEK | MSG_DONTWAIT);
+	if (ret == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+	if (ret < 0)
+	{
+		return createResult(static_cast<int32_t>(ret));
+	}
+	SharedMemoryOffer expected;
+	if (memcmp(&offer, &expected.magic, std::min(static_cast<size_t>(ret), sizeof(expected.magic))) != 0)
+	{
+		// An ordinary first request.
+		return SocketResult(SocketCode::SUCCESS);
+	}
+	if (ret < static_cast<ssize_t>(sizeof(offer)))
+	{
+		return SocketResult(SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED, -1);
+	}
+
+	iovec piece{ &offer, sizeof(offer) };
+	union
+	{
+		cmsghdr header;
+		char data[CMSG_SPACE(sizeof(int))];
+	} control{};
+	msghdr message{};
+	message.msg_iov = &piece;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data;
+	message.msg_controllen = sizeof(control.data);
+	ret = ::recvmsg(socket, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+	if (ret != static_cast<ssize_t>(sizeof(offer)))
+	{
+		return ret < 0 ? createResult(static_cast<int32_t>(ret)) : SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+
+	int fd{ -1 };
+	for (cmsghdr* rights = CMSG_FIRSTHDR(&message); rights != nullptr; rights = CMSG_NXTHDR(&message, rights))
+	{
+		if (rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS && rights->cmsg_len >= CMSG_LEN(sizeof(int)))
+			memcpy(&fd, CMSG_DATA(rights), sizeof(int));
+	}
+
+	// Only a sealed memfd of the offered size: the client must not be able to
+	// shrink it under our mapping.
+	bool is_valid = fd >= 0 && (message.msg_flags & MSG_CTRUNC) == 0;
+	if (is_valid)
+	{
+		struct stat status{};
+		int seals = ::fcntl(fd, F_GET_SEALS);
+		is_valid = seals >= 0 && (seals & F_SEAL_SHRINK) != 0 &&
+			::fstat(fd, &status) == 0 && static_cast<uint64_t>(status.st_size) == offer.size &&
+			offer.size > sizeof(Header) && offer.size <= sizeof(Header) + 2 * MAX_RING_SIZE;
+	}
+	if (is_valid)
+	{
+		void* mapping = ::mmap(nullptr, offer.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+			_mapping = mapping;
+			_mapping_size = offer.size;
+			is_valid = map(fd, offer.size, true);
+			if (!is_valid)
+				close();
+		}
+		else
+		{
+			is_valid = false;
+		}
+	}
+	if (fd >= 0)
+		::close(fd);
+
+	char answer = is_valid ? OFFER_ACCEPTED : OFFER_DECLINED;
+	ret = ::send(socket, &answer, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (ret != 1)
+	{
+		close();
+		return ret < 0 ? createResult(static_cast<int32_t>(ret)) : SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+	return SocketResult(SocketCode::SUCCESS);
+#else
+	(void)socket;
+	return SocketResult(SocketCode::SUCCESS);
+#endif
+}
+
+bool SharedMemoryChannel::map(int32_t fd, size_t size, bool is_server)
+{
+	(void)fd;
+	auto* header = static_cast<Header*>(_mapping);
+	size_t ring_size = static_cast<size_t>(header->ring_size);
+	if (header->magic != SHARED_MEMORY_MAGIC || ring_size < MIN_RING_SIZE || ring_size > MAX_RING_SIZE ||
+		(ring_size & (ring_size - 1)) != 0 || sizeof(Header) + 2 * ring_size != size)
+	{
+		return false;
+	}
+
+	_ring_size = ring_size;
+	char* data = static_cast<char*>(_mapping) + sizeof(Header);
+	_rx = &header->rings[is_server ? 0 : 1];
+	_tx = &header->rings[is_server ? 1 : 0];
+	_rx_data = data + (is_server ? 0 : ring_size);
+	_tx_data = data + (is_server ? ring_size : 0);
+	_rx_tail = _rx->tail.load(std::memory_order_acquire);
+	_tx_head = _tx->head.load(std::memory_order_acquire);
+	return true;
+}
+
+void SharedMemoryChannel::close()
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	if (_mapping)
+		::munmap(_mapping, _mapping_size);
+	if (_fd >= 0)
+		::close(_fd);
+#endif
+	_mapping = nullptr;
+	_mapping_size = 0;
+	_fd = -1;
+	_rx = _tx = nullptr;
+	_rx_data = _tx_data = nullptr;
+}
+
+void SharedMemoryChannel::setBusyPoll(uint32_t busy_poll_us)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	static const bool is_single_cpu = []() {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		return sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) <= 1;
+	}();
+	_busy_poll_us = is_single_cpu ? 0 : busy_poll_us;
+#else
+	_busy_poll_us = busy_poll_us;
+#endif
+}
+
+size_t SharedMemoryChannel::readable() const
+{
+	uint64_t size = _rx->head.load(std::memory_order_acquire) - _rx_tail;
+	// More than the ring holds: the peer has scribbled over its position.
+	return size <= _ring_size ? static_cast<size_t>(size) : 0;
+}
+
+size_t SharedMemoryChannel::arm()
+{
+	_rx->is_reader_waiting.store(1, std::memory_order_seq_cst);
+	// Pairs with the writer's store of head before it looks at the flag.
+	size_t size = static_cast<size_t>(_rx->head.load(std::memory_order_seq_cst) - _rx_tail);
+	if (size > 0)
+		_rx->is_reader_waiting.store(0, std::memory_order_relaxed);
+	return size <= _ring_size ? size : 0;
+}
+
+uint64_t SharedMemoryChannel::armWriter()
+{
+	_tx->is_writer_waiting.store(1, std::memory_order_seq_cst);
+	// Pairs with the reader's store of tail before it looks at the flag.
+	uint64_t used = _tx_head - _tx->tail.load(std::memory_order_seq_cst);
+	if (used != _ring_size)
+		_tx->is_writer_waiting.store(0, std::memory_order_relaxed);
+	return used;
+}
+
+void SharedMemoryChannel::wakeup(int32_t socket)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	// A full socket buffer already holds a wakeup.
+	char wakeup{ 1 };
+	::send(socket, &wakeup, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+	(void)socket;
+#endif
+}
+
+bool SharedMemoryChannel::drain(int32_t socket)
+{
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	char wakeups[64];
+	while (true)
+	{
+		auto ret = ::recv(socket, wakeups, sizeof(wakeups), MSG_DONTWAIT);
+		if (ret == 0)
+			return false;
+		if (ret < 0)
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+	}
+#else
+	(void)socket;
+	return true;
+#endif
+}
+
+size_t SharedMemoryChannel::pending(int32_t socket)
+{
+	size_t size = readable();
+	if (size > 0)
+		return size;
+
+#if defined(SECURITYSOCKET_HAS_MEMFD)
+	// While we spin, the writer sees no request for a wakeup and sends none.
+	if (_busy_poll_us > 0)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(_busy_poll_us);
+		do
+		{
+			for (int i = 0; i < 64; i++)
+			{
+				size = readable();
+				if (size > 0)
+					return size;
+				relaxCPU();
+			}
+		} while (std::chrono::steady_clock::now() < deadline);
+	}
+#endif
+
+	// A closed peer is left for poll() and read() to report.
+	if (!drain(socket))
+		return 0;
+	return arm();
+}
+
+SocketResult SharedMemoryChannel::read(int32_t socket, void* buffer, size_t size)
+{
+	uint64_t available = _rx->head.load(std::memory_order_acquire) - _rx_tail;
+	if (available > _ring_size)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+	if (available == 0)
+	{
+		if (!drain(socket))
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+		}
+		available = arm();
+		if (available == 0)
+		{
+			return SocketResult(SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED, -1);
+		}
+	}
+	if (size == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+
+	size = std::min(size, static_cast<size_t>(available));
+	size_t offset = static_cast<size_t>(_rx_tail & (_ring_size - 1));
+	size_t first = std::min(size, _ring_size - offset);
+	memcpy(buffer, _rx_data + offset, first);
+	memcpy(static_cast<char*>(buffer) + first, _rx_data, size - first);
+	_rx_tail += size;
+	_rx->tail.store(_rx_tail, std::memory_order_seq_cst);
+
+	// Pairs with armWriter(), as write() does with arm().
+	if (_rx->is_writer_waiting.load(std::memory_order_seq_cst) != 0 &&
+		_rx->is_writer_waiting.exchange(0, std::memory_order_seq_cst) != 0)
+	{
+		wakeup(socket);
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+}
+
+SocketResult SharedMemoryChannel::write(int32_t socket, const void* buffer, size_t size)
+{
+	uint64_t used = _tx_head - _tx->tail.load(std::memory_order_acquire);
+	if (used == _ring_size)
+	{
+		// Wakeups already sent are spent; only the next one may end the wait.
+		if (!drain(socket))
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+		}
+		used = armWriter();
+	}
+	if (used > _ring_size)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	}
+	size_t space = _ring_size - static_cast<size_t>(used);
+	_is_write_blocked = space == 0;
+	if (space == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED, -1);
+	}
+	if (size == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+
+	size = std::min(size, space);
+	size_t offset = static_cast<size_t>(_tx_head & (_ring_size - 1));
+	size_t first = std::min(size, _ring_size - offset);
+	memcpy(_tx_data + offset, buffer, first);
+	memcpy(_tx_data, static_cast<const char*>(buffer) + first, size - first);
+	_tx_head += size;
+	_tx->head.store(_tx_head, std::memory_order_seq_cst);
+
+	// Pairs with arm(): either the reader sees the new head, or we see its flag.
+	if (_tx->is_reader_waiting.load(std::memory_order_seq_cst) != 0 &&
+		_tx->is_reader_waiting.exchange(0, std::memory_order_seq_cst) != 0)
+	{
+		wakeup(socket);
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+}
@@ -0,0 +1,103 @@
+#if !defined(__BN3MONKEY__SHAREDMEMORYCHANNEL__)
+#define __BN3MONKEY__SHAREDMEMORYCHANNEL__
+
+#include "../SecuritySocket.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Bn3Monkey
+{
+	// The stream of one unix domain connection, moved through shared memory:
+	// two single-producer / single-consumer byte rings in a memfd, one for each
+	// direction. The socket is left to carry wakeups, one byte each, sent only
+	// to a reader that has said it is going to sleep on an empty ring, or to a
+	// writer on a full one. Both ends wait for POLLIN: the socket itself is
+	// always writable.
+	//
+	// The client create()s the memfd and offer()s it over the socket
+	// (SCM_RIGHTS); the server's acceptOffer() maps it. Linux only; elsewhere
+	// nothing is offered and the connection stays on the socket.
+	class SharedMemoryChannel
+	{
+	public:
+		SharedMemoryChannel() {}
+		~SharedMemoryChannel() { close(); }
+
+		// Client. Rings of ring_size bytes, rounded up to a power of two.
+		SocketResult create(size_t ring_size);
+		// Client, after create(). Sends the memfd and waits up to timeout_ms
+		// for the answer. SUCCESS with isOpen() false if the server declined.
+		SocketResult offer(int32_t socket, uint32_t timeout_ms);
+		// Server, before anything else is read. SUCCESS with isOpen() false if
+		// the client sent something else first, which stays unread.
+		SocketResult acceptOffer(int32_t socket);
+		void close();
+
+		inline bool isOpen() const { return _mapping != nullptr; }
+		// How long pending() spins on an empty ring before it asks for a wakeup.
+		// Not at all on a single CPU, where the spin only holds the writer back.
+		// Clients only: a server's pending() runs on its event loop, which the
+		// spin would hold up for every other connection.
+		void setBusyPoll(uint32_t busy_poll_us);
+
+		// As recv() / send() on a non-blocking socket: an empty or full ring is
+		// SOCKET_CONNECTION_NEED_TO_BE_BLOCKED with -1 bytes.
+		SocketResult read(int32_t socket, void* buffer, size_t size);
+		SocketResult write(int32_t socket, const void* buffer, size_t size);
+		// Bytes read() can take without waiting. 0 only once the writer has been
+		// asked for a wakeup, so poll() on the socket reports what comes next.
+		size_t pending(int32_t socket);
+		// Bytes read() can take, without spinning or asking for a wakeup.
+		size_t readable() const;
+		// The last write() found the ring full and asked for a wakeup, which
+		// comes as POLLIN on the socket.
+		inline bool isWriteBlocked() const { return _is_write_blocked; }
+
+	private:
+		struct alignas(64) Ring
+		{
+			// Free-running positions; head - tail bytes are readable.
+			alignas(64) std::atomic<uint64_t> head{ 0 };
+			alignas(64) std::atomic<uint64_t> tail{ 0 };
+			// Set by the reader before it sleeps on the socket, cleared by the
+			// writer that wakes it.
+			alignas(64) std::atomic<uint32_t> is_reader_waiting{ 0 };
+			// The same for a writer that found the ring full.
+			alignas(64) std::atomic<uint32_t> is_writer_waiting{ 0 };
+		};
+		struct Header
+		{
+			uint64_t magic{ 0 };
+			uint64_t ring_size{ 0 };
+			// [0] client to server, [1] server to client.
+			Ring rings[2];
+		};
+
+		bool map(int32_t fd, size_t size, bool is_server);
+		// Takes the wakeups already sent. false once the peer has closed.
+		bool drain(int32_t socket);
+		// Asks the writer for a wakeup, then looks again.
+		size_t arm();
+		// Asks the reader for a wakeup, then looks again. Bytes in the ring.
+		uint64_t armWriter();
+		void wakeup(int32_t socket);
+
+		void* _mapping{ nullptr };
+		size_t _mapping_size{ 0 };
+		size_t _ring_size{ 0 };
+		int32_t _fd{ -1 };
+		uint32_t _busy_poll_us{ 0 };
+
+		Ring* _rx{ nullptr };
+		Ring* _tx{ nullptr };
+		char* _rx_data{ nullptr };
+		char* _tx_data{ nullptr };
+		// Our own ends, kept here rather than trusted back from the mapping.
+		uint64_t _rx_tail{ 0 };
+		uint64_t _tx_head{ 0 };
+		bool _is_write_blocked{ false };
+	};
+}
+
+#endif // __BN3MONKEY__SHAREDMEMORYCHANNEL__
@@ -15,7 +15,7 @@ SocketResult SocketBroadcastServerImpl::open(SocketBroadcastHandler* handler, si
 
 	SocketResult result = SocketResult(SocketCode::SUCCESS);
 
-	_container = PassiveSocketContainer(_tls_configuration.valid(), _configuration.is_unix_domain());
+	_container = PassiveSocketContainer(_tls_configuration.valid(), _configuration.is_unix_domain(), _tls_configuration);
 	_socket = _container.get();
 	result = _socket->valid();
 	if (result.code() != SocketCode::SUCCESS)
@@ -42,10 +42,16 @@ SocketResult SocketBroadcastServerImpl::open(SocketBroadcastHandler* handler, si
 
 	_handler = handler;
 
-	// Listener is now a member so dropAll() can call removeEvent on it from
-	// the broadcast caller's thread. Register the accept fd here, before the
-	// monitor thread starts polling.
-	_listener.open();
+	// Listener is a member so other threads can wake the monitor and post()
+	// to it. Register the accept fd here, before the monitor thread starts
+	// polling.
+	result = _listener.open(_configuration.event_backend());
+	if (result.code() != SocketCode::SUCCESS)
+		return result;
+
+	if (_tls_configuration.valid())
+		_handshake_pool.open(_tls_configuration.handshakeThreads(), &_listener);
+
 	_server_context = SocketEventContext{};
 	_server_context.fd = _socket->descriptor();
 	_listener.addEvent(&_server_context, SocketEventType::ACCEPT);
@@ -66,21 +72,30 @@ void Bn3Monkey::SocketBroadcastServerImpl::monitorClient()
 	// entirely in this loop.
 	//
 	// The listener and the accept-context are members (initialized in open())
-	// rather than locals, so dropAll() can call _listener.removeEvent() from
-	// the broadcast caller's thread.
+	// rather than locals, so other threads can wake the monitor and post()
+	// work to it. Only the monitor changes the listener's registrations.
 
 	while (_is_monitoring)
 	{
-		// Release the strong refs held by dropAll() from the previous round.
-		// Safe here: the previous wait+dispatch cycle (which may have held
-		// stale context pointers in its local snapshot) is fully done by the
-		// time control reaches the top of the loop.
+		// Between two waits: no event list holds a context pointer here.
+		_listener.runPostedTasks();
+
+		// Release the strong refs held by dropped clients from the previous
+		// round. Safe here: the previous wait+dispatch cycle (which may have
+		// held stale context pointers in its local snapshot) is fully done by
+		// the time control reaches the top of the loop.
 		{
 			std::lock_guard<std::mutex> lk(_clients_mtx);
 			_pending_destruction.clear();
 		}
 
+		// Finished pool handshakes, post(), dropAll() and close() wake the wait.
+		SOCKET_TRACE_BEGIN(wait_begin);
 		auto eventlist = _listener.wait(_configuration.read_timeout());
+		SOCKET_TRACE_COMPLETE(WAIT, this, wait_begin, eventlist.contexts.size());
+		_metrics.add(SocketCounter::EVENT_LOOP_WAKEUPS, 1);
+		adoptHandshakes();
+		expireHandshakes();
 		if (eventlist.result.code() == SocketCode::SOCKET_TIMEOUT)
 			continue;
 		if (eventlist.result.code() != SocketCode::SUCCESS)
@@ -95,7 +110,13 @@ void Bn3Monkey::SocketBroadcastServerImpl::monitorClient()
 				auto socket_container = _socket->accept();
 				auto* client_socket = socket_container.get();
 				if (client_socket->result().code() != SocketCode::SUCCESS)
+				{
+					if (client_socket->descriptor() >= 0)
+						client_socket->close();
 					break;
+				}
+				_metrics.add(SocketCounter::ACCEPTED_CONNECTIONS, 1);
+				SOCKET_TRACE_INSTANT(ACCEPT, this, client_socket->descriptor());
 
 				// Broadcast latency > coalescing throughput: disable Nagle so
 				// each write() reaches the wire immediately.
@@ -104,59 +125,42 @@ void Bn3Monkey::SocketBroadcastServerImpl::monitorClient()
 				auto client = std::make_shared<BroadcastClient>();
 				client->container = socket_container;
 				client->fd = client_socket->descriptor();
-				_listener.addEvent(client.get(), SocketEventType::READ);
-
-				char ip_buf[22];
-				int port = client_socket->port();
-				std::snprintf(ip_buf, sizeof(ip_buf), "%s", client_socket->ip());
-
+				client->handshake_deadline = std::chrono::steady_clock::now() +
+					std::chrono::milliseconds(static_cast<uint64_t>(_configuration.read_timeout()) * _configuration.max_retries());
+				if (_handshake_pool.isRunning())
 				{
-					std::lock_guard<std::mutex> lk(_clients_mtx);
-					_active_clients.push_back(std::move(client));
+					client->is_handshaking = true;
+					client->is_offloaded = true;
+					_handshaking_clients.push_back(client);
+					_handshake_pool.submit(client.get(), client_socket, client->handshake_deadline);
+					break;
 				}
-				_clients_cv.notify_all();
-
-				if (_handler)
-					_handler->onClientConnected(ip_buf, port);
+				handshakeClient(client);
 			}
 			break;
 
 			case SocketEventType::DISCONNECTED:
 			{
-				auto* client = static_cast<BroadcastClient*>(context);
-				_listener.removeEvent(client);
-
-				char ip_buf[22];
-				int port = 0;
-				if (auto* sock = client->container.get()) {
-					std::snprintf(ip_buf, sizeof(ip_buf), "%s", sock->ip());
-					port = sock->port();
-				}
+				disconnectClient(static_cast<BroadcastClient*>(context));
+			}
+			break;
 
-				std::shared_ptr<BroadcastClient> erased;
+			case SocketEventType::READ:
+			case SocketEventType::WRITE:
+			{
+				auto* client = static_cast<BroadcastClient*>(context);
+				if (client->is_handshaking)
 				{
-					std::lock_guard<std::mutex> lk(_clients_mtx);
-					auto it = std::find_if(
-						_active_clients.begin(), _active_clients.end(),
-						[client](const std::shared_ptr<BroadcastClient>& sp) {
-							return sp.get() == client;
-						});
-					if (it != _active_clients.end())
-					{
-						erased = *it;
-						_active_clients.erase(it);
-					}
+					auto iter = std::find_if(_handshaking_clients.begin(), _handshaking_clients.end(),
+						[client](const std::shared_ptr<BroadcastClient>& sp) { return sp.get() == client; });
+					if (iter != _handshaking_clients.end())
+						handshakeClient(*iter);
 				}
-				// Only fire close + handler if we actually owned this client.
-				// If dropAll() already drained it, we get a stale DISCONNECTED
-				// for a context now sitting in _pending_destruction — handler
-				// already ran inside dropAll, so skip here to avoid double-fire.
-				if (erased) {
-					if (auto* sock = erased->container.get()) sock->close();
-					if (_handler)
-						_handler->onClientDisconnected(ip_buf, port);
+				else if (!drainClient(client))
+				{
+					// Linux reports a peer's FIN as POLLIN, not POLLHUP.
+					disconnectClient(client);
 				}
-				_clients_cv.notify_all();
 			}
 			break;
 
@@ -167,27 +171,232 @@ void Bn3Monkey::SocketBroadcastServerImpl::monitorClient()
 	}
 }
 
+void SocketBroadcastServerImpl::handshakeClient(std::shared_ptr<BroadcastClient> client)
+{
+	auto* sock = client->container.get();
+	auto result = sock->handshake();
+
+	if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+	{
+		if (!client->is_handshaking)
+		{
+			client->is_handshaking = true;
+			_handshaking_clients.push_back(client);
+			_listener.addEvent(client.get(), sock->pendingEvent());
+		}
+		else
+		{
+			_listener.modifyEvent(client.get(), sock->pendingEvent());
+		}
+		return;
+	}
+
+	bool was_handshaking = client->is_handshaking;
+	if (was_handshaking)
+	{
+		client->is_handshaking = false;
+		_handshaking_clients.erase(std::remove(_handshaking_clients.begin(), _handshaking_clients.end(), client), _handshaking_clients.end());
+		_listener.removeEvent(client.get());
+	}
+
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		// Failed handshakes are never reported to the handler.
+		sock->close();
+		_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
+		if (was_handshaking)
+		{
+			std::lock_guard<std::mutex> lk(_clients_mtx);
+			_pending_destruction.push_back(client);
+		}
+		return;
+	}
+
+	activateClient(client);
+}
+
+void SocketBroadcastServerImpl::activateClient(const std::shared_ptr<BroadcastClient>& client)
+{
+	auto* client_socket = client->container.get();
+	_listener.addEvent(client.get(), SocketEventType::READ);
+
+	char ip_buf[22];
+	int port = client_socket->port();
+	std::snprintf(ip_buf, sizeof(ip_buf), "%s", client_socket->ip());
+
+	{
+		std::lock_guard<std::mutex> lk(_clients_mtx);
+		_active_clients.push_back(client);
+	}
+	_clients_cv.notify_all();
+
+	if (_handler)
+		_handler->onClientConnected(ip_buf, port);
+}
+
+void SocketBroadcastServerImpl::disconnectClient(BroadcastClient* client)
+{
+	_listener.removeEvent(client);
+
+	if (client->is_handshaking)
+	{
+		auto iter = std::find_if(_handshaking_clients.begin(), _handshaking_clients.end(),
+			[client](const std::shared_ptr<BroadcastClient>& sp) { return sp.get() == client; });
+		if (iter != _handshaking_clients.end())
+		{
+			client->is_handshaking = false;
+			if (auto* sock = client->container.get()) sock->close();
+			_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
+			std::lock_guard<std::mutex> lk(_clients_mtx);
+			_pending_destruction.push_back(*iter);
+			_handshaking_clients.erase(iter);
+		}
+		return;
+	}
+
+	char ip_buf[22];
+	int port = 0;
+	if (auto* sock = client->container.get()) {
+		std::snprintf(ip_buf, sizeof(ip_buf), "%s", sock->ip());
+		port = sock->port();
+	}
+
+	std::shared_ptr<BroadcastClient> erased;
+	{
+		std::lock_guard<std::mutex> lk(_clients_mtx);
+		auto it = std::find_if(
+			_active_clients.begin(), _active_clients.end(),
+			[client](const std::shared_ptr<BroadcastClient>& sp) {
+				return sp.get() == client;
+			});
+		if (it != _active_clients.end())
+		{
+			erased = *it;
+			_active_clients.erase(it);
+		}
+	}
+	// Only fire close + handler if we actually owned this client.
+	// If dropAll() already drained it, we get a stale DISCONNECTED
+	// for a context now sitting in _pending_destruction — handler
+	// already ran inside dropAll, so skip here to avoid double-fire.
+	if (erased) {
+		if (auto* sock = erased->container.get()) {
+			std::lock_guard<std::mutex> lk(erased->mtx);
+			sock->close();
+		}
+		_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
+		if (_handler)
+			_handler->onClientDisconnected(ip_buf, port);
+	}
+	_clients_cv.notify_all();
+}
+
+void SocketBroadcastServerImpl::expireHandshakes()
+{
+	auto now = std::chrono::steady_clock::now();
+	std::vector<BroadcastClient*> expired;
+	for (auto& client : _handshaking_clients)
+	{
+		// The pool enforces the deadline of the handshakes it runs.
+		if (!client->is_offloaded && now >= client->handshake_deadline)
+			expired.push_back(client.get());
+	}
+	for (auto* client : expired)
+		disconnectClient(client);
+}
+
+void SocketBroadcastServerImpl::adoptHandshakes()
+{
+	if (!_handshake_pool.isRunning())
+		return;
+
+	std::vector<TLSHandshakePool::Finished> finished;
+	_handshake_pool.collect(finished);
+	for (auto& entry : finished)
+	{
+		auto* client = static_cast<BroadcastClient*>(entry.context);
+		auto iter = std::find_if(_handshaking_clients.begin(), _handshaking_clients.end(),
+			[client](const std::shared_ptr<BroadcastClient>& sp) { return sp.get() == client; });
+		if (iter == _handshaking_clients.end())
+			continue;
+
+		client->is_offloaded = false;
+		if (entry.is_established)
+			handshakeClient(*iter); // Already complete: activates the client.
+		else
+			disconnectClient(client);
+	}
+}
+
+bool SocketBroadcastServerImpl::drainClient(BroadcastClient* client)
+{
+	char buffer[256];
+	std::lock_guard<std::mutex> lk(client->mtx);
+	auto* sock = client->container.get();
+	if (!sock || sock->descriptor() < 0)
+		return true;
+
+	auto result = sock->read(buffer, sizeof(buffer));
+	switch (result.code())
+	{
+	case SocketCode::SUCCESS:
+		if (result.bytes() > 0)
+			_metrics.add(SocketCounter::BYTES_RECEIVED, static_cast<uint64_t>(result.bytes()));
+		return true;
+	case SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED:
+	case SocketCode::SOCKET_CONNECTION_INTERRUPTED:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void SocketBroadcastServerImpl::dropAll()
 {
-	// Atomically detach every active client from both the listener and the
-	// active list. The listener.removeEvent calls happen under _clients_mtx
-	// so no concurrent monitor dispatch can re-find these contexts in the
-	// active list mid-mutation.
+	// Only the monitor changes the listener, so the drop runs there; from any
+	// other thread it is posted and waited for.
+	if (!_is_monitoring || std::this_thread::get_id() == _monitor_client.get_id())
+	{
+		dropClients();
+		return;
+	}
+
+	auto is_dropped = std::make_shared<bool>(false);
+	auto result = _listener.post([this, is_dropped]() {
+		dropClients();
+		{
+			std::lock_guard<std::mutex> lk(_clients_mtx);
+			*is_dropped = true;
+		}
+		_clients_cv.notify_all();
+	});
+	if (result.code() != SocketCode::SUCCESS)
+		return;
+
+	// close() drops the task if the monitor stops first, and closes the
+	// clients itself.
+	std::unique_lock<std::mutex> lk(_clients_mtx);
+	_clients_cv.wait(lk, [&] { return *is_dropped || !_is_monitoring; });
+}
+
+void SocketBroadcastServerImpl::dropClients()
+{
+	// Atomically detach every active client from the active list, then from
+	// the listener. Called from a handler callback, the monitor may still
+	// hold them in the current event list.
 	std::vector<std::shared_ptr<BroadcastClient>> dropped;
 	{
 		std::lock_guard<std::mutex> lk(_clients_mtx);
 		dropped.swap(_active_clients);
-		for (auto& client : dropped) {
-			_listener.removeEvent(client.get());
-		}
 		// Hand off the strong refs to _pending_destruction. The monitor
 		// clears that list at the top of its next iteration — by which time
-		// any in-flight wait+dispatch cycle holding stale snapshot pointers
-		// is finished. Releasing the refs synchronously here would race that
-		// dispatch and risk dereferencing freed BroadcastClients.
+		// any in-flight dispatch holding stale snapshot pointers is finished.
 		_pending_destruction.insert(_pending_destruction.end(),
 			dropped.begin(), dropped.end());
 	}
+	for (auto& client : dropped) {
+		_listener.removeEvent(client.get());
+	}
 
 	// Wake any await/awaitClose waiter — active list is now empty.
 	_clients_cv.notify_all();
@@ -200,13 +409,24 @@ void SocketBroadcastServerImpl::dropAll()
 		if (auto* sock = client->container.get()) {
 			std::snprintf(ip_buf, sizeof(ip_buf), "%s", sock->ip());
 			port = sock->port();
+			std::lock_guard<std::mutex> client_lock(client->mtx);
 			sock->close();
 		}
+		_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
 		if (_handler)
 			_handler->onClientDisconnected(ip_buf, port);
 	}
 }
 
+SocketResult SocketBroadcastServerImpl::post(std::function<void()> task)
+{
+	if (!task)
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	if (!_is_monitoring)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	return _listener.post(std::move(task));
+}
+
 SocketResult SocketBroadcastServerImpl::write(const void* buffer, size_t size)
 {
 	// Snapshot the active list under lock, then stream bytes lock-free.
@@ -222,12 +442,15 @@ SocketResult SocketBroadcastServerImpl::write(const void* buffer, size_t size)
 	if (snapshot.empty())
 		return SocketResult(SocketCode::SUCCESS, 0);
 
+	auto start = std::chrono::steady_clock::now();
+	SOCKET_TRACE_BEGIN(write_begin);
 	SocketResult result{ SocketCode::SUCCESS };
 
 	for (auto& client : snapshot)
 	{
 		auto* sock = client->container.get();
 		if (!sock) continue;
+		SOCKET_TRACE_BEGIN(send_begin);
 
 		SocketResult per_client_result{ SocketCode::SUCCESS };
 		SocketEventListener listener;
@@ -258,13 +481,21 @@ SocketResult SocketBroadcastServerImpl::write(const void* buffer, size_t size)
 				break;
 			}
 
-			inner_result = sock->write(static_cast<const char*>(buffer) + written_size,
-				size - written_size);
+			{
+				std::lock_guard<std::mutex> client_lock(client->mtx);
+				inner_result = sock->write(static_cast<const char*>(buffer) + written_size,
+					size - written_size);
+			}
 			if (inner_result.code() == SocketCode::SOCKET_TIMEOUT)
 			{
 				i++;
 				continue;
 			}
+			if (inner_result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				// TLS: the same write is retried once the socket drains.
+				continue;
+			}
 			if (inner_result.code() == SocketCode::SOCKET_CLOSED)
 			{
 				per_client_result = SocketResult(SocketCode::SOCKET_CLOSED,
@@ -279,6 +510,7 @@ SocketResult SocketBroadcastServerImpl::write(const void* buffer, size_t size)
 			}
 
 			written_size += static_cast<size_t>(inner_result.bytes());
+			_metrics.add(SocketCounter::BYTES_SENT, static_cast<uint64_t>(inner_result.bytes()));
 			if (written_size >= size)
 			{
 				per_client_result = SocketResult(SocketCode::SUCCESS,
@@ -287,9 +519,12 @@ SocketResult SocketBroadcastServerImpl::write(const void* buffer, size_t size)
 			}
 		}
 
+		SOCKET_TRACE_COMPLETE(BROADCAST_SEND, client.get(), send_begin, written_size);
 		result = per_client_result;
 	}
 
+	SOCKET_TRACE_COMPLETE(BROADCAST_WRITE, this, write_begin, snapshot.size());
+	_metrics.record(SocketLatency::BROADCAST_FANOUT_TIME, std::chrono::steady_clock::now() - start);
 	return result;
 }
 
@@ -310,23 +545,48 @@ SocketResult SocketBroadcastServerImpl::await(uint64_t timeout_ms)
 	std::lock_guard<std::mutex> lk(_clients_mtx);
 	if (!_is_monitoring)
 		return SocketResult(SocketCode::SOCKET_CLOSED);
+	// The clients awaitClose() will wait for.
+	markRound();
 	return SocketResult(SocketCode::SUCCESS,
 		static_cast<int32_t>(_active_clients.size()));
 }
 
+void SocketBroadcastServerImpl::markRound()
+{
+	_round++;
+	_is_round_open = true;
+	for (auto& client : _active_clients)
+		client->round = _round;
+}
+
 SocketResult SocketBroadcastServerImpl::awaitClose(uint64_t timeout_ms)
 {
 	std::unique_lock<std::mutex> lk(_clients_mtx);
+	// Only the clients active when await() returned count. A peer that is
+	// dropped and reconnects before we get here must not keep the barrier
+	// shut with its new connection.
+	if (!_is_round_open)
+		markRound();
+	auto remaining = [&]() {
+		size_t count = 0;
+		for (auto& client : _active_clients)
+		{
+			if (client->round == _round)
+				count++;
+		}
+		return count;
+	};
 	_clients_cv.wait_for(lk,
 		std::chrono::milliseconds(timeout_ms),
-		[this] { return _active_clients.empty() || !_is_monitoring; });
+		[&] { return remaining() == 0 || !_is_monitoring; });
 
 	if (!_is_monitoring)
 		return SocketResult(SocketCode::SOCKET_CLOSED);
-	if (!_active_clients.empty())
+	if (size_t count = remaining())
 		return SocketResult(SocketCode::SOCKET_TIMEOUT,
-			static_cast<int32_t>(_active_clients.size()));
+			static_cast<int32_t>(count));
 
+	_is_round_open = false;
 	return SocketResult(SocketCode::SUCCESS, 0);
 }
 
@@ -334,6 +594,7 @@ void SocketBroadcastServerImpl::close()
 {
 	if (_is_monitoring) {
 		_is_monitoring = false;
+		_listener.wakeup();
 		// Wake any await/awaitClose waiters so they return SOCKET_CLOSED
 		// instead of waiting out their timeout.
 		_clients_cv.notify_all();
@@ -341,6 +602,11 @@ void SocketBroadcastServerImpl::close()
 			_monitor_client.join();
 	}
 
+	// Stop the handshake threads before closing the sockets they work on.
+	_handshake_pool.close();
+	std::vector<TLSHandshakePool::Finished> abandoned;
+	_handshake_pool.collect(abandoned);
+
 	// Monitor has joined — no more producers. Close any remaining client
 	// fds the test/caller didn't drain via awaitClose / dropAll first, and
 	// release the deferred-destruction list now that the monitor can no
@@ -350,9 +616,17 @@ void SocketBroadcastServerImpl::close()
 		for (auto& client : _active_clients) {
 			if (auto* sock = client->container.get()) sock->close();
 		}
+		_metrics.add(SocketCounter::CLOSED_CONNECTIONS, _active_clients.size() + _handshaking_clients.size());
 		_active_clients.clear();
+		for (auto& client : _handshaking_clients) {
+			if (auto* sock = client->container.get()) sock->close();
+		}
+		_handshaking_clients.clear();
 		_pending_destruction.clear();
 	}
+	// The first notify may have come before a dropAll() began waiting; the
+	// lock above orders this one after it.
+	_clients_cv.notify_all();
 
 	_listener.close();
 
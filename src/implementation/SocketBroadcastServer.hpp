@@ -8,13 +8,18 @@
 #include "ServerActiveSocket.hpp"
 #include "SocketEvent.hpp"
 #include "SocketConnection.hpp"
+#include "TLSHandshakePool.hpp"
 #include "ObjectPool.hpp"
+#include "SocketMetrics.hpp"
+#include "SocketTrace.hpp"
 
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <functional>
 #include <condition_variable>
 
 namespace Bn3Monkey
@@ -25,6 +30,18 @@ namespace Bn3Monkey
     struct BroadcastClient : public SocketEventContext
     {
         ServerActiveSocketContainer container;
+        // Serializes the monitor's reads with broadcast writes. A TLS session
+        // must not be used from two threads at once.
+        std::mutex mtx;
+        // Still in the TLS handshake: not in _active_clients yet.
+        bool is_handshaking{ false };
+        // The handshake runs in _handshake_pool, which owns the socket until
+        // the monitor collects it.
+        bool is_offloaded{ false };
+        std::chrono::steady_clock::time_point handshake_deadline;
+        // The barrier round it belongs to, under _clients_mtx: awaitClose()
+        // waits only for clients of the current one.
+        uint64_t round{ 0 };
     };
 
     class SocketBroadcastServerImpl
@@ -39,6 +56,9 @@ namespace Bn3Monkey
 		SocketResult open(SocketBroadcastHandler* handler, size_t num_of_clients);
         SocketResult write(const void* buffer, size_t size);
 
+        inline void snapshot(SocketServerMetrics& metrics) const { _metrics.snapshot(metrics); }
+        inline SocketEventBackend eventBackend() const { return _listener.backend(); }
+
         SocketResult await(uint64_t timeout_ms);
         SocketResult awaitClose(uint64_t timeout_ms);
 
@@ -48,7 +68,9 @@ namespace Bn3Monkey
         // without sending FIN (e.g., reconnecting via a fresh socket without
         // closing the old one) — the kernel never reports POLLHUP for those,
         // so the accept-monitor has no signal to detect the staleness.
+        // Runs on the monitor thread; other callers wait for it.
         void dropAll();
+        SocketResult post(std::function<void()> task);
 
         void close();
 
@@ -61,17 +83,34 @@ namespace Bn3Monkey
 
         SocketBroadcastHandler* _handler{ nullptr };
 
+        // Kept across open() / close() for the life of the server.
+        SocketMetrics _metrics;
+
         std::thread _monitor_client;
         std::atomic_bool _is_monitoring{ false };
         void monitorClient();
+        // Monitor-thread helpers.
+        // By value: it may erase the caller's element of _handshaking_clients.
+        void handshakeClient(std::shared_ptr<BroadcastClient> client);
+        void activateClient(const std::shared_ptr<BroadcastClient>& client);
+        void disconnectClient(BroadcastClient* client);
+        void dropClients();
+        // Under _clients_mtx: starts a barrier round with the active clients.
+        void markRound();
+        void expireHandshakes();
+        void adoptHandshakes();
+        // Clients may send nothing meaningful; reading just notices their FIN.
+        bool drainClient(BroadcastClient* client);
 
         // Listener and accept-context are members (rather than locals inside
-        // monitorClient) so dropAll() running on the broadcast caller's thread
-        // can call _listener.removeEvent() to take clients out of the polling
-        // set without going through the monitor.
+        // monitorClient) so close(), dropAll() and post() on other threads can
+        // wake the monitor and hand it work.
         SocketMultiEventListener _listener;
         SocketEventContext _server_context;
 
+        // Only running when SocketTLSServerConfiguration::handshakeThreads() > 0.
+        TLSHandshakePool _handshake_pool;
+
         // Single mutex protecting _active_clients and _pending_destruction.
         // The accept-monitor mutates _active_clients on ACCEPT/DISCONNECTED
         // events; broadcast callers snapshot it on write() and observe its
@@ -88,16 +127,24 @@ namespace Bn3Monkey
         std::mutex _clients_mtx;
         std::condition_variable _clients_cv;
         std::vector<std::shared_ptr<BroadcastClient>> _active_clients;
-
-        // Holds dropAll()'d clients until the accept-monitor's *next* loop
-        // iteration. Reason: when dropAll runs, the monitor's currently
-        // in-flight _listener.wait() may already hold a snapshot of context
+        // Bumped by await() and by an awaitClose() with no await() before it,
+        // which tag the clients active then with it.
+        uint64_t _round{ 0 };
+        bool _is_round_open{ false };
+
+        // Holds dropped clients until the accept-monitor's *next* loop
+        // iteration. Reason: when dropAll runs from a handler callback, the
+        // monitor's current event list may still hold context
         // pointers into these BroadcastClients; freeing them immediately
         // would race the dispatch step that dereferences context->type after
         // wait returns. The monitor clears this list at the top of each
         // iteration — by which point the previous wait+dispatch is fully
         // done, so it's safe to release the strong refs.
         std::vector<std::shared_ptr<BroadcastClient>> _pending_destruction;
+
+        // Clients whose TLS handshake has not finished. Only the monitor
+        // touches this list (and close(), after the monitor has joined).
+        std::vector<std::shared_ptr<BroadcastClient>> _handshaking_clients;
     };
 }
 
@@ -1,6 +1,7 @@
 #include "SocketClient.hpp"
 #include "SocketResult.hpp"
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
 
@@ -118,16 +119,35 @@ SocketResult SocketClientImpl::connect()
 		}
 	}
 
+	if (_configuration.shared_memory_size() > 0 && _configuration.is_unix_domain() && !_tls_configuration.valid())
+	{
+		return _socket->openSharedMemory(_configuration.shared_memory_size(), _configuration.busy_poll_time(),
+			_configuration.read_timeout() * _configuration.max_retries());
+	}
+
 	// Phase 2: post-handshake probe — TLS 1.3 deferred rejection detection.
 	// postHandshakeProbe() returns SOCKET_CONNECTION_NEED_TO_BE_BLOCKED when no
-	// data is buffered yet.  We wait once via the event listener (POLLIN):
-	//   SOCKET_TIMEOUT  → no rejection alert arrived within read_timeout → accepted.
-	//   SUCCESS (data)  → retry probe to process the rejection alert.
+	// data is buffered yet.  We wait via the event listener (POLLIN) until the
+	// probe deadline:
+	//   deadline passed → no rejection alert arrived in time → accepted.
+	//   SUCCESS (data)  → retry probe to process the alert (or session tickets,
+	//                     after which the wait resumes for what is left).
 	//   other error     → propagate.
+	// With fast connect, write() runs the probe later without waiting.
+	_is_probe_deferred = false;
+	if (_tls_configuration.shouldFastConnect())
+	{
+		_is_probe_deferred = true;
+		return SocketResult(SocketCode::SUCCESS);
+	}
 	{
+		uint32_t probe_timeout = _tls_configuration.handshakeProbeTimeout() > 0 ?
+			_tls_configuration.handshakeProbeTimeout() : _configuration.read_timeout();
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(probe_timeout);
+
 		SocketEventListener event_listener;
 		event_listener.open(*_socket, SocketEventType::READ);
-		for (size_t i = 0; i < _configuration.max_retries(); )
+		while (true)
 		{
 			result = _socket->reconnect(true);
 			if (result.code() == SocketCode::SUCCESS)
@@ -137,7 +157,12 @@ SocketResult SocketClientImpl::connect()
 			else if (result.code() == SocketCode::SOCKET_CONNECTION_IN_PROGRESS
 				|| result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
 			{
-				result = event_listener.wait(_configuration.read_timeout());
+				auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+				if (remaining <= 0)
+				{
+					return SocketResult(SocketCode::SUCCESS);
+				}
+				result = event_listener.wait(static_cast<uint32_t>(remaining));
 				if (result.code() == SocketCode::SOCKET_TIMEOUT)
 				{
 					return SocketResult(SocketCode::SUCCESS);
@@ -156,19 +181,47 @@ SocketResult SocketClientImpl::connect()
 		}
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	return result;
 }
+SocketResult SocketClientImpl::connect(const void* early_data, size_t size)
+{
+	// Offered as TLS 1.3 early data when the resumed session allows it.
+	_socket->setEarlyData(early_data, size);
+	auto result = connect();
+	_socket->setEarlyData(nullptr, 0);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+	if (_socket->isEarlyDataAccepted())
+	{
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+	}
+
+	// Never offered, or rejected by the server: it has not seen a byte of it.
+	result = write(early_data, size);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+	return SocketResult(SocketCode::SUCCESS, 0);
+}
 SocketResult SocketClientImpl::read(void* buffer, size_t size)
 {
-	SocketResult result;
-	
+	// Held writes first, or the reply to them would never come.
+	SocketResult result = flush();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
 	SocketEventListener event_listener;
 	event_listener.open(*_socket, SocketEventType::READ);
 
 	for (size_t i = 0; i < _configuration.max_retries(); i++)
 	{
-		result = event_listener.wait(_configuration.read_timeout());
+		// Data OpenSSL already holds will not wake poll() up.
+		result = _socket->pending() > 0 ? SocketResult(SocketCode::SUCCESS) : event_listener.wait(_configuration.read_timeout());
 		if (result.code() == SocketCode::SOCKET_TIMEOUT)
 		{
 		}
@@ -196,10 +249,39 @@ SocketResult SocketClientImpl::read(void* buffer, size_t size)
 		std::this_thread::sleep_for(std::chrono::milliseconds(_configuration.time_between_retries()));
 	}
 
+	// Application data from the server: it accepted the handshake.
+	if (result.code() == SocketCode::SUCCESS)
+	{
+		_is_probe_deferred = false;
+	}
 	return result;
 }
+SocketResult SocketClientImpl::probeBeforeWrite()
+{
+	if (_is_probe_deferred)
+	{
+		// Non-blocking: a rejection that has already arrived fails this write;
+		// one still in flight comes out of the next read().
+		auto probed = _socket->reconnect(true);
+		if (probed.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+		{
+			_is_probe_deferred = false;
+			if (probed.code() != SocketCode::SUCCESS)
+			{
+				return probed;
+			}
+		}
+	}
+	return SocketResult(SocketCode::SUCCESS);
+}
 SocketResult SocketClientImpl::write(const void* buffer, size_t size)
 {
+	auto probed = probeBeforeWrite();
+	if (probed.code() != SocketCode::SUCCESS)
+	{
+		return probed;
+	}
+
 	size_t written_size{ 0 };
 	SocketResult result;
 
@@ -219,6 +301,8 @@ SocketResult SocketClientImpl::write(const void* buffer, size_t size)
 		}
 		else {
 			result = _socket->write((char*)buffer + written_size, size - written_size);
+			// A full shared-memory ring is waited out on READ.
+			event_listener.open(*_socket, _socket->writeEvent());
 			if (result.code() == SocketCode::SOCKET_TIMEOUT)
 			{
 				i++;
@@ -243,8 +327,266 @@ SocketResult SocketClientImpl::write(const void* buffer, size_t size)
 	result = SocketResult(result.code(), static_cast<int32_t>(written_size));
 	return result;
 }
+SocketResult SocketClientImpl::writev(const SocketIOBuffer* buffers, size_t count)
+{
+	if (buffers == nullptr && count > 0)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+
+	auto probed = probeBeforeWrite();
+	if (probed.code() != SocketCode::SUCCESS)
+	{
+		return probed;
+	}
+
+	// The next byte to write is buffers[index] at offset.
+	size_t index{ 0 };
+	size_t offset{ 0 };
+	size_t written_size{ 0 };
+	auto skipWritten = [&]() {
+		while (index < count && offset == buffers[index].size)
+		{
+			index++;
+			offset = 0;
+		}
+	};
+	skipWritten();
+
+	SocketResult result;
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::WRITE);
+
+	for (size_t i = 0; i < _configuration.max_retries() && index < count; )
+	{
+		result = event_listener.wait(_configuration.write_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			i++;
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			break;
+		}
+		else {
+			result = _socket->writev(buffers + index, std::min(count - index, SocketClient::MAX_IO_BUFFERS), offset);
+			event_listener.open(*_socket, _socket->writeEvent());
+
+			// A failed TLS write still reports the records it got out.
+			size_t sent = result.bytes() > 0 ? static_cast<size_t>(result.bytes()) : 0;
+			written_size += sent;
+			while (sent > 0)
+			{
+				size_t taken = std::min(sent, buffers[index].size - offset);
+				offset += taken;
+				sent -= taken;
+				skipWritten();
+			}
+
+			if (result.code() == SocketCode::SOCKET_TIMEOUT)
+			{
+				i++;
+			}
+			else if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				// Not counted, as in write().
+			}
+			else if (result.code() != SocketCode::SUCCESS)
+				break;
+			if (index == count)
+				break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(_configuration.time_between_retries()));
+	}
+
+	if (index == count)
+	{
+		return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written_size));
+	}
+	return SocketResult(result.code(), static_cast<int32_t>(written_size));
+}
+SocketResult SocketClientImpl::readv(const SocketIOBuffer* buffers, size_t count)
+{
+	if (buffers == nullptr || count == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+
+	SocketResult result = flush();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::READ);
+
+	for (size_t i = 0; i < _configuration.max_retries(); i++)
+	{
+		result = _socket->pending() > 0 ? SocketResult(SocketCode::SUCCESS) : event_listener.wait(_configuration.read_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			break;
+		}
+		else {
+			result = _socket->readv(buffers, std::min(count, SocketClient::MAX_IO_BUFFERS));
+			if (result.bytes() == 0)
+			{
+				result = SocketResult(SocketCode::SOCKET_CLOSED);
+				break;
+			}
+			if (result.code() != SocketCode::SOCKET_TIMEOUT &&
+				result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				break;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(_configuration.time_between_retries()));
+	}
+
+	if (result.code() == SocketCode::SUCCESS)
+	{
+		_is_probe_deferred = false;
+	}
+	return result;
+}
+SocketResult SocketClientImpl::sendDescriptor(int32_t descriptor, const void* buffer, size_t size)
+{
+	if (descriptor < 0 || buffer == nullptr || size == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+
+	SocketResult result;
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::WRITE);
+
+	for (size_t i = 0; i < _configuration.max_retries(); )
+	{
+		result = event_listener.wait(_configuration.write_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			i++;
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			break;
+		}
+		else {
+			result = _socket->writeDescriptor(descriptor, buffer, size);
+			if (result.code() == SocketCode::SOCKET_TIMEOUT)
+			{
+				i++;
+			}
+			else if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				break;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(_configuration.time_between_retries()));
+	}
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	// The descriptor went with the first byte; the rest is plain data.
+	size_t written_size = static_cast<size_t>(result.bytes());
+	if (written_size == size)
+	{
+		return result;
+	}
+	result = write(static_cast<const char*>(buffer) + written_size, size - written_size);
+	return SocketResult(result.code(), static_cast<int32_t>(written_size) + std::max(result.bytes(), 0));
+}
+SocketResult SocketClientImpl::receiveDescriptor(void* buffer, size_t size, int32_t* descriptor)
+{
+	if (descriptor == nullptr)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+	*descriptor = -1;
+
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::READ);
+
+	SocketResult result;
+	for (size_t i = 0; i < _configuration.max_retries(); i++)
+	{
+		result = event_listener.wait(_configuration.read_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			break;
+		}
+		else {
+			result = _socket->readDescriptor(buffer, size, *descriptor);
+			if (result.bytes() == 0)
+			{
+				result = SocketResult(SocketCode::SOCKET_CLOSED);
+				break;
+			}
+			if (result.code() != SocketCode::SOCKET_TIMEOUT &&
+				result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				break;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(_configuration.time_between_retries()));
+	}
+	return result;
+}
+SocketResult SocketClientImpl::flush()
+{
+	SocketResult result = _socket->flush();
+	if (result.code() != SocketCode::SOCKET_TIMEOUT &&
+		result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+	{
+		return result;
+	}
+
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::WRITE);
+
+	for (size_t i = 0; i < _configuration.max_retries(); )
+	{
+		result = event_listener.wait(_configuration.write_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			i++;
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			break;
+		}
+		else {
+			result = _socket->flush();
+			if (result.code() == SocketCode::SOCKET_TIMEOUT)
+			{
+				i++;
+			}
+			else if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+			{
+				break;
+			}
+		}
+	}
+	return result;
+}
 SocketResult SocketClientImpl::isConnected()
 {
 	return _socket->isConnected();
 }
-
+SocketResult SocketClientImpl::isAlive()
+{
+	if (!_socket)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+	return _socket->isAlive();
+}
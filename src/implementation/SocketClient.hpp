@@ -43,9 +43,19 @@ namespace Bn3Monkey
         void close();
 
 		SocketResult connect();
+		SocketResult connect(const void* early_data, size_t size);
 		SocketResult read(void* buffer, size_t size);
 		SocketResult write(const void* buffer, size_t size);
+		SocketResult writev(const SocketIOBuffer* buffers, size_t count);
+		SocketResult readv(const SocketIOBuffer* buffers, size_t count);
+		SocketResult sendDescriptor(int32_t descriptor, const void* buffer, size_t size);
+		SocketResult receiveDescriptor(void* buffer, size_t size, int32_t* descriptor);
+		SocketResult flush();
 		SocketResult isConnected();
+		SocketResult isAlive();
+
+		// For clients that drive the connected socket themselves.
+		ClientActiveSocket* socket() { return _socket; }
 
 	private:
 		ClientActiveSocketContainer _container{};
@@ -53,6 +63,11 @@ namespace Bn3Monkey
 		
 		SocketConfiguration _configuration;
 		SocketTLSClientConfiguration _tls_configuration;
+		// Fast connect skipped the post-handshake probe; write() runs it
+		// without waiting until the server has proven it accepted us.
+		bool _is_probe_deferred{ false };
+		// Runs the deferred probe before a write; SUCCESS unless it failed.
+		SocketResult probeBeforeWrite();
 	};
 }
 
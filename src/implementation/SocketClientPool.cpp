@@ -0,0 +1,188 @@
+#include "SocketClientPool.hpp"
+#include "SocketResult.hpp"
+
+#include <chrono>
+
+using namespace Bn3Monkey;
+
+SocketClientPoolImpl::~SocketClientPoolImpl()
+{
+	close();
+}
+
+SocketResult SocketClientPoolImpl::open()
+{
+	if (_is_running)
+	{
+		return SocketResult(SocketCode::SOCKET_SERVER_ALREADY_RUNNING);
+	}
+
+	_is_running = true;
+	_warmer = std::thread{ &SocketClientPoolImpl::run, this };
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void SocketClientPoolImpl::close()
+{
+	if (!_is_running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_is_running = false;
+	}
+	_cv.notify_all();
+	if (_warmer.joinable())
+		_warmer.join();
+
+	std::vector<SocketClient*> idle;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		idle.swap(_idle);
+	}
+	for (auto* client : idle)
+		delete client;
+}
+
+SocketResult SocketClientPoolImpl::acquire(SocketClient** client)
+{
+	*client = nullptr;
+	if (!_is_running)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+
+	std::vector<SocketClient*> dead;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		while (!_idle.empty())
+		{
+			auto* candidate = _idle.back();
+			_idle.pop_back();
+			if (isReusable(candidate))
+			{
+				*client = candidate;
+				break;
+			}
+			dead.push_back(candidate);
+		}
+	}
+	// Let the warmer top the idle list back up.
+	_cv.notify_all();
+
+	for (auto* candidate : dead)
+		delete candidate;
+
+	if (*client)
+	{
+		return SocketResult(SocketCode::SUCCESS);
+	}
+
+	// Cold path: nothing idle, connect on the caller's thread.
+	SocketResult result;
+	*client = createClient(result);
+	return result;
+}
+
+void SocketClientPoolImpl::release(SocketClient* client)
+{
+	if (client == nullptr)
+		return;
+
+	if (isReusable(client))
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		if (_is_running && _idle.size() < _max_idle)
+		{
+			_idle.push_back(client);
+			return;
+		}
+	}
+	delete client;
+}
+
+void SocketClientPoolImpl::discard(SocketClient* client)
+{
+	delete client;
+}
+
+SocketClient* SocketClientPoolImpl::createClient(SocketResult& result)
+{
+	// An invalid (default) TLS configuration makes a plain client.
+	auto* client = new SocketClient(_configuration, _tls_configuration);
+	result = client->open();
+	if (result.code() == SocketCode::SUCCESS)
+	{
+		result = client->connect();
+	}
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		delete client;
+		return nullptr;
+	}
+	return client;
+}
+
+bool SocketClientPoolImpl::isReusable(SocketClient* client)
+{
+	// Unread bytes on an idle connection are a response nobody consumed;
+	// handing that connection out would desynchronize the next request.
+	auto result = client->isAlive();
+	return result.code() == SocketCode::SUCCESS && result.bytes() == 0;
+}
+
+void SocketClientPoolImpl::run()
+{
+	std::unique_lock<std::mutex> lock(_mtx);
+	while (_is_running)
+	{
+		_cv.wait_for(lock, std::chrono::milliseconds(HEALTH_CHECK_INTERVAL_MS), [&]() {
+			return !_is_running || _idle.size() < _min_idle;
+			});
+		if (!_is_running)
+			break;
+
+		std::vector<SocketClient*> dead;
+		for (auto iter = _idle.begin(); iter != _idle.end(); )
+		{
+			if (isReusable(*iter))
+			{
+				++iter;
+				continue;
+			}
+			dead.push_back(*iter);
+			iter = _idle.erase(iter);
+		}
+		size_t missing = _idle.size() < _min_idle ? _min_idle - _idle.size() : 0;
+
+		lock.unlock();
+		for (auto* client : dead)
+			delete client;
+
+		bool is_failed{ false };
+		for (size_t i = 0; i < missing && _is_running; i++)
+		{
+			SocketResult result;
+			auto* client = createClient(result);
+			// A server at capacity, or one that speaks first, leaves a
+			// connection that cannot be pooled: as good as unreachable.
+			if (client == nullptr || !isReusable(client))
+			{
+				delete client;
+				is_failed = true;
+				break;
+			}
+			release(client);
+		}
+		lock.lock();
+
+		if (is_failed)
+		{
+			// Endpoint unreachable or refusing: back off instead of reconnecting
+			// in a loop.
+			_cv.wait_for(lock, std::chrono::milliseconds(_configuration.read_timeout()), [&]() {
+				return !_is_running;
+				});
+		}
+	}
+}
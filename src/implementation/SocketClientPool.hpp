@@ -0,0 +1,56 @@
+#if !defined(__BN3MONKEY__SOCKETCLIENTPOOL__)
+#define __BN3MONKEY__SOCKETCLIENTPOOL__
+
+#include "../SecuritySocket.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+namespace Bn3Monkey
+{
+	class SocketClientPoolImpl
+	{
+	public:
+		SocketClientPoolImpl(const SocketConfiguration& configuration, size_t min_idle, size_t max_idle)
+			: _configuration(configuration), _min_idle(min_idle), _max_idle(max_idle < min_idle ? min_idle : max_idle) {}
+		SocketClientPoolImpl(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, size_t min_idle, size_t max_idle)
+			: _configuration(configuration), _tls_configuration(tls_configuration), _min_idle(min_idle), _max_idle(max_idle < min_idle ? min_idle : max_idle) {}
+		virtual ~SocketClientPoolImpl();
+
+		SocketResult open();
+		void close();
+
+		SocketResult acquire(SocketClient** client);
+		void release(SocketClient* client);
+		void discard(SocketClient* client);
+
+	private:
+		// How often the warmer re-checks idle connections when nothing else
+		// wakes it up.
+		static constexpr uint32_t HEALTH_CHECK_INTERVAL_MS = 1000;
+
+		SocketClient* createClient(SocketResult& result);
+		static bool isReusable(SocketClient* client);
+		void run();
+
+		SocketConfiguration _configuration;
+		SocketTLSClientConfiguration _tls_configuration;
+		size_t _min_idle;
+		size_t _max_idle;
+
+		std::atomic<bool> _is_running{ false };
+		std::thread _warmer;
+
+		// Guards _idle. Connects and destructions happen outside of it.
+		std::mutex _mtx;
+		std::condition_variable _cv;
+		// Most recently released at the back: acquire() takes the warmest one
+		// and surplus connections age out at the front.
+		std::vector<SocketClient*> _idle;
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETCLIENTPOOL__
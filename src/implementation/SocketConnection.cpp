@@ -1,28 +1,75 @@
 #include "SocketConnection.hpp"
 #include "SocketEvent.hpp"
+#include "SocketFile.hpp"
+
+#include <algorithm>
 
 using namespace Bn3Monkey;
 
 
+// Anything but "try again later" means the connection is gone.
+static inline bool isBroken(SocketResult result)
+{
+	switch (result.code())
+	{
+	case SocketCode::SUCCESS:
+	case SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED:
+	case SocketCode::SOCKET_CONNECTION_INTERRUPTED:
+	case SocketCode::SOCKET_TIMEOUT:
+		return false;
+	default:
+		return true;
+	}
+}
+
 void Bn3Monkey::SocketConnection::connectClient()
 {
+	_is_connected = true;
 	_handler.onClientConnected(_socket->ip(), _socket->port());
 }
 
 void Bn3Monkey::SocketConnection::disconnectClient()
 {
-	_handler.onClientDisconnected(_socket->ip(), _socket->port());
+	// A connection whose handshake never finished was never reported.
+	if (_is_connected)
+		_handler.onClientDisconnected(_socket->ip(), _socket->port());
+	_is_connected = false;
+	releaseFile();
 	_socket->close();
+	_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
+	moveTo(ProcessState::CLOSED);
 	// listener.removeEvent(this);
 }
 
+Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::handshake()
+{
+	auto result = _socket->handshake();
+	if (result.code() == SocketCode::SUCCESS)
+	{
+		connectClient();
+		return ProcessState::READING_HEADER;
+	}
+	if (isBroken(result))
+	{
+		return ProcessState::CLOSED;
+	}
+	return ProcessState::HANDSHAKING;
+}
+
 Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::readHeader()
 {
 	auto result = _socket->read(reinterpret_cast<char*>(input_header_buffer.data()) + total_input_header_read_size, input_header_buffer.size() - total_input_header_read_size);
+	if (isBroken(result)) {
+		return ProcessState::CLOSED;
+	}
 	if (result.bytes() < 0) {
 		return ProcessState::READING_HEADER;
 	}
+	if (total_input_header_read_size == 0) {
+		_request_start = std::chrono::steady_clock::now();
+	}
 	total_input_header_read_size += result.bytes();
+	_metrics.add(SocketCounter::BYTES_RECEIVED, static_cast<uint64_t>(result.bytes()));
 
 	if (total_input_header_read_size == input_header_buffer.size()) {
 		auto* header = input_header_buffer.data();
@@ -42,10 +89,14 @@ Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::readPaylo
 {
 	auto* payload = input_payload_buffer.data();
 	auto result = _socket->read(reinterpret_cast<char*>(payload) + total_input_payload_read_size, _payload_size - total_input_payload_read_size);
+	if (isBroken(result)) {
+		return ProcessState::CLOSED;
+	}
 	if (result.bytes() < 0) {
 		return ProcessState::READING_PAYLOAD;
 	}
 	total_input_payload_read_size += result.bytes();
+	_metrics.add(SocketCounter::BYTES_RECEIVED, static_cast<uint64_t>(result.bytes()));
 	if (total_input_payload_read_size == _payload_size)
 	{
 		return runTask(_mode, _payload_size);
@@ -55,26 +106,179 @@ Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::readPaylo
 
 Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::writeResponse()
 {
+	auto finished = _file.fd >= 0 ? ProcessState::WRITING_FILE : ProcessState::FINISH_PROCESS;
+	if (total_output_write_size == response_size) {
+		return finished;
+	}
 	auto result = _socket->write(reinterpret_cast<char*>(output_buffer.data()) + total_output_write_size, response_size - total_output_write_size);
+	if (isBroken(result)) {
+		return ProcessState::CLOSED;
+	}
 	if (result.bytes() < 0) {
 		return ProcessState::WRITING_RESPONSE;
 	}
 
 	total_output_write_size += result.bytes();
+	_metrics.add(SocketCounter::BYTES_SENT, static_cast<uint64_t>(result.bytes()));
 
 	if (total_output_write_size == response_size) {
-		return ProcessState::FINISH_PROCESS;
+		return finished;
 	}
 	return ProcessState::WRITING_RESPONSE;
 }
 
+Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::writeFile()
+{
+	_is_waiting_for_file = false;
+	if (_file_sent == _file.size) {
+		releaseFile();
+		return ProcessState::FINISH_PROCESS;
+	}
+
+	SocketResult result;
+	if (!_is_file_copied) {
+		result = _socket->sendFile(_file.fd, _file.offset + static_cast<int64_t>(_file_sent), static_cast<size_t>(_file.size - _file_sent));
+		if (result.code() == SocketCode::SOCKET_INVALID_ARGUMENT) {
+			_is_file_copied = true;
+		}
+	}
+	if (_is_file_copied) {
+		result = copyFile();
+	}
+
+	if (result.code() == SocketCode::SOCKET_TIMEOUT) {
+		_is_waiting_for_file = true;
+		file_event.fd = _file.fd;
+		return ProcessState::WRITING_FILE;
+	}
+	if (isBroken(result)) {
+		return ProcessState::CLOSED;
+	}
+	if (result.bytes() < 0) {
+		return ProcessState::WRITING_FILE;
+	}
+	// The file ended before the range did.
+	if (result.bytes() == 0) {
+		return ProcessState::CLOSED;
+	}
+
+	_file_sent += result.bytes();
+	_metrics.add(SocketCounter::BYTES_SENT, static_cast<uint64_t>(result.bytes()));
+	if (_file_sent == _file.size) {
+		releaseFile();
+		return ProcessState::FINISH_PROCESS;
+	}
+	return ProcessState::WRITING_FILE;
+}
+
+Bn3Monkey::SocketResult Bn3Monkey::SocketConnection::copyFile()
+{
+	// The response has left, so output_buffer is free. Bytes read stay in it
+	// until written: a pipe cannot give them again, and TLS must retry them.
+	if (_file_buffer_offset == _file_buffered) {
+		size_t size = static_cast<size_t>(std::min<uint64_t>(output_buffer.size(), _file.size - _file_sent));
+		auto result = readFile(_file.fd, _file.offset + static_cast<int64_t>(_file_sent), output_buffer.data(), size);
+		if (result.code() != SocketCode::SUCCESS || result.bytes() == 0) {
+			return result;
+		}
+		_file_buffered = static_cast<size_t>(result.bytes());
+		_file_buffer_offset = 0;
+	}
+
+	auto result = _socket->write(output_buffer.data() + _file_buffer_offset, _file_buffered - _file_buffer_offset);
+	if (result.bytes() > 0) {
+		_file_buffer_offset += result.bytes();
+	}
+	return result;
+}
+
+void Bn3Monkey::SocketConnection::releaseFile()
+{
+	if (_file.close_after) {
+		closeFile(_file.fd);
+	}
+	_file = SocketFileRange();
+	_file_sent = 0;
+	_is_file_copied = false;
+	_is_waiting_for_file = false;
+	_file_buffered = 0;
+	_file_buffer_offset = 0;
+}
+
+Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::pollCompletion()
+{
+	auto completion = _completion;
+	if (!completion)
+	{
+		return ProcessState::FINISH_PROCESS;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(completion->mtx);
+		if (!completion->is_completed)
+		{
+			return ProcessState::PROCESSING;
+		}
+		completion->connection = nullptr;
+	}
+	_completion.reset();
+
+	return response_size > 0 ? ProcessState::WRITING_RESPONSE : ProcessState::FINISH_PROCESS;
+}
+
+void Bn3Monkey::SocketConnection::abandonCompletion()
+{
+	auto completion = _completion;
+	if (!completion)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(completion->mtx);
+		completion->connection = nullptr;
+	}
+	_completion.reset();
+}
+
+Bn3Monkey::SocketResult Bn3Monkey::SocketRequestCompletionState::complete(const void* response, size_t size)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	if (connection == nullptr || is_completed)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+	if (size > connection->output_buffer.size())
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+
+	// The server thread leaves output_buffer alone while the connection is
+	// PROCESSING, and it stops doing so only after taking mtx.
+	if (size > 0)
+	{
+		memcpy(connection->output_buffer.data(), response, size);
+	}
+	connection->response_size = size;
+	is_completed = true;
+	// Still under mtx: the server closes the listener only after it has
+	// abandoned every completion.
+	listener->wakeup();
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+}
+
 void Bn3Monkey::SocketConnection::flush()
 {
+	if (total_input_header_read_size > 0)
+	{
+		_metrics.record(SocketLatency::REQUEST_SERVICE_TIME, std::chrono::steady_clock::now() - _request_start);
+	}
+
 	memset(input_header_buffer.data(), 0, input_header_buffer.size());
 	memset(input_payload_buffer.data(), 0, input_payload_buffer.size());
 	memset(output_buffer.data(), 0, output_buffer.size());
 
-	state = ProcessState::READING_HEADER;
+	moveTo(ProcessState::READING_HEADER);
 
 	total_input_header_read_size = 0;
 	
@@ -86,6 +290,16 @@ void Bn3Monkey::SocketConnection::flush()
 }
 
 Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::runTask(SocketRequestMode mode, size_t payload_size)
+{
+	_metrics.addRequest(mode);
+	auto start = std::chrono::steady_clock::now();
+	auto state = processTask(mode, payload_size);
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+	_metrics.add(SocketCounter::PROCESSING_TIME_NS, static_cast<uint64_t>(elapsed.count()));
+	return state;
+}
+
+Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::processTask(SocketRequestMode mode, size_t payload_size)
 {
 
 	auto* header = input_header_buffer.data();
@@ -101,11 +315,31 @@ Bn3Monkey::SocketConnection::ProcessState Bn3Monkey::SocketConnection::runTask(S
 	break;
 	case SocketRequestMode::SLOW:
 	{
-		// @Todo
+		_completion = std::make_shared<SocketRequestCompletionState>();
+		_completion->connection = this;
+		_completion->listener = &_listener;
+		if (!_handler.onProcessedAsync(header, payload, payload_size, SocketRequestCompletion(_completion)))
+		{
+			abandonCompletion();
+			_handler.onProcessed(header, payload, payload_size, output_buffer.data(), &response_size);
+			return ProcessState::WRITING_RESPONSE;
+		}
+		// The handler may have completed before returning.
+		return pollCompletion();
 	}
 	break;
 	case SocketRequestMode::READ_STREAM:
 	{
+		SocketFileRange file;
+		if (_handler.onFileRequested(header, payload, payload_size, output_buffer.data(), &response_size, &file))
+		{
+			_file = file;
+			if (_file.fd < 0 || _file.size == 0) {
+				// Nothing to stream.
+				releaseFile();
+			}
+			return ProcessState::WRITING_RESPONSE;
+		}
 		_handler.onProcessed(header, payload, payload_size, output_buffer.data(), &response_size);
 		return ProcessState::WRITING_RESPONSE;
 	}
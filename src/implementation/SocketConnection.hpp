@@ -4,28 +4,57 @@
 #include "../SecuritySocket.hpp"
 #include "ServerActiveSocket.hpp"
 #include "SocketEvent.hpp"
+#include "SocketMetrics.hpp"
+#include "SocketTrace.hpp"
+#include "SocketTimerWheel.hpp"
 
 #include <thread>
+#include <chrono>
 #include <functional>
 #include <queue>
 #include <mutex>
+#include <memory>
 #include <condition_variable>
 
 namespace Bn3Monkey
 {
+    class SocketConnection;
+
+    // Shared by a connection waiting on a SLOW-mode request and the
+    // SocketRequestCompletion handed to the handler, which may outlive it.
+    struct SocketRequestCompletionState
+    {
+        std::mutex mtx;
+        // nullptr once the connection stops waiting (completed or dropped).
+        SocketConnection* connection{ nullptr };
+        // Woken by complete(), so the server thread resumes the connection.
+        SocketMultiEventListener* listener{ nullptr };
+        bool is_completed{ false };
+
+        SocketResult complete(const void* response, size_t size);
+    };
+
     class SocketConnection : public SocketEventContext
     {
     public:
         enum class ProcessState {
+            HANDSHAKING,
             READING_HEADER,
             READING_PAYLOAD,
+            PROCESSING,
             WRITING_RESPONSE,
-            FINISH_PROCESS
+            // Streaming the SocketFileRange behind the response.
+            WRITING_FILE,
+            FINISH_PROCESS,
+            // The peer closed the connection or it broke; drop it.
+            CLOSED
         };
 
-        SocketConnection(ServerActiveSocketContainer& container, SocketRequestHandler& handler, size_t pdu_size) :
+        SocketConnection(ServerActiveSocketContainer& container, SocketRequestHandler& handler, size_t pdu_size, SocketMetrics& metrics, SocketMultiEventListener& listener) :
             _container(container),
-            _handler(handler) {
+            _handler(handler),
+            _metrics(metrics),
+            _listener(listener) {
             _socket = _container.get();
             fd = _socket->descriptor();
 
@@ -40,6 +69,34 @@ namespace Bn3Monkey
         void disconnectClient();
 
         ProcessState state{ ProcessState::READING_HEADER };
+        // Assigns state, tracing the transition.
+        inline void moveTo(ProcessState next) {
+            SOCKET_TRACE_STATE(this, state, next);
+            state = next;
+        }
+
+        // HANDSHAKING : wait for pendingEvent() | READING_HEADER : connected | CLOSED : failed
+        // Calls connectClient() once the handshake is done.
+        ProcessState handshake();
+        inline SocketEventType pendingEvent() { return _socket->pendingEvent(); }
+        // What an unfinished WRITING_RESPONSE / WRITING_FILE waits for.
+        inline SocketEventType writeEvent() { return _socket->writeEvent(); }
+        // Input the socket has already taken off the wire (TLS records), which
+        // poll() will not report again.
+        inline bool hasBufferedInput() { return _socket->pending() > 0; }
+        inline ServerActiveSocket* socket() { return _socket; }
+        std::chrono::steady_clock::time_point handshake_deadline;
+
+        // Owned by the server thread's SocketTimerWheel; fires at the
+        // earliest deadline of the current state.
+        SocketTimer timer;
+        // Last READ / WRITE event, for the idle timeout.
+        std::chrono::steady_clock::time_point last_activity;
+        // When the current request went to the handler as SLOW.
+        std::chrono::steady_clock::time_point processing_start;
+        // Part of a request has been read.
+        inline bool isReadingRequest() const { return total_input_header_read_size > 0; }
+        inline std::chrono::steady_clock::time_point requestStart() const { return _request_start; }
 
         // false : READING_HEADER | true : READING_PAYLOAD
         ProcessState readHeader();
@@ -49,16 +106,43 @@ namespace Bn3Monkey
 
         // false : WRITING_RESPONSE | true : READING_HEADER
         ProcessState  writeResponse();
+
+        // WRITING_FILE : more to send | FINISH_PROCESS | CLOSED
+        ProcessState writeFile();
+        // The pipe being streamed is empty; wait for file_event instead of
+        // the socket.
+        inline bool isWaitingForFile() const { return _is_waiting_for_file; }
+        // Watches the pipe being streamed while isWaitingForFile().
+        SocketEventContext file_event;
+
+        // PROCESSING : handler still owns the request | WRITING_RESPONSE | FINISH_PROCESS
+        ProcessState pollCompletion();
+        // The server stops waiting; a later complete() from the handler is dropped.
+        void abandonCompletion();
         
         void flush();
         
     private:
+        friend struct SocketRequestCompletionState;
+
+        // Counts and times the handler call of processTask().
         ProcessState runTask(SocketRequestMode mode, size_t payload_size);
+        ProcessState processTask(SocketRequestMode mode, size_t payload_size);
+        // Reads the file into output_buffer and writes it, when the socket
+        // cannot send from the descriptor itself.
+        SocketResult copyFile();
+        void releaseFile();
 
         ServerActiveSocketContainer _container{};
         ServerActiveSocket* _socket{ nullptr };
+        bool _is_connected{ false };
 
         SocketRequestHandler& _handler;
+        SocketMetrics& _metrics;
+        SocketMultiEventListener& _listener;
+        // First byte of the request being served; the service time runs
+        // from here to flush().
+        std::chrono::steady_clock::time_point _request_start;
         
         // Read Header
         size_t total_input_header_read_size{ 0 };
@@ -75,6 +159,18 @@ namespace Bn3Monkey
         size_t total_output_write_size{ 0 };
         std::vector<char> output_buffer{ 0, std::allocator<char>() };
 
+        // SLOW mode
+        std::shared_ptr<SocketRequestCompletionState> _completion;
+
+        // READ_STREAM answered by SocketRequestHandler::onFileRequested()
+        SocketFileRange _file;
+        uint64_t _file_sent{ 0 };
+        bool _is_file_copied{ false };
+        bool _is_waiting_for_file{ false };
+        // What copyFile() holds in output_buffer.
+        size_t _file_buffered{ 0 };
+        size_t _file_buffer_offset{ 0 };
+
         // Worker Thread
 
         std::thread _worker;
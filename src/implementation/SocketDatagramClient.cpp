@@ -0,0 +1,120 @@
+#include "SocketDatagramClient.hpp"
+#include "SocketEvent.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+SocketDatagramClientImpl::~SocketDatagramClientImpl()
+{
+	close();
+}
+
+SocketResult SocketDatagramClientImpl::open()
+{
+	if (_socket)
+	{
+		return SocketResult(SocketCode::SUCCESS);
+	}
+
+	auto socket = std::unique_ptr<DatagramSocket>(new DatagramSocket(_configuration.is_unix_domain()));
+	SocketResult result = socket->valid();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	SocketAddress address{ _configuration.ip(), _configuration.port(), false, _configuration.is_unix_domain() };
+	result = address;
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		socket->close();
+		return result;
+	}
+
+	result = socket->connect(address);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		socket->close();
+		return result;
+	}
+
+	if (_configuration.segmentation_offload())
+		socket->enableSegmentationOffload(false);
+
+	_batch_size = DatagramSocket::batchSize(_configuration.datagram_batch_size());
+	_socket = std::move(socket);
+	return result;
+}
+
+void SocketDatagramClientImpl::close()
+{
+	if (_socket)
+	{
+		_socket->close();
+		_socket.reset();
+	}
+}
+
+SocketResult SocketDatagramClientImpl::write(const void* buffer, size_t size)
+{
+	SocketIOBuffer datagram;
+	datagram.data = const_cast<void*>(buffer);
+	datagram.size = size;
+	auto result = writeBatch(&datagram, 1);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(size));
+}
+
+SocketResult SocketDatagramClientImpl::writeBatch(const SocketIOBuffer* datagrams, size_t count)
+{
+	if (!_socket)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		if (datagrams[i].size > DatagramSocket::MAX_DATAGRAM_SIZE)
+		{
+			return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+		}
+	}
+
+	size_t sent{ 0 };
+	SocketEventListener event_listener;
+	event_listener.open(*_socket, SocketEventType::WRITE);
+
+	for (size_t i = 0; sent < count && i < _configuration.max_retries(); )
+	{
+		auto result = _socket->sendBatch(datagrams + sent, std::min(count - sent, _batch_size));
+		if (result.code() == SocketCode::SUCCESS)
+		{
+			sent += static_cast<size_t>(result.bytes());
+			continue;
+		}
+		if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+		{
+			return SocketResult(result.code(), static_cast<int32_t>(sent));
+		}
+
+		// The send buffer is full.
+		result = event_listener.wait(_configuration.write_timeout());
+		if (result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			i++;
+		}
+		else if (result.code() != SocketCode::SUCCESS)
+		{
+			return SocketResult(result.code(), static_cast<int32_t>(sent));
+		}
+	}
+
+	if (sent < count)
+	{
+		return SocketResult(SocketCode::SOCKET_TIMEOUT, static_cast<int32_t>(sent));
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(sent));
+}
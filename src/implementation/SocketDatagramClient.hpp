@@ -0,0 +1,32 @@
+#if !defined(__BN3MONKEY__SOCKETDATAGRAMCLIENT__)
+#define __BN3MONKEY__SOCKETDATAGRAMCLIENT__
+
+#include "../SecuritySocket.hpp"
+#include "DatagramSocket.hpp"
+
+#include <memory>
+
+namespace Bn3Monkey
+{
+	class SocketDatagramClientImpl
+	{
+	public:
+		explicit SocketDatagramClientImpl(const SocketConfiguration& configuration)
+			: _configuration(configuration) {}
+
+		virtual ~SocketDatagramClientImpl();
+
+		SocketResult open();
+		void close();
+
+		SocketResult write(const void* buffer, size_t size);
+		SocketResult writeBatch(const SocketIOBuffer* datagrams, size_t count);
+
+	private:
+		SocketConfiguration _configuration;
+		std::unique_ptr<DatagramSocket> _socket;
+		size_t _batch_size{ 1 };
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETDATAGRAMCLIENT__
@@ -0,0 +1,145 @@
+#include "SocketDatagramServer.hpp"
+#include "SocketTrace.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+// Receives per READ event. The rest waits for the next wait(), so posted
+// tasks and close() are not held up by a sender that never stops.
+static constexpr size_t MAX_RECEIVES_PER_EVENT = 16;
+
+SocketDatagramServerImpl::~SocketDatagramServerImpl()
+{
+	close();
+}
+
+SocketResult SocketDatagramServerImpl::open(SocketDatagramHandler* handler)
+{
+	if (_is_running)
+	{
+		return SocketResult(SocketCode::SUCCESS);
+	}
+
+	auto socket = std::unique_ptr<DatagramSocket>(new DatagramSocket(_configuration.is_unix_domain()));
+	SocketResult result = socket->valid();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	SocketAddress address{ _configuration.ip(), _configuration.port(), true, _configuration.is_unix_domain() };
+	result = address;
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		socket->close();
+		return result;
+	}
+
+	result = socket->bind(address);
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		socket->close();
+		return result;
+	}
+
+	// GRO hands over up to 64 KB of coalesced datagrams at once, whatever
+	// pdu_size() is.
+	size_t slot_size = std::max<size_t>(_configuration.pdu_size(), 1);
+	if (_configuration.segmentation_offload() && socket->enableSegmentationOffload(true))
+		slot_size = std::max(slot_size, SocketConfiguration::MAX_PDU_SIZE);
+	_batch.resize(DatagramSocket::batchSize(_configuration.datagram_batch_size()), slot_size);
+
+	result = _listener.open(_configuration.event_backend());
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		socket->close();
+		return result;
+	}
+
+	_handler = handler;
+	_socket = std::move(socket);
+	_server_context = SocketEventContext{};
+	_server_context.fd = _socket->descriptor();
+	_listener.addEvent(&_server_context, SocketEventType::READ);
+
+	_is_running = true;
+	_thread = std::thread{ &Bn3Monkey::SocketDatagramServerImpl::run, this };
+	return result;
+}
+
+void SocketDatagramServerImpl::run()
+{
+	while (_is_running)
+	{
+		_listener.runPostedTasks();
+
+		// post() and close() wake the wait.
+		SOCKET_TRACE_BEGIN(wait_begin);
+		auto eventlist = _listener.wait(_configuration.read_timeout());
+		SOCKET_TRACE_COMPLETE(WAIT, this, wait_begin, eventlist.contexts.size());
+		_metrics.add(SocketCounter::EVENT_LOOP_WAKEUPS, 1);
+		if (eventlist.result.code() == SocketCode::SOCKET_TIMEOUT)
+			continue;
+		if (eventlist.result.code() != SocketCode::SUCCESS)
+			break;
+
+		for (auto* context : eventlist.contexts)
+		{
+			// An error queued by ICMP comes as DISCONNECTED; the next
+			// receive takes it out.
+			if (context == &_server_context)
+				receiveDatagrams();
+		}
+	}
+}
+
+void SocketDatagramServerImpl::receiveDatagrams()
+{
+	for (size_t i = 0; i < MAX_RECEIVES_PER_EVENT && _is_running; i++)
+	{
+		auto result = _socket->receive(_batch);
+		if (result.code() != SocketCode::SUCCESS || _batch.size() == 0)
+			return;
+
+		uint64_t bytes{ 0 };
+		const auto* datagrams = _batch.datagrams();
+		for (size_t index = 0; index < _batch.size(); index++)
+			bytes += datagrams[index].size;
+		_metrics.add(SocketCounter::DATAGRAMS_RECEIVED, _batch.size());
+		_metrics.add(SocketCounter::BYTES_RECEIVED, bytes);
+
+		if (_handler)
+			_handler->onDatagramsReceived(datagrams, _batch.size());
+	}
+}
+
+SocketResult SocketDatagramServerImpl::post(std::function<void()> task)
+{
+	if (!task)
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	if (!_is_running)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	return _listener.post(std::move(task));
+}
+
+void SocketDatagramServerImpl::close()
+{
+	if (_is_running)
+	{
+		_is_running = false;
+		_listener.wakeup();
+		if (_thread.joinable())
+			_thread.join();
+	}
+
+	_listener.close();
+
+	if (_socket)
+	{
+		_socket->close();
+		_socket.reset();
+	}
+
+	_handler = nullptr;
+}
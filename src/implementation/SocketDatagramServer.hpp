@@ -0,0 +1,53 @@
+#if !defined(__BN3MONKEY__SOCKETDATAGRAMSERVER__)
+#define __BN3MONKEY__SOCKETDATAGRAMSERVER__
+
+#include "../SecuritySocket.hpp"
+#include "DatagramSocket.hpp"
+#include "SocketEvent.hpp"
+#include "SocketMetrics.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace Bn3Monkey
+{
+	class SocketDatagramServerImpl
+	{
+	public:
+		explicit SocketDatagramServerImpl(const SocketConfiguration& configuration)
+			: _configuration(configuration) {}
+
+		virtual ~SocketDatagramServerImpl();
+
+		SocketResult open(SocketDatagramHandler* handler);
+		void close();
+
+		inline void snapshot(SocketServerMetrics& metrics) const { _metrics.snapshot(metrics); }
+		inline SocketEventBackend eventBackend() const { return _listener.backend(); }
+		SocketResult post(std::function<void()> task);
+
+	private:
+		SocketConfiguration _configuration;
+		std::unique_ptr<DatagramSocket> _socket;
+		SocketDatagramHandler* _handler{ nullptr };
+
+		// Kept across open() / close() for the life of the server.
+		SocketMetrics _metrics;
+
+		std::thread _thread;
+		std::atomic_bool _is_running{ false };
+		void run();
+		// Hands what is waiting on the socket to the handler, a batch at a time.
+		void receiveDatagrams();
+
+		// A member so close() and post() on other threads can wake the server.
+		SocketMultiEventListener _listener;
+		SocketEventContext _server_context;
+		// Only the server thread touches it.
+		DatagramBatch _batch;
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETDATAGRAMSERVER__
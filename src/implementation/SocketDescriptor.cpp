@@ -0,0 +1,142 @@
+#include "SocketDescriptor.hpp"
+#include "SocketResult.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#include <WS2tcpip.h>
+#else
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace Bn3Monkey;
+
+SocketResult Bn3Monkey::sendDescriptor(int32_t socket, int32_t descriptor, const void* buffer, size_t size)
+{
+	if (descriptor < 0 || buffer == nullptr || size == 0)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+#ifdef _WIN32
+	(void)socket;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+#else
+	iovec piece{ const_cast<void*>(buffer), size };
+	union
+	{
+		cmsghdr header;
+		char data[CMSG_SPACE(sizeof(int))];
+	} control{};
+	msghdr message{};
+	message.msg_iov = &piece;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data;
+	message.msg_controllen = sizeof(control.data);
+	cmsghdr* rights = CMSG_FIRSTHDR(&message);
+	rights->cmsg_level = SOL_SOCKET;
+	rights->cmsg_type = SCM_RIGHTS;
+	rights->cmsg_len = CMSG_LEN(sizeof(int));
+	int fd = descriptor;
+	memcpy(CMSG_DATA(rights), &fd, sizeof(int));
+
+#ifdef __linux__
+	int32_t ret = static_cast<int32_t>(::sendmsg(socket, &message, MSG_NOSIGNAL));
+#else
+	int32_t ret = static_cast<int32_t>(::sendmsg(socket, &message, 0));
+#endif
+	if (ret == 0)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	return createResult(ret);
+#endif
+}
+
+SocketResult Bn3Monkey::receiveDescriptors(int32_t socket, void* buffer, size_t size, int32_t* descriptors, size_t capacity, size_t& count)
+{
+	count = 0;
+#ifdef _WIN32
+	(void)socket;
+	(void)buffer;
+	(void)size;
+	(void)descriptors;
+	(void)capacity;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+#else
+	iovec piece{ buffer, size };
+	union
+	{
+		cmsghdr header;
+		char data[CMSG_SPACE(sizeof(int) * MAX_RECEIVED_DESCRIPTORS)];
+	} control{};
+	msghdr message{};
+	message.msg_iov = &piece;
+	message.msg_iovlen = 1;
+	message.msg_control = control.data;
+	message.msg_controllen = sizeof(control.data);
+#ifdef __linux__
+	int32_t ret = static_cast<int32_t>(::recvmsg(socket, &message, MSG_CMSG_CLOEXEC));
+#else
+	int32_t ret = static_cast<int32_t>(::recvmsg(socket, &message, 0));
+#endif
+	if (ret < 0)
+		return createResult(ret);
+
+	for (cmsghdr* rights = CMSG_FIRSTHDR(&message); rights != nullptr; rights = CMSG_NXTHDR(&message, rights))
+	{
+		if (rights->cmsg_level != SOL_SOCKET || rights->cmsg_type != SCM_RIGHTS)
+			continue;
+		size_t num_of_fds = (rights->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		for (size_t i = 0; i < num_of_fds; i++)
+		{
+			int fd{ -1 };
+			memcpy(&fd, CMSG_DATA(rights) + i * sizeof(int), sizeof(int));
+			if (count < capacity)
+			{
+#ifndef __linux__
+				::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+				descriptors[count++] = fd;
+			}
+			else
+			{
+				::close(fd);
+			}
+		}
+	}
+
+	if (ret == 0)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	return SocketResult(SocketCode::SUCCESS, ret);
+#endif
+}
+
+bool Bn3Monkey::isStreamSocket(int32_t descriptor)
+{
+	if (descriptor < 0)
+		return false;
+	int type{ 0 };
+	socklen_t length = sizeof(type);
+	if (::getsockopt(descriptor, SOL_SOCKET, SO_TYPE, reinterpret_cast<char*>(&type), &length) != 0 || type != SOCK_STREAM)
+		return false;
+	// A listening socket is SOCK_STREAM too, but has no peer to serve.
+	int is_listening{ 0 };
+	length = sizeof(is_listening);
+	if (::getsockopt(descriptor, SOL_SOCKET, SO_ACCEPTCONN, reinterpret_cast<char*>(&is_listening), &length) != 0)
+		return false;
+	return is_listening == 0;
+}
+
+void Bn3Monkey::closeDescriptor(int32_t descriptor)
+{
+	if (descriptor < 0)
+		return;
+#ifdef _WIN32
+	::closesocket(descriptor);
+#else
+	::close(descriptor);
+#endif
+}
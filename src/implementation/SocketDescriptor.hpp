@@ -0,0 +1,32 @@
+#if !defined(__BN3MONKEY__SOCKETDESCRIPTOR__)
+#define __BN3MONKEY__SOCKETDESCRIPTOR__
+
+#include "../SecuritySocket.hpp"
+
+#include <cstdint>
+
+namespace Bn3Monkey
+{
+	// Passes descriptors over unix domain stream sockets (SCM_RIGHTS). The
+	// receiver gets its own copy of each; the sender still owns its own.
+	// Neither works on Windows, where both are SOCKET_INVALID_ARGUMENT.
+
+	// Descriptors one receiveDescriptors() can take. The kernel closes the
+	// rest of a message that carries more.
+	static constexpr size_t MAX_RECEIVED_DESCRIPTORS = 8;
+
+	// send() of buffer with descriptor attached to its first byte, so size
+	// must be at least 1.
+	SocketResult sendDescriptor(int32_t socket, int32_t descriptor, const void* buffer, size_t size);
+	// recv() that also takes the descriptors passed with the bytes read, up to
+	// capacity (at most MAX_RECEIVED_DESCRIPTORS), close-on-exec. count is how
+	// many came; any beyond capacity are closed.
+	SocketResult receiveDescriptors(int32_t socket, void* buffer, size_t size, int32_t* descriptors, size_t capacity, size_t& count);
+
+	// A connected stream socket, such as a TCP or unix domain connection.
+	// Listening sockets are not.
+	bool isStreamSocket(int32_t descriptor);
+	void closeDescriptor(int32_t descriptor);
+}
+
+#endif // __BN3MONKEY__SOCKETDESCRIPTOR__
@@ -13,6 +13,8 @@
 
 #include <vector>
 #include <unordered_map>
+#include <atomic>
+#include <functional>
 #include <mutex>
 #include <condition_variable>
 
@@ -56,26 +58,68 @@ namespace Bn3Monkey
         std::vector<SocketEventContext*> contexts;
     };
 
+    class SocketEventRing;
+
     class SocketMultiEventListener
     {
     public:
-        SocketResult open();
+        ~SocketMultiEventListener() { close(); }
+
+        // IO_URING falls back to poll() when the kernel cannot run it.
+        SocketResult open(SocketEventBackend backend = SocketEventBackend::POLL);
         void close();        
         SocketResult addEvent(SocketEventContext* context, SocketEventType eventType);
         SocketResult modifyEvent(SocketEventContext* context, SocketEventType eventType);
         SocketResult removeEvent(SocketEventContext* context);
+        // A wait() ended only by wakeup() returns SOCKET_TIMEOUT with no contexts.
         SocketEventResult wait(uint32_t timeout_ms);
+        // The backend open() ended up with; POLL while closed.
+        inline SocketEventBackend backend() const { return _ring ? SocketEventBackend::IO_URING : SocketEventBackend::POLL; }
+
+        // Any thread. Ends the wait() in progress, or the next one, at once.
+        SocketResult wakeup();
+        // Any thread. Queues task for the thread that calls wait() and wakes it.
+        // SOCKET_CLOSED unless the listener is open.
+        SocketResult post(std::function<void()> task);
+        // The waiting thread. Runs the tasks post() queued so far, in order.
+        void runPostedTasks();
 
     private:
         int32_t _server_socket {0};
         std::mutex _mtx;
         std::vector<SocketEventContext*> _contexts;
+        // Set when the io_uring backend is in use; it then handles every call.
+        SocketEventRing* _ring{ nullptr };
+
+        // Registered by open() like any descriptor. wakeup() makes it readable;
+        // wait() drains it and leaves it out of its result.
+        SocketEventContext _wakeup_context;
+        // Guards the wakeup descriptors against close() and _posted.
+        std::mutex _wakeup_mtx;
+        std::vector<std::function<void()>> _posted;
+        // Set from wakeup() until wait() drains, so a burst of wakeups
+        // costs one write.
+        std::atomic<bool> _is_woken{ false };
+
+        // Per platform: create, signal, drain and close the wakeup descriptors.
+        bool openWakeup();
+        void signalWakeup();
+        void drainWakeup();
+        void closeWakeup();
+        // Drops the wakeup context out of an event result.
+        void takeWakeup(SocketEventResult& result);
+        SocketEventResult pollEvents(uint32_t timeout_ms);
     
 #if defined(_WIN32)
         std::vector<pollfd> _handle;
+        // The end wakeup() sends to; a UDP socket connected to _wakeup_context's.
+        SOCKET _wakeup_sender{ INVALID_SOCKET };
         // void *_handle;
     #elif defined __linux__
         std::vector<pollfd> _handle;
+        // The end wakeup() writes to: the eventfd itself, or the write end of
+        // a pipe where eventfd is unavailable.
+        int32_t _wakeup_writer{ -1 };
         // int32_t _handle;
     #endif
     };
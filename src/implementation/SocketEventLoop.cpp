@@ -0,0 +1,219 @@
+#include "SocketEventLoop.hpp"
+#include "SocketResult.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+SocketEventLoopImpl::~SocketEventLoopImpl()
+{
+	close();
+}
+
+SocketResult SocketEventLoopImpl::open()
+{
+	if (_is_running)
+	{
+		return SocketResult(SocketCode::SOCKET_SERVER_ALREADY_RUNNING);
+	}
+
+	auto result = _listener.open();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	_is_running = true;
+	_routine = std::thread{ &SocketEventLoopImpl::run, this };
+	return result;
+}
+
+void SocketEventLoopImpl::close()
+{
+	if (!_is_running)
+		return;
+
+	_is_running = false;
+	_listener.wakeup();
+	if (_routine.joinable())
+		_routine.join();
+
+	// Loop thread is gone — fail whatever the remaining clients still wait on.
+	std::vector<SocketEventLoopClient*> remaining;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		remaining.assign(_clients.begin(), _clients.end());
+		for (auto* client : remaining)
+		{
+			if (client->_watched != SocketEventType::UNDEFINED)
+				_listener.removeEvent(client);
+			client->_watched = SocketEventType::UNDEFINED;
+			client->_scheduled = false;
+		}
+		_clients.clear();
+		_ready.clear();
+	}
+	_iteration_cv.notify_all();
+
+	for (auto* client : remaining)
+		client->onLoopClosed();
+
+	_listener.close();
+}
+
+SocketResult SocketEventLoopImpl::attach(SocketEventLoopClient* client)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (!_is_running)
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	_clients.insert(client);
+	client->_watched = SocketEventType::UNDEFINED;
+	client->_scheduled = false;
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void SocketEventLoopImpl::detach(SocketEventLoopClient* client)
+{
+	std::unique_lock<std::mutex> lock(_mtx);
+	if (_clients.erase(client) == 0)
+		return;
+
+	if (client->_watched != SocketEventType::UNDEFINED)
+		_listener.removeEvent(client);
+	client->_watched = SocketEventType::UNDEFINED;
+
+	if (client->_scheduled)
+	{
+		_ready.erase(std::remove(_ready.begin(), _ready.end(), client), _ready.end());
+		client->_scheduled = false;
+	}
+
+	// On the loop thread (i.e. from a callback) the attach check in run()
+	// already keeps the rest of this iteration away from the client.
+	if (!_is_running || std::this_thread::get_id() == _routine.get_id())
+		return;
+
+	auto iteration = _iteration;
+	_listener.wakeup();
+	_iteration_cv.wait(lock, [&]() {
+		return _iteration != iteration || !_is_running;
+		});
+}
+
+void SocketEventLoopImpl::watch(SocketEventLoopClient* client, SocketEventType type)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (_clients.find(client) == _clients.end())
+		return;
+	if (client->_watched == type)
+		return;
+
+	if (type == SocketEventType::UNDEFINED)
+		_listener.removeEvent(client);
+	else if (client->_watched == SocketEventType::UNDEFINED)
+		_listener.addEvent(client, type);
+	else
+		_listener.modifyEvent(client, type);
+	client->_watched = type;
+	wakeupFromOutside();
+}
+
+void SocketEventLoopImpl::schedule(SocketEventLoopClient* client)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (client->_scheduled || _clients.find(client) == _clients.end())
+		return;
+	client->_scheduled = true;
+	_ready.push_back(client);
+	wakeupFromOutside();
+}
+
+void SocketEventLoopImpl::wakeupFromOutside()
+{
+	if (std::this_thread::get_id() != _routine.get_id())
+		_listener.wakeup();
+}
+
+bool SocketEventLoopImpl::isAttached(SocketEventLoopClient* client)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	return _clients.find(client) != _clients.end();
+}
+
+void SocketEventLoopImpl::run()
+{
+	auto next_tick = std::chrono::steady_clock::now() + std::chrono::milliseconds(TICK_INTERVAL_MS);
+
+	while (_is_running)
+	{
+		bool has_ready{ false };
+		{
+			std::lock_guard<std::mutex> lock(_mtx);
+			has_ready = !_ready.empty();
+		}
+
+		// Foreign threads wake the loop, so it only has to be back for the tick.
+		uint32_t timeout_ms{ 0 };
+		auto now = std::chrono::steady_clock::now();
+		if (!has_ready && next_tick > now)
+			timeout_ms = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(next_tick - now).count()) + 1;
+
+		auto eventlist = _listener.wait(timeout_ms);
+		if (eventlist.result.code() == SocketCode::SUCCESS ||
+			eventlist.result.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			dispatch(eventlist);
+		}
+		// Otherwise poll() was interrupted or fed a stale fd; the next
+		// iteration rebuilds the snapshot from the current registrations.
+
+		now = std::chrono::steady_clock::now();
+		if (now >= next_tick)
+		{
+			next_tick = now + std::chrono::milliseconds(TICK_INTERVAL_MS);
+
+			std::vector<SocketEventLoopClient*> clients;
+			{
+				std::lock_guard<std::mutex> lock(_mtx);
+				clients.assign(_clients.begin(), _clients.end());
+			}
+			for (auto* client : clients)
+			{
+				if (isAttached(client))
+					client->onTick(now);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mtx);
+			_iteration++;
+		}
+		_iteration_cv.notify_all();
+	}
+}
+
+void SocketEventLoopImpl::dispatch(SocketEventResult& eventlist)
+{
+	std::vector<SocketEventLoopClient*> ready;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		ready.swap(_ready);
+		for (auto* client : ready)
+			client->_scheduled = false;
+	}
+
+	for (auto* client : ready)
+	{
+		if (isAttached(client))
+			client->onEvent(SocketEventType::UNDEFINED);
+	}
+
+	for (auto* context : eventlist.contexts)
+	{
+		// The listener snapshot may still reference a client that a callback
+		// earlier in this iteration detached.
+		auto* client = static_cast<SocketEventLoopClient*>(context);
+		if (client != nullptr && isAttached(client))
+			client->onEvent(client->type);
+	}
+}
@@ -0,0 +1,90 @@
+#if !defined(__BN3MONKEY__SOCKETEVENTLOOP__)
+#define __BN3MONKEY__SOCKETEVENTLOOP__
+
+#include "../SecuritySocket.hpp"
+#include "SocketEvent.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+
+namespace Bn3Monkey
+{
+    // Anything driven by a SocketEventLoopImpl. The loop hands the object back
+    // to it (on the loop thread) whenever its fd fires or it asked to be
+    // scheduled, so a single thread can progress any number of sockets.
+    class SocketEventLoopClient : public SocketEventContext
+    {
+    public:
+        virtual ~SocketEventLoopClient() {}
+
+        // fd fired (type = READ / WRITE / DISCONNECTED) or the client was
+        // scheduled (type = UNDEFINED). Must never block.
+        virtual void onEvent(SocketEventType type) = 0;
+        // Periodic hook used to expire pending operations.
+        virtual void onTick(std::chrono::steady_clock::time_point now) = 0;
+        // The loop was closed while the client was still attached.
+        virtual void onLoopClosed() = 0;
+
+    private:
+        friend class SocketEventLoopImpl;
+        // Both guarded by SocketEventLoopImpl::_mtx.
+        SocketEventType _watched{ SocketEventType::UNDEFINED };
+        bool _scheduled{ false };
+    };
+
+    class SocketEventLoopImpl
+    {
+    public:
+        SocketEventLoopImpl() {}
+        virtual ~SocketEventLoopImpl();
+
+        SocketResult open();
+        void close();
+
+        SocketResult attach(SocketEventLoopClient* client);
+        // After detach() returns, the loop never touches the client again.
+        // Called from a foreign thread it wakes the loop and blocks until the
+        // current iteration is over.
+        void detach(SocketEventLoopClient* client);
+
+        // Replace the set of events polled for client->fd. UNDEFINED takes the
+        // fd out of the polling set, so an idle socket with unread data does
+        // not keep the level-triggered poll spinning.
+        void watch(SocketEventLoopClient* client, SocketEventType type);
+        // Run client->onEvent(UNDEFINED) on the next loop iteration without
+        // waiting for its fd to fire.
+        void schedule(SocketEventLoopClient* client);
+
+    private:
+        static constexpr uint32_t TICK_INTERVAL_MS = 50;
+
+        void run();
+        void dispatch(SocketEventResult& eventlist);
+        bool isAttached(SocketEventLoopClient* client);
+        // A change made from a foreign thread is only seen once the loop's
+        // wait() ends; callbacks on the loop thread need no wakeup.
+        void wakeupFromOutside();
+
+        SocketMultiEventListener _listener;
+        std::thread _routine;
+        std::atomic<bool> _is_running{ false };
+
+        // Guards _clients, _ready, _iteration and the per-client watch state.
+        std::mutex _mtx;
+        // Signalled at the end of every iteration. detach() from a foreign
+        // thread waits on it: the listener snapshot taken by an in-flight
+        // wait() still points at the client, and the loop may be inside one
+        // of its callbacks.
+        std::condition_variable _iteration_cv;
+        uint64_t _iteration{ 0 };
+        std::unordered_set<SocketEventLoopClient*> _clients;
+        std::vector<SocketEventLoopClient*> _ready;
+    };
+}
+
+#endif // __BN3MONKEY__SOCKETEVENTLOOP__
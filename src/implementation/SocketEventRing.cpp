@@ -0,0 +1,386 @@
+#if defined(__linux__)
+#include "SocketEventRing.hpp"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+using namespace Bn3Monkey;
+
+static uint32_t toPollEvents(SocketEventType eventType)
+{
+	switch (eventType)
+	{
+	case SocketEventType::ACCEPT:
+	case SocketEventType::READ:
+		return POLLIN;
+	case SocketEventType::CONNECT:
+	case SocketEventType::READ_WRITE:
+		return POLLIN | POLLOUT;
+	case SocketEventType::WRITE:
+		return POLLOUT;
+	default:
+		return 0;
+	}
+}
+
+SocketEventRing::~SocketEventRing()
+{
+	close();
+}
+
+bool SocketEventRing::open()
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = CQ_ENTRIES;
+
+	_fd = static_cast<int32_t>(::syscall(__NR_io_uring_setup, SQ_ENTRIES, &params));
+	if (_fd < 0)
+	{
+		_fd = -1;
+		return false;
+	}
+	// Timed waits need EXT_ARG (5.11); NODROP keeps completions that do not
+	// fit the ring instead of losing them.
+	if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP))
+	{
+		close();
+		return false;
+	}
+
+	_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool is_single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (is_single_mmap)
+	{
+		if (_cq_ring_size > _sq_ring_size)
+			_sq_ring_size = _cq_ring_size;
+		_cq_ring_size = _sq_ring_size;
+	}
+
+	_sq_ring = ::mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+	if (_sq_ring == MAP_FAILED)
+	{
+		_sq_ring = nullptr;
+		close();
+		return false;
+	}
+	if (is_single_mmap)
+	{
+		_cq_ring = _sq_ring;
+	}
+	else
+	{
+		_cq_ring = ::mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+		if (_cq_ring == MAP_FAILED)
+		{
+			_cq_ring = nullptr;
+			close();
+			return false;
+		}
+	}
+	_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	void* sqes = ::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	_sqes = static_cast<io_uring_sqe*>(sqes);
+
+	auto* sq = static_cast<char*>(_sq_ring);
+	_sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+	_sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+	_sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+	_sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+	_sq_entries = params.sq_entries;
+
+	auto* cq = static_cast<char*>(_cq_ring);
+	_cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+	_cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+	_cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+	_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	return true;
+}
+
+void SocketEventRing::close()
+{
+	// Closing the ring cancels every poll still in it.
+	if (_sqes)
+		::munmap(_sqes, _sqes_size);
+	if (_cq_ring && _cq_ring != _sq_ring)
+		::munmap(_cq_ring, _cq_ring_size);
+	if (_sq_ring)
+		::munmap(_sq_ring, _sq_ring_size);
+	if (_fd >= 0)
+		::close(_fd);
+	_sqes = nullptr;
+	_cq_ring = nullptr;
+	_sq_ring = nullptr;
+	_fd = -1;
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	_registrations.clear();
+	_ids.clear();
+	_to_arm.clear();
+}
+
+SocketResult SocketEventRing::addEvent(SocketEventContext* context, SocketEventType eventType)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	auto iter = _ids.find(context);
+	if (iter != _ids.end())
+		unregisterEvent(iter->second);
+
+	uint64_t id = registerEvent(context, eventType);
+	auto& registration = _registrations[id];
+	if (!queuePoll(id, registration))
+	{
+		unregisterEvent(id);
+		return SocketResult(SocketCode::SOCKET_EVENT_CANNOT_ADDED);
+	}
+	registration.is_armed = true;
+	submitIfWaiting();
+	return SocketResult();
+}
+
+SocketResult SocketEventRing::modifyEvent(SocketEventContext* context, SocketEventType eventType)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	auto iter = _ids.find(context);
+	if (iter != _ids.end())
+	{
+		auto& registration = _registrations[iter->second];
+		if (!registration.is_armed)
+		{
+			// It fired and waits in _to_arm: the next wait() arms the new mask
+			// without a removal.
+			registration.events = toPollEvents(eventType);
+			registration.is_accept = eventType == SocketEventType::ACCEPT;
+			return SocketResult();
+		}
+		unregisterEvent(iter->second);
+	}
+
+	uint64_t id = registerEvent(context, eventType);
+	auto& registration = _registrations[id];
+	if (!queuePoll(id, registration))
+	{
+		unregisterEvent(id);
+		return SocketResult(SocketCode::SOCKET_EVENT_CANNOT_ADDED);
+	}
+	registration.is_armed = true;
+	submitIfWaiting();
+	return SocketResult();
+}
+
+SocketResult SocketEventRing::removeEvent(SocketEventContext* context)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	auto iter = _ids.find(context);
+	if (iter != _ids.end())
+	{
+		unregisterEvent(iter->second);
+		submitIfWaiting();
+	}
+	return SocketResult();
+}
+
+SocketEventResult SocketEventRing::wait(uint32_t timeout_ms)
+{
+	SocketEventResult res;
+
+	uint32_t to_submit{ 0 };
+	bool has_completions{ false };
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		size_t done{ 0 };
+		for (; done < _to_arm.size(); done++)
+		{
+			auto iter = _registrations.find(_to_arm[done]);
+			if (iter == _registrations.end() || iter->second.is_armed)
+				continue;
+			// A full queue is submitted by nextEntry(); failing past that
+			// leaves this and the rest in _to_arm for the next wait().
+			if (!queuePoll(iter->first, iter->second))
+				break;
+			iter->second.is_armed = true;
+		}
+		_to_arm.erase(_to_arm.begin(), _to_arm.begin() + static_cast<std::ptrdiff_t>(done));
+
+		to_submit = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+		has_completions = *_cq_head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+		_is_waiting = !has_completions;
+	}
+
+	if (has_completions)
+	{
+		// Events are already waiting; only hand over the re-armed polls.
+		if (to_submit > 0)
+			enter(to_submit, 0, 0, nullptr, 0);
+	}
+	else
+	{
+		__kernel_timespec timeout{};
+		timeout.tv_sec = timeout_ms / 1000;
+		timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+		io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		arg.sigmask_sz = _NSIG / 8;
+		arg.ts = reinterpret_cast<uint64_t>(&timeout);
+
+		int32_t ret = enter(to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+		_is_waiting = false;
+		// ETIME / EINTR end the wait like a timeout; EBUSY means completions
+		// are backed up and are collected below.
+		if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+		{
+			res.result = SocketResult(SocketCode::SOCKET_EVENT_ERROR);
+			return res;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		uint32_t head = *_cq_head;
+		uint32_t tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++)
+		{
+			const io_uring_cqe& cqe = _cqes[head & _cq_mask];
+			if (cqe.user_data == REMOVE_ID)
+				continue;
+			auto iter = _registrations.find(cqe.user_data);
+			if (iter == _registrations.end())
+				continue;
+
+			auto& registration = iter->second;
+			registration.is_armed = false;
+			_to_arm.push_back(iter->first);
+
+			auto* context = registration.context;
+			int32_t revents = cqe.res;
+			if (revents < 0 || revents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				// A failed poll (e.g. a descriptor closed under us) is treated
+				// like POLLNVAL by the poll() backend.
+				context->type = SocketEventType::DISCONNECTED;
+			}
+			else if (registration.is_accept && revents & POLLIN)
+			{
+				context->type = SocketEventType::ACCEPT;
+			}
+			else if (revents & POLLIN)
+			{
+				context->type = SocketEventType::READ;
+			}
+			else if (revents & POLLOUT)
+			{
+				context->type = SocketEventType::WRITE;
+			}
+			res.contexts.push_back(context);
+		}
+		__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	if (res.contexts.empty())
+		res.result = SocketResult(SocketCode::SOCKET_TIMEOUT);
+	return res;
+}
+
+uint64_t SocketEventRing::registerEvent(SocketEventContext* context, SocketEventType eventType)
+{
+	uint64_t id = _next_id++;
+	Registration registration;
+	registration.context = context;
+	registration.events = toPollEvents(eventType);
+	registration.is_accept = eventType == SocketEventType::ACCEPT;
+	_registrations.emplace(id, registration);
+	_ids[context] = id;
+	return id;
+}
+
+void SocketEventRing::unregisterEvent(uint64_t id)
+{
+	auto iter = _registrations.find(id);
+	if (iter == _registrations.end())
+		return;
+	// The kernel holds a reference to the file while a poll is armed, so the
+	// poll has to go for a close() to take effect.
+	if (iter->second.is_armed)
+		queueRemove(id);
+	_ids.erase(iter->second.context);
+	_registrations.erase(iter);
+}
+
+bool SocketEventRing::queuePoll(uint64_t id, const Registration& registration)
+{
+	auto* sqe = nextEntry();
+	if (!sqe)
+		return false;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = registration.context->fd;
+	sqe->poll32_events = registration.events;
+	sqe->user_data = id;
+	commitEntry();
+	return true;
+}
+
+bool SocketEventRing::queueRemove(uint64_t id)
+{
+	auto* sqe = nextEntry();
+	if (!sqe)
+		return false;
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = id;
+	sqe->user_data = REMOVE_ID;
+	commitEntry();
+	return true;
+}
+
+io_uring_sqe* SocketEventRing::nextEntry()
+{
+	uint32_t tail = *_sq_tail;
+	if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries)
+	{
+		// Full: hand what is queued to the kernel to make room.
+		enter(tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE), 0, 0, nullptr, 0);
+		if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries)
+			return nullptr;
+	}
+	uint32_t index = tail & _sq_mask;
+	auto* sqe = &_sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	_sq_array[index] = index;
+	return sqe;
+}
+
+void SocketEventRing::commitEntry()
+{
+	__atomic_store_n(_sq_tail, *_sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+void SocketEventRing::submitIfWaiting()
+{
+	if (!_is_waiting)
+		return;
+	uint32_t to_submit = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+	if (to_submit > 0)
+		enter(to_submit, 0, 0, nullptr, 0);
+}
+
+int32_t SocketEventRing::enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags, const void* arg, size_t arg_size)
+{
+	return static_cast<int32_t>(::syscall(__NR_io_uring_enter, _fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+#endif // __linux__
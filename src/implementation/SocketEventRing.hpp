@@ -0,0 +1,106 @@
+#if !defined(__BN3MONKEY__SOCKETEVENTRING__)
+#define __BN3MONKEY__SOCKETEVENTRING__
+
+#if defined(__linux__)
+
+#include "SocketEvent.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace Bn3Monkey
+{
+	// io_uring backend of SocketMultiEventListener, driven through the raw
+	// system calls.
+	//
+	// Every registered descriptor keeps a one-shot IORING_OP_POLL_ADD in the
+	// kernel. A poll that completed is armed again by the next wait(), in the
+	// same io_uring_enter() that waits for completions. A wait is therefore
+	// one system call however many descriptors are registered or fired, and
+	// none when completions are already in the ring. poll() copies and scans
+	// the whole set instead. One-shot polls keep poll()'s level-triggered
+	// behavior: data left unread is reported again by the next wait().
+	//
+	// Same threading as the poll() backend: one thread waits, and any thread
+	// may add, modify or remove events.
+	class SocketEventRing
+	{
+	public:
+		~SocketEventRing();
+
+		// false if the kernel has no usable io_uring (too old, or disabled).
+		bool open();
+		void close();
+
+		SocketResult addEvent(SocketEventContext* context, SocketEventType eventType);
+		SocketResult modifyEvent(SocketEventContext* context, SocketEventType eventType);
+		SocketResult removeEvent(SocketEventContext* context);
+		SocketEventResult wait(uint32_t timeout_ms);
+
+	private:
+		struct Registration
+		{
+			SocketEventContext* context{ nullptr };
+			uint32_t events{ 0 };
+			bool is_accept{ false };
+			// A poll for it is in the kernel.
+			bool is_armed{ false };
+		};
+
+		// Callers hold _mtx.
+		uint64_t registerEvent(SocketEventContext* context, SocketEventType eventType);
+		void unregisterEvent(uint64_t id);
+		bool queuePoll(uint64_t id, const Registration& registration);
+		bool queueRemove(uint64_t id);
+		io_uring_sqe* nextEntry();
+		void commitEntry();
+		// Hands queued entries to the kernel right away while another thread
+		// sleeps in wait(); otherwise that wait() submits them.
+		void submitIfWaiting();
+		int32_t enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags, const void* arg, size_t arg_size);
+
+		int32_t _fd{ -1 };
+
+		void* _sq_ring{ nullptr };
+		size_t _sq_ring_size{ 0 };
+		void* _cq_ring{ nullptr };
+		size_t _cq_ring_size{ 0 };
+		io_uring_sqe* _sqes{ nullptr };
+		size_t _sqes_size{ 0 };
+
+		uint32_t* _sq_head{ nullptr };
+		uint32_t* _sq_tail{ nullptr };
+		uint32_t* _sq_array{ nullptr };
+		uint32_t _sq_mask{ 0 };
+		uint32_t _sq_entries{ 0 };
+		uint32_t* _cq_head{ nullptr };
+		uint32_t* _cq_tail{ nullptr };
+		uint32_t _cq_mask{ 0 };
+		io_uring_cqe* _cqes{ nullptr };
+
+		std::mutex _mtx;
+		std::atomic<bool> _is_waiting{ false };
+		// user_data of a poll. A removed registration's id is never reused,
+		// so a completion that was already in the ring is simply ignored.
+		uint64_t _next_id{ 1 };
+		std::unordered_map<uint64_t, Registration> _registrations;
+		std::unordered_map<SocketEventContext*, uint64_t> _ids;
+		// Fired by the last wait(); armed again by the next one.
+		std::vector<uint64_t> _to_arm;
+
+		static constexpr uint32_t SQ_ENTRIES = 1024;
+		static constexpr uint32_t CQ_ENTRIES = 8192;
+		// user_data of POLL_REMOVE requests, whose completions are not events.
+		static constexpr uint64_t REMOVE_ID = 0;
+	};
+}
+
+#endif // __linux__
+
+#endif // __BN3MONKEY__SOCKETEVENTRING__
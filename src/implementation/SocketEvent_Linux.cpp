@@ -1,7 +1,11 @@
 #if defined(__linux__)
 #include "SocketEvent.hpp"
+#include "SocketEventRing.hpp"
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <algorithm>
 
 void SocketEventListener::open(BaseSocket& sock, SocketEventType eventType)
@@ -70,17 +74,140 @@ SocketResult SocketEventListener::wait(uint32_t timeout_ms)
 }
 
 
-SocketResult SocketMultiEventListener::open()
+SocketResult SocketMultiEventListener::open(SocketEventBackend backend)
 {
+    if (backend == SocketEventBackend::IO_URING && !_ring)
+    {
+        _ring = new SocketEventRing();
+        if (!_ring->open())
+        {
+            delete _ring;
+            _ring = nullptr;
+        }
+    }
     _handle.reserve(16);
+
+    if (!openWakeup())
+        return SocketResult(SocketCode::SOCKET_EVENT_ERROR);
+    addEvent(&_wakeup_context, SocketEventType::READ);
     return SocketResult();
 }
 void SocketMultiEventListener::close()
 {
-    // Do nothing
+    if (_wakeup_context.fd >= 0)
+        removeEvent(&_wakeup_context);
+    closeWakeup();
+
+    if (_ring)
+    {
+        _ring->close();
+        delete _ring;
+        _ring = nullptr;
+    }
+}
+bool SocketMultiEventListener::openWakeup()
+{
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd >= 0)
+        return true;
+
+    // One eventfd is both ends; a pipe is the fallback for kernels without it.
+    int32_t fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0)
+    {
+        _wakeup_context.fd = fd;
+        _wakeup_writer = fd;
+    }
+    else
+    {
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0)
+            return false;
+        _wakeup_context.fd = fds[0];
+        _wakeup_writer = fds[1];
+    }
+    _is_woken = false;
+    return true;
+}
+void SocketMultiEventListener::signalWakeup()
+{
+    // Eight bytes suit both: an eventfd only takes a uint64_t.
+    uint64_t value = 1;
+    ssize_t ret = ::write(_wakeup_writer, &value, sizeof(value));
+    // EAGAIN : the counter or pipe is full, so the descriptor is readable anyway.
+    (void)ret;
+}
+void SocketMultiEventListener::drainWakeup()
+{
+    uint64_t buffer[8];
+    while (::read(_wakeup_context.fd, buffer, sizeof(buffer)) > 0)
+    {
+    }
+}
+void SocketMultiEventListener::closeWakeup()
+{
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd < 0)
+        return;
+    if (_wakeup_writer != _wakeup_context.fd)
+        ::close(_wakeup_writer);
+    ::close(_wakeup_context.fd);
+    _wakeup_context.fd = -1;
+    _wakeup_writer = -1;
+    _posted.clear();
+}
+SocketResult SocketMultiEventListener::wakeup()
+{
+    if (_is_woken.exchange(true))
+        return SocketResult();
+
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd < 0)
+        return SocketResult(SocketCode::SOCKET_CLOSED);
+    signalWakeup();
+    return SocketResult();
+}
+SocketResult SocketMultiEventListener::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_wakeup_mtx);
+        if (_wakeup_context.fd < 0)
+            return SocketResult(SocketCode::SOCKET_CLOSED);
+        _posted.push_back(std::move(task));
+    }
+    return wakeup();
+}
+void SocketMultiEventListener::runPostedTasks()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_wakeup_mtx);
+        tasks.swap(_posted);
+    }
+    for (auto& task : tasks)
+        task();
+}
+void SocketMultiEventListener::takeWakeup(SocketEventResult& result)
+{
+    auto iter = std::find(result.contexts.begin(), result.contexts.end(), &_wakeup_context);
+    if (iter == result.contexts.end())
+        return;
+    result.contexts.erase(iter);
+
+    // Cleared before draining: a wakeup() from here on writes again, and a
+    // write the drain swallows was made after its caller's change, which
+    // the waiting thread sees once wait() returns.
+    _is_woken = false;
+    drainWakeup();
+
+    if (result.contexts.empty())
+        result.result = SocketResult(SocketCode::SOCKET_TIMEOUT);
 }
 SocketResult SocketMultiEventListener::addEvent(SocketEventContext* context, SocketEventType eventType)
 {
+    if (_ring)
+        return _ring->addEvent(context, eventType);
+
     pollfd fd;
     fd.fd = context->fd;
     
@@ -126,6 +253,9 @@ SocketResult SocketMultiEventListener::addEvent(SocketEventContext* context, Soc
 }
 SocketResult SocketMultiEventListener::modifyEvent(SocketEventContext* context, SocketEventType eventType)
 {
+    if (_ring)
+        return _ring->modifyEvent(context, eventType);
+
     // @Todo Need to change
     removeEvent(context);
     addEvent(context, eventType);
@@ -133,6 +263,9 @@ SocketResult SocketMultiEventListener::modifyEvent(SocketEventContext* context,
 }
 SocketResult SocketMultiEventListener::removeEvent(SocketEventContext* context)
 {
+    if (_ring)
+        return _ring->removeEvent(context);
+
     {
         std::lock_guard<std::mutex> lock(_mtx);
         {
@@ -156,6 +289,12 @@ SocketResult SocketMultiEventListener::removeEvent(SocketEventContext* context)
     return SocketResult();
 }
 SocketEventResult SocketMultiEventListener::wait(uint32_t timeout_ms)
+{
+    auto res = _ring ? _ring->wait(timeout_ms) : pollEvents(timeout_ms);
+    takeWakeup(res);
+    return res;
+}
+SocketEventResult SocketMultiEventListener::pollEvents(uint32_t timeout_ms)
 {
     SocketEventResult res;
     
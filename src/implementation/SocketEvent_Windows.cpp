@@ -69,14 +69,122 @@ SocketResult SocketEventListener::wait(uint32_t timeout_ms)
 }
 
 
-SocketResult SocketMultiEventListener::open()
+SocketResult SocketMultiEventListener::open(SocketEventBackend backend)
 {
+    // io_uring is Linux only.
+    (void)backend;
     _handle.reserve(16);
+
+    if (!openWakeup())
+        return SocketResult(SocketCode::SOCKET_EVENT_ERROR);
+    addEvent(&_wakeup_context, SocketEventType::READ);
     return SocketResult();
 }
 void SocketMultiEventListener::close()
 {
-    // Do nothing
+    if (_wakeup_context.fd >= 0)
+        removeEvent(&_wakeup_context);
+    closeWakeup();
+}
+bool SocketMultiEventListener::openWakeup()
+{
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd >= 0)
+        return true;
+
+    // WSAPoll only takes sockets, so the self-pipe is a loopback UDP socket
+    // connected to itself.
+    SOCKET sock = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET)
+        return false;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    int length = sizeof(address);
+    u_long non_blocking = 1;
+    if (::bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::getsockname(sock, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        ::connect(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::ioctlsocket(sock, FIONBIO, &non_blocking) != 0)
+    {
+        ::closesocket(sock);
+        return false;
+    }
+
+    _wakeup_context.fd = static_cast<int32_t>(sock);
+    _wakeup_sender = sock;
+    _is_woken = false;
+    return true;
+}
+void SocketMultiEventListener::signalWakeup()
+{
+    char value = 1;
+    // WSAEWOULDBLOCK : datagrams are already queued, so it is readable anyway.
+    ::send(_wakeup_sender, &value, 1, 0);
+}
+void SocketMultiEventListener::drainWakeup()
+{
+    char buffer[64];
+    while (::recv(_wakeup_sender, buffer, sizeof(buffer), 0) > 0)
+    {
+    }
+}
+void SocketMultiEventListener::closeWakeup()
+{
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd < 0)
+        return;
+    ::closesocket(_wakeup_sender);
+    _wakeup_context.fd = -1;
+    _wakeup_sender = INVALID_SOCKET;
+    _posted.clear();
+}
+SocketResult SocketMultiEventListener::wakeup()
+{
+    if (_is_woken.exchange(true))
+        return SocketResult();
+
+    std::lock_guard<std::mutex> lock(_wakeup_mtx);
+    if (_wakeup_context.fd < 0)
+        return SocketResult(SocketCode::SOCKET_CLOSED);
+    signalWakeup();
+    return SocketResult();
+}
+SocketResult SocketMultiEventListener::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_wakeup_mtx);
+        if (_wakeup_context.fd < 0)
+            return SocketResult(SocketCode::SOCKET_CLOSED);
+        _posted.push_back(std::move(task));
+    }
+    return wakeup();
+}
+void SocketMultiEventListener::runPostedTasks()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_wakeup_mtx);
+        tasks.swap(_posted);
+    }
+    for (auto& task : tasks)
+        task();
+}
+void SocketMultiEventListener::takeWakeup(SocketEventResult& result)
+{
+    auto iter = std::find(result.contexts.begin(), result.contexts.end(), &_wakeup_context);
+    if (iter == result.contexts.end())
+        return;
+    result.contexts.erase(iter);
+
+    // Cleared before draining, as on Linux.
+    _is_woken = false;
+    drainWakeup();
+
+    if (result.contexts.empty())
+        result.result = SocketResult(SocketCode::SOCKET_TIMEOUT);
 }
 SocketResult SocketMultiEventListener::addEvent(SocketEventContext* context, SocketEventType eventType)
 {
@@ -155,6 +263,12 @@ SocketResult SocketMultiEventListener::removeEvent(SocketEventContext* context)
     return SocketResult();
 }
 SocketEventResult SocketMultiEventListener::wait(uint32_t timeout_ms)
+{
+    auto res = pollEvents(timeout_ms);
+    takeWakeup(res);
+    return res;
+}
+SocketEventResult SocketMultiEventListener::pollEvents(uint32_t timeout_ms)
 {
     SocketEventResult res;
     
@@ -0,0 +1,122 @@
+#include "SocketFile.hpp"
+#include "SocketResult.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+using namespace Bn3Monkey;
+
+// SocketResult counts bytes in an int32_t.
+static constexpr size_t MAX_FILE_CHUNK = 1 << 30;
+
+#ifndef _WIN32
+// A pipe that would not block a read, including one whose writer is gone.
+static bool isReadable(int32_t fd)
+{
+	pollfd handle{};
+	handle.fd = fd;
+	handle.events = POLLIN;
+	return ::poll(&handle, 1, 0) > 0 && (handle.revents & (POLLIN | POLLHUP)) != 0;
+}
+#endif
+
+SocketResult Bn3Monkey::sendFile(int32_t socket, int32_t fd, int64_t offset, size_t size)
+{
+#ifdef __linux__
+	size = std::min(size, MAX_FILE_CHUNK);
+	off_t position = static_cast<off_t>(offset);
+	ssize_t ret = ::sendfile(socket, fd, &position, size);
+	if (ret < 0 && (errno == EINVAL || errno == ESPIPE))
+	{
+		// Not something sendfile() reads from; a pipe goes through splice().
+		ret = ::splice(fd, nullptr, socket, nullptr, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+	}
+	if (ret == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	// Either end may be what would block.
+	if (ret < 0 && errno == EAGAIN && !isReadable(fd))
+	{
+		return SocketResult(SocketCode::SOCKET_TIMEOUT);
+	}
+	return createResult(static_cast<int32_t>(ret));
+#else
+	(void)socket;
+	(void)fd;
+	(void)offset;
+	(void)size;
+	return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+#endif
+}
+
+SocketResult Bn3Monkey::readFile(int32_t fd, int64_t offset, void* buffer, size_t size)
+{
+	size = std::min(size, MAX_FILE_CHUNK);
+#ifdef _WIN32
+	// Pipes cannot seek, and are read from wherever they are.
+	if (isRegularFile(fd))
+		_lseeki64(fd, offset, SEEK_SET);
+	int ret = _read(fd, buffer, static_cast<unsigned int>(size));
+	if (ret < 0)
+	{
+		return SocketResult(SocketCode::UNKNOWN_ERROR, ret);
+	}
+	return SocketResult(SocketCode::SUCCESS, ret);
+#else
+	ssize_t ret = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+	if (ret < 0 && errno == ESPIPE)
+	{
+		// A pipe may not be in non-blocking mode.
+		if (!isReadable(fd))
+		{
+			return SocketResult(SocketCode::SOCKET_TIMEOUT);
+		}
+		ret = ::read(fd, buffer, size);
+	}
+	if (ret == 0)
+	{
+		return SocketResult(SocketCode::SUCCESS, 0);
+	}
+	if (ret < 0 && errno == EAGAIN)
+	{
+		return SocketResult(SocketCode::SOCKET_TIMEOUT);
+	}
+	return createResult(static_cast<int32_t>(ret));
+#endif
+}
+
+bool Bn3Monkey::isRegularFile(int32_t fd)
+{
+#ifdef _WIN32
+	struct _stat64 status;
+	return _fstat64(fd, &status) == 0 && (status.st_mode & _S_IFMT) == _S_IFREG;
+#else
+	struct stat status;
+	return ::fstat(fd, &status) == 0 && S_ISREG(status.st_mode);
+#endif
+}
+
+void Bn3Monkey::closeFile(int32_t fd)
+{
+	if (fd < 0)
+		return;
+#ifdef _WIN32
+	_close(fd);
+#else
+	::close(fd);
+#endif
+}
@@ -0,0 +1,26 @@
+#if !defined(__BN3MONKEY__SOCKETFILE__)
+#define __BN3MONKEY__SOCKETFILE__
+
+#include "../SecuritySocket.hpp"
+
+#include <cstdint>
+
+namespace Bn3Monkey
+{
+	// Streams files into sockets for SocketFileRange. Every call is
+	// non-blocking on both ends. Besides the usual codes:
+	// - SOCKET_TIMEOUT : fd is a pipe with nothing in it yet.
+	// - SUCCESS with 0 bytes : fd has ended.
+
+	// Up to size bytes of fd from offset into the socket without a copy
+	// through user space: sendfile() for files, splice() for pipes.
+	// SOCKET_INVALID_ARGUMENT when the platform cannot do that for fd.
+	SocketResult sendFile(int32_t socket, int32_t fd, int64_t offset, size_t size);
+	// Copies up to size bytes of fd from offset into buffer.
+	SocketResult readFile(int32_t fd, int64_t offset, void* buffer, size_t size);
+
+	bool isRegularFile(int32_t fd);
+	void closeFile(int32_t fd);
+}
+
+#endif // __BN3MONKEY__SOCKETFILE__
@@ -0,0 +1,181 @@
+#include "SocketMetrics.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+namespace
+{
+	// The last few SocketMetrics this thread recorded to. A server thread
+	// only ever records to its own server; the cache is for threads that
+	// call write() on several broadcast servers.
+	struct SocketMetricsShardCache
+	{
+		static constexpr size_t SIZE = 4;
+
+		struct Entry
+		{
+			uint64_t id{ 0 };
+			std::shared_ptr<SocketMetricsShard> shard;
+		};
+		Entry entries[SIZE];
+		size_t next{ 0 };
+
+		~SocketMetricsShardCache()
+		{
+			for (auto& entry : entries)
+			{
+				if (entry.shard)
+					entry.shard->is_owned.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local SocketMetricsShardCache shard_cache;
+	std::atomic<uint64_t> next_metrics_id{ 1 };
+
+	inline void storeMax(std::atomic<uint64_t>& field, uint64_t value)
+	{
+		if (value > field.load(std::memory_order_relaxed))
+			field.store(value, std::memory_order_relaxed);
+	}
+}
+
+SocketMetrics::SocketMetrics() : _id(next_metrics_id.fetch_add(1))
+{
+}
+
+SocketMetricsShard& SocketMetrics::shard()
+{
+	for (auto& entry : shard_cache.entries)
+	{
+		if (entry.id == _id)
+			return *entry.shard;
+	}
+	return acquireShard();
+}
+
+SocketMetricsShard& SocketMetrics::acquireShard()
+{
+	std::shared_ptr<SocketMetricsShard> shard;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		for (auto& candidate : _shards)
+		{
+			// Acquire pairs with the release of the thread that gave it up,
+			// so its last updates are seen before this thread adds to them.
+			bool is_owned{ false };
+			if (candidate->is_owned.compare_exchange_strong(is_owned, true, std::memory_order_acquire))
+			{
+				shard = candidate;
+				break;
+			}
+		}
+		if (!shard)
+		{
+			shard.reset(new SocketMetricsShard);
+			shard->is_owned.store(true, std::memory_order_relaxed);
+			_shards.push_back(shard);
+		}
+	}
+
+	auto& entry = shard_cache.entries[shard_cache.next++ % SocketMetricsShardCache::SIZE];
+	if (entry.shard)
+		entry.shard->is_owned.store(false, std::memory_order_release);
+	entry.id = _id;
+	entry.shard = shard;
+	return *shard;
+}
+
+void SocketMetrics::record(SocketLatency latency, std::chrono::steady_clock::duration duration)
+{
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+
+	auto& histogram = shard().histograms[static_cast<size_t>(latency)];
+	auto& bucket = histogram.buckets[SocketLatencyHistogram::bucketOf(value)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	histogram.count.store(histogram.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	histogram.sum_ns.store(histogram.sum_ns.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	storeMax(histogram.max_ns, value);
+}
+
+void SocketMetrics::snapshot(SocketServerMetrics& metrics) const
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+
+	uint64_t counters[static_cast<size_t>(SocketCounter::COUNT)]{ 0 };
+	SocketLatencyHistogram* histograms[] = { &metrics.request_service_time, &metrics.broadcast_fanout_time };
+
+	for (auto& shard : _shards)
+	{
+		for (size_t i = 0; i < static_cast<size_t>(SocketCounter::COUNT); i++)
+			counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+
+		for (size_t i = 0; i < static_cast<size_t>(SocketLatency::COUNT); i++)
+		{
+			auto& source = shard->histograms[i];
+			auto* target = histograms[i];
+			target->count += source.count.load(std::memory_order_relaxed);
+			target->sum_ns += source.sum_ns.load(std::memory_order_relaxed);
+			target->max_ns = std::max(target->max_ns, source.max_ns.load(std::memory_order_relaxed));
+			for (size_t bucket = 0; bucket < SocketLatencyHistogram::NUM_OF_BUCKETS; bucket++)
+				target->buckets[bucket] += source.buckets[bucket].load(std::memory_order_relaxed);
+		}
+	}
+
+	metrics.accepted_connections = counters[static_cast<size_t>(SocketCounter::ACCEPTED_CONNECTIONS)];
+	metrics.closed_connections = counters[static_cast<size_t>(SocketCounter::CLOSED_CONNECTIONS)];
+	metrics.timed_out_connections = counters[static_cast<size_t>(SocketCounter::TIMED_OUT_CONNECTIONS)];
+	metrics.bytes_received = counters[static_cast<size_t>(SocketCounter::BYTES_RECEIVED)];
+	metrics.bytes_sent = counters[static_cast<size_t>(SocketCounter::BYTES_SENT)];
+	for (size_t mode = 0; mode < 4; mode++)
+		metrics.requests[mode] = counters[static_cast<size_t>(SocketCounter::FAST_REQUESTS) + mode];
+	metrics.datagrams_received = counters[static_cast<size_t>(SocketCounter::DATAGRAMS_RECEIVED)];
+	metrics.event_loop_wakeups = counters[static_cast<size_t>(SocketCounter::EVENT_LOOP_WAKEUPS)];
+	metrics.processing_time_ns = counters[static_cast<size_t>(SocketCounter::PROCESSING_TIME_NS)];
+}
+
+size_t SocketLatencyHistogram::bucketOf(uint64_t ns)
+{
+	constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+	if (ns < SUB_BUCKETS)
+		return static_cast<size_t>(ns);
+
+	uint32_t length{ 0 };
+	for (uint64_t value = ns; value; value >>= 1)
+		length++;
+	// The top SUB_BUCKET_BITS bits pick the bucket within the row of this
+	// power of two. Their top bit is always set, so a row only uses its upper
+	// half.
+	uint32_t shift = length - static_cast<uint32_t>(SUB_BUCKET_BITS);
+	size_t bucket = static_cast<size_t>((static_cast<uint64_t>(shift) << SUB_BUCKET_BITS) + (ns >> shift));
+	return std::min(bucket, NUM_OF_BUCKETS - 1);
+}
+
+uint64_t SocketLatencyHistogram::upperBoundOf(size_t bucket)
+{
+	constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+	uint64_t shift = bucket >> SUB_BUCKET_BITS;
+	uint64_t sub_bucket = bucket & (SUB_BUCKETS - 1);
+	return ((sub_bucket + 1) << shift) - 1;
+}
+
+uint64_t SocketLatencyHistogram::percentile(double percentile) const
+{
+	if (count == 0)
+		return 0;
+	uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+	rank = std::max<uint64_t>(1, std::min(rank, count));
+
+	uint64_t seen{ 0 };
+	for (size_t bucket = 0; bucket < NUM_OF_BUCKETS; bucket++)
+	{
+		seen += buckets[bucket];
+		if (seen >= rank)
+			return std::min(upperBoundOf(bucket), max_ns);
+	}
+	return max_ns;
+}
@@ -0,0 +1,105 @@
+#if !defined(__BN3MONKEY__SOCKETMETRICS__)
+#define __BN3MONKEY__SOCKETMETRICS__
+
+#include "../SecuritySocket.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Bn3Monkey
+{
+	enum class SocketCounter : size_t
+	{
+		ACCEPTED_CONNECTIONS,
+		CLOSED_CONNECTIONS,
+		TIMED_OUT_CONNECTIONS,
+		BYTES_RECEIVED,
+		BYTES_SENT,
+		// One per SocketRequestMode, in its order.
+		FAST_REQUESTS,
+		SLOW_REQUESTS,
+		READ_STREAM_REQUESTS,
+		WRITE_STREAM_REQUESTS,
+		EVENT_LOOP_WAKEUPS,
+		PROCESSING_TIME_NS,
+		DATAGRAMS_RECEIVED,
+		COUNT
+	};
+
+	enum class SocketLatency : size_t
+	{
+		REQUEST_SERVICE_TIME,
+		BROADCAST_FANOUT_TIME,
+		COUNT
+	};
+
+	// The counters of one thread. Only the thread that owns the shard writes
+	// to it, so an update is a relaxed load and store: no lock and no
+	// read-modify-write. Each shard is a separate allocation. Readers
+	// load every field and may see a shard mid-update, which a monotonic
+	// counter tolerates.
+	struct SocketMetricsShard
+	{
+		struct Histogram
+		{
+			std::atomic<uint64_t> count{ 0 };
+			std::atomic<uint64_t> sum_ns{ 0 };
+			std::atomic<uint64_t> max_ns{ 0 };
+			std::atomic<uint64_t> buckets[SocketLatencyHistogram::NUM_OF_BUCKETS];
+
+			Histogram() {
+				for (auto& bucket : buckets)
+					bucket.store(0, std::memory_order_relaxed);
+			}
+		};
+
+		std::atomic<uint64_t> counters[static_cast<size_t>(SocketCounter::COUNT)];
+		Histogram histograms[static_cast<size_t>(SocketLatency::COUNT)];
+		// Taken by a thread; released when the thread exits or forgets it.
+		std::atomic<bool> is_owned{ false };
+
+		SocketMetricsShard() {
+			for (auto& counter : counters)
+				counter.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Per-thread counters and latency histograms of a server, added up by
+	// snapshot(). Any thread may record; each one gets a shard of its own
+	// the first time, and the shard of an exited thread goes to the next
+	// new one, so threads that come and go do not grow the set.
+	class SocketMetrics
+	{
+	public:
+		SocketMetrics();
+
+		inline void add(SocketCounter counter, uint64_t value)
+		{
+			auto& field = shard().counters[static_cast<size_t>(counter)];
+			field.store(field.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+		inline void addRequest(SocketRequestMode mode)
+		{
+			add(static_cast<SocketCounter>(static_cast<size_t>(SocketCounter::FAST_REQUESTS) + static_cast<size_t>(mode)), 1);
+		}
+		void record(SocketLatency latency, std::chrono::steady_clock::duration duration);
+
+		void snapshot(SocketServerMetrics& metrics) const;
+
+	private:
+		SocketMetricsShard& shard();
+		SocketMetricsShard& acquireShard();
+
+		// Unique over the process, unlike `this`, so a thread's cached shard
+		// never matches a later SocketMetrics at the same address.
+		uint64_t _id;
+		mutable std::mutex _mtx;
+		std::vector<std::shared_ptr<SocketMetricsShard>> _shards;
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETMETRICS__
@@ -0,0 +1,274 @@
+#include "SocketMultiplexClient.hpp"
+#include "SocketResult.hpp"
+#include "SocketHelper.hpp"
+
+#include <chrono>
+
+using namespace Bn3Monkey;
+
+SocketMultiplexClientImpl::~SocketMultiplexClientImpl()
+{
+	close();
+}
+
+SocketResult SocketMultiplexClientImpl::open()
+{
+	if (_is_running || _reader.joinable())
+	{
+		return SocketResult(SocketCode::SOCKET_ALREADY_CONNECTED);
+	}
+
+	auto result = _client.open();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+	result = _client.connect();
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		// Or the next open() leaks this socket.
+		_client.close();
+		return result;
+	}
+
+	// From here on the reader thread and the requesters share the socket, so
+	// neither may block inside read() / write() while holding _io_mtx.
+	_socket = _client.socket();
+	setNonBlockingMode(_socket->descriptor());
+	// Requests go out as soon as they are written; nothing would flush them.
+	_socket->setWriteCoalescing(0);
+
+	_is_running = true;
+	_reader = std::thread{ &SocketMultiplexClientImpl::run, this };
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void SocketMultiplexClientImpl::close()
+{
+	_is_running = false;
+	_window_cv.notify_all();
+	if (_reader.joinable())
+		_reader.join();
+
+	{
+		// A request already past the window may still be writing.
+		std::lock_guard<std::mutex> write_lock(_write_mtx);
+		std::lock_guard<std::mutex> io_lock(_io_mtx);
+		if (_socket)
+		{
+			_client.close();
+			_socket = nullptr;
+		}
+	}
+	failAll(SocketResult(SocketCode::SOCKET_CLOSED));
+}
+
+std::future<SocketMultiplexResponse> SocketMultiplexClientImpl::request(const void* buffer, size_t size)
+{
+	std::promise<SocketMultiplexResponse> promise;
+	auto future = promise.get_future();
+
+	uint64_t id{ 0 };
+	{
+		std::unique_lock<std::mutex> lock(_mtx);
+		// Backpressure: wait for a slot in the window for as long as a
+		// blocking write would have waited.
+		uint32_t retries = _configuration.max_retries() > 0 ? _configuration.max_retries() : 1;
+		auto budget = std::chrono::milliseconds(static_cast<uint64_t>(_configuration.write_timeout()) * retries);
+		bool has_slot = _window_cv.wait_for(lock, budget, [&]() {
+			return !_is_running || _pending.size() < _window;
+			});
+
+		SocketResult rejected{ SocketCode::SUCCESS };
+		if (!_is_running)
+			rejected = SocketResult(SocketCode::SOCKET_CLOSED);
+		else if (!has_slot)
+			rejected = SocketResult(SocketCode::SOCKET_TIMEOUT);
+
+		if (rejected.code() != SocketCode::SUCCESS)
+		{
+			lock.unlock();
+			SocketMultiplexResponse response;
+			response.result = rejected;
+			promise.set_value(std::move(response));
+			return future;
+		}
+
+		id = _next_id++;
+		_pending.emplace(id, std::move(promise));
+	}
+
+	std::vector<char> message(static_cast<const char*>(buffer), static_cast<const char*>(buffer) + size);
+	_codec->setRequestId(message.data(), message.size(), id);
+
+	SocketResult result;
+	{
+		std::lock_guard<std::mutex> lock(_write_mtx);
+		result = writeFully(message.data(), message.size());
+	}
+
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		// A partially written request leaves the stream out of sync: the
+		// connection cannot be used any more.
+		_is_running = false;
+		failAll(result);
+	}
+	return future;
+}
+
+size_t SocketMultiplexClientImpl::outstanding()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	return _pending.size();
+}
+
+void SocketMultiplexClientImpl::run()
+{
+	SocketResult result{ SocketCode::SUCCESS };
+	std::vector<char> header(_codec->getResponseHeaderSize());
+
+	while (_is_running)
+	{
+		result = readFully(header.data(), header.size());
+		if (result.code() != SocketCode::SUCCESS)
+			break;
+
+		SocketMultiplexResponse response;
+		response.payload.resize(_codec->getResponsePayloadSize(header.data()));
+		result = readFully(response.payload.data(), response.payload.size());
+		if (result.code() != SocketCode::SUCCESS)
+			break;
+		response.header = header;
+		response.result = SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(response.payload.size()));
+
+		std::promise<SocketMultiplexResponse> promise;
+		bool is_found{ false };
+		{
+			std::lock_guard<std::mutex> lock(_mtx);
+			auto iter = _pending.find(_codec->getResponseId(header.data()));
+			if (iter != _pending.end())
+			{
+				promise = std::move(iter->second);
+				_pending.erase(iter);
+				is_found = true;
+			}
+		}
+		// A response nobody waits for (unknown id) is dropped.
+		if (is_found)
+		{
+			_window_cv.notify_all();
+			promise.set_value(std::move(response));
+		}
+	}
+
+	if (_is_running)
+	{
+		// The peer closed or the connection broke under us.
+		_is_running = false;
+		failAll(result);
+	}
+}
+
+SocketResult SocketMultiplexClientImpl::readFully(char* buffer, size_t size)
+{
+	size_t received{ 0 };
+	while (received < size)
+	{
+		if (!_is_running)
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED);
+		}
+
+		SocketResult result;
+		{
+			std::lock_guard<std::mutex> lock(_io_mtx);
+			result = _socket->read(buffer + received, size - received);
+		}
+
+		if (result.code() == SocketCode::SUCCESS && result.bytes() > 0)
+		{
+			received += static_cast<size_t>(result.bytes());
+			continue;
+		}
+		if (result.code() == SocketCode::SUCCESS)
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED);
+		}
+		if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED &&
+			result.code() != SocketCode::SOCKET_TIMEOUT)
+		{
+			return result;
+		}
+
+		SocketEventListener listener;
+		listener.open(*_socket, _socket->pendingEvent());
+		auto waited = listener.wait(READER_POLL_SLICE_MS);
+		if (waited.code() != SocketCode::SUCCESS && waited.code() != SocketCode::SOCKET_TIMEOUT)
+		{
+			return waited;
+		}
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(received));
+}
+
+SocketResult SocketMultiplexClientImpl::writeFully(const char* buffer, size_t size)
+{
+	size_t written{ 0 };
+	uint32_t timeouts{ 0 };
+	while (written < size)
+	{
+		SocketResult result;
+		ClientActiveSocket* socket{ nullptr };
+		{
+			std::lock_guard<std::mutex> lock(_io_mtx);
+			if (!_is_running || !_socket)
+				return SocketResult(SocketCode::SOCKET_CLOSED, static_cast<int32_t>(written));
+			socket = _socket;
+			result = socket->write(buffer + written, size - written);
+		}
+
+		if (result.code() == SocketCode::SUCCESS)
+		{
+			written += static_cast<size_t>(result.bytes());
+			continue;
+		}
+		if (result.code() != SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED &&
+			result.code() != SocketCode::SOCKET_TIMEOUT)
+		{
+			return SocketResult(result.code(), static_cast<int32_t>(written));
+		}
+
+		// close() takes _write_mtx before it frees the socket.
+		SocketEventListener listener;
+		listener.open(*socket, SocketEventType::WRITE);
+		auto waited = listener.wait(_configuration.write_timeout());
+		if (waited.code() == SocketCode::SOCKET_TIMEOUT)
+		{
+			if (++timeouts >= _configuration.max_retries())
+				return SocketResult(SocketCode::SOCKET_TIMEOUT, static_cast<int32_t>(written));
+		}
+		else if (waited.code() != SocketCode::SUCCESS)
+		{
+			return SocketResult(waited.code(), static_cast<int32_t>(written));
+		}
+	}
+	return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(written));
+}
+
+void SocketMultiplexClientImpl::failAll(SocketResult result)
+{
+	std::unordered_map<uint64_t, std::promise<SocketMultiplexResponse>> pending;
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		pending.swap(_pending);
+	}
+	_window_cv.notify_all();
+
+	for (auto& entry : pending)
+	{
+		SocketMultiplexResponse response;
+		response.result = result;
+		entry.second.set_value(std::move(response));
+	}
+}
@@ -0,0 +1,66 @@
+#if !defined(__BN3MONKEY__SOCKETMULTIPLEXCLIENT__)
+#define __BN3MONKEY__SOCKETMULTIPLEXCLIENT__
+
+#include "../SecuritySocket.hpp"
+#include "SocketClient.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+namespace Bn3Monkey
+{
+	class SocketMultiplexClientImpl
+	{
+	public:
+		SocketMultiplexClientImpl(const SocketConfiguration& configuration, SocketMultiplexCodec* codec, size_t window)
+			: _configuration(configuration), _client(configuration), _codec(codec), _window(window == 0 ? 1 : window) {}
+		SocketMultiplexClientImpl(const SocketConfiguration& configuration, const SocketTLSClientConfiguration& tls_configuration, SocketMultiplexCodec* codec, size_t window)
+			: _configuration(configuration), _client(configuration, tls_configuration), _codec(codec), _window(window == 0 ? 1 : window) {}
+		virtual ~SocketMultiplexClientImpl();
+
+		SocketResult open();
+		void close();
+
+		std::future<SocketMultiplexResponse> request(const void* buffer, size_t size);
+		size_t outstanding();
+
+	private:
+		// Upper bound on how long close() waits for the reader thread.
+		static constexpr uint32_t READER_POLL_SLICE_MS = 100;
+
+		void run();
+		// Reads until `size` bytes arrived. SOCKET_TIMEOUT only means the
+		// reader is being stopped.
+		SocketResult readFully(char* buffer, size_t size);
+		SocketResult writeFully(const char* buffer, size_t size);
+		void failAll(SocketResult result);
+
+		SocketConfiguration _configuration;
+		SocketClientImpl _client;
+		ClientActiveSocket* _socket{ nullptr };
+		SocketMultiplexCodec* _codec;
+		size_t _window;
+
+		std::atomic<bool> _is_running{ false };
+		std::thread _reader;
+
+		// One OpenSSL object must not be used by two threads at once, so every
+		// read() / write() on the socket is serialized. poll() is done outside.
+		std::mutex _io_mtx;
+		// Keeps whole requests contiguous on the wire.
+		std::mutex _write_mtx;
+
+		// Guards the fields below.
+		std::mutex _mtx;
+		std::condition_variable _window_cv;
+		uint64_t _next_id{ 1 };
+		std::unordered_map<uint64_t, std::promise<SocketMultiplexResponse>> _pending;
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETMULTIPLEXCLIENT__
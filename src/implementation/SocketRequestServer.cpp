@@ -1,5 +1,6 @@
 #include "SocketRequestServer.hpp"
 #include "SocketResult.hpp"
+#include "SocketDescriptor.hpp"
 #include <vector>
 #include <queue>
 
@@ -10,16 +11,17 @@ Bn3Monkey::SocketRequestServerImpl::~SocketRequestServerImpl()
 
 Bn3Monkey::SocketResult Bn3Monkey::SocketRequestServerImpl::open(SocketRequestHandler* handler, size_t num_of_clients)
 {
-	(void)num_of_clients;
-
 	if (_is_running)
 	{
 		return SocketResult(SocketCode::SOCKET_SERVER_ALREADY_RUNNING);
 	}
 
+	// Connections beyond the pool are closed as soon as they are accepted.
+	_socket_connection_pool.reserve(num_of_clients);
+
 	SocketResult result = SocketResult(SocketCode::SUCCESS);
 
-	_container = PassiveSocketContainer(_tls_configuration.valid(), _configuration.is_unix_domain());
+	_container = PassiveSocketContainer(_tls_configuration.valid(), _configuration.is_unix_domain(), _tls_configuration);
 	_socket = _container.get();
 	result = _socket->valid();
 	if (result.code() != SocketCode::SUCCESS)
@@ -44,6 +46,17 @@ Bn3Monkey::SocketResult Bn3Monkey::SocketRequestServerImpl::open(SocketRequestHa
 		return result;
 	}
 
+	result = _listener.open(_configuration.event_backend());
+	if (result.code() != SocketCode::SUCCESS)
+	{
+		return result;
+	}
+
+	if (_tls_configuration.valid())
+	{
+		_handshake_pool.open(_tls_configuration.handshakeThreads(), &_listener);
+	}
+
 	_is_running = true;
 	_routine = std::thread{ &SocketRequestServerImpl::run, this, handler };
 	return result;
@@ -54,9 +67,19 @@ void Bn3Monkey::SocketRequestServerImpl::close()
 	if (_is_running)
 	{
 		_is_running = false;
+		_listener.wakeup();
 		_routine.join();
 
 		_socket->close();
+		// Tasks still queued are dropped with it.
+		_listener.close();
+
+		// Descriptors adopt() queued after the server thread last looked.
+		std::lock_guard<std::mutex> lock(_adoption_mutex);
+		for (auto descriptor : _adoptions)
+			closeDescriptor(descriptor);
+		_adoptions.clear();
+		_has_adoptions = false;
 	}
 }
 
@@ -64,17 +87,33 @@ void Bn3Monkey::SocketRequestServerImpl::close()
 
 void Bn3Monkey::SocketRequestServerImpl::run(SocketRequestHandler* handler)
 {
-	SocketMultiEventListener listener;
-	listener.open();
-
 	SocketEventContext server_context;
 	server_context.fd = _socket->descriptor();
-	listener.addEvent(&server_context, SocketEventType::ACCEPT);
+	_listener.addEvent(&server_context, SocketEventType::ACCEPT);
 
+	// Connections whose SLOW-mode request is still in the handler. They are
+	// out of the listener until the handler completes them.
+	std::list<SocketConnection*> processing;
 
+	_now = std::chrono::steady_clock::now();
 	while (_is_running)
 	{
-		auto eventlist = listener.wait(_configuration.read_timeout());
+		// Before the wait, so no connection closed here is left in an event
+		// list. _now is a dispatch behind, which only makes timers a little late.
+		_listener.runPostedTasks();
+		adoptDescriptors(handler, processing);
+		expireTimers(_listener, processing);
+
+		// SLOW-mode completions, finished handshakes, post() and close() all
+		// wake the wait, so it only has to end for the next timer.
+		SOCKET_TRACE_BEGIN(wait_begin);
+		auto eventlist = _listener.wait(_timers.timeout(_configuration.read_timeout()));
+		SOCKET_TRACE_COMPLETE(WAIT, this, wait_begin, eventlist.contexts.size());
+		_now = std::chrono::steady_clock::now();
+		_metrics.add(SocketCounter::EVENT_LOOP_WAKEUPS, 1);
+		resumeProcessedConnections(_listener, processing);
+		adoptHandshakes(_listener, processing);
+
 		if (eventlist.result.code() == SocketCode::SOCKET_TIMEOUT)
 		{
 			continue;
@@ -87,6 +126,28 @@ void Bn3Monkey::SocketRequestServerImpl::run(SocketRequestHandler* handler)
 
 		for (auto& context : eventlist.contexts)
 		{
+			if (!_file_waits.empty())
+			{
+				auto waiting = _file_waits.find(context);
+				if (waiting != _file_waits.end())
+				{
+					// The pipe being streamed has data, or its writer is gone.
+					auto* connection = waiting->second;
+					connection->last_activity = _now;
+					if (!serve(_listener, connection, processing))
+					{
+						connection->disconnectClient();
+						_listener.removeEvent(connection);
+						releaseConnection(connection);
+					}
+					else
+					{
+						armTimer(connection);
+					}
+					continue;
+				}
+			}
+
 			auto& type = context->type;
 
 			switch (type)
@@ -94,85 +155,518 @@ void Bn3Monkey::SocketRequestServerImpl::run(SocketRequestHandler* handler)
 			case SocketEventType::ACCEPT:
 			{
 				auto socket_container = _socket->accept();
-				auto* client_socket = socket_container.get();
-				if (client_socket->result().code() == SocketCode::SUCCESS)
-				{
-					SocketConnection* connection = _socket_connection_pool.acquire(socket_container, *handler, _configuration.pdu_size());
-					connection->connectClient();
-					listener.addEvent(connection, Bn3Monkey::SocketEventType::READ);
-				}
+				acceptConnection(socket_container, handler, processing, true);
 			}
 			break;
 			case SocketEventType::DISCONNECTED:
 			{
 				auto* connection = static_cast<SocketConnection*>(context);
 				connection->disconnectClient();
-				listener.removeEvent(connection);
-				_socket_connection_pool.release(connection);
+				_listener.removeEvent(connection);
+				releaseConnection(connection);
 			}
 			break;
 
 			case SocketEventType::READ:
+			case SocketEventType::WRITE:
 			{
 				auto* connection = static_cast<SocketConnection*>(context);
-				switch (connection->state)
+				connection->last_activity = _now;
+				bool is_served = serve(_listener, connection, processing);
+				// Before a connection that passed descriptors and left is released.
+				adoptPassedDescriptors(connection, handler, processing);
+				if (!is_served)
 				{
-				case SocketConnection::ProcessState::READING_HEADER:
-					{
-						connection->state = connection->readHeader();
-						if (connection->state == SocketConnection::ProcessState::WRITING_RESPONSE) {
-							listener.modifyEvent(connection, Bn3Monkey::SocketEventType::WRITE);
-						}
-						else if (connection->state == SocketConnection::ProcessState::FINISH_PROCESS) {
-							connection->flush();
-							connection->state = SocketConnection::ProcessState::READING_HEADER;
-						}
-					}
-					break;
-				case SocketConnection::ProcessState::READING_PAYLOAD:
-					{
-						connection->state = connection->readPayload();
-						if (connection->state == SocketConnection::ProcessState::WRITING_RESPONSE) {
-							listener.modifyEvent(connection, Bn3Monkey::SocketEventType::WRITE);
-						}
-						else if (connection->state == SocketConnection::ProcessState::FINISH_PROCESS) {
-							connection->flush();
-							connection->state = SocketConnection::ProcessState::READING_HEADER;
-						}
-					}
-					break;
-
-				default:
-					break;
+					connection->disconnectClient();
+					_listener.removeEvent(connection);
+					releaseConnection(connection);
+				}
+				else
+				{
+					armTimer(connection);
 				}
 			}
 			break;
 
-			case SocketEventType::WRITE :
+			default:
+				break;
+			}
+		}
+
+	}
+
+	for (auto* connection : processing)
+	{
+		connection->abandonCompletion();
+	}
+
+	// Anything the pool still holds is reported as failed once it stops.
+	_handshake_pool.close();
+	std::vector<TLSHandshakePool::Finished> finished;
+	_handshake_pool.collect(finished);
+	for (auto& entry : finished)
+	{
+		auto* connection = static_cast<SocketConnection*>(entry.context);
+		connection->disconnectClient();
+		releaseConnection(connection);
+	}
+
+	_listener.removeEvent(&server_context);
+	_timers.clear();
+	_application_timers.clear();
+	_file_waits.clear();
+}
+
+void Bn3Monkey::SocketRequestServerImpl::acceptConnection(ServerActiveSocketContainer& socket_container, SocketRequestHandler* handler, std::list<SocketConnection*>& processing, bool is_accepted)
+{
+	auto* client_socket = socket_container.get();
+	if (client_socket->result().code() == SocketCode::SUCCESS)
+	{
+		_metrics.add(SocketCounter::ACCEPTED_CONNECTIONS, 1);
+		SocketConnection* connection = _socket_connection_pool.acquire(socket_container, *handler, _configuration.pdu_size(), _metrics, _listener);
+		if (!connection)
+		{
+			client_socket->close();
+			_metrics.add(SocketCounter::CLOSED_CONNECTIONS, 1);
+			return;
+		}
+		SOCKET_TRACE_INSTANT(ACCEPT, connection, connection->fd);
+		// Every connection starts out handshaking; plain ones finish at once.
+		SOCKET_TRACE_STATE(connection, SocketConnection::ProcessState::CLOSED, SocketConnection::ProcessState::HANDSHAKING);
+		connection->state = SocketConnection::ProcessState::HANDSHAKING;
+		connection->timer.kind = static_cast<uint32_t>(TimerKind::CONNECTION);
+		connection->timer.context = connection;
+		connection->last_activity = _now;
+		// Adopted descriptors need not be unix domain connections.
+		if (is_accepted && _configuration.is_unix_domain() && !_tls_configuration.valid())
+		{
+			// The client's shared-memory offer is taken as its handshake.
+			if (_configuration.shared_memory_size() > 0)
+				connection->socket()->acceptSharedMemory();
+			if (_configuration.descriptor_passing())
+				connection->socket()->receiveDescriptors();
+		}
+
+		connection->handshake_deadline = std::chrono::steady_clock::now() +
+			std::chrono::milliseconds(static_cast<uint64_t>(_configuration.read_timeout()) * _configuration.max_retries());
+		if (_handshake_pool.isRunning())
+		{
+			// Stays out of the listener until adoptHandshakes() takes it back.
+			_handshake_pool.submit(connection, connection->socket(), connection->handshake_deadline);
+			return;
+		}
+
+		// Plain connections are done at once; TLS ones usually wait
+		// for the ClientHello.
+		connection->moveTo(connection->handshake());
+		if (connection->state == SocketConnection::ProcessState::CLOSED)
+		{
+			connection->disconnectClient();
+			releaseConnection(connection);
+		}
+		else if (connection->state == SocketConnection::ProcessState::HANDSHAKING)
+		{
+			_listener.addEvent(connection, connection->pendingEvent());
+			armTimer(connection);
+		}
+		else
+		{
+			_listener.addEvent(connection, Bn3Monkey::SocketEventType::READ);
+			// TLS early data may have come with the ClientHello.
+			if (connection->hasBufferedInput() && !serve(_listener, connection, processing))
 			{
-				auto connection = static_cast<SocketConnection*>(context);
-				switch (connection->state) {
-					case SocketConnection::ProcessState::WRITING_RESPONSE:
-					{
-						connection->state = connection->writeResponse();
-						if (connection->state == SocketConnection::ProcessState::FINISH_PROCESS) {
-							connection->flush();
-							listener.modifyEvent(connection, Bn3Monkey::SocketEventType::READ);
-							connection->state = SocketConnection::ProcessState::READING_HEADER;
-						}
-					}
-						break;
-					default:
-						break;
-				}
+				connection->disconnectClient();
+				_listener.removeEvent(connection);
+				releaseConnection(connection);
 			}
+			else
+			{
+				armTimer(connection);
+			}
+		}
+	}
+	else if (client_socket->descriptor() >= 0)
+	{
+		client_socket->close();
+	}
+}
 
-			default:
-				break;
+SocketResult Bn3Monkey::SocketRequestServerImpl::adopt(int32_t descriptor)
+{
+	if (!isStreamSocket(descriptor))
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+	{
+		std::lock_guard<std::mutex> lock(_adoption_mutex);
+		if (!_is_running)
+		{
+			return SocketResult(SocketCode::SOCKET_CLOSED);
+		}
+		_adoptions.push_back(descriptor);
+		_has_adoptions = true;
+	}
+	_listener.wakeup();
+	return SocketResult(SocketCode::SUCCESS);
+}
+
+void Bn3Monkey::SocketRequestServerImpl::adoptDescriptors(SocketRequestHandler* handler, std::list<SocketConnection*>& processing)
+{
+	if (!_has_adoptions)
+	{
+		return;
+	}
+	std::vector<int32_t> descriptors;
+	{
+		std::lock_guard<std::mutex> lock(_adoption_mutex);
+		descriptors.swap(_adoptions);
+		_has_adoptions = false;
+	}
+	for (auto descriptor : descriptors)
+	{
+		auto socket_container = _socket->adopt(descriptor);
+		acceptConnection(socket_container, handler, processing, false);
+	}
+}
+
+void Bn3Monkey::SocketRequestServerImpl::adoptPassedDescriptors(SocketConnection* connection, SocketRequestHandler* handler, std::list<SocketConnection*>& processing)
+{
+	for (int32_t descriptor = connection->socket()->takeDescriptor(); descriptor >= 0; descriptor = connection->socket()->takeDescriptor())
+	{
+		// Whatever the client sent, only a stream socket can be served.
+		if (!isStreamSocket(descriptor))
+		{
+			closeDescriptor(descriptor);
+			continue;
+		}
+		auto socket_container = _socket->adopt(descriptor);
+		acceptConnection(socket_container, handler, processing, false);
+	}
+}
+
+bool Bn3Monkey::SocketRequestServerImpl::serve(SocketMultiEventListener& listener, SocketConnection* connection, std::list<SocketConnection*>& processing)
+{
+	using ProcessState = SocketConnection::ProcessState;
+
+	if (connection->state == ProcessState::HANDSHAKING)
+	{
+		connection->moveTo(connection->handshake());
+		if (connection->state == ProcessState::CLOSED)
+		{
+			return false;
+		}
+		if (connection->state == ProcessState::HANDSHAKING)
+		{
+			// OpenSSL may have to flush its own flight before it reads again.
+			listener.modifyEvent(connection, connection->pendingEvent());
+			return true;
+		}
+		listener.modifyEvent(connection, Bn3Monkey::SocketEventType::READ);
+		if (!connection->hasBufferedInput())
+		{
+			return true;
+		}
+	}
+
+	if (connection->state == ProcessState::WRITING_RESPONSE || connection->state == ProcessState::WRITING_FILE)
+	{
+		if (connection->state == ProcessState::WRITING_RESPONSE)
+		{
+			connection->moveTo(connection->writeResponse());
+		}
+		if (connection->state == ProcessState::WRITING_FILE)
+		{
+			connection->moveTo(connection->writeFile());
+		}
+		if (connection->state == ProcessState::CLOSED)
+		{
+			return false;
+		}
+		watchFile(listener, connection);
+		if (connection->state != ProcessState::FINISH_PROCESS)
+		{
+			// A full shared-memory ring is waited out on READ, as the socket
+			// is always writable. type is the event that brought us here.
+			auto event = connection->writeEvent();
+			if (!connection->isWaitingForFile() && event != connection->type)
+			{
+				listener.modifyEvent(connection, event);
+			}
+			return true;
+		}
+		connection->flush();
+		listener.modifyEvent(connection, Bn3Monkey::SocketEventType::READ);
+		if (!connection->hasBufferedInput())
+		{
+			return true;
+		}
+	}
+
+	// poll() only reports what is still in the kernel, so keep going while a
+	// decrypted TLS record holds more than the last read took.
+	do
+	{
+		switch (connection->state)
+		{
+		case ProcessState::READING_HEADER:
+			connection->moveTo(connection->readHeader());
+			break;
+		case ProcessState::READING_PAYLOAD:
+			connection->moveTo(connection->readPayload());
+			break;
+		default:
+			return true;
+		}
+
+		switch (connection->state)
+		{
+		case ProcessState::CLOSED:
+			return false;
+		case ProcessState::PROCESSING:
+			connection->processing_start = _now;
+			listener.removeEvent(connection);
+			processing.push_back(connection);
+			return true;
+		case ProcessState::WRITING_RESPONSE:
+			listener.modifyEvent(connection, Bn3Monkey::SocketEventType::WRITE);
+			return true;
+		case ProcessState::FINISH_PROCESS:
+			connection->flush();
+			break;
+		default:
+			break;
+		}
+	} while (connection->hasBufferedInput());
+
+	return true;
+}
+
+void Bn3Monkey::SocketRequestServerImpl::adoptHandshakes(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing)
+{
+	using ProcessState = SocketConnection::ProcessState;
+
+	if (!_handshake_pool.isRunning())
+	{
+		return;
+	}
+
+	std::vector<TLSHandshakePool::Finished> finished;
+	_handshake_pool.collect(finished);
+	for (auto& entry : finished)
+	{
+		auto* connection = static_cast<SocketConnection*>(entry.context);
+		// The handshake is already complete, so this only reports the client.
+		connection->moveTo(entry.is_established ? connection->handshake() : ProcessState::CLOSED);
+		if (connection->state == ProcessState::READING_HEADER)
+		{
+			connection->last_activity = _now;
+			listener.addEvent(connection, Bn3Monkey::SocketEventType::READ);
+			// A request sent right behind the handshake may already be decrypted.
+			if (!connection->hasBufferedInput() || serve(listener, connection, processing))
+			{
+				armTimer(connection);
+				continue;
 			}
+			listener.removeEvent(connection);
+		}
+		connection->disconnectClient();
+		releaseConnection(connection);
+	}
+}
+
+void Bn3Monkey::SocketRequestServerImpl::resumeProcessedConnections(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing)
+{
+	for (auto iter = processing.begin(); iter != processing.end(); )
+	{
+		auto* connection = *iter;
+		connection->moveTo(connection->pollCompletion());
+		if (connection->state == SocketConnection::ProcessState::PROCESSING)
+		{
+			++iter;
+			continue;
+		}
+		iter = processing.erase(iter);
+
+		if (connection->state == SocketConnection::ProcessState::WRITING_RESPONSE) {
+			listener.addEvent(connection, Bn3Monkey::SocketEventType::WRITE);
+		}
+		else {
+			connection->flush();
+			listener.addEvent(connection, Bn3Monkey::SocketEventType::READ);
+		}
+		connection->last_activity = _now;
+		armTimer(connection);
+	}
+}
+
+void Bn3Monkey::SocketRequestServerImpl::watchFile(SocketMultiEventListener& listener, SocketConnection* connection)
+{
+	auto* file_event = &connection->file_event;
+	bool is_watched = _file_waits.count(file_event) > 0;
+	if (connection->isWaitingForFile() == is_watched)
+	{
+		return;
+	}
+	if (!is_watched)
+	{
+		// The socket stays writable meanwhile; leave it out.
+		listener.removeEvent(connection);
+		listener.addEvent(file_event, Bn3Monkey::SocketEventType::READ);
+		_file_waits[file_event] = connection;
+		return;
+	}
+	listener.removeEvent(file_event);
+	_file_waits.erase(file_event);
+	listener.addEvent(connection, Bn3Monkey::SocketEventType::WRITE);
+}
+
+void Bn3Monkey::SocketRequestServerImpl::releaseConnection(SocketConnection* connection)
+{
+	if (_file_waits.erase(&connection->file_event) > 0)
+	{
+		_listener.removeEvent(&connection->file_event);
+	}
+	_timers.cancel(connection->timer);
+	_socket_connection_pool.release(connection);
+}
+
+bool Bn3Monkey::SocketRequestServerImpl::deadlineOf(SocketConnection* connection, std::chrono::steady_clock::time_point& deadline)
+{
+	using ProcessState = SocketConnection::ProcessState;
+
+	bool has_deadline{ false };
+	auto limit = [&](std::chrono::steady_clock::time_point since, uint32_t timeout_ms) {
+		if (timeout_ms == 0)
+			return;
+		auto candidate = since + std::chrono::milliseconds(timeout_ms);
+		if (!has_deadline || candidate < deadline)
+			deadline = candidate;
+		has_deadline = true;
+	};
+
+	switch (connection->state)
+	{
+	case ProcessState::HANDSHAKING:
+		deadline = connection->handshake_deadline;
+		return true;
+	case ProcessState::READING_HEADER:
+	case ProcessState::READING_PAYLOAD:
+		limit(connection->last_activity, _configuration.idle_timeout());
+		if (connection->isReadingRequest())
+			limit(connection->requestStart(), _configuration.request_read_timeout());
+		break;
+	case ProcessState::PROCESSING:
+		limit(connection->processing_start, _configuration.processing_timeout());
+		break;
+	case ProcessState::WRITING_RESPONSE:
+	case ProcessState::WRITING_FILE:
+		limit(connection->last_activity, _configuration.idle_timeout());
+		break;
+	default:
+		break;
+	}
+	return has_deadline;
+}
+
+void Bn3Monkey::SocketRequestServerImpl::armTimer(SocketConnection* connection)
+{
+	std::chrono::steady_clock::time_point deadline;
+	if (!deadlineOf(connection, deadline))
+	{
+		_timers.cancel(connection->timer);
+		return;
+	}
+	if (!connection->timer.isPending() || _timers.tickOf(deadline) < connection->timer.expiry)
+	{
+		_timers.schedule(connection->timer, deadline);
+	}
+}
+
+void Bn3Monkey::SocketRequestServerImpl::expireTimers(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing)
+{
+	using ProcessState = SocketConnection::ProcessState;
+
+	_timers.advance(_now, [&](SocketTimer& timer) {
+		if (timer.kind == static_cast<uint32_t>(TimerKind::APPLICATION))
+		{
+			auto* application_timer = static_cast<ApplicationTimer*>(timer.context);
+			auto callback = std::move(application_timer->callback);
+			_application_timers.erase(application_timer->id);
+			callback();
+			return;
+		}
+
+		auto* connection = static_cast<SocketConnection*>(timer.context);
+		std::chrono::steady_clock::time_point deadline;
+		if (!deadlineOf(connection, deadline))
+		{
+			return;
+		}
+		if (deadline > _now)
+		{
+			// Activity since the timer was set moved the deadline on.
+			_timers.schedule(connection->timer, deadline);
+			return;
 		}
 
+		if (connection->state == ProcessState::PROCESSING)
+		{
+			// The handler's complete() now fails with SOCKET_CLOSED.
+			processing.remove(connection);
+			connection->abandonCompletion();
+		}
+		else
+		{
+			listener.removeEvent(connection);
+		}
+		_metrics.add(SocketCounter::TIMED_OUT_CONNECTIONS, 1);
+		connection->disconnectClient();
+		releaseConnection(connection);
+	});
+}
+
+uint64_t Bn3Monkey::SocketRequestServerImpl::addTimer(uint32_t delay_ms, SocketTimerCallback callback)
+{
+	if (!_is_running || !callback)
+	{
+		return 0;
 	}
 
-	listener.close();
+	uint64_t id = _next_timer_id.fetch_add(1);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+	auto result = _listener.post([this, id, deadline, callback]() mutable {
+		std::unique_ptr<ApplicationTimer> timer{ new ApplicationTimer };
+		timer->timer.kind = static_cast<uint32_t>(TimerKind::APPLICATION);
+		timer->timer.context = timer.get();
+		timer->id = id;
+		timer->callback = std::move(callback);
+		_timers.schedule(timer->timer, deadline);
+		_application_timers[id] = std::move(timer);
+	});
+	return result.code() == SocketCode::SUCCESS ? id : 0;
+}
+
+void Bn3Monkey::SocketRequestServerImpl::cancelTimer(uint64_t timer_id)
+{
+	_listener.post([this, timer_id]() {
+		auto iter = _application_timers.find(timer_id);
+		if (iter != _application_timers.end())
+		{
+			_timers.cancel(iter->second->timer);
+			_application_timers.erase(iter);
+		}
+	});
+}
+
+Bn3Monkey::SocketResult Bn3Monkey::SocketRequestServerImpl::post(std::function<void()> task)
+{
+	if (!task)
+	{
+		return SocketResult(SocketCode::SOCKET_INVALID_ARGUMENT);
+	}
+	if (!_is_running)
+	{
+		return SocketResult(SocketCode::SOCKET_CLOSED);
+	}
+	return _listener.post(std::move(task));
 }
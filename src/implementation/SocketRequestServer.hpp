@@ -7,13 +7,18 @@
 #include "ServerActiveSocket.hpp"
 #include "SocketEvent.hpp"
 #include "SocketConnection.hpp"
+#include "TLSHandshakePool.hpp"
 #include "ObjectPool.hpp"
+#include "SocketMetrics.hpp"
+#include "SocketTimerWheel.hpp"
 
 #include <atomic>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 namespace Bn3Monkey
 {
@@ -28,6 +33,14 @@ namespace Bn3Monkey
 		SocketResult open(SocketRequestHandler* handler, size_t num_of_clients);
 		void close();
 
+		inline void snapshot(SocketServerMetrics& metrics) const { _metrics.snapshot(metrics); }
+		inline SocketEventBackend eventBackend() const { return _listener.backend(); }
+
+		uint64_t addTimer(uint32_t delay_ms, SocketTimerCallback callback);
+		void cancelTimer(uint64_t timer_id);
+		SocketResult post(std::function<void()> task);
+		SocketResult adopt(int32_t descriptor);
+
 	private:
 		PassiveSocketContainer _container;
 		PassiveSocket* _socket{ nullptr };
@@ -37,10 +50,72 @@ namespace Bn3Monkey
 
 		std::atomic<bool> _is_running{ false };
 		std::thread _routine;
+		// Open from open() to close(), so any thread may wake the server
+		// thread or post() to it meanwhile.
+		SocketMultiEventListener _listener;
+
+		// Kept across open() / close() for the life of the server.
+		SocketMetrics _metrics;
 			
+		// Grown to num_of_clients by open(); never smaller than this.
 		ObjectPool<SocketConnection> _socket_connection_pool {32};
+		// Only running when SocketTLSServerConfiguration::handshakeThreads() > 0.
+		TLSHandshakePool _handshake_pool;
+
+		enum class TimerKind : uint32_t
+		{
+			CONNECTION,
+			APPLICATION
+		};
+		struct ApplicationTimer
+		{
+			SocketTimer timer;
+			uint64_t id{ 0 };
+			SocketTimerCallback callback;
+		};
+		// The rest is the server thread's.
+		SocketTimerWheel _timers;
+		std::unordered_map<uint64_t, std::unique_ptr<ApplicationTimer>> _application_timers;
+		// When the last wait returned.
+		std::chrono::steady_clock::time_point _now;
+		// file_event of connections waiting for the pipe they stream.
+		std::unordered_map<SocketEventContext*, SocketConnection*> _file_waits;
+
+		std::atomic<uint64_t> _next_timer_id{ 1 };
+
+		// Descriptors from adopt(), for the server thread to take in.
+		std::mutex _adoption_mutex;
+		std::vector<int32_t> _adoptions;
+		std::atomic<bool> _has_adoptions{ false };
 
 		void run(SocketRequestHandler* handler);
+		// Advances a connection on READ / WRITE. false once it has to be dropped.
+		bool serve(SocketMultiEventListener& listener, SocketConnection* connection, std::list<SocketConnection*>& processing);
+		// Takes a socket from accept() or adopt() into the listener.
+		// is_accepted : one of the server's own clients, not a descriptor
+		// adopted from elsewhere.
+		void acceptConnection(ServerActiveSocketContainer& socket_container, SocketRequestHandler* handler, std::list<SocketConnection*>& processing, bool is_accepted);
+		// Descriptors queued by adopt().
+		void adoptDescriptors(SocketRequestHandler* handler, std::list<SocketConnection*>& processing);
+		// Descriptors the connection's client passed with its bytes.
+		void adoptPassedDescriptors(SocketConnection* connection, SocketRequestHandler* handler, std::list<SocketConnection*>& processing);
+		void resumeProcessedConnections(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing);
+		// Takes back connections whose handshake ended in the pool.
+		void adoptHandshakes(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing);
+		// Cancels the connection's timer and file_event as well.
+		void releaseConnection(SocketConnection* connection);
+		// Moves the connection's event between its socket and file_event as
+		// isWaitingForFile() changes.
+		void watchFile(SocketMultiEventListener& listener, SocketConnection* connection);
+
+		// The earliest deadline of the connection's state; false if none.
+		bool deadlineOf(SocketConnection* connection, std::chrono::steady_clock::time_point& deadline);
+		// Brings the connection's timer forward to deadlineOf(). A later
+		// deadline is left to expireTimers(), which looks again when the
+		// timer fires, so a busy connection does not touch the wheel.
+		void armTimer(SocketConnection* connection);
+		// Runs due application timers and closes connections past a deadline.
+		void expireTimers(SocketMultiEventListener& listener, std::list<SocketConnection*>& processing);
 	};
 
 	// @Todo Limit the number of request workers to the number of core and distribute socket to limited workers
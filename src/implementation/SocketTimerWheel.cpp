@@ -0,0 +1,128 @@
+#include "SocketTimerWheel.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+SocketTimerWheel::SocketTimerWheel() : _origin(std::chrono::steady_clock::now()), _slots(LEVELS * SLOTS)
+{
+	for (auto& head : _slots)
+	{
+		head.prev = &head;
+		head.next = &head;
+	}
+}
+
+SocketTimerWheel::~SocketTimerWheel()
+{
+	// Owners may outlive the wheel; leave none of them pointing into it.
+	clear();
+}
+
+void SocketTimerWheel::clear()
+{
+	for (auto& head : _slots)
+	{
+		while (head.next != &head)
+			cancel(*head.next);
+	}
+}
+
+uint64_t SocketTimerWheel::tickOf(std::chrono::steady_clock::time_point time) const
+{
+	if (time <= _origin)
+		return 0;
+	// Rounded up, so a timer never fires before its deadline.
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - _origin).count();
+	return static_cast<uint64_t>((ns + 999999) / 1000000);
+}
+
+void SocketTimerWheel::schedule(SocketTimer& timer, std::chrono::steady_clock::time_point deadline)
+{
+	if (timer.isPending())
+		cancel(timer);
+	timer.expiry = std::max(tickOf(deadline), _now + 1);
+	insert(timer);
+	_size++;
+}
+
+void SocketTimerWheel::cancel(SocketTimer& timer)
+{
+	if (!timer.isPending())
+		return;
+	unlink(timer);
+	_size--;
+}
+
+void SocketTimerWheel::insert(SocketTimer& timer)
+{
+	constexpr uint64_t MAX_DELAY = (1ull << (SLOT_BITS * LEVELS)) - 1;
+	uint64_t delay = std::min(timer.expiry - _now, MAX_DELAY);
+	uint64_t slot_tick = _now + delay;
+
+	size_t level = 0;
+	while (level + 1 < LEVELS && delay >= (1ull << (SLOT_BITS * (level + 1))))
+		level++;
+	size_t slot = static_cast<size_t>((slot_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+	SocketTimer& head = _slots[level * SLOTS + slot];
+	timer.prev = head.prev;
+	timer.next = &head;
+	head.prev->next = &timer;
+	head.prev = &timer;
+}
+
+void SocketTimerWheel::unlink(SocketTimer& timer)
+{
+	timer.prev->next = timer.next;
+	timer.next->prev = timer.prev;
+	timer.prev = nullptr;
+	timer.next = nullptr;
+}
+
+void SocketTimerWheel::cascade()
+{
+	for (size_t level = 1; level < LEVELS; level++)
+	{
+		// Level n's slot starts when every level below has wrapped around.
+		if ((_now & ((1ull << (SLOT_BITS * level)) - 1)) != 0)
+			return;
+
+		size_t slot = static_cast<size_t>((_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+		SocketTimer& head = _slots[level * SLOTS + slot];
+		while (head.next != &head)
+		{
+			SocketTimer* timer = head.next;
+			unlink(*timer);
+			insert(*timer);
+		}
+	}
+}
+
+uint32_t SocketTimerWheel::timeout(uint32_t max_ms) const
+{
+	if (_size == 0)
+		return max_ms;
+
+	// The first non-empty slot of each level, which is either due (level 0)
+	// or cascades down at the start of its span. Nothing is due before the
+	// earliest of these.
+	uint64_t wakeup = UINT64_MAX;
+	for (size_t level = 0; level < LEVELS; level++)
+	{
+		uint64_t span = _now >> (SLOT_BITS * level);
+		for (uint64_t step = 1; step <= SLOTS; step++)
+		{
+			const SocketTimer& head = _slots[level * SLOTS + ((span + step) & (SLOTS - 1))];
+			if (head.next != &head)
+			{
+				wakeup = std::min(wakeup, (span + step) << (SLOT_BITS * level));
+				break;
+			}
+		}
+	}
+
+	// Ticks are rounded up, so a wait of that long may end a little short of
+	// the tick; the next advance() then finds nothing and the loop waits again.
+	return static_cast<uint32_t>(std::min<uint64_t>(wakeup - _now, max_ms));
+}
@@ -0,0 +1,115 @@
+#if !defined(__BN3MONKEY__SOCKETTIMERWHEEL__)
+#define __BN3MONKEY__SOCKETTIMERWHEEL__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Bn3Monkey
+{
+	// A node of SocketTimerWheel, kept inside whatever it times. Not pending
+	// while next is nullptr.
+	struct SocketTimer
+	{
+		SocketTimer* prev{ nullptr };
+		SocketTimer* next{ nullptr };
+		// Tick (ms since the wheel started) the timer is due at.
+		uint64_t expiry{ 0 };
+		// What the owner keeps the timer for, and for whom.
+		uint32_t kind{ 0 };
+		void* context{ nullptr };
+
+		inline bool isPending() const { return next != nullptr; }
+	};
+
+	// Hierarchical timing wheel with 1 ms ticks: LEVELS levels of SLOTS slots.
+	// A timer goes into the level whose span covers its delay, and moves down
+	// a level each time the level below wraps around, so schedule() and
+	// cancel() are O(1) and advance() only looks at the slots it passes.
+	// Delays beyond the top level (about 4.6 hours) go round it again.
+	// Not thread-safe; it belongs to one event loop thread.
+	class SocketTimerWheel
+	{
+	public:
+		static constexpr size_t SLOT_BITS = 6;
+		static constexpr size_t SLOTS = 1 << SLOT_BITS;
+		static constexpr size_t LEVELS = 4;
+
+		SocketTimerWheel();
+		~SocketTimerWheel();
+
+		SocketTimerWheel(const SocketTimerWheel&) = delete;
+		SocketTimerWheel& operator=(const SocketTimerWheel&) = delete;
+
+		// (Re)schedules the timer; a deadline already passed is due on the
+		// next advance().
+		void schedule(SocketTimer& timer, std::chrono::steady_clock::time_point deadline);
+		void cancel(SocketTimer& timer);
+		// Cancels every timer.
+		void clear();
+
+		// Milliseconds the event loop may wait before advance() may find a
+		// due timer, at most max_ms.
+		uint32_t timeout(uint32_t max_ms) const;
+
+		// Moves the wheel to `now` and calls on_expired(SocketTimer&) for each
+		// due timer, which is no longer pending by then. on_expired may
+		// schedule and cancel any timer.
+		template<typename OnExpired>
+		void advance(std::chrono::steady_clock::time_point now, OnExpired&& on_expired)
+		{
+			uint64_t target = tickOf(now);
+			if (_size == 0)
+			{
+				_now = target > _now ? target : _now;
+				return;
+			}
+
+			while (_now < target)
+			{
+				_now++;
+				cascade();
+
+				SocketTimer& head = _slots[_now & (SLOTS - 1)];
+				while (head.next != &head)
+				{
+					SocketTimer* timer = head.next;
+					if (timer->expiry > _now)
+					{
+						// Went round the top level; not due yet.
+						unlink(*timer);
+						insert(*timer);
+						continue;
+					}
+					cancel(*timer);
+					on_expired(*timer);
+				}
+				if (_size == 0)
+				{
+					_now = target;
+					break;
+				}
+			}
+		}
+
+		inline size_t size() const { return _size; }
+		// The tick a deadline falls on, as in SocketTimer::expiry.
+		uint64_t tickOf(std::chrono::steady_clock::time_point time) const;
+
+	private:
+		std::chrono::steady_clock::time_point _origin;
+		// The last tick advance() went through.
+		uint64_t _now{ 0 };
+		size_t _size{ 0 };
+		// LEVELS * SLOTS list heads.
+		std::vector<SocketTimer> _slots;
+
+		void insert(SocketTimer& timer);
+		void unlink(SocketTimer& timer);
+		// Moves the timers of the upper slots that start at _now one level down.
+		void cascade();
+	};
+}
+
+#endif // __BN3MONKEY__SOCKETTIMERWHEEL__
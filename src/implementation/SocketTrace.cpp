@@ -0,0 +1,185 @@
+#include "SocketTrace.hpp"
+
+#if defined(SECURITYSOCKET_TRACE)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace Bn3Monkey;
+
+namespace
+{
+	struct SocketTraceRing
+	{
+		// Written by the owning thread only; a record is complete once head
+		// has moved past it.
+		SocketTraceRecord records[SocketTrace::RING_CAPACITY];
+		std::atomic<uint64_t> head{ 0 };
+		std::atomic<bool> is_owned{ false };
+		uint32_t thread_id{ 0 };
+	};
+
+	std::mutex rings_mtx;
+	std::vector<std::shared_ptr<SocketTraceRing>> rings;
+	std::atomic<uint32_t> next_thread_id{ 1 };
+
+	std::shared_ptr<SocketTraceRing> acquireRing()
+	{
+		std::lock_guard<std::mutex> lock(rings_mtx);
+		for (auto& ring : rings)
+		{
+			bool is_owned{ false };
+			if (ring->is_owned.compare_exchange_strong(is_owned, true, std::memory_order_acquire))
+			{
+				ring->thread_id = next_thread_id.fetch_add(1);
+				return ring;
+			}
+		}
+		std::shared_ptr<SocketTraceRing> ring{ new SocketTraceRing };
+		ring->is_owned.store(true, std::memory_order_relaxed);
+		ring->thread_id = next_thread_id.fetch_add(1);
+		rings.push_back(ring);
+		return ring;
+	}
+
+	struct SocketTraceRingHolder
+	{
+		std::shared_ptr<SocketTraceRing> ring;
+
+		~SocketTraceRingHolder()
+		{
+			if (ring)
+				ring->is_owned.store(false, std::memory_order_release);
+		}
+	};
+
+	thread_local SocketTraceRingHolder ring_holder;
+
+	const char* EVENT_NAMES[] = { "accept", "wait", "state", "broadcast write", "broadcast send" };
+	static_assert(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == static_cast<size_t>(SocketTraceEvent::COUNT), "Every SocketTraceEvent needs a name");
+
+	// In SocketConnection::ProcessState order.
+	const char* STATE_NAMES[] = { "HANDSHAKING", "READING_HEADER", "READING_PAYLOAD", "PROCESSING", "WRITING_RESPONSE", "WRITING_FILE", "FINISH_PROCESS", "CLOSED" };
+	constexpr uint8_t CLOSED_STATE = 7;
+
+	inline const char* stateName(uint8_t state)
+	{
+		return state < sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]) ? STATE_NAMES[state] : "UNKNOWN";
+	}
+}
+
+uint64_t SocketTrace::now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void SocketTrace::write(SocketTraceEvent event, const void* object, uint64_t timestamp_ns, uint64_t duration_ns, uint32_t argument, uint8_t from, uint8_t to)
+{
+	auto& ring = ring_holder.ring;
+	if (!ring)
+		ring = acquireRing();
+
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	auto& record = ring->records[head & (RING_CAPACITY - 1)];
+	record.timestamp_ns = timestamp_ns;
+	record.object = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object));
+	record.duration_ns = static_cast<uint32_t>(std::min<uint64_t>(duration_ns, UINT32_MAX));
+	record.argument = argument;
+	record.thread_id = ring->thread_id;
+	record.event = event;
+	record.from = from;
+	record.to = to;
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool SocketTrace::dump(const char* path)
+{
+	std::vector<SocketTraceRecord> records;
+	{
+		std::lock_guard<std::mutex> lock(rings_mtx);
+		std::vector<SocketTraceRecord> copied;
+		for (auto& ring : rings)
+		{
+			uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t tail = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+			copied.clear();
+			for (uint64_t index = tail; index < head; index++)
+				copied.push_back(ring->records[index & (RING_CAPACITY - 1)]);
+
+			// The owner kept writing while the records were copied; whatever
+			// it reached again has been overwritten.
+			uint64_t last_head = ring->head.load(std::memory_order_acquire);
+			uint64_t valid_tail = last_head > RING_CAPACITY ? last_head - RING_CAPACITY : 0;
+			size_t skip = static_cast<size_t>(std::min(head, std::max(tail, valid_tail)) - tail);
+			records.insert(records.end(), copied.begin() + skip, copied.end());
+		}
+	}
+
+	FILE* file = ::fopen(path, "w");
+	if (!file)
+		return false;
+
+	std::sort(records.begin(), records.end(), [](const SocketTraceRecord& lhs, const SocketTraceRecord& rhs) {
+		return lhs.timestamp_ns < rhs.timestamp_ns;
+	});
+	uint64_t origin = records.empty() ? 0 : records.front().timestamp_ns;
+
+	::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	bool is_first{ true };
+	auto begin = [&](const char* phase, const char* name, const SocketTraceRecord& record) {
+		::fprintf(file, "%s\n{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%.3f",
+			is_first ? "" : ",", phase, name, record.thread_id, static_cast<double>(record.timestamp_ns - origin) / 1000.0);
+		is_first = false;
+	};
+
+	for (auto& record : records)
+	{
+		switch (record.event)
+		{
+		case SocketTraceEvent::ACCEPT:
+			begin("i", EVENT_NAMES[static_cast<size_t>(record.event)], record);
+			::fprintf(file, ",\"s\":\"t\",\"args\":{\"object\":\"0x%" PRIx64 "\",\"fd\":%" PRIu32 "}}", record.object, record.argument);
+			break;
+		case SocketTraceEvent::WAIT:
+		case SocketTraceEvent::BROADCAST_WRITE:
+		case SocketTraceEvent::BROADCAST_SEND:
+		{
+			const char* argument_name = record.event == SocketTraceEvent::WAIT ? "events" :
+				record.event == SocketTraceEvent::BROADCAST_WRITE ? "clients" : "bytes";
+			begin("X", EVENT_NAMES[static_cast<size_t>(record.event)], record);
+			::fprintf(file, ",\"dur\":%.3f,\"args\":{\"object\":\"0x%" PRIx64 "\",\"%s\":%" PRIu32 "}}",
+				static_cast<double>(record.duration_ns) / 1000.0, record.object, argument_name, record.argument);
+			break;
+		}
+		case SocketTraceEvent::CONNECTION_STATE:
+			// Each state is an async slice on the connection's own track,
+			// ended by the next transition.
+			if (record.from != CLOSED_STATE)
+			{
+				begin("e", stateName(record.from), record);
+				::fprintf(file, ",\"cat\":\"connection\",\"id\":\"0x%" PRIx64 "\"}", record.object);
+			}
+			if (record.to != CLOSED_STATE)
+			{
+				begin("b", stateName(record.to), record);
+				::fprintf(file, ",\"cat\":\"connection\",\"id\":\"0x%" PRIx64 "\"}", record.object);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	::fprintf(file, "\n]}\n");
+
+	bool is_written = ::ferror(file) == 0;
+	return ::fclose(file) == 0 && is_written;
+}
+
+#endif // SECURITYSOCKET_TRACE
@@ -0,0 +1,94 @@
+#if !defined(__BN3MONKEY__SOCKETTRACE__)
+#define __BN3MONKEY__SOCKETTRACE__
+
+// Trace points on the server hot paths. They are compiled in only with
+// SECURITYSOCKET_TRACE (CMake option SECURITYSOCKET_USING_TRACE). Without it
+// every SOCKET_TRACE_* macro expands to nothing, arguments included, so a
+// trace point costs nothing at all.
+//
+// SOCKET_TRACE_BEGIN(variable)                        : start of a timed span
+// SOCKET_TRACE_COMPLETE(event, object, begin, arg)    : end of that span
+// SOCKET_TRACE_INSTANT(event, object, arg)            : a point in time
+// SOCKET_TRACE_STATE(object, from, to)                : SocketConnection state change
+//
+// `object` tells apart the connections / clients / servers an event is about.
+
+#if defined(SECURITYSOCKET_TRACE)
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Bn3Monkey
+{
+	enum class SocketTraceEvent : uint8_t
+	{
+		// A connection was accepted. arg : fd
+		ACCEPT,
+		// The server thread's event wait returned. arg : fired events
+		WAIT,
+		// SocketConnection::ProcessState changed.
+		CONNECTION_STATE,
+		// SocketBroadcastServer::write() took its snapshot of the clients and
+		// ran to the end. arg : clients
+		BROADCAST_WRITE,
+		// One client's part of a broadcast write(). arg : bytes sent
+		BROADCAST_SEND,
+		COUNT
+	};
+
+	// One event in a thread's ring. 32 bytes.
+	struct SocketTraceRecord
+	{
+		uint64_t timestamp_ns;
+		uint64_t object;
+		// 0 for instants; spans of 4.29 s and more are clamped.
+		uint32_t duration_ns;
+		uint32_t argument;
+		uint32_t thread_id;
+		SocketTraceEvent event;
+		// CONNECTION_STATE : previous and next ProcessState.
+		uint8_t from;
+		uint8_t to;
+	};
+
+	// Every thread writes to a ring of its own, so recording takes no lock
+	// and no atomic read-modify-write. A full ring overwrites its oldest
+	// records. Rings outlive their threads; the ring of an exited thread is
+	// handed to the next new one.
+	namespace SocketTrace
+	{
+		static constexpr size_t RING_CAPACITY = 1 << 16;
+
+		uint64_t now();
+		void write(SocketTraceEvent event, const void* object, uint64_t timestamp_ns, uint64_t duration_ns, uint32_t argument, uint8_t from = 0, uint8_t to = 0);
+		// Chrome trace-event JSON of every ring. Records overwritten while
+		// this runs are skipped.
+		bool dump(const char* path);
+	}
+}
+
+#define SOCKET_TRACE_BEGIN(variable) \
+	uint64_t variable = Bn3Monkey::SocketTrace::now()
+#define SOCKET_TRACE_COMPLETE(event, object, begin, argument) \
+	do { \
+		uint64_t socket_trace_end = Bn3Monkey::SocketTrace::now(); \
+		Bn3Monkey::SocketTrace::write(Bn3Monkey::SocketTraceEvent::event, object, begin, socket_trace_end - (begin), static_cast<uint32_t>(argument)); \
+	} while (0)
+#define SOCKET_TRACE_INSTANT(event, object, argument) \
+	Bn3Monkey::SocketTrace::write(Bn3Monkey::SocketTraceEvent::event, object, Bn3Monkey::SocketTrace::now(), 0, static_cast<uint32_t>(argument))
+#define SOCKET_TRACE_STATE(object, from, to) \
+	do { \
+		if ((from) != (to)) \
+			Bn3Monkey::SocketTrace::write(Bn3Monkey::SocketTraceEvent::CONNECTION_STATE, object, Bn3Monkey::SocketTrace::now(), 0, 0, static_cast<uint8_t>(from), static_cast<uint8_t>(to)); \
+	} while (0)
+
+#else
+
+#define SOCKET_TRACE_BEGIN(variable)
+#define SOCKET_TRACE_COMPLETE(event, object, begin, argument)
+#define SOCKET_TRACE_INSTANT(event, object, argument)
+#define SOCKET_TRACE_STATE(object, from, to)
+
+#endif // SECURITYSOCKET_TRACE
+
+#endif // __BN3MONKEY__SOCKETTRACE__
@@ -0,0 +1,403 @@
+#include "TLSContext.hpp"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#include <WS2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#endif
+
+using namespace Bn3Monkey;
+
+std::mutex TLSClientContextCache::_mtx;
+std::unordered_map<std::string, SSL_CTX*> TLSClientContextCache::_contexts;
+std::unordered_map<SSL_CTX*, std::unordered_map<std::string, SSL_SESSION*>> TLSClientContextCache::_sessions;
+
+// "host:port" (or the socket path) of the peer the SSL object is attached to.
+// host is the SNI the client sends, so virtual hosts behind one address keep
+// sessions of their own; the numeric address without one.
+static bool getPeerKey(const SSL* ssl, std::string& key)
+{
+	sockaddr_storage address{};
+	socklen_t length = sizeof(address);
+	if (::getpeername(SSL_get_fd(ssl), reinterpret_cast<sockaddr*>(&address), &length) != 0)
+		return false;
+
+#ifndef _WIN32
+	if (address.ss_family == AF_UNIX)
+	{
+		key = reinterpret_cast<const sockaddr_un*>(&address)->sun_path;
+		return true;
+	}
+#endif
+
+	char host[NI_MAXHOST]{ 0 };
+	char port[NI_MAXSERV]{ 0 };
+	if (getnameinfo(reinterpret_cast<sockaddr*>(&address), length, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+		return false;
+	const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+	key = server_name != nullptr ? server_name : host;
+	key += ':';
+	key += port;
+	return true;
+}
+
+static void trackTLSInfo(const SSL* ssl, int where, int ret)
+{
+	// The callback is registered on the shared context; only sockets that
+	// asked for TLS events carry one.
+	auto* onTLSEvent = reinterpret_cast<SocketTLSClientConfiguration::TlsEventCallback>(SSL_get_ex_data(ssl, 0));
+	if (!onTLSEvent)
+		return;
+
+	char buffer[2048]{ 0 };
+
+	int w = where & ~SSL_ST_MASK;
+
+	if (where & SSL_CB_LOOP)
+	{
+		const char* header = "";
+		if (w & SSL_ST_CONNECT) header = "SSL_connect";
+		else if (w & SSL_ST_ACCEPT) header = "SSL_accept";
+		snprintf(buffer, sizeof(buffer), "[%s] %s", header, SSL_state_string_long(ssl));
+	}
+	else if (where & SSL_CB_ALERT)
+	{
+		snprintf(buffer, sizeof(buffer), "[ALERT] : %s :%s", SSL_alert_type_string_long(ret), SSL_alert_desc_string_long(ret));
+	}
+	else if (where & SSL_CB_EXIT)
+	{
+		if (ret <= 0) {
+			snprintf(buffer, sizeof(buffer), "%s", ret == 0 ? "Handshake failed" : "Handshake error");
+		}
+	}
+	else if (where & SSL_CB_HANDSHAKE_START) {
+		snprintf(buffer, sizeof(buffer), "Handshake start");
+	}
+	else if (where & SSL_CB_HANDSHAKE_DONE) {
+		snprintf(buffer, sizeof(buffer), "Handshake done (%s)", SSL_session_reused(ssl) ? "session resumed" : "full handshake");
+	}
+
+	onTLSEvent(buffer);
+}
+
+// [1] TLS 버전 범위 설정 : TLS 1.3 우선, 실패 시 TLS 1.2 자동 협상
+// [2] Cipher Suite 등록
+template<class Configuration>
+static void applyProtocolSettings(SSL_CTX* context, const Configuration& tls_configuration)
+{
+	{
+		bool has12 = tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_2);
+		bool has13 = tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_3);
+		int min_ver = has12 ? TLS1_2_VERSION : TLS1_3_VERSION;
+		int max_ver = has13 ? TLS1_3_VERSION : TLS1_2_VERSION;
+		SSL_CTX_set_min_proto_version(context, min_ver);
+		SSL_CTX_set_max_proto_version(context, max_ver);
+	}
+
+	{
+		char cipher_list[512]{ 0 };
+		tls_configuration.generateTLS12CipherSuites(cipher_list);
+		if (cipher_list[0] != '\0')
+			SSL_CTX_set_cipher_list(context, cipher_list);
+
+		char ciphersuites[512]{ 0 };
+		tls_configuration.generateTLS13CipherSuites(ciphersuites);
+		if (ciphersuites[0] != '\0')
+			SSL_CTX_set_ciphersuites(context, ciphersuites);
+	}
+
+	// Kernel TLS : OpenSSL moves each direction to the kernel after the
+	// handshake when it can, and silently keeps it in user space when the
+	// kernel module, the OpenSSL build or the negotiated cipher does not
+	// support it.
+	if (tls_configuration.shouldUseKernelTLS())
+		SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+}
+
+static int providePassword(char* buf, int size, int /*rwflag*/, void* userdata)
+{
+	const char* pw = static_cast<const char*>(userdata);
+	int len = static_cast<int>(strlen(pw));
+	if (len > size) len = size;
+	memcpy(buf, pw, static_cast<size_t>(len));
+	return len;
+}
+
+SSL_CTX* TLSClientContextCache::acquire(const SocketTLSClientConfiguration& tls_configuration)
+{
+	auto key = makeKey(tls_configuration);
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	auto iter = _contexts.find(key);
+	if (iter != _contexts.end())
+	{
+		SSL_CTX_up_ref(iter->second);
+		return iter->second;
+	}
+
+	bool is_cacheable{ true };
+	SSL_CTX* context = create(tls_configuration, is_cacheable);
+	if (!context)
+		return nullptr;
+
+	// A context whose certificate or key failed to load is handed out once
+	// but not kept, so fixing the files on disk takes effect on the next socket.
+	if (is_cacheable)
+	{
+		SSL_CTX_up_ref(context);
+		_contexts.emplace(std::move(key), context);
+		if (tls_configuration.shouldResumeSession())
+			_sessions.emplace(context, std::unordered_map<std::string, SSL_SESSION*>{});
+	}
+	return context;
+}
+
+void TLSClientContextCache::flush()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	for (auto& entry : _sessions)
+	{
+		for (auto& session : entry.second)
+			SSL_SESSION_free(session.second);
+	}
+	_sessions.clear();
+	for (auto& entry : _contexts)
+		SSL_CTX_free(entry.second);
+	_contexts.clear();
+}
+
+void TLSClientContextCache::restoreSession(SSL* ssl)
+{
+	std::string peer;
+	if (!getPeerKey(ssl, peer))
+		return;
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	auto context = _sessions.find(SSL_get_SSL_CTX(ssl));
+	if (context == _sessions.end())
+		return;
+	auto session = context->second.find(peer);
+	if (session == context->second.end())
+		return;
+	// The server decides whether it is actually resumed; if not, OpenSSL
+	// falls back to a full handshake on its own.
+	SSL_set_session(ssl, session->second);
+}
+
+int TLSClientContextCache::storeSession(SSL* ssl, SSL_SESSION* session)
+{
+	std::string peer;
+	if (!SSL_SESSION_is_resumable(session) || !getPeerKey(ssl, peer))
+		return 0;
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	// Contexts that were flushed or never cached keep no sessions.
+	auto context = _sessions.find(SSL_get_SSL_CTX(ssl));
+	if (context == _sessions.end())
+		return 0;
+
+	// TLS 1.3 servers usually send several tickets; the newest one wins.
+	auto& stored = context->second[peer];
+	if (stored)
+		SSL_SESSION_free(stored);
+	stored = session;
+	return 1;
+}
+
+std::string TLSClientContextCache::makeKey(const SocketTLSClientConfiguration& tls_configuration)
+{
+	// Every field that ends up in the SSL_CTX. The TLS event callback is not
+	// part of it because it is attached to each SSL object instead.
+	std::string key;
+	key += tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_2) ? '1' : '0';
+	key += tls_configuration.isVersionSupported(SocketTLSVersion::TLS1_3) ? '1' : '0';
+	key += tls_configuration.shouldVerifyServer() ? '1' : '0';
+	key += tls_configuration.shouldUseClientCertificate() ? '1' : '0';
+	key += tls_configuration.shouldResumeSession() ? '1' : '0';
+	key += tls_configuration.shouldUseKernelTLS() ? '1' : '0';
+
+	char ciphers[512]{ 0 };
+	tls_configuration.generateTLS12CipherSuites(ciphers);
+	key.append(ciphers).push_back('\0');
+	memset(ciphers, 0, sizeof(ciphers));
+	tls_configuration.generateTLS13CipherSuites(ciphers);
+	key.append(ciphers).push_back('\0');
+
+	if (tls_configuration.shouldVerifyServer())
+		key.append(tls_configuration.serverTrustStorePath()).push_back('\0');
+	if (tls_configuration.shouldUseClientCertificate())
+	{
+		key.append(tls_configuration.clientCertFilePath()).push_back('\0');
+		key.append(tls_configuration.clientKeyFilePath()).push_back('\0');
+		key.append(tls_configuration.clientKeyPassword()).push_back('\0');
+	}
+	return key;
+}
+
+SSL_CTX* TLSClientContextCache::create(const SocketTLSClientConfiguration& tls_configuration, bool& is_cacheable)
+{
+	SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+	if (!context)
+		return nullptr;
+
+	applyProtocolSettings(context, tls_configuration);
+
+	// [3] 서버 인증서 검증
+	if (tls_configuration.shouldVerifyServer()) {
+		SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+		const char* trust_store = tls_configuration.serverTrustStorePath();
+		if (trust_store[0] != '\0')
+			SSL_CTX_load_verify_locations(context, trust_store, nullptr);
+		else
+			SSL_CTX_set_default_verify_paths(context);
+	}
+	else {
+		SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+	}
+
+	// [4] 클라이언트 인증서 등록
+	if (tls_configuration.shouldUseClientCertificate()) {
+		const char* key_password = tls_configuration.clientKeyPassword();
+		if (key_password[0] != '\0') {
+			SSL_CTX_set_default_passwd_cb(context, providePassword);
+			SSL_CTX_set_default_passwd_cb_userdata(context, const_cast<char*>(key_password));
+		}
+		if (SSL_CTX_use_certificate_file(context, tls_configuration.clientCertFilePath(), SSL_FILETYPE_PEM) != 1)
+			is_cacheable = false;
+		if (SSL_CTX_use_PrivateKey_file(context, tls_configuration.clientKeyFilePath(), SSL_FILETYPE_PEM) != 1)
+			is_cacheable = false;
+		// The password is only needed while the key is decrypted above, and
+		// the configuration it points into does not outlive this call.
+		SSL_CTX_set_default_passwd_cb(context, nullptr);
+		SSL_CTX_set_default_passwd_cb_userdata(context, nullptr);
+	}
+
+	// [5] 세션 재사용 : OpenSSL의 내부 저장소 대신 피어별로 직접 보관
+	if (tls_configuration.shouldResumeSession()) {
+		SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(context, storeSession);
+	}
+
+	// TLS info tracking
+	SSL_CTX_set_info_callback(context, trackTLSInfo);
+
+	return context;
+}
+
+SSL_CTX* Bn3Monkey::createTLSServerContext(const SocketTLSServerConfiguration& tls_configuration)
+{
+	SSL_CTX* context = SSL_CTX_new(TLS_server_method());
+	if (!context)
+		return nullptr;
+
+	applyProtocolSettings(context, tls_configuration);
+
+	// [3] 서버 인증서 / 개인키 등록
+	{
+		const char* key_password = tls_configuration.serverKeyPassword();
+		if (key_password[0] != '\0') {
+			SSL_CTX_set_default_passwd_cb(context, providePassword);
+			SSL_CTX_set_default_passwd_cb_userdata(context, const_cast<char*>(key_password));
+		}
+		bool is_loaded =
+			SSL_CTX_use_certificate_chain_file(context, tls_configuration.serverCertFilePath()) == 1 &&
+			SSL_CTX_use_PrivateKey_file(context, tls_configuration.serverKeyFilePath(), SSL_FILETYPE_PEM) == 1 &&
+			SSL_CTX_check_private_key(context) == 1;
+		SSL_CTX_set_default_passwd_cb(context, nullptr);
+		SSL_CTX_set_default_passwd_cb_userdata(context, nullptr);
+		if (!is_loaded) {
+			SSL_CTX_free(context);
+			return nullptr;
+		}
+	}
+
+	// [4] 클라이언트 인증서 검증
+	switch (tls_configuration.clientAuthenticationMode()) {
+	case SocketTLSClientAuthenticationMode::AUTH_MODE_NONE:
+		SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+		break;
+	case SocketTLSClientAuthenticationMode::AUTH_MODE_OPTIONAL:
+		SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+		break;
+	case SocketTLSClientAuthenticationMode::AUTH_MODE_REQUIRED:
+		SSL_CTX_set_verify(context, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+		break;
+	}
+	if (tls_configuration.clientAuthenticationMode() != SocketTLSClientAuthenticationMode::AUTH_MODE_NONE) {
+		const char* trust_store = tls_configuration.clientTrustStorePath();
+		if (trust_store[0] != '\0')
+			SSL_CTX_load_verify_locations(context, trust_store, nullptr);
+		else
+			SSL_CTX_set_default_verify_paths(context);
+	}
+
+	// [5] 세션 재사용 : 클라이언트 인증을 쓰는 서버도 세션을 재개할 수 있도록 지정
+	static const unsigned char session_id_context[] = "Bn3Monkey::SecuritySocket";
+	SSL_CTX_set_session_id_context(context, session_id_context, sizeof(session_id_context) - 1);
+
+	// [6] Early data : tickets advertise the limit, and the server reads up to
+	// that much. Anti-replay keeps each ticket in the session cache until it
+	// is used once.
+	if (tls_configuration.maxEarlyData() > 0) {
+		SSL_CTX_set_max_early_data(context, tls_configuration.maxEarlyData());
+		SSL_CTX_set_recv_max_early_data(context, tls_configuration.maxEarlyData());
+		if (!tls_configuration.shouldPreventEarlyDataReplay())
+			SSL_CTX_set_options(context, SSL_OP_NO_ANTI_REPLAY);
+	}
+
+	// Non-blocking writes: SSL_write() may return after part of the buffer,
+	// and the retry after WANT_WRITE resumes from the advanced pointer.
+	SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+	// The context belongs to this server alone, so the knob can live here.
+	if (tls_configuration.shouldReleaseBuffers())
+		SSL_CTX_set_mode(context, SSL_MODE_RELEASE_BUFFERS);
+
+	// TLS info tracking : each accepted SSL picks the callback up from here.
+	auto on_tls_event = tls_configuration.getOnTLSEvent();
+	if (on_tls_event)
+		SSL_CTX_set_ex_data(context, 0, reinterpret_cast<void*>(on_tls_event));
+	SSL_CTX_set_info_callback(context, trackTLSInfo);
+
+	return context;
+}
+
+void Bn3Monkey::reportKernelTLS(SSL* ssl)
+{
+	if (!(SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS))
+		return;
+	auto* onTLSEvent = reinterpret_cast<SocketTLSClientConfiguration::TlsEventCallback>(SSL_get_ex_data(ssl, 0));
+	if (!onTLSEvent)
+		return;
+
+	char buffer[64]{ 0 };
+	snprintf(buffer, sizeof(buffer), "Kernel TLS (send : %s, receive : %s)",
+		BIO_get_ktls_send(SSL_get_wbio(ssl)) ? "on" : "off",
+		BIO_get_ktls_recv(SSL_get_rbio(ssl)) ? "on" : "off");
+	onTLSEvent(buffer);
+}
+
+void Bn3Monkey::TLSRecordSizer::prepare(SSL* ssl, size_t size)
+{
+	if (!_is_enabled)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - _last_write > std::chrono::milliseconds(IDLE_RESET_MS))
+		_sent_bytes = 0;
+	_last_write = now;
+
+	bool is_warm = _sent_bytes >= WARM_UP_BYTES;
+	if (!_is_applied || is_warm != _is_warm)
+	{
+		SSL_set_max_send_fragment(ssl, is_warm ? LARGE_RECORD_SIZE : SMALL_RECORD_SIZE);
+		_is_warm = is_warm;
+		_is_applied = true;
+	}
+	_sent_bytes += size;
+}
@@ -0,0 +1,92 @@
+#if !defined(__BN3MONKEY__TLSCONTEXT__)
+#define __BN3MONKEY__TLSCONTEXT__
+
+#include "../SecuritySocket.hpp"
+#include "TLSHelper.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Bn3Monkey
+{
+	// Process-wide cache of client SSL_CTXs.
+	//
+	// Building an SSL_CTX parses the cipher lists and reads the trust store and
+	// the client certificate / key from disk, so it is done once per distinct
+	// SocketTLSClientConfiguration and then shared by every socket created
+	// from an equal configuration. Contexts are ref-counted by OpenSSL itself:
+	// the cache holds one reference and every socket holds another.
+	class TLSClientContextCache
+	{
+	public:
+		// Returns an SSL_CTX with one reference owned by the caller, who
+		// releases it with SSL_CTX_free(). nullptr if it could not be created.
+		static SSL_CTX* acquire(const SocketTLSClientConfiguration& tls_configuration);
+
+		// Drops the cache's references and every stored session. Sockets still
+		// using a context keep it alive until they close.
+		static void flush();
+
+		// Offers the last session negotiated with the peer `ssl` is connected
+		// to. Call once the fd and the SNI are set, before SSL_connect(). Does
+		// nothing unless the configuration enabled session resumption.
+		static void restoreSession(SSL* ssl);
+
+	private:
+		static std::string makeKey(const SocketTLSClientConfiguration& tls_configuration);
+		static SSL_CTX* create(const SocketTLSClientConfiguration& tls_configuration, bool& is_cacheable);
+		// OpenSSL new-session callback. Keeps the newest session per peer.
+		static int storeSession(SSL* ssl, SSL_SESSION* session);
+
+		static std::mutex _mtx;
+		static std::unordered_map<std::string, SSL_CTX*> _contexts;
+		// Sessions of resumption-enabled contexts, by context and then "SNI host:port".
+		static std::unordered_map<SSL_CTX*, std::unordered_map<std::string, SSL_SESSION*>> _sessions;
+	};
+
+	// Builds the SSL_CTX of a TLS server from its configuration. Each server
+	// owns its context (released with SSL_CTX_free() on close), and every
+	// accepted connection takes an SSL object from it.
+	// nullptr if the certificate or key cannot be loaded.
+	SSL_CTX* createTLSServerContext(const SocketTLSServerConfiguration& tls_configuration);
+
+	// Tells the TLS event callback whether kernel TLS took over sending and
+	// receiving. Call once the handshake has completed; does nothing unless
+	// the configuration asked for kernel TLS.
+	void reportKernelTLS(SSL* ssl);
+
+	// Dynamic TLS record sizing. A fresh or idle connection sends records that
+	// fit one TCP segment, so the peer can decrypt the first bytes without
+	// waiting for a whole 16 KB record to arrive. Once enough data has gone out
+	// the window is open and full-size records cut per-record overhead.
+	//
+	// Trivially copyable, so it can live inside sockets held by SocketContainer.
+	class TLSRecordSizer
+	{
+	public:
+		inline void enable(bool is_enabled) { _is_enabled = is_enabled; }
+		inline bool isEnabled() const { return _is_enabled; }
+		// Call before every SSL_write() of `size` bytes.
+		void prepare(SSL* ssl, size_t size);
+
+	private:
+		// Fits one 1448-byte segment (1500 MTU, TCP timestamps) after the record
+		// header, explicit nonce and AEAD tag.
+		static constexpr long SMALL_RECORD_SIZE = 1400;
+		static constexpr long LARGE_RECORD_SIZE = 16384;
+		static constexpr uint64_t WARM_UP_BYTES = 1024 * 1024;
+		// Past this much silence the congestion window may have shrunk again.
+		static constexpr uint32_t IDLE_RESET_MS = 1000;
+
+		bool _is_enabled{ false };
+		bool _is_warm{ false };
+		bool _is_applied{ false };
+		uint64_t _sent_bytes{ 0 };
+		std::chrono::steady_clock::time_point _last_write{};
+	};
+}
+
+#endif // __BN3MONKEY__TLSCONTEXT__
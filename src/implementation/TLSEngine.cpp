@@ -0,0 +1,278 @@
+#include "TLSEngine.hpp"
+#include "SocketResult.hpp"
+
+#include <memory>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#include <WS2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
+
+using namespace Bn3Monkey;
+
+bool TLSEngine::open(SSL* ssl, int32_t fd)
+{
+	BIO* rbio = BIO_new(BIO_s_mem());
+	BIO* wbio{ nullptr };
+	BIO* network{ nullptr };
+	// Nothing is written to the network half, so its own buffer stays tiny.
+	if (!rbio || BIO_new_bio_pair(&wbio, WRITE_BUFFER_SIZE, &network, 1) != 1)
+	{
+		if (rbio)
+			BIO_free(rbio);
+		return false;
+	}
+
+	// An empty memory BIO reports "retry", so OpenSSL asks for more input
+	// (SSL_ERROR_WANT_READ) instead of seeing end of file.
+	SSL_set_bio(ssl, rbio, wbio);
+	_ssl = ssl;
+	_rbio = rbio;
+	_network = network;
+	_fd = fd;
+	_accepted_size = 0;
+	_wants_write = false;
+	return true;
+}
+
+void TLSEngine::close()
+{
+	if (_ssl)
+	{
+		transmit();
+		BIO_free(_network);
+	}
+	_ssl = nullptr;
+	_rbio = nullptr;
+	_network = nullptr;
+	_fd = -1;
+}
+
+SocketResult TLSEngine::handshake()
+{
+	while (true)
+	{
+		// Our previous flight has to be out before the peer can answer it.
+		auto sent = transmit();
+		if (sent.code() != SocketCode::SUCCESS)
+			return sent;
+
+		ERR_clear_error();
+		int32_t ret = SSL_do_handshake(_ssl);
+		if (ret == 1)
+		{
+			// The last flight (and TLS 1.3 session tickets) may still be queued.
+			sent = transmit();
+			if (sent.code() != SocketCode::SUCCESS)
+				return sent;
+			return SocketResult(SocketCode::SUCCESS, ret);
+		}
+		int32_t error = SSL_get_error(_ssl, ret);
+		// A full write BIO is emptied at the top of the loop.
+		if (error == SSL_ERROR_WANT_WRITE)
+			continue;
+		if (error != SSL_ERROR_WANT_READ)
+			return createTLSResult(_ssl, ret);
+
+		sent = transmit();
+		if (sent.code() != SocketCode::SUCCESS)
+			return sent;
+		auto received = receive();
+		if (received.code() != SocketCode::SUCCESS)
+			return received;
+	}
+}
+
+SocketResult TLSEngine::read(void* buffer, size_t size)
+{
+	while (true)
+	{
+		ERR_clear_error();
+		int32_t ret = SSL_read(_ssl, buffer, static_cast<int32_t>(size));
+		// Post-handshake messages (key updates, tickets) may produce output.
+		auto sent = transmit();
+		if (ret > 0)
+			return SocketResult(SocketCode::SUCCESS, ret);
+		int32_t error = SSL_get_error(_ssl, ret);
+		if (error == SSL_ERROR_WANT_WRITE)
+		{
+			if (sent.code() != SocketCode::SUCCESS)
+				return sent;
+			continue;
+		}
+		if (error != SSL_ERROR_WANT_READ)
+			return createTLSResult(_ssl, ret);
+
+		auto received = receive();
+		if (received.code() != SocketCode::SUCCESS)
+			return received;
+	}
+}
+
+SocketResult TLSEngine::write(const void* buffer, size_t size)
+{
+	return encrypt(buffer, size, false);
+}
+
+SocketResult TLSEngine::readEarlyData(void* buffer, size_t size, bool& is_finished)
+{
+	is_finished = false;
+	while (true)
+	{
+		ERR_clear_error();
+		size_t read_size{ 0 };
+		int32_t ret = SSL_read_early_data(_ssl, buffer, size, &read_size);
+		// The server's flight goes out while the client's early data comes in.
+		auto sent = transmit();
+		if (ret == SSL_READ_EARLY_DATA_SUCCESS)
+			return SocketResult(SocketCode::SUCCESS, static_cast<int32_t>(read_size));
+		if (ret == SSL_READ_EARLY_DATA_FINISH)
+		{
+			is_finished = true;
+			return SocketResult(SocketCode::SUCCESS, 0);
+		}
+		int32_t error = SSL_get_error(_ssl, ret);
+		if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE)
+			return createTLSResult(_ssl, ret);
+		if (sent.code() != SocketCode::SUCCESS)
+			return sent;
+		if (error == SSL_ERROR_WANT_WRITE)
+			continue;
+
+		auto received = receive();
+		if (received.code() != SocketCode::SUCCESS)
+			return received;
+	}
+}
+
+SocketResult TLSEngine::writeEarlyData(const void* buffer, size_t size)
+{
+	return encrypt(buffer, size, true);
+}
+
+SocketResult TLSEngine::encrypt(const void* buffer, size_t size, bool is_early_data)
+{
+	auto sent = transmit();
+	if (_accepted_size > 0)
+	{
+		// Retry of a write whose records are already encrypted.
+		if (sent.code() != SocketCode::SUCCESS)
+			return sent;
+		int32_t accepted = _accepted_size;
+		_accepted_size = 0;
+		return SocketResult(SocketCode::SUCCESS, accepted);
+	}
+	if (sent.code() != SocketCode::SUCCESS)
+		return sent;
+
+	int32_t ret{ 0 };
+	while (true)
+	{
+		ERR_clear_error();
+		if (is_early_data)
+		{
+			size_t written{ 0 };
+			if (SSL_write_early_data(_ssl, buffer, size, &written) == 1)
+				ret = static_cast<int32_t>(written);
+		}
+		else
+		{
+			ret = SSL_write(_ssl, buffer, static_cast<int32_t>(size));
+		}
+		if (ret > 0)
+			break;
+		if (SSL_get_error(_ssl, ret) != SSL_ERROR_WANT_WRITE)
+			return createTLSResult(_ssl, ret);
+
+		// Not one record fits into the write BIO. OpenSSL resumes the same
+		// write once there is room.
+		sent = transmit();
+		if (sent.code() != SocketCode::SUCCESS)
+			return sent;
+	}
+
+	sent = transmit();
+	if (sent.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED)
+	{
+		_accepted_size = ret;
+		return sent;
+	}
+	if (sent.code() != SocketCode::SUCCESS)
+		return sent;
+	return SocketResult(SocketCode::SUCCESS, ret);
+}
+
+SocketEventType TLSEngine::pendingEvent()
+{
+	return _wants_write ? SocketEventType::WRITE : SocketEventType::READ;
+}
+
+size_t TLSEngine::pending()
+{
+	if (!_ssl)
+		return 0;
+	size_t decrypted = static_cast<size_t>(SSL_pending(_ssl));
+	if (decrypted > 0)
+		return decrypted;
+	return hasCompleteRecord() ? BIO_ctrl_pending(_rbio) : 0;
+}
+
+SocketResult TLSEngine::receive()
+{
+	// Copied into the read BIO at once, so one buffer serves every engine of
+	// the thread. Too large for the stack of a pool thread.
+	static thread_local std::unique_ptr<char[]> buffer{ new char[RECEIVE_BATCH_SIZE] };
+	int32_t ret = ::recv(_fd, buffer.get(), static_cast<int32_t>(RECEIVE_BATCH_SIZE), 0);
+	if (ret == 0)
+		return SocketResult(SocketCode::SOCKET_CLOSED, 0);
+	if (ret < 0)
+		return createResult(ret);
+
+	BIO_write(_rbio, buffer.get(), ret);
+	return SocketResult(SocketCode::SUCCESS, ret);
+}
+
+SocketResult TLSEngine::transmit()
+{
+	_wants_write = false;
+	while (true)
+	{
+		// Records are sent from the pair's own buffer; one that wraps around
+		// its end goes out in two send()s.
+		char* data{ nullptr };
+		long size = static_cast<long>(BIO_nread0(_network, &data));
+		if (size <= 0)
+			return SocketResult(SocketCode::SUCCESS, 0);
+
+		int32_t ret{ 0 };
+#ifdef __linux__
+		ret = ::send(_fd, data, static_cast<size_t>(size), MSG_NOSIGNAL);
+#else
+		ret = ::send(_fd, data, static_cast<int32_t>(size), 0);
+#endif
+		if (ret < 0)
+		{
+			auto result = createResult(ret);
+			if (result.code() == SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED ||
+				result.code() == SocketCode::SOCKET_TIMEOUT)
+				_wants_write = true;
+			return result;
+		}
+
+		BIO_nread(_network, &data, ret);
+	}
+}
+
+bool TLSEngine::hasCompleteRecord()
+{
+	char* data{ nullptr };
+	long size = BIO_get_mem_data(_rbio, &data);
+	if (size < static_cast<long>(RECORD_HEADER_SIZE))
+		return false;
+	auto* header = reinterpret_cast<const unsigned char*>(data);
+	size_t length = (static_cast<size_t>(header[3]) << 8) | header[4];
+	return static_cast<size_t>(size) >= RECORD_HEADER_SIZE + length;
+}
@@ -0,0 +1,79 @@
+#if !defined(__BN3MONKEY__TLSENGINE__)
+#define __BN3MONKEY__TLSENGINE__
+
+#include "../SecuritySocket.hpp"
+#include "SocketEvent.hpp"
+#include "TLSHelper.hpp"
+
+#include <cstdint>
+
+namespace Bn3Monkey
+{
+	// Runs an SSL object over a pair of memory BIOs instead of its descriptor.
+	//
+	// OpenSSL only encrypts and decrypts in memory; the engine moves the
+	// ciphertext itself. One recv() of up to RECEIVE_BATCH_SIZE bytes can carry
+	// several records, which SSL_read() then decrypts without another syscall,
+	// and a whole flight of records leaves with one send(). Records are written
+	// into a BIO pair of WRITE_BUFFER_SIZE bytes and sent from there.
+	//
+	// Works on blocking and non-blocking descriptors. The results follow
+	// SSL_read() / SSL_write(): SOCKET_CONNECTION_NEED_TO_BE_BLOCKED means wait
+	// for pendingEvent() and call again with the same arguments.
+	//
+	// Holds raw pointers only, so it can live inside sockets that
+	// SocketContainer copies with memcpy. The BIOs belong to the SSL object and
+	// are freed with it, except the pair's network half, which close() frees.
+	class TLSEngine
+	{
+	public:
+		// Replaces the BIOs of `ssl`, which must not have started its handshake.
+		// false if the memory BIOs cannot be created; `ssl` is left untouched.
+		bool open(SSL* ssl, int32_t fd);
+		inline bool isOpened() const { return _ssl != nullptr; }
+		// Sends what is still buffered (such as close_notify) without waiting.
+		void close();
+
+		// SSL_do_handshake() with the ciphertext moved in and out.
+		SocketResult handshake();
+		SocketResult read(void* buffer, size_t size);
+		SocketResult write(const void* buffer, size_t size);
+		// SSL_read_early_data() / SSL_write_early_data() with the ciphertext
+		// moved in and out. `is_finished` turns true, with 0 bytes, once no
+		// more early data will come; read() takes over from there.
+		SocketResult readEarlyData(void* buffer, size_t size, bool& is_finished);
+		SocketResult writeEarlyData(const void* buffer, size_t size);
+
+		SocketEventType pendingEvent();
+		// Nonzero while decrypted bytes or at least one whole record are already
+		// in memory, which poll() will not report again.
+		size_t pending();
+
+	private:
+		SocketResult encrypt(const void* buffer, size_t size, bool is_early_data);
+		// One recv() into the read BIO.
+		SocketResult receive();
+		// send() the write BIO pair until it is empty or the socket would block.
+		SocketResult transmit();
+		bool hasCompleteRecord();
+
+		SSL* _ssl{ nullptr };
+		BIO* _rbio{ nullptr };
+		// The other half of the SSL object's write BIO, which transmit()
+		// reads in place.
+		BIO* _network{ nullptr };
+		int32_t _fd{ -1 };
+
+		// Plaintext taken by the last write() whose ciphertext is still in the
+		// write BIO. Reported once the retried write() has sent it.
+		int32_t _accepted_size{ 0 };
+		bool _wants_write{ false };
+
+		static constexpr size_t RECEIVE_BATCH_SIZE = 65536;
+		static constexpr size_t WRITE_BUFFER_SIZE = 65536;
+		// Record header: type (1), version (2), length (2).
+		static constexpr size_t RECORD_HEADER_SIZE = 5;
+	};
+}
+
+#endif // __BN3MONKEY__TLSENGINE__
@@ -0,0 +1,185 @@
+#include "TLSHandshakePool.hpp"
+
+#include <algorithm>
+
+using namespace Bn3Monkey;
+
+void TLSHandshakePool::open(size_t num_of_threads, SocketMultiEventListener* owner)
+{
+	if (!_workers.empty() || num_of_threads == 0)
+		return;
+
+	_owner = owner;
+	_is_running = true;
+	for (size_t i = 0; i < num_of_threads; i++)
+	{
+		_workers.emplace_back(new Worker());
+		_workers.back()->listener.open();
+	}
+	for (auto& worker : _workers)
+		worker->thread = std::thread{ &TLSHandshakePool::run, this, worker.get() };
+}
+
+void TLSHandshakePool::close()
+{
+	if (_workers.empty())
+		return;
+
+	_is_running = false;
+	for (auto& worker : _workers)
+	{
+		{
+			std::lock_guard<std::mutex> lock(worker->mtx);
+		}
+		worker->cv.notify_all();
+		worker->listener.wakeup();
+	}
+	for (auto& worker : _workers)
+		worker->thread.join();
+
+	// The threads are gone; hand back whatever they were still working on.
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		for (auto& worker : _workers)
+		{
+			for (auto& handshake : worker->active)
+				_finished.push_back(Finished{ handshake.context, false });
+			for (auto& handshake : worker->submitted)
+				_finished.push_back(Finished{ handshake.context, false });
+			worker->listener.close();
+		}
+	}
+	_workers.clear();
+	_next_worker = 0;
+	_owner = nullptr;
+}
+
+void TLSHandshakePool::submit(SocketEventContext* context, ServerActiveSocket* socket, std::chrono::steady_clock::time_point deadline)
+{
+	_outstanding++;
+
+	// Round robin: handshakes cost about the same, so this spreads the load
+	// without any bookkeeping.
+	auto* worker = _workers[_next_worker].get();
+	_next_worker = (_next_worker + 1) % _workers.size();
+	{
+		std::lock_guard<std::mutex> lock(worker->mtx);
+		worker->submitted.push_back(Handshake{ context, socket, deadline });
+	}
+	worker->cv.notify_one();
+	// A worker with handshakes in flight sleeps in its listener instead.
+	worker->listener.wakeup();
+}
+
+void TLSHandshakePool::collect(std::vector<Finished>& finished)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	_outstanding -= _finished.size();
+	finished.insert(finished.end(), _finished.begin(), _finished.end());
+	_finished.clear();
+}
+
+void TLSHandshakePool::run(Worker* worker)
+{
+	std::vector<Handshake> submitted;
+
+	while (_is_running)
+	{
+		{
+			std::unique_lock<std::mutex> lock(worker->mtx);
+			// Idle workers sleep until there is something to do.
+			if (worker->active.empty())
+				worker->cv.wait(lock, [&]() { return !worker->submitted.empty() || !_is_running; });
+			submitted.swap(worker->submitted);
+		}
+		if (!_is_running)
+		{
+			// close() reports them.
+			std::lock_guard<std::mutex> lock(worker->mtx);
+			worker->submitted.insert(worker->submitted.end(), submitted.begin(), submitted.end());
+			break;
+		}
+
+		for (auto& handshake : submitted)
+			advance(worker, handshake);
+		submitted.clear();
+
+		if (worker->active.empty())
+			continue;
+
+		auto eventlist = worker->listener.wait(POLL_SLICE_MS);
+		if (eventlist.result.code() == SocketCode::SUCCESS)
+		{
+			for (auto* context : eventlist.contexts)
+			{
+				auto iter = std::find_if(worker->active.begin(), worker->active.end(),
+					[context](const Handshake& handshake) { return handshake.context == context; });
+				if (iter == worker->active.end())
+					continue;
+
+				if (context->type == SocketEventType::DISCONNECTED)
+					finish(worker, context, false);
+				else
+					advance(worker, *iter);
+			}
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		std::vector<SocketEventContext*> expired;
+		for (auto& handshake : worker->active)
+		{
+			if (now >= handshake.deadline)
+				expired.push_back(handshake.context);
+		}
+		for (auto* context : expired)
+			finish(worker, context, false);
+	}
+}
+
+void TLSHandshakePool::advance(Worker* worker, const Handshake& handshake)
+{
+	auto result = handshake.socket->handshake();
+	switch (result.code())
+	{
+	case SocketCode::SUCCESS:
+		finish(worker, handshake.context, true);
+		return;
+	case SocketCode::SOCKET_CONNECTION_NEED_TO_BE_BLOCKED:
+	case SocketCode::SOCKET_CONNECTION_INTERRUPTED:
+		break;
+	default:
+		finish(worker, handshake.context, false);
+		return;
+	}
+
+	auto event = handshake.socket->pendingEvent();
+	auto iter = std::find_if(worker->active.begin(), worker->active.end(),
+		[&handshake](const Handshake& active) { return active.context == handshake.context; });
+	if (iter == worker->active.end())
+	{
+		worker->active.push_back(handshake);
+		worker->listener.addEvent(handshake.context, event);
+	}
+	else
+	{
+		worker->listener.modifyEvent(handshake.context, event);
+	}
+}
+
+void TLSHandshakePool::finish(Worker* worker, SocketEventContext* context, bool is_established)
+{
+	auto iter = std::find_if(worker->active.begin(), worker->active.end(),
+		[context](const Handshake& handshake) { return handshake.context == context; });
+	if (iter != worker->active.end())
+	{
+		worker->listener.removeEvent(context);
+		worker->active.erase(iter);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_finished.push_back(Finished{ context, is_established });
+	}
+	if (_owner)
+		_owner->wakeup();
+}
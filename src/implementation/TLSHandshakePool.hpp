@@ -0,0 +1,90 @@
+#if !defined(__BN3MONKEY__TLSHANDSHAKEPOOL__)
+#define __BN3MONKEY__TLSHANDSHAKEPOOL__
+
+#include "../SecuritySocket.hpp"
+#include "ServerActiveSocket.hpp"
+#include "SocketEvent.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Bn3Monkey
+{
+	// Runs server-side TLS handshakes on a fixed set of threads, so the
+	// public-key work of new connections is spread over several cores instead
+	// of the server's single I/O thread. Every thread drives its share of
+	// handshakes without blocking, the same way the server thread does when no
+	// pool is used, so a stalled client only costs a slot in a poll set.
+	//
+	// The server thread hands a freshly accepted socket over with submit() and
+	// takes it back with collect(). In between the pool owns the socket: the
+	// server must not read, write, close or poll it.
+	class TLSHandshakePool
+	{
+	public:
+		struct Finished
+		{
+			SocketEventContext* context{ nullptr };
+			// false : failed, timed out or abandoned by close()
+			bool is_established{ false };
+		};
+
+		// owner, if any, is woken whenever a handshake ends, so its thread can
+		// collect() without polling for it.
+		void open(size_t num_of_threads, SocketMultiEventListener* owner = nullptr);
+		// Stops the threads. Handshakes still running come out of collect() as failed.
+		void close();
+
+		inline bool isRunning() const { return !_workers.empty(); }
+
+		// context->fd must be the socket's descriptor.
+		void submit(SocketEventContext* context, ServerActiveSocket* socket, std::chrono::steady_clock::time_point deadline);
+		// Appends every handshake that ended since the last call.
+		void collect(std::vector<Finished>& finished);
+		// Submitted and not collected yet.
+		inline size_t outstanding() const { return _outstanding; }
+
+	private:
+		struct Handshake
+		{
+			SocketEventContext* context{ nullptr };
+			ServerActiveSocket* socket{ nullptr };
+			std::chrono::steady_clock::time_point deadline;
+		};
+		struct Worker
+		{
+			std::thread thread;
+			std::mutex mtx;
+			std::condition_variable cv;
+			std::vector<Handshake> submitted;
+
+			// Worker thread only.
+			SocketMultiEventListener listener;
+			std::vector<Handshake> active;
+		};
+
+		void run(Worker* worker);
+		void advance(Worker* worker, const Handshake& handshake);
+		void finish(Worker* worker, SocketEventContext* context, bool is_established);
+
+		std::vector<std::unique_ptr<Worker>> _workers;
+		size_t _next_worker{ 0 };
+		std::atomic<bool> _is_running{ false };
+
+		std::mutex _mtx;
+		std::vector<Finished> _finished;
+		std::atomic<size_t> _outstanding{ 0 };
+		SocketMultiEventListener* _owner{ nullptr };
+
+		// Poll timeout while handshakes are in flight, so deadlines are
+		// noticed. New submissions and close() wake the listener.
+		static constexpr uint32_t POLL_SLICE_MS = 10;
+	};
+}
+
+#endif // __BN3MONKEY__TLSHANDSHAKEPOOL__
@@ -16,6 +16,10 @@ inline METHOD* TLS_client_method()
 {
     return nullptr;
 }
+inline METHOD* TLS_server_method()
+{
+    return nullptr;
+}
 
 inline SSL_CTX* SSL_CTX_new(METHOD* method)
 {
@@ -34,6 +38,12 @@ inline void SSL_CTX_free(SSL_CTX* context)
     return;
 }
 
+inline int32_t SSL_CTX_up_ref(SSL_CTX* context)
+{
+    (void)context;
+    return 1;
+}
+
 inline int32_t SSL_connect(SSL* ssl)
 {
     (void)ssl;
@@ -44,6 +54,15 @@ inline int32_t SSL_accept(SSL* ssl)
     (void)ssl;
     return 0;
 }
+inline void SSL_set_accept_state(SSL* ssl)
+{
+    (void)ssl;
+}
+inline int32_t SSL_is_init_finished(const SSL* ssl)
+{
+    (void)ssl;
+    return 0;
+}
 inline void SSL_shutdown(SSL* ssl)
 {
     (void)ssl;
@@ -87,6 +106,21 @@ inline int32_t SSL_get_error(SSL* ssl, int32_t operation_return)
 	(void)operation_return;
     return 0;
 }
+inline int32_t SSL_get_fd(const SSL* ssl)
+{
+    (void)ssl;
+    return -1;
+}
+inline int32_t SSL_want_write(const SSL* ssl)
+{
+    (void)ssl;
+    return 0;
+}
+inline int32_t SSL_pending(const SSL* ssl)
+{
+    (void)ssl;
+    return 0;
+}
 
 static constexpr int32_t SSL_ERROR_SSL = 1;
 static constexpr int32_t SSL_ERROR_SYSCALL = 2;
@@ -101,6 +135,7 @@ static constexpr int TLS1_3_VERSION = 0x0304;
 // Verify mode constants
 static constexpr int SSL_VERIFY_NONE = 0;
 static constexpr int SSL_VERIFY_PEER = 1;
+static constexpr int SSL_VERIFY_FAIL_IF_NO_PEER_CERT = 2;
 
 // Certificate file type
 static constexpr int SSL_FILETYPE_PEM = 1;
@@ -127,8 +162,23 @@ inline void SSL_CTX_set_default_passwd_cb_userdata(SSL_CTX*, void*) {}
 inline int  SSL_CTX_use_certificate_file(SSL_CTX*, const char*, int) { return 1; }
 inline int  SSL_CTX_use_PrivateKey_file(SSL_CTX*, const char*, int) { return 1; }
 
+// Server certificate
+inline int  SSL_CTX_use_certificate_chain_file(SSL_CTX*, const char*) { return 1; }
+inline int  SSL_CTX_check_private_key(const SSL_CTX*) { return 1; }
+inline int  SSL_CTX_set_session_id_context(SSL_CTX*, const unsigned char*, unsigned int) { return 1; }
+
+// Record layer modes
+static constexpr long SSL_MODE_ENABLE_PARTIAL_WRITE       = 0x00000001;
+static constexpr long SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER = 0x00000002;
+static constexpr long SSL_MODE_RELEASE_BUFFERS            = 0x00000010;
+inline long SSL_CTX_set_mode(SSL_CTX*, long mode) { return mode; }
+inline long SSL_set_mode(SSL*, long mode) { return mode; }
+inline int  SSL_set_max_send_fragment(SSL*, long) { return 1; }
+
 // Hostname / SNI
 inline int SSL_set_tlsext_host_name(SSL*, const char*) { return 1; }
+static constexpr int TLSEXT_NAMETYPE_host_name = 0;
+inline const char* SSL_get_servername(const SSL*, int) { return nullptr; }
 inline int SSL_set1_host(SSL*, const char*) { return 1; }
 
 // X.509 type stub (used only when SECURITYSOCKET_TLS is not defined)
@@ -205,6 +255,77 @@ inline const char* SSL_alert_desc_string_long(int)         { return ""; }
 // project's TlsEventCallback pointer at runtime.
 inline int   SSL_set_ex_data(SSL*, int, void*)             { return 1; }
 inline void* SSL_get_ex_data(const SSL*, int)              { return nullptr; }
+inline int   SSL_CTX_set_ex_data(SSL_CTX*, int, void*)     { return 1; }
+inline void* SSL_CTX_get_ex_data(const SSL_CTX*, int)      { return nullptr; }
+
+// ---- Client session resumption -------------------------------------------
+// Sessions (TLS 1.2 session IDs / tickets, TLS 1.3 PSK tickets) are handed to
+// the project through the new-session callback and offered again with
+// SSL_set_session() on the next connection to the same peer.
+using SSL_SESSION = void;
+
+static constexpr long SSL_SESS_CACHE_CLIENT             = 0x0001;
+static constexpr long SSL_SESS_CACHE_NO_INTERNAL_STORE  = 0x0300;
+
+using SSL_new_session_cb_fn = int (*)(SSL*, SSL_SESSION*);
+inline long     SSL_CTX_set_session_cache_mode(SSL_CTX*, long) { return 0; }
+inline void     SSL_CTX_sess_set_new_cb(SSL_CTX*, SSL_new_session_cb_fn) {}
+inline SSL_CTX* SSL_get_SSL_CTX(const SSL*)                     { return nullptr; }
+inline int      SSL_set_session(SSL*, SSL_SESSION*)             { return 1; }
+inline int      SSL_session_reused(const SSL*)                  { return 0; }
+inline int      SSL_SESSION_is_resumable(const SSL_SESSION*)    { return 0; }
+inline void     SSL_SESSION_free(SSL_SESSION*)                  {}
+
+// ---- Kernel TLS offload ------------------------------------------------------
+// With SSL_OP_ENABLE_KTLS OpenSSL installs the record keys into the kernel
+// after the handshake; the BIOs then report which directions are offloaded.
+using BIO = void;
+
+static constexpr uint64_t SSL_OP_ENABLE_KTLS = 0;
+
+inline uint64_t SSL_CTX_set_options(SSL_CTX*, uint64_t options) { return options; }
+inline uint64_t SSL_get_options(const SSL*)                      { return 0; }
+inline BIO*     SSL_get_wbio(const SSL*)                         { return nullptr; }
+inline BIO*     SSL_get_rbio(const SSL*)                         { return nullptr; }
+inline int      BIO_get_ktls_send(BIO*)                          { return 0; }
+inline int      BIO_get_ktls_recv(BIO*)                          { return 0; }
+inline long     SSL_sendfile(SSL*, int, long, size_t, int)       { return -1; }
+
+// ---- Memory BIOs -------------------------------------------------------------
+// TLSEngine runs OpenSSL over in-memory buffers and moves ciphertext itself.
+using BIO_METHOD = void;
+
+inline const BIO_METHOD* BIO_s_mem()                             { return nullptr; }
+inline BIO*     BIO_new(const BIO_METHOD*)                       { return nullptr; }
+inline int      BIO_free(BIO*)                                   { return 1; }
+inline int      BIO_read(BIO*, void*, int)                       { return -1; }
+inline int      BIO_write(BIO*, const void*, int)                { return -1; }
+inline long     BIO_get_mem_data(BIO*, char** data)              { *data = nullptr; return 0; }
+inline int      BIO_new_bio_pair(BIO**, size_t, BIO**, size_t)   { return 0; }
+inline int      BIO_nread0(BIO*, char** data)                    { *data = nullptr; return 0; }
+inline int      BIO_nread(BIO*, char** data, int)                { *data = nullptr; return 0; }
+inline size_t   BIO_ctrl_pending(BIO*)                           { return 0; }
+inline void     SSL_set_bio(SSL*, BIO*, BIO*)                    {}
+inline int      SSL_do_handshake(SSL*)                           { return -1; }
+
+// ---- TLS 1.3 early data ------------------------------------------------------
+// A resumed client writes its first request with SSL_write_early_data() before
+// the handshake; a server that allows it reads it with SSL_read_early_data().
+static constexpr int SSL_EARLY_DATA_NOT_SENT     = 0;
+static constexpr int SSL_EARLY_DATA_REJECTED     = 1;
+static constexpr int SSL_EARLY_DATA_ACCEPTED     = 2;
+static constexpr int SSL_READ_EARLY_DATA_ERROR   = 0;
+static constexpr int SSL_READ_EARLY_DATA_SUCCESS = 1;
+static constexpr int SSL_READ_EARLY_DATA_FINISH  = 2;
+static constexpr uint64_t SSL_OP_NO_ANTI_REPLAY = 0;
+
+inline SSL_SESSION* SSL_get_session(const SSL*)                               { return nullptr; }
+inline uint32_t SSL_SESSION_get_max_early_data(const SSL_SESSION*)            { return 0; }
+inline int      SSL_CTX_set_max_early_data(SSL_CTX*, uint32_t)                { return 1; }
+inline int      SSL_CTX_set_recv_max_early_data(SSL_CTX*, uint32_t)           { return 1; }
+inline int      SSL_write_early_data(SSL*, const void*, size_t, size_t*)      { return 0; }
+inline int      SSL_read_early_data(SSL*, void*, size_t, size_t*)             { return SSL_READ_EARLY_DATA_ERROR; }
+inline int      SSL_get_early_data_status(const SSL*)                         { return SSL_EARLY_DATA_NOT_SENT; }
 
 #endif // USING_TLS
 
@@ -0,0 +1,399 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "securitysockettest_helper.hpp"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr const char* kSharedMemoryPath = "/tmp/securitysockettest_shm.sock";
+    constexpr const char* kDescriptorPath = "/tmp/securitysockettest_fd.sock";
+    constexpr const char* kDescriptorSourcePath = "/tmp/securitysockettest_fd_source.sock";
+
+    struct UnixEchoHeader
+    {
+        uint32_t request_no{ 0 };
+        uint32_t payload_size{ 0 };
+    };
+
+    // Sends the payload back behind the same header.
+    struct UnixEchoHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(UnixEchoHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const UnixEchoHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            (void)ip;
+            (void)port;
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            (void)ip;
+            (void)port;
+        }
+        void onProcessed(const char* header, const char* input_buffer, size_t input_size, char* output_buffer, size_t* output_size) override {
+            memcpy(output_buffer, header, sizeof(UnixEchoHeader));
+            memcpy(output_buffer + sizeof(UnixEchoHeader), input_buffer, input_size);
+            *output_size = sizeof(UnixEchoHeader) + input_size;
+        }
+        void onProcessedWithoutResponse(const char* header, const char* input_buffer, size_t input_size) override {
+            (void)header;
+            (void)input_buffer;
+            (void)input_size;
+        }
+    };
+
+    bool readFully(Bn3Monkey::SocketClient& client, char* buffer, size_t size)
+    {
+        size_t read_size{ 0 };
+        while (read_size < size)
+        {
+            auto result = client.read(buffer + read_size, size - read_size);
+            if (result.code() != Bn3Monkey::SocketCode::SUCCESS || result.bytes() <= 0)
+                return false;
+            read_size += static_cast<size_t>(result.bytes());
+        }
+        return true;
+    }
+
+    // Payloads of several ring sizes go around the ring's end and fill it
+    // while the other side is still reading.
+    void runUnixEcho(Bn3Monkey::SocketClient& client)
+    {
+        const size_t sizes[] = { 1, 100, 4000, 4096, 20000, 50000 };
+        uint32_t request_no{ 0 };
+        for (size_t size : sizes)
+        {
+            std::string payload(size, '\0');
+            for (size_t i = 0; i < size; i++)
+                payload[i] = static_cast<char>('a' + (i + request_no) % 26);
+
+            UnixEchoHeader header{ request_no++, static_cast<uint32_t>(size) };
+            ASSERT_EQ(Bn3Monkey::SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+            ASSERT_EQ(Bn3Monkey::SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+
+            UnixEchoHeader response_header;
+            std::string response(size, '\0');
+            ASSERT_TRUE(readFully(client, reinterpret_cast<char*>(&response_header), sizeof(response_header)));
+            ASSERT_TRUE(readFully(client, &response[0], response.size()));
+            EXPECT_EQ(header.request_no, response_header.request_no);
+            EXPECT_EQ(header.payload_size, response_header.payload_size);
+            EXPECT_EQ(payload, response);
+        }
+    }
+
+    // Holds the server's only thread on the first request, so the client's
+    // next one fills the ring.
+    struct SlowUnixEchoHandler : public UnixEchoHandler
+    {
+        void onProcessed(const char* header, const char* input_buffer, size_t input_size, char* output_buffer, size_t* output_size) override {
+            if (reinterpret_cast<const UnixEchoHeader*>(header)->request_no == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            UnixEchoHandler::onProcessed(header, input_buffer, input_size, output_buffer, output_size);
+        }
+    };
+
+    // Keeps the address every connection was reported with.
+    struct PeerRecordingHandler : public UnixEchoHandler
+    {
+        void onClientConnected(const char* ip, int port) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            peers.emplace_back(ip, port);
+        }
+        std::mutex mutex;
+        std::vector<std::pair<std::string, int>> peers;
+    };
+
+    // Mappings of the memfd this library creates, in this process.
+    size_t countSharedMemoryMappings()
+    {
+        std::ifstream maps{ "/proc/self/maps" };
+        size_t count{ 0 };
+        for (std::string line; std::getline(maps, line); )
+        {
+            if (line.find("memfd:securitysocket") != std::string::npos)
+                count++;
+        }
+        return count;
+    }
+}
+
+#if defined(__linux__) && !defined(__ANDROID__)
+TEST(UDSRequestEcho, shouldEchoThroughSharedMemory)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+    std::remove(kSharedMemoryPath);
+
+    SocketConfiguration config{ kSharedMemoryPath, 0, true, 5, 1000, 1000, 10, 65536 };
+    // The smallest ring, so the larger payloads wrap and fill it.
+    config.setSharedMemorySize(4096);
+    config.setBusyPollTime(50);
+
+    UnixEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 2).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    {
+        SocketClient client{ config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+        // Both ends map the same memfd.
+        EXPECT_EQ(2u, countSharedMemoryMappings());
+
+        runUnixEcho(client);
+        EXPECT_EQ(SocketCode::SUCCESS, client.isAlive().code());
+        client.close();
+    }
+
+    {
+        // A client that does not offer is served over the socket.
+        SocketConfiguration plain_config{ kSharedMemoryPath, 0, true, 5, 1000, 1000, 10, 65536 };
+        SocketClient client{ plain_config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+        runUnixEcho(client);
+        client.close();
+    }
+
+    // The server lets go of the first connection's mapping once it closes.
+    for (int32_t i = 0; i < 100 && countSharedMemoryMappings() > 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(0u, countSharedMemoryMappings());
+
+    server.close();
+    std::remove(kSharedMemoryPath);
+    releaseSecuritySocket();
+}
+
+static std::chrono::nanoseconds processCPUTime()
+{
+    timespec now{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+}
+
+TEST(UDSRequestEcho, shouldWaitOnFullSharedMemoryRingWithoutSpinning)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+    std::remove(kSharedMemoryPath);
+
+    SocketConfiguration config{ kSharedMemoryPath, 0, true, 5, 1000, 1000, 10, 65536 };
+    config.setSharedMemorySize(4096);
+
+    SlowUnixEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 1).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+    ASSERT_EQ(2u, countSharedMemoryMappings());
+
+    auto cpu_start = processCPUTime();
+    auto start = std::chrono::steady_clock::now();
+
+    // The client waits for the server to read, then the server for the client.
+    const char small[] = "first";
+    std::string large(20000, 'x');
+    UnixEchoHeader first{ 0, sizeof(small) };
+    UnixEchoHeader second{ 1, static_cast<uint32_t>(large.size()) };
+    ASSERT_EQ(SocketCode::SUCCESS, client.write(&first, sizeof(first)).code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.write(small, sizeof(small)).code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.write(&second, sizeof(second)).code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.write(large.data(), large.size()).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<char> response(2 * sizeof(UnixEchoHeader) + sizeof(small) + large.size());
+    ASSERT_TRUE(readFully(client, response.data(), response.size()));
+    EXPECT_EQ(0, memcmp(small, response.data() + sizeof(UnixEchoHeader), sizeof(small)));
+    EXPECT_EQ(large, std::string(response.data() + 2 * sizeof(UnixEchoHeader) + sizeof(small), large.size()));
+
+    // Both waits sleep on the socket rather than poll a ring that stays full.
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto cpu = processCPUTime() - cpu_start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(400));
+    EXPECT_LT(cpu, elapsed / 4);
+
+    client.close();
+    server.close();
+    std::remove(kSharedMemoryPath);
+    releaseSecuritySocket();
+}
+
+// One echo through a blocking socket the test holds itself.
+static void expectRawEcho(int descriptor, uint32_t request_no)
+{
+    const char payload[] = "passed";
+    UnixEchoHeader header{ request_no, sizeof(payload) };
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(header)), ::write(descriptor, &header, sizeof(header)));
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(payload)), ::write(descriptor, payload, sizeof(payload)));
+
+    char response[sizeof(UnixEchoHeader) + sizeof(payload)]{};
+    size_t read_size{ 0 };
+    while (read_size < sizeof(response))
+    {
+        ssize_t ret = ::read(descriptor, response + read_size, sizeof(response) - read_size);
+        ASSERT_GT(ret, 0);
+        read_size += static_cast<size_t>(ret);
+    }
+    UnixEchoHeader response_header;
+    memcpy(&response_header, response, sizeof(response_header));
+    EXPECT_EQ(request_no, response_header.request_no);
+    EXPECT_EQ(0, memcmp(payload, response + sizeof(UnixEchoHeader), sizeof(payload)));
+}
+
+TEST(UDSRequestEcho, shouldServePassedDescriptors)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+    std::remove(kDescriptorPath);
+    std::remove(kDescriptorSourcePath);
+
+    SocketConfiguration config{ kDescriptorPath, 0, true, 5, 1000, 1000, 10, 65536 };
+    config.setDescriptorPassing(true);
+
+    PeerRecordingHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+    {
+        // Passed with the header of a request the client still gets its
+        // answer to; the server serves the other end as well.
+        int pair[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+        const char payload[] = "carrier";
+        UnixEchoHeader header{ 7, sizeof(payload) };
+        ASSERT_EQ(SocketCode::SUCCESS, client.sendDescriptor(pair[1], &header, sizeof(header)).code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.write(payload, sizeof(payload)).code());
+        ::close(pair[1]);
+
+        UnixEchoHeader response_header;
+        char response[sizeof(payload)]{};
+        ASSERT_TRUE(readFully(client, reinterpret_cast<char*>(&response_header), sizeof(response_header)));
+        ASSERT_TRUE(readFully(client, response, sizeof(response)));
+        EXPECT_EQ(7u, response_header.request_no);
+        EXPECT_STREQ(payload, response);
+
+        expectRawEcho(pair[0], 8);
+        ::close(pair[0]);
+    }
+
+    {
+        // Received by a client from elsewhere and handed to adopt().
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_GE(listener, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, kDescriptorSourcePath, sizeof(address.sun_path) - 1);
+        ASSERT_EQ(0, ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        ASSERT_EQ(0, ::listen(listener, 1));
+
+        SocketConfiguration source_config{ kDescriptorSourcePath, 0, true, 5, 1000, 1000, 10, 65536 };
+        SocketClient receiver{ source_config };
+        ASSERT_EQ(SocketCode::SUCCESS, receiver.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, receiver.connect().code());
+        int source = ::accept(listener, nullptr, nullptr);
+        ASSERT_GE(source, 0);
+
+        int pair[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+        char tag{ 'x' };
+        iovec piece{ &tag, 1 };
+        union
+        {
+            cmsghdr header;
+            char data[CMSG_SPACE(sizeof(int))];
+        } control{};
+        msghdr message{};
+        message.msg_iov = &piece;
+        message.msg_iovlen = 1;
+        message.msg_control = control.data;
+        message.msg_controllen = sizeof(control.data);
+        cmsghdr* rights = CMSG_FIRSTHDR(&message);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(rights), &pair[1], sizeof(int));
+        ASSERT_EQ(1, ::sendmsg(source, &message, 0));
+        ::close(pair[1]);
+
+        char received_tag{ 0 };
+        int32_t descriptor{ -1 };
+        auto result = receiver.receiveDescriptor(&received_tag, 1, &descriptor);
+        ASSERT_EQ(SocketCode::SUCCESS, result.code());
+        EXPECT_EQ(1, result.bytes());
+        EXPECT_EQ('x', received_tag);
+        ASSERT_GE(descriptor, 0);
+
+        // Only stream sockets are taken.
+        int datagrams[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_DGRAM, 0, datagrams));
+        EXPECT_EQ(SocketCode::SOCKET_INVALID_ARGUMENT, server.adopt(datagrams[0]).code());
+        ::close(datagrams[0]);
+        ::close(datagrams[1]);
+        // Nor listening ones, though they are SOCK_STREAM.
+        EXPECT_EQ(SocketCode::SOCKET_INVALID_ARGUMENT, server.adopt(listener).code());
+
+        ASSERT_EQ(SocketCode::SUCCESS, server.adopt(descriptor).code());
+        expectRawEcho(pair[0], 9);
+        ::close(pair[0]);
+
+        receiver.close();
+        ::close(source);
+        ::close(listener);
+    }
+
+    // The connection that passed the descriptor is served as before.
+    runUnixEcho(client);
+    client.close();
+
+    {
+        // The client, the passed socket and the adopted one: unix domain
+        // peers have neither an address nor a port.
+        std::lock_guard<std::mutex> lock(handler.mutex);
+        EXPECT_EQ(3u, handler.peers.size());
+        for (auto& peer : handler.peers)
+        {
+            EXPECT_EQ("", peer.first);
+            EXPECT_EQ(0, peer.second);
+        }
+    }
+
+    server.close();
+    std::remove(kDescriptorPath);
+    std::remove(kDescriptorSourcePath);
+    releaseSecuritySocket();
+}
+#endif
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "securitysockettest_helper.hpp"
+
+namespace
+{
+    constexpr uint32_t kAsyncEchoPort = 21350;
+    constexpr uint32_t kAsyncRefusedPort = 21351;
+
+    struct AsyncEchoHeader
+    {
+        uint32_t payload_size{ 0 };
+    };
+
+    // Echoes the payload back, prefixed by the same header.
+    struct AsyncEchoHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(AsyncEchoHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const AsyncEchoHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size
+        ) override {
+            memcpy(output_buffer, header, sizeof(AsyncEchoHeader));
+            memcpy(output_buffer + sizeof(AsyncEchoHeader), input_buffer, input_size);
+            *output_size = sizeof(AsyncEchoHeader) + input_size;
+        }
+        void onProcessedWithoutResponse(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size
+        ) override {
+            (void)header;
+            (void)input_buffer;
+            (void)input_size;
+        }
+    };
+
+    // Runs `rounds` request/response exchanges purely by chaining callbacks on
+    // the loop thread, then fulfils `done`.
+    class AsyncEchoSession : public std::enable_shared_from_this<AsyncEchoSession>
+    {
+    public:
+        AsyncEchoSession(Bn3Monkey::SocketEventLoop& loop, const Bn3Monkey::SocketConfiguration& config, int32_t client_no, int32_t rounds)
+            : _client(loop, config), _client_no(client_no), _rounds(rounds) {}
+
+        std::future<bool> start()
+        {
+            auto future = _done.get_future();
+            if (_client.open().code() != Bn3Monkey::SocketCode::SUCCESS)
+            {
+                _done.set_value(false);
+                return future;
+            }
+            auto self = shared_from_this();
+            _client.connectAsync([self](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                    return self->finish(false);
+                self->sendRequest();
+            });
+            return future;
+        }
+
+        void close() { _client.close(); }
+
+    private:
+        void sendRequest()
+        {
+            if (_round == _rounds)
+                return finish(true);
+
+            _payload = "client " + std::to_string(_client_no) + " round " + std::to_string(_round);
+            _request.resize(sizeof(AsyncEchoHeader) + _payload.size());
+            AsyncEchoHeader header{ static_cast<uint32_t>(_payload.size()) };
+            memcpy(_request.data(), &header, sizeof(header));
+            memcpy(_request.data() + sizeof(header), _payload.data(), _payload.size());
+
+            auto self = shared_from_this();
+            _client.writeAsync(_request.data(), _request.size(), [self](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS ||
+                    static_cast<size_t>(result.bytes()) != self->_request.size())
+                    return self->finish(false);
+                self->_response.assign(self->_request.size(), 0);
+                self->_received = 0;
+                self->readResponse();
+            });
+        }
+
+        void readResponse()
+        {
+            auto self = shared_from_this();
+            _client.readAsync(_response.data() + _received, _response.size() - _received, [self](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                    return self->finish(false);
+                self->_received += result.bytes();
+                if (self->_received < self->_response.size())
+                    return self->readResponse();
+                if (self->_response != self->_request)
+                    return self->finish(false);
+                self->_round++;
+                self->sendRequest();
+            });
+        }
+
+        void finish(bool success)
+        {
+            if (!_finished.exchange(true))
+                _done.set_value(success);
+        }
+
+        Bn3Monkey::AsyncSocketClient _client;
+        int32_t _client_no;
+        int32_t _rounds;
+        int32_t _round{ 0 };
+        std::string _payload;
+        std::vector<char> _request;
+        std::vector<char> _response;
+        size_t _received{ 0 };
+        std::promise<bool> _done;
+        std::atomic<bool> _finished{ false };
+    };
+}
+
+TEST(AsyncSocketClient, runManyClientsOnOneLoop)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kAsyncEchoPort, false, 5, 1000, 1000, 100, 8192 };
+
+    AsyncEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 16).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketEventLoop loop;
+    ASSERT_EQ(SocketCode::SUCCESS, loop.open().code());
+
+    constexpr int32_t kClients = 12;
+    constexpr int32_t kRounds = 20;
+
+    std::vector<std::shared_ptr<AsyncEchoSession>> sessions;
+    std::vector<std::future<bool>> results;
+    for (int32_t i = 0; i < kClients; i++)
+    {
+        sessions.push_back(std::make_shared<AsyncEchoSession>(loop, config, i, kRounds));
+        results.push_back(sessions.back()->start());
+    }
+
+    for (auto& result : results)
+    {
+        ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(20)));
+        EXPECT_TRUE(result.get());
+    }
+
+    for (auto& session : sessions)
+        session->close();
+    loop.close();
+    server.close();
+
+    releaseSecuritySocket();
+}
+
+TEST(AsyncSocketClient, shouldReturnFutures)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kAsyncEchoPort, false, 5, 1000, 1000, 100, 8192 };
+
+    AsyncEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 1).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketEventLoop loop;
+    ASSERT_EQ(SocketCode::SUCCESS, loop.open().code());
+
+    AsyncSocketClient client{ loop, config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connectAsync().get().code());
+
+    const char payload[] = "future based echo";
+    AsyncEchoHeader header{ sizeof(payload) };
+    auto header_written = client.writeAsync(&header, sizeof(header));
+    auto payload_written = client.writeAsync(payload, sizeof(payload));
+    EXPECT_EQ(static_cast<int32_t>(sizeof(header)), header_written.get().bytes());
+    EXPECT_EQ(static_cast<int32_t>(sizeof(payload)), payload_written.get().bytes());
+
+    char response[sizeof(header) + sizeof(payload)]{ 0 };
+    size_t received{ 0 };
+    while (received < sizeof(response))
+    {
+        auto result = client.readAsync(response + received, sizeof(response) - received).get();
+        ASSERT_EQ(SocketCode::SUCCESS, result.code());
+        received += result.bytes();
+    }
+    EXPECT_STREQ(payload, response + sizeof(header));
+
+    // A read nobody answers is failed by close().
+    char dummy[16];
+    auto pending = client.readAsync(dummy, sizeof(dummy));
+    client.close();
+    EXPECT_EQ(SocketCode::SOCKET_CLOSED, pending.get().code());
+
+    loop.close();
+    server.close();
+
+    releaseSecuritySocket();
+}
+
+TEST(AsyncSocketClient, shouldFailConnectWithoutServer)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kAsyncRefusedPort, false, 1, 500, 500, 100, 8192 };
+
+    SocketEventLoop loop;
+    ASSERT_EQ(SocketCode::SUCCESS, loop.open().code());
+
+    AsyncSocketClient client{ loop, config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+
+    auto connected = client.connectAsync();
+    ASSERT_EQ(std::future_status::ready, connected.wait_for(std::chrono::seconds(5)));
+    EXPECT_NE(SocketCode::SUCCESS, connected.get().code());
+
+    char buffer[16];
+    EXPECT_EQ(SocketCode::SOCKET_CLOSED, client.readAsync(buffer, sizeof(buffer)).get().code());
+
+    client.close();
+    loop.close();
+
+    releaseSecuritySocket();
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "securitysockettest_helper.hpp"
+
+namespace
+{
+    constexpr uint32_t kPoolEchoPort = 21355;
+    constexpr uint32_t kPoolBroadcastPort = 21356;
+
+    struct PoolEchoHeader
+    {
+        uint32_t payload_size{ 0 };
+    };
+
+    struct PoolEchoHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(PoolEchoHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const PoolEchoHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size
+        ) override {
+            (void)header;
+            memcpy(output_buffer, input_buffer, input_size);
+            *output_size = input_size;
+        }
+        void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+    };
+
+    struct PoolCountingHandler : public Bn3Monkey::SocketBroadcastHandler
+    {
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+            connected++;
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+            disconnected++;
+        }
+        std::atomic<int32_t> connected{ 0 };
+        std::atomic<int32_t> disconnected{ 0 };
+    };
+
+    template<class Predicate>
+    bool waitUntil(Predicate predicate, std::chrono::milliseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    void runPoolEcho(Bn3Monkey::SocketClient* client, const std::string& payload)
+    {
+        using namespace Bn3Monkey;
+
+        PoolEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+        ASSERT_EQ(SocketCode::SUCCESS, client->write(&header, sizeof(header)).code());
+        ASSERT_EQ(SocketCode::SUCCESS, client->write(payload.data(), payload.size()).code());
+
+        std::string response(payload.size(), '\0');
+        size_t received{ 0 };
+        while (received < response.size())
+        {
+            auto result = client->read(&response[received], response.size() - received);
+            ASSERT_EQ(SocketCode::SUCCESS, result.code());
+            received += result.bytes();
+        }
+        EXPECT_EQ(payload, response);
+    }
+}
+
+TEST(ClientPool, shouldReuseWarmConnections)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kPoolEchoPort, false, 5, 1000, 1000, 100, 8192 };
+
+    PoolEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 8).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClientPool pool{ config, 2, 4 };
+    ASSERT_EQ(SocketCode::SUCCESS, pool.open().code());
+
+    // Let the warmer connect in the background (connect() alone takes > 100 ms).
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));
+
+    SocketClient* client{ nullptr };
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(SocketCode::SUCCESS, pool.acquire(&client).code());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_NE(nullptr, client);
+    EXPECT_LT(elapsed, 50);
+
+    auto alive = client->isAlive();
+    EXPECT_EQ(SocketCode::SUCCESS, alive.code());
+    EXPECT_EQ(0, alive.bytes());
+
+    runPoolEcho(client, "first request");
+    pool.release(client);
+
+    // The connection just released is the one handed out next.
+    SocketClient* reused{ nullptr };
+    ASSERT_EQ(SocketCode::SUCCESS, pool.acquire(&reused).code());
+    EXPECT_EQ(client, reused);
+    runPoolEcho(reused, "second request");
+
+    // A connection with an unread response must not be pooled.
+    PoolEchoHeader header{ 4 };
+    reused->write(&header, sizeof(header));
+    reused->write("left", 4);
+    ASSERT_TRUE(waitUntil([&]() { return reused->isAlive().bytes() > 0; }, std::chrono::milliseconds(1000)));
+    pool.release(reused);
+
+    SocketClient* other{ nullptr };
+    ASSERT_EQ(SocketCode::SUCCESS, pool.acquire(&other).code());
+    EXPECT_EQ(0, other->isAlive().bytes());
+    runPoolEcho(other, "third request");
+    pool.release(other);
+
+    pool.close();
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(ClientPool, shouldDropConnectionsClosedByPeer)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kPoolBroadcastPort, false, 5, 1000, 1000, 100, 8192 };
+
+    PoolCountingHandler handler;
+    SocketBroadcastServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 8).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClientPool pool{ config, 2, 4 };
+    ASSERT_EQ(SocketCode::SUCCESS, pool.open().code());
+    ASSERT_TRUE(waitUntil([&]() { return handler.connected.load() == 2; }, std::chrono::milliseconds(3000)));
+
+    // FIN every pooled connection from the server side.
+    server.dropAll();
+    ASSERT_TRUE(waitUntil([&]() { return handler.disconnected.load() == 2; }, std::chrono::milliseconds(1000)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient* client{ nullptr };
+    ASSERT_EQ(SocketCode::SUCCESS, pool.acquire(&client).code());
+    ASSERT_NE(nullptr, client);
+    auto alive = client->isAlive();
+    EXPECT_EQ(SocketCode::SUCCESS, alive.code());
+    EXPECT_EQ(0, alive.bytes());
+    // The client handed out is a new connection, not one of the dropped ones.
+    EXPECT_TRUE(waitUntil([&]() { return handler.connected.load() >= 3; }, std::chrono::milliseconds(1000)));
+
+    pool.discard(client);
+    pool.close();
+    server.close();
+    releaseSecuritySocket();
+}
@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "securitysockettest_helper.hpp"
+
+#if defined(__cpp_impl_coroutine)
+#include <SecuritySocketCoroutine.hpp>
+#endif
+
+namespace
+{
+    constexpr uint32_t kSlowRequestPort = 21352;
+    constexpr uint32_t kCoroutineFrontPort = 21353;
+    constexpr uint32_t kCoroutineBackPort = 21354;
+
+    struct SlowRequestHeader
+    {
+        uint32_t payload_size{ 0 };
+        uint32_t is_slow{ 0 };
+    };
+
+    // Answers with the header followed by the reversed payload.
+    std::vector<char> makeReversedResponse(const char* header, const char* payload, size_t payload_size)
+    {
+        std::vector<char> response(sizeof(SlowRequestHeader) + payload_size);
+        memcpy(response.data(), header, sizeof(SlowRequestHeader));
+        std::reverse_copy(payload, payload + payload_size, response.data() + sizeof(SlowRequestHeader));
+        return response;
+    }
+
+    struct SlowRequestHandlerBase : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(SlowRequestHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const SlowRequestHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            return reinterpret_cast<const SlowRequestHeader*>(header)->is_slow ?
+                Bn3Monkey::SocketRequestMode::SLOW : Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size
+        ) override {
+            auto response = makeReversedResponse(header, input_buffer, input_size);
+            memcpy(output_buffer, response.data(), response.size());
+            *output_size = response.size();
+        }
+        void onProcessedWithoutResponse(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size
+        ) override {
+            (void)header;
+            (void)input_buffer;
+            (void)input_size;
+        }
+    };
+
+    // Finishes every SLOW request from a worker thread after a delay, so the
+    // server has several requests outstanding at once.
+    struct DeferredSlowRequestHandler : public SlowRequestHandlerBase
+    {
+        bool onProcessedAsync(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            Bn3Monkey::SocketRequestCompletion completion
+        ) override {
+            auto response = makeReversedResponse(header, input_buffer, input_size);
+            std::lock_guard<std::mutex> lock(mtx);
+            workers.emplace_back([completion, response]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                completion.complete(response.data(), response.size());
+            });
+            return true;
+        }
+
+        ~DeferredSlowRequestHandler() {
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        std::mutex mtx;
+        std::vector<std::thread> workers;
+    };
+
+    void runSlowRequestClient(uint32_t port, int32_t client_no, int32_t rounds, bool is_slow)
+    {
+        using namespace Bn3Monkey;
+
+        SocketConfiguration config{ "127.0.0.1", port, false, 5, 3000, 3000, 100, 8192 };
+        SocketClient client{ config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+        for (int32_t round = 0; round < rounds; round++)
+        {
+            std::string payload = "client " + std::to_string(client_no) + " round " + std::to_string(round);
+            SlowRequestHeader header{ static_cast<uint32_t>(payload.size()), is_slow ? 1u : 0u };
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+
+            std::vector<char> response(sizeof(header) + payload.size());
+            size_t received{ 0 };
+            while (received < response.size())
+            {
+                auto result = client.read(response.data() + received, response.size() - received);
+                ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                received += result.bytes();
+            }
+
+            std::string expected{ payload.rbegin(), payload.rend() };
+            EXPECT_EQ(expected, std::string(response.data() + sizeof(header), payload.size()));
+        }
+        client.close();
+    }
+}
+
+TEST(SlowRequest, shouldCompleteFromAnotherThread)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kSlowRequestPort, false, 5, 3000, 3000, 100, 8192 };
+
+    DeferredSlowRequestHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 8).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    constexpr int32_t kClients = 8;
+    constexpr int32_t kRounds = 5;
+
+    // Eight clients * five 100 ms requests: served one at a time this would
+    // take four seconds.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int32_t i = 0; i < kClients; i++)
+        clients.emplace_back(runSlowRequestClient, kSlowRequestPort, i, kRounds, true);
+    // FAST requests keep being served while SLOW ones are outstanding.
+    clients.emplace_back(runSlowRequestClient, kSlowRequestPort, kClients, kRounds, false);
+    for (auto& client : clients)
+        client.join();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    printConcurrent("SLOW requests finished in %lld ms\n", static_cast<long long>(elapsed));
+    EXPECT_LT(elapsed, 2000);
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+#if defined(__cpp_impl_coroutine)
+
+namespace
+{
+    // Front server: every SLOW request is forwarded to the back server from a
+    // coroutine, which suspends on the downstream round trip.
+    struct ForwardingCoroutineHandler : public Bn3Monkey::SocketCoroutineRequestHandler
+    {
+        explicit ForwardingCoroutineHandler(Bn3Monkey::SocketEventLoop& loop) : loop(loop) {}
+
+        size_t getHeaderSize() override {
+            return sizeof(SlowRequestHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const SlowRequestHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::SLOW;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(const char*, const char*, size_t, char*, size_t* output_size) override {
+            *output_size = 0;
+        }
+        void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+
+        Bn3Monkey::SocketTask<std::vector<char>> onProcessedCoroutine(
+            std::vector<char> header,
+            std::vector<char> payload
+        ) override {
+            using namespace Bn3Monkey;
+
+            SocketConfiguration config{ "127.0.0.1", kCoroutineBackPort, false, 5, 3000, 3000, 100, 8192 };
+            auto downstream = std::make_unique<SocketCoroutineClient>(loop, config);
+            if (downstream->open().code() != SocketCode::SUCCESS)
+                co_return std::vector<char>{};
+            if ((co_await downstream->connect()).code() != SocketCode::SUCCESS)
+                co_return std::vector<char>{};
+
+            // The back server treats it as FAST.
+            reinterpret_cast<SlowRequestHeader*>(header.data())->is_slow = 0;
+            co_await downstream->write(header.data(), header.size());
+            co_await downstream->write(payload.data(), payload.size());
+
+            std::vector<char> response(header.size() + payload.size());
+            auto result = co_await downstream->readFully(response.data(), response.size());
+            downstream->close();
+            if (result.code() != SocketCode::SUCCESS)
+                co_return std::vector<char>{};
+
+            forwarded++;
+            co_return response;
+        }
+
+        Bn3Monkey::SocketEventLoop& loop;
+        std::atomic<int32_t> forwarded{ 0 };
+    };
+}
+
+TEST(SlowRequest, shouldForwardThroughCoroutines)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration back_config{ "127.0.0.1", kCoroutineBackPort, false, 5, 3000, 3000, 100, 8192 };
+    SlowRequestHandlerBase back_handler;
+    SocketRequestServer back_server{ back_config };
+    ASSERT_EQ(SocketCode::SUCCESS, back_server.open(&back_handler, 16).code());
+
+    SocketEventLoop loop;
+    ASSERT_EQ(SocketCode::SUCCESS, loop.open().code());
+
+    SocketConfiguration front_config{ "127.0.0.1", kCoroutineFrontPort, false, 5, 3000, 3000, 100, 8192 };
+    ForwardingCoroutineHandler front_handler{ loop };
+    SocketRequestServer front_server{ front_config };
+    ASSERT_EQ(SocketCode::SUCCESS, front_server.open(&front_handler, 8).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    constexpr int32_t kClients = 4;
+    constexpr int32_t kRounds = 5;
+
+    std::vector<std::thread> clients;
+    for (int32_t i = 0; i < kClients; i++)
+        clients.emplace_back(runSlowRequestClient, kCoroutineFrontPort, i, kRounds, true);
+    for (auto& client : clients)
+        client.join();
+
+    EXPECT_EQ(kClients * kRounds, front_handler.forwarded.load());
+
+    front_server.close();
+    loop.close();
+    back_server.close();
+    releaseSecuritySocket();
+}
+
+#endif // __cpp_impl_coroutine
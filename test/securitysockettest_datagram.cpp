@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "securitysockettest_helper.hpp"
+
+namespace
+{
+    constexpr uint32_t kDatagramPort = 21372;
+    constexpr uint32_t kSegmentedDatagramPort = 21373;
+
+    struct DatagramCollector : public Bn3Monkey::SocketDatagramHandler
+    {
+        void onDatagramsReceived(const Bn3Monkey::SocketDatagram* datagrams, size_t count) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (size_t i = 0; i < count; i++)
+            {
+                received.emplace_back(datagrams[i].data, datagrams[i].size);
+                sender_ip = datagrams[i].ip;
+            }
+            batches++;
+        }
+        size_t size() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return received.size();
+        }
+
+        std::mutex mtx;
+        std::vector<std::string> received;
+        std::string sender_ip;
+        size_t batches{ 0 };
+    };
+
+    template<class Predicate>
+    bool waitUntil(Predicate predicate, std::chrono::milliseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    // Datagram i: its number, then filler up to size.
+    std::string makeDatagram(size_t i, size_t size)
+    {
+        std::string datagram = std::to_string(i) + ":";
+        datagram.resize(std::max(size, datagram.size()), static_cast<char>('a' + i % 26));
+        return datagram;
+    }
+}
+
+TEST(UDPDatagram, shouldReceiveBatchedDatagrams)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kDatagramPort, false, 3, 1000, 1000, 10, 4096 };
+    config.setDatagramBatchSize(16);
+
+    DatagramCollector collector;
+    SocketDatagramServer server{ config };
+    ASSERT_EQ(server.open(&collector).code(), SocketCode::SUCCESS);
+
+    SocketDatagramClient client{ config };
+    ASSERT_EQ(client.open().code(), SocketCode::SUCCESS);
+
+    // Varied sizes, an empty one included.
+    constexpr size_t num_of_datagrams = 200;
+    std::vector<std::string> sent;
+    for (size_t i = 0; i < num_of_datagrams; i++)
+        sent.push_back(i == 7 ? std::string{} : makeDatagram(i, (i * 37) % 1500));
+    std::vector<SocketIOBuffer> buffers(sent.size());
+    for (size_t i = 0; i < sent.size(); i++)
+    {
+        buffers[i].data = const_cast<char*>(sent[i].data());
+        buffers[i].size = sent[i].size();
+    }
+
+    // Loopback keeps them all, in order, as long as a round fits in the
+    // server's receive buffer.
+    constexpr size_t round_size = 40;
+    for (size_t offset = 0; offset < num_of_datagrams - 1; offset += round_size)
+    {
+        size_t count = std::min(round_size, num_of_datagrams - 1 - offset);
+        auto result = client.writeBatch(buffers.data() + offset, count);
+        EXPECT_EQ(result.code(), SocketCode::SUCCESS);
+        EXPECT_EQ(result.bytes(), static_cast<int32_t>(count));
+        EXPECT_TRUE(waitUntil([&] { return collector.size() >= offset + count; }, std::chrono::milliseconds(3000)));
+    }
+    auto result = client.write(sent.back().data(), sent.back().size());
+    EXPECT_EQ(result.code(), SocketCode::SUCCESS);
+    EXPECT_EQ(result.bytes(), static_cast<int32_t>(sent.back().size()));
+
+    EXPECT_TRUE(waitUntil([&] { return collector.size() >= num_of_datagrams; }, std::chrono::milliseconds(3000)));
+    {
+        std::lock_guard<std::mutex> lock(collector.mtx);
+        ASSERT_EQ(collector.received.size(), num_of_datagrams);
+        for (size_t i = 0; i < num_of_datagrams; i++)
+            EXPECT_EQ(collector.received[i], sent[i]) << "datagram " << i;
+        EXPECT_EQ(collector.sender_ip, "127.0.0.1");
+        EXPECT_LT(collector.batches, num_of_datagrams);
+    }
+
+    auto metrics = server.snapshot();
+    EXPECT_EQ(metrics.datagrams_received, num_of_datagrams);
+
+    // Too long for one UDP datagram.
+    std::vector<char> oversized(SocketDatagramClient::MAX_DATAGRAM_SIZE + 1, 'x');
+    EXPECT_EQ(client.write(oversized.data(), oversized.size()).code(), SocketCode::SOCKET_INVALID_ARGUMENT);
+
+    client.close();
+    server.close();
+    EXPECT_EQ(client.write(sent[0].data(), sent[0].size()).code(), SocketCode::SOCKET_CLOSED);
+    releaseSecuritySocket();
+}
+
+TEST(UDPDatagram, shouldSplitSegmentedDatagrams)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kSegmentedDatagramPort, false, 3, 1000, 1000, 10, 2048 };
+    config.setDatagramBatchSize(8);
+    config.setSegmentationOffload(true);
+
+    DatagramCollector collector;
+    SocketDatagramServer server{ config };
+    ASSERT_EQ(server.open(&collector).code(), SocketCode::SUCCESS);
+
+    SocketDatagramClient client{ config };
+    ASSERT_EQ(client.open().code(), SocketCode::SUCCESS);
+
+    // Runs of equal sizes, each ending shorter, go out as GSO sends where the
+    // kernel has it, and may arrive GRO coalesced. Either way the handler
+    // sees the datagrams as sent.
+    std::vector<std::string> sent;
+    for (size_t i = 0; i < 150; i++)
+        sent.push_back(makeDatagram(i, i % 50 == 49 ? 300 : 1200));
+    std::vector<SocketIOBuffer> buffers(sent.size());
+    for (size_t i = 0; i < sent.size(); i++)
+    {
+        buffers[i].data = const_cast<char*>(sent[i].data());
+        buffers[i].size = sent[i].size();
+    }
+
+    auto result = client.writeBatch(buffers.data(), buffers.size());
+    EXPECT_EQ(result.code(), SocketCode::SUCCESS);
+    EXPECT_EQ(result.bytes(), static_cast<int32_t>(sent.size()));
+
+    EXPECT_TRUE(waitUntil([&] { return collector.size() >= sent.size(); }, std::chrono::milliseconds(3000)));
+    {
+        std::lock_guard<std::mutex> lock(collector.mtx);
+        ASSERT_EQ(collector.received.size(), sent.size());
+        for (size_t i = 0; i < sent.size(); i++)
+            EXPECT_EQ(collector.received[i], sent[i]) << "datagram " << i;
+    }
+
+    client.close();
+    server.close();
+    releaseSecuritySocket();
+}
@@ -102,7 +102,7 @@ public:
     {
         {
             std::unique_lock<std::mutex> lock(_mtx);
-            _is_sleeping = false;
+            _is_woken = true;
             _cv.notify_all();
         }
     }
@@ -111,14 +111,15 @@ public:
     {
         {
             std::unique_lock<std::mutex> lock(_mtx);
-            _is_sleeping = true;
+            // A wake() that came first is kept rather than lost.
             _cv.wait(lock, [&](){
-                return !_is_sleeping;
+                return _is_woken;
             });
+            _is_woken = false;
         }
     }
 private:
-    bool _is_sleeping {false};
+    bool _is_woken {false};
     std::mutex _mtx;
     std::condition_variable _cv;
 };
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <vector>
+#include <string>
+
+#include "securitysockettest_helper.hpp"
+
+#if defined(__linux__)
+#include <dirent.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t kMultiplexPort = 21357;
+    constexpr uint32_t kMultiplexWindowPort = 21358;
+    // Nothing listens here.
+    constexpr uint32_t kMultiplexRefusedPort = 21381;
+
+    struct MultiplexHeader
+    {
+        uint64_t id{ 0 };
+        uint32_t payload_size{ 0 };
+        uint32_t is_held{ 0 };
+    };
+
+    struct MultiplexCodec : public Bn3Monkey::SocketMultiplexCodec
+    {
+        size_t getResponseHeaderSize() override {
+            return sizeof(MultiplexHeader);
+        }
+        size_t getResponsePayloadSize(const char* header) override {
+            return reinterpret_cast<const MultiplexHeader*>(header)->payload_size;
+        }
+        uint64_t getResponseId(const char* header) override {
+            return reinterpret_cast<const MultiplexHeader*>(header)->id;
+        }
+        void setRequestId(char* request, size_t size, uint64_t id) override {
+            (void)size;
+            reinterpret_cast<MultiplexHeader*>(request)->id = id;
+        }
+    };
+
+    // Echoes header (with its id) and payload. Requests flagged is_held are
+    // SLOW and only answered once release() is called.
+    struct MultiplexEchoHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(MultiplexHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const MultiplexHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            return reinterpret_cast<const MultiplexHeader*>(header)->is_held ?
+                Bn3Monkey::SocketRequestMode::SLOW : Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size
+        ) override {
+            memcpy(output_buffer, header, sizeof(MultiplexHeader));
+            memcpy(output_buffer + sizeof(MultiplexHeader), input_buffer, input_size);
+            *output_size = sizeof(MultiplexHeader) + input_size;
+        }
+        void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+
+        bool onProcessedAsync(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            Bn3Monkey::SocketRequestCompletion completion
+        ) override {
+            std::vector<char> response(sizeof(MultiplexHeader) + input_size);
+            size_t size{ 0 };
+            onProcessed(header, input_buffer, input_size, response.data(), &size);
+            std::lock_guard<std::mutex> lock(mtx);
+            held.emplace_back(completion, std::move(response));
+            return true;
+        }
+
+        void release() {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto& entry : held)
+                entry.first.complete(entry.second.data(), entry.second.size());
+            held.clear();
+        }
+
+        std::mutex mtx;
+        std::vector<std::pair<Bn3Monkey::SocketRequestCompletion, std::vector<char>>> held;
+    };
+
+    std::vector<char> makeMultiplexRequest(const std::string& payload, bool is_held = false)
+    {
+        std::vector<char> request(sizeof(MultiplexHeader) + payload.size());
+        MultiplexHeader header{ 0, static_cast<uint32_t>(payload.size()), is_held ? 1u : 0u };
+        memcpy(request.data(), &header, sizeof(header));
+        memcpy(request.data() + sizeof(header), payload.data(), payload.size());
+        return request;
+    }
+}
+
+TEST(MultiplexClient, shouldDemultiplexManyRequestsOnOneConnection)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kMultiplexPort, false, 5, 1000, 1000, 100, 8192 };
+
+    MultiplexEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    MultiplexCodec codec;
+    SocketMultiplexClient client{ config, &codec, 16 };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+
+    constexpr int32_t kThreads = 4;
+    constexpr int32_t kRequests = 100;
+
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&client, t]() {
+            std::vector<std::string> payloads;
+            std::vector<std::future<SocketMultiplexResponse>> responses;
+            for (int32_t i = 0; i < kRequests; i++)
+            {
+                payloads.push_back("thread " + std::to_string(t) + " request " + std::to_string(i));
+                auto request = makeMultiplexRequest(payloads.back());
+                responses.push_back(client.request(request.data(), request.size()));
+            }
+            for (int32_t i = 0; i < kRequests; i++)
+            {
+                auto response = responses[i].get();
+                ASSERT_EQ(SocketCode::SUCCESS, response.result.code());
+                EXPECT_EQ(payloads[i], std::string(response.payload.begin(), response.payload.end()));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(0u, client.outstanding());
+
+    client.close();
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(MultiplexClient, shouldApplyBackpressureWhenWindowIsFull)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kMultiplexWindowPort, false, 1, 300, 300, 100, 8192 };
+
+    MultiplexEchoHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    MultiplexCodec codec;
+    SocketMultiplexClient client{ config, &codec, 2 };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+
+    auto first_request = makeMultiplexRequest("first", true);
+    auto second_request = makeMultiplexRequest("second", true);
+    auto first = client.request(first_request.data(), first_request.size());
+    auto second = client.request(second_request.data(), second_request.size());
+    EXPECT_EQ(2u, client.outstanding());
+
+    // Window full: the third request waits, then gives up.
+    auto third_request = makeMultiplexRequest("third");
+    auto start = std::chrono::steady_clock::now();
+    auto third = client.request(third_request.data(), third_request.size());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(SocketCode::SOCKET_TIMEOUT, third.get().result.code());
+    EXPECT_GE(elapsed, 250);
+
+    // Room frees up as soon as held responses arrive.
+    std::thread releaser([&handler]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        handler.release();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        handler.release();
+    });
+    auto fourth_request = makeMultiplexRequest("fourth");
+    auto fourth = client.request(fourth_request.data(), fourth_request.size());
+
+    EXPECT_EQ("first", [&]() { auto r = first.get(); return std::string(r.payload.begin(), r.payload.end()); }());
+    EXPECT_EQ("second", [&]() { auto r = second.get(); return std::string(r.payload.begin(), r.payload.end()); }());
+    EXPECT_EQ("fourth", [&]() { auto r = fourth.get(); return std::string(r.payload.begin(), r.payload.end()); }());
+    releaser.join();
+
+    client.close();
+    server.close();
+    releaseSecuritySocket();
+}
+
+#if defined(__linux__)
+static size_t countOpenDescriptors()
+{
+    size_t count{ 0 };
+    DIR* directory = ::opendir("/proc/self/fd");
+    if (!directory)
+        return 0;
+    while (::readdir(directory))
+        count++;
+    ::closedir(directory);
+    return count;
+}
+
+TEST(MultiplexClient, shouldCloseSocketWhenConnectFails)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kMultiplexRefusedPort, false, 1, 100, 100, 10, 8192 };
+    MultiplexCodec codec;
+    SocketMultiplexClient client{ config, &codec, 2 };
+
+    size_t before = countOpenDescriptors();
+    for (int32_t i = 0; i < 5; i++)
+        EXPECT_NE(SocketCode::SUCCESS, client.open().code());
+    EXPECT_EQ(before, countOpenDescriptors());
+
+    client.close();
+    releaseSecuritySocket();
+}
+#endif
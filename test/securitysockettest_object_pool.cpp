@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include "implementation/ObjectPool.hpp"
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "securitysockettest_helper.hpp"
+
+namespace
+{
+    constexpr uint32_t kManyClientsPort = 21380;
+
+    struct PooledObject
+    {
+        PooledObject(int value) : value(value) {}
+        int value;
+    };
+
+    struct ManyClientsHeader
+    {
+        uint32_t payload_size{ 0 };
+    };
+
+    struct ManyClientsHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(ManyClientsHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const ManyClientsHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            (void)ip;
+            (void)port;
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            (void)ip;
+            (void)port;
+        }
+        void onProcessed(const char* header, const char* input_buffer, size_t input_size, char* output_buffer, size_t* output_size) override {
+            (void)header;
+            memcpy(output_buffer, input_buffer, input_size);
+            *output_size = input_size;
+        }
+        void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+    };
+}
+
+TEST(ObjectPool, shouldGrowWithoutMovingObjects)
+{
+    using namespace Bn3Monkey;
+    ObjectPool<PooledObject> pool{ 2 };
+    EXPECT_EQ(2u, pool.capacity());
+
+    auto* first = pool.acquire(1);
+    auto* second = pool.acquire(2);
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    EXPECT_EQ(nullptr, pool.acquire(3));
+
+    // A smaller size leaves the pool as it is.
+    pool.reserve(1);
+    EXPECT_EQ(2u, pool.capacity());
+
+    pool.reserve(5);
+    EXPECT_EQ(5u, pool.capacity());
+    std::vector<PooledObject*> added;
+    for (int i = 0; i < 3; i++)
+    {
+        added.push_back(pool.acquire(10 + i));
+        ASSERT_NE(nullptr, added.back());
+    }
+    EXPECT_EQ(nullptr, pool.acquire(4));
+    EXPECT_EQ(1, first->value);
+    EXPECT_EQ(2, second->value);
+
+    // Objects of either chunk come back, and nothing else is taken.
+    PooledObject outsider{ 0 };
+    pool.release(&outsider);
+    EXPECT_EQ(nullptr, pool.acquire(4));
+
+    pool.release(first);
+    pool.release(added[2]);
+    EXPECT_NE(nullptr, pool.acquire(5));
+    EXPECT_NE(nullptr, pool.acquire(6));
+    EXPECT_EQ(nullptr, pool.acquire(7));
+}
+
+TEST(ObjectPool, shouldReleaseIntoEveryChunk)
+{
+    using namespace Bn3Monkey;
+    constexpr int kNumOfChunks = 16;
+    ObjectPool<PooledObject> pool{ 1 };
+    for (int i = 2; i <= kNumOfChunks; i++)
+        pool.reserve(static_cast<size_t>(i * i));
+
+    std::vector<PooledObject*> objects;
+    for (size_t i = 0; i < pool.capacity(); i++)
+    {
+        objects.push_back(pool.acquire(static_cast<int>(i)));
+        ASSERT_NE(nullptr, objects.back());
+    }
+    EXPECT_EQ(nullptr, pool.acquire(-1));
+
+    // Back in an order unrelated to the chunks, and every one is taken.
+    for (size_t i = 0; i < objects.size(); i += 2)
+        pool.release(objects[i]);
+    for (size_t i = 1; i < objects.size(); i += 2)
+        pool.release(objects[objects.size() - i]);
+    for (size_t i = 0; i < objects.size(); i++)
+        EXPECT_NE(nullptr, pool.acquire(static_cast<int>(i)));
+    EXPECT_EQ(nullptr, pool.acquire(-1));
+}
+
+TEST(TCPRequestEcho, shouldServeNumOfClientsConnections)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    // More than the 32 connections open() used to keep at most.
+    constexpr size_t kNumOfClients = 48;
+    SocketConfiguration config{ "127.0.0.1", kManyClientsPort, false, 5, 1000, 1000, 10, 1024 };
+
+    ManyClientsHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, kNumOfClients).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::unique_ptr<SocketClient>> clients;
+    for (size_t i = 0; i < kNumOfClients; i++)
+    {
+        clients.emplace_back(new SocketClient{ config });
+        ASSERT_EQ(SocketCode::SUCCESS, clients.back()->open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, clients.back()->connect().code());
+    }
+
+    // Every client is still served while all of them are connected.
+    for (size_t i = 0; i < kNumOfClients; i++)
+    {
+        uint32_t payload = static_cast<uint32_t>(i);
+        ManyClientsHeader header{ sizeof(payload) };
+        ASSERT_EQ(SocketCode::SUCCESS, clients[i]->write(&header, sizeof(header)).code());
+        ASSERT_EQ(SocketCode::SUCCESS, clients[i]->write(&payload, sizeof(payload)).code());
+
+        uint32_t response{ 0 };
+        auto result = clients[i]->read(&response, sizeof(response));
+        ASSERT_EQ(SocketCode::SUCCESS, result.code());
+        ASSERT_EQ(static_cast<int32_t>(sizeof(response)), result.bytes());
+        EXPECT_EQ(payload, response);
+    }
+
+    for (auto& client : clients)
+        client->close();
+    server.close();
+    releaseSecuritySocket();
+}
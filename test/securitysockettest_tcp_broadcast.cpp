@@ -6,6 +6,8 @@
 #include <utility>
 #include <chrono>
 #include <future>
+#include <atomic>
+#include <mutex>
 
 #include "securitysockettest_helper.hpp"
 
@@ -40,10 +42,12 @@ struct BroadcastEventPatterns
 struct PrintingBroadcastHandler : public Bn3Monkey::SocketBroadcastHandler
 {
     TimeWatch* tw{ nullptr };
+    std::atomic<size_t> connected{ 0 };
     explicit PrintingBroadcastHandler(TimeWatch* tw_ = nullptr) : tw(tw_) {}
 
     void onClientConnected(const char* ip, int port) override {
         if (tw) tw->markf("[H] onClientConnected %s:%d", ip, port);
+        connected++;
         printConcurrent("[Server] client connected    %s:%d\n", ip, port);
     }
     void onClientDisconnected(const char* ip, int port) override {
@@ -55,7 +59,8 @@ struct PrintingBroadcastHandler : public Bn3Monkey::SocketBroadcastHandler
 
 // Repeated connect / disconnect cycles. write() skips when no client is
 // connected, so the test uses SimpleEvent to make sure the client has finished
-// connect() before the server starts writing each trial.
+// connect() before the server starts writing each trial. connect() can return
+// before the server accepts, so the server also waits for the handler.
 TEST(TCPBroadcast, shouldHandleRepeatedClientConnectionsAndDisconnections)
 {
     using namespace Bn3Monkey;
@@ -145,6 +150,10 @@ TEST(TCPBroadcast, shouldHandleRepeatedClientConnectionsAndDisconnections)
         event.sleep();
         tw.markf("[S] T%zu event.sleep end", trial);
 
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (handler.connected.load() <= trial && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
         for (size_t i = 0; i < BroadcastEventPatterns::NUM_OF_PATTERNS; i++)
         {
             auto* buffer = patterns.patterns[i].data();
@@ -441,3 +450,152 @@ TEST(TCPBroadcast, shouldRecoverViaDropAllWhenClientsAbandonSockets)
     tw.dump("shouldRecoverViaDropAllWhenClientsAbandonSockets");
     Bn3Monkey::releaseSecuritySocket();
 }
+
+TEST(TCPBroadcast, shouldReportFanOutMetrics)
+{
+    using namespace Bn3Monkey;
+
+    BroadcastEventPatterns patterns;
+
+    Bn3Monkey::initializeSecuritySocket();
+
+    constexpr uint32_t kPort = 21348;
+    constexpr size_t kClients = 2;
+    constexpr size_t kMessages = 20;
+
+    SocketConfiguration config{
+       "127.0.0.1",
+       kPort,
+       false,
+       5,
+       1000,
+       1000,
+       100,
+       8192
+    };
+
+    SocketBroadcastServer server{ config };
+    PrintingBroadcastHandler handler;
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, kClients).code());
+
+    std::vector<std::unique_ptr<SocketClient>> clients;
+    for (size_t i = 0; i < kClients; i++)
+    {
+        clients.emplace_back(new SocketClient{ config });
+        ASSERT_EQ(SocketCode::SUCCESS, clients.back()->open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, clients.back()->connect().code());
+    }
+    // await() returns once one client is active; wait for all of them.
+    for (int32_t i = 0; i < 100 && server.await(1000).bytes() < static_cast<int32_t>(kClients); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::vector<char> received(BroadcastEventPatterns::LENGTH_OF_PATTERN);
+    for (size_t i = 0; i < kMessages; i++)
+    {
+        ASSERT_EQ(SocketCode::SUCCESS, server.write(patterns.patterns[i].data(), BroadcastEventPatterns::LENGTH_OF_PATTERN).code());
+        for (auto& client : clients)
+        {
+            size_t total{ 0 };
+            while (total < received.size())
+            {
+                auto result = client->read(received.data() + total, received.size() - total);
+                ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                total += result.bytes();
+            }
+        }
+    }
+
+    auto metrics = server.snapshot();
+    EXPECT_EQ(kClients, metrics.accepted_connections);
+    EXPECT_EQ(0u, metrics.closed_connections);
+    EXPECT_EQ(kClients * kMessages * BroadcastEventPatterns::LENGTH_OF_PATTERN, metrics.bytes_sent);
+    EXPECT_EQ(kMessages, metrics.broadcast_fanout_time.count);
+    EXPECT_GT(metrics.broadcast_fanout_time.percentile(50), 0u);
+    EXPECT_EQ(0u, metrics.request_service_time.count);
+
+    for (auto& client : clients)
+        client->close();
+    EXPECT_EQ(SocketCode::SUCCESS, server.awaitClose(5000).code());
+    EXPECT_EQ(kClients, server.snapshot().closed_connections);
+
+    server.close();
+    Bn3Monkey::releaseSecuritySocket();
+}
+
+// Records the thread every handler call comes from.
+struct ThreadRecordingBroadcastHandler : public Bn3Monkey::SocketBroadcastHandler
+{
+    std::mutex mtx;
+    std::thread::id thread;
+    std::atomic<int32_t> disconnected{ 0 };
+
+    void onClientConnected(const char* ip, int port) override {
+        (void)ip; (void)port;
+        std::lock_guard<std::mutex> lock(mtx);
+        thread = std::this_thread::get_id();
+    }
+    void onClientDisconnected(const char* ip, int port) override {
+        (void)ip; (void)port;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            thread = std::this_thread::get_id();
+        }
+        disconnected++;
+    }
+};
+
+TEST(TCPBroadcast, shouldRunPostedTasksAndDropAllOnServerThread)
+{
+    using namespace Bn3Monkey;
+
+    Bn3Monkey::initializeSecuritySocket();
+
+    constexpr uint32_t kPort = 21369;
+
+    // Long enough that nothing here may wait out a read_timeout.
+    SocketConfiguration config{
+       "127.0.0.1",
+       kPort,
+       false,
+       5,
+       2000,
+       1000,
+       100,
+       8192
+    };
+
+    SocketBroadcastServer server{ config };
+    ThreadRecordingBroadcastHandler handler;
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 1).code());
+
+    SocketClient client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+    ASSERT_EQ(SocketCode::SUCCESS, server.await(1000).code());
+
+    auto start = std::chrono::steady_clock::now();
+    std::promise<std::thread::id> posted;
+    auto posted_f = posted.get_future();
+    ASSERT_EQ(SocketCode::SUCCESS, server.post([&]() { posted.set_value(std::this_thread::get_id()); }).code());
+    ASSERT_EQ(std::future_status::ready, posted_f.wait_for(std::chrono::milliseconds(1000)));
+    auto server_thread = posted_f.get();
+    EXPECT_NE(std::this_thread::get_id(), server_thread);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    // dropAll() returns once the handler has seen the client go.
+    start = std::chrono::steady_clock::now();
+    server.dropAll();
+    EXPECT_EQ(1, handler.disconnected.load());
+    {
+        std::lock_guard<std::mutex> lock(handler.mtx);
+        EXPECT_EQ(server_thread, handler.thread);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    start = std::chrono::steady_clock::now();
+    server.close();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    client.close();
+    Bn3Monkey::releaseSecuritySocket();
+}
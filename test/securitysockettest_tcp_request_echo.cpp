@@ -4,9 +4,18 @@
 #include <thread>
 #include <random>
 #include <utility>
+#include <atomic>
+#include <mutex>
 
 #include "securitysockettest_helper.hpp"
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
 const char* test_patterns[] = {
     "Hello, world!",
     "The quick brown fox jumps over the lazy dog.",
@@ -94,7 +103,7 @@ struct EchoRequestHandler : public Bn3Monkey::SocketRequestHandler
         case 0:
             printConcurrent("[Client %d -> Server] : %s\n", derived_header->client_no, input_buffer);
             
-            auto* response = new (output_buffer) EchoResponse{ {derived_header->request_type, derived_header->request_no, sizeof(EchoResponse)}, input_buffer, input_size };
+            new (output_buffer) EchoResponse{ {derived_header->request_type, derived_header->request_no, sizeof(EchoResponse)}, input_buffer, input_size };
             *output_size = sizeof(EchoResponse);
             
             break;
@@ -106,6 +115,9 @@ struct EchoRequestHandler : public Bn3Monkey::SocketRequestHandler
         const char* input_buffer,
         size_t input_size
     ) override {
+        (void)header;
+        (void)input_buffer;
+        (void)input_size;
         return;
     }
 };
@@ -198,4 +210,410 @@ TEST(TCPRequestEcho, runFourClient)
     
     releaseSecuritySocket();
     return;
-}
\ No newline at end of file
+}
+
+// Whether this kernel can run the ring SocketEventRing sets up.
+static bool isIoUringAvailable()
+{
+#if defined(__linux__) && !defined(__ANDROID__)
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 8, &params));
+    if (fd < 0)
+        return false;
+    ::close(fd);
+    return (params.features & IORING_FEAT_EXT_ARG) && (params.features & IORING_FEAT_NODROP);
+#else
+    return false;
+#endif
+}
+
+TEST(TCPRequestEcho, runFourClientOnIoUring)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{
+        "127.0.0.1",
+        21345,
+        false,
+        5,
+        1000,
+        1000,
+        100,
+        8192
+    };
+    config.setEventBackend(SocketEventBackend::IO_URING);
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    EXPECT_EQ(SocketEventBackend::POLL, server.eventBackend());
+
+    auto result = server.open(&handler, 4);
+    ASSERT_EQ(SocketCode::SUCCESS, result.code());
+    // poll() only where the kernel cannot run the ring.
+    EXPECT_EQ(isIoUringAvailable() ? SocketEventBackend::IO_URING : SocketEventBackend::POLL, server.eventBackend());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::thread client1{ runEchoClient, 1 };
+    std::thread client2{ runEchoClient, 2 };
+    std::thread client3{ runEchoClient, 3 };
+    std::thread client4{ runEchoClient, 4 };
+
+    client1.join();
+    client2.join();
+    client3.join();
+    client4.join();
+
+    server.close();
+
+    releaseSecuritySocket();
+}
+
+TEST(TCPRequestEcho, shouldReportMetrics)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 1000, 1000, 100, 8192 };
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::thread client1{ runEchoClient, 1 };
+    std::thread client2{ runEchoClient, 2 };
+    client1.join();
+    client2.join();
+
+    // Both clients are gone; give the server thread a moment to notice.
+    SocketServerMetrics metrics;
+    for (int32_t i = 0; i < 100; i++)
+    {
+        metrics = server.snapshot();
+        if (metrics.closed_connections == 2)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    constexpr uint64_t kRequests = 2 * sizeof(test_patterns) / sizeof(test_patterns[0]);
+    size_t request_bytes{ 0 };
+    for (auto* pattern : test_patterns)
+        request_bytes += sizeof(EchoRequestHeader) + strlen(pattern);
+
+    EXPECT_EQ(2u, metrics.accepted_connections);
+    EXPECT_EQ(2u, metrics.closed_connections);
+    EXPECT_EQ(kRequests, metrics.requests[static_cast<size_t>(SocketRequestMode::FAST)]);
+    EXPECT_EQ(0u, metrics.requests[static_cast<size_t>(SocketRequestMode::SLOW)]);
+    EXPECT_EQ(2 * request_bytes, metrics.bytes_received);
+    EXPECT_EQ(kRequests * sizeof(EchoResponse), metrics.bytes_sent);
+    EXPECT_GT(metrics.event_loop_wakeups, 0u);
+    EXPECT_GT(metrics.processing_time_ns, 0u);
+
+    auto& service_time = metrics.request_service_time;
+    EXPECT_EQ(kRequests, service_time.count);
+    EXPECT_LE(service_time.percentile(50), service_time.percentile(99));
+    EXPECT_LE(service_time.percentile(99), service_time.max_ns);
+    EXPECT_GE(service_time.max_ns, service_time.mean());
+    EXPECT_EQ(0u, metrics.broadcast_fanout_time.count);
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TCPRequestEcho, shouldDumpTrace)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 1000, 1000, 100, 8192 };
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::thread client{ runEchoClient, 1 };
+    client.join();
+    server.close();
+
+    const char* path = "securitysockettest_trace.json";
+    if (!dumpSecuritySocketTrace(path))
+    {
+        releaseSecuritySocket();
+        GTEST_SKIP() << "library built without SECURITYSOCKET_USING_TRACE";
+    }
+
+    std::string trace;
+    if (auto* fp = fopen(path, "rb"))
+    {
+        char buffer[4096];
+        size_t size{ 0 };
+        while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+            trace.append(buffer, size);
+        fclose(fp);
+    }
+    remove(path);
+
+    EXPECT_EQ(0u, trace.find("{\"displayTimeUnit\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"accept\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"wait\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"READING_PAYLOAD\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"WRITING_RESPONSE\""));
+
+    releaseSecuritySocket();
+}
+
+// Requests of type 1 go SLOW and are never completed.
+struct StallingRequestHandler : public EchoRequestHandler
+{
+    Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+        return reinterpret_cast<const EchoRequestHeader*>(header)->request_type == 1 ?
+            Bn3Monkey::SocketRequestMode::SLOW : Bn3Monkey::SocketRequestMode::FAST;
+    }
+    bool onProcessedAsync(const char*, const char*, size_t, Bn3Monkey::SocketRequestCompletion completion) override {
+        std::lock_guard<std::mutex> lock(mtx);
+        completions.push_back(completion);
+        return true;
+    }
+
+    std::mutex mtx;
+    std::vector<Bn3Monkey::SocketRequestCompletion> completions;
+};
+
+TEST(TCPRequestEcho, shouldCloseConnectionsPastDeadlines)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 1000, 1000, 100, 8192 };
+    config.setIdleTimeout(200);
+    config.setRequestReadTimeout(300);
+    config.setProcessingTimeout(200);
+
+    StallingRequestHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 8).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Connects and stays silent : idle timeout.
+    SocketClient idle_client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, idle_client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, idle_client.connect().code());
+
+    // Sends a SLOW request the handler never completes : processing timeout.
+    SocketClient stalled_client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, stalled_client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, stalled_client.connect().code());
+    EchoRequestHeader stalled_header{ 1, 0, 0, 0 };
+    ASSERT_EQ(SocketCode::SUCCESS, stalled_client.write(&stalled_header, sizeof(stalled_header)).code());
+
+    // Trickles its header a byte at a time, too fast for the idle timeout :
+    // request read timeout.
+    std::thread trickling{ [&]() {
+        SocketClient client{ config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+        EchoRequestHeader header{ 0, 0, 0, 0 };
+        auto* bytes = reinterpret_cast<const char*>(&header);
+        for (size_t i = 0; i + 1 < sizeof(header); i++)
+        {
+            if (client.write(bytes + i, 1).code() != SocketCode::SUCCESS)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        client.close();
+    } };
+
+    // Keeps sending requests, so it outlives every deadline.
+    SocketClient busy_client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, busy_client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, busy_client.connect().code());
+    const char* pattern = "ping";
+    std::vector<char> request_container(sizeof(EchoRequestHeader) + strlen(pattern));
+    memcpy(request_container.data() + sizeof(EchoRequestHeader), pattern, strlen(pattern));
+    std::vector<char> response_container(sizeof(EchoResponse));
+    for (int32_t i = 0; i < 10; i++)
+    {
+        EchoRequestHeader request_header{ 0, i, strlen(pattern), 0 };
+        memcpy(request_container.data(), &request_header, sizeof(EchoRequestHeader));
+        ASSERT_EQ(SocketCode::SUCCESS, busy_client.write(request_container.data(), request_container.size()).code());
+
+        size_t received{ 0 };
+        while (received < response_container.size())
+        {
+            auto ret = busy_client.read(response_container.data() + received, response_container.size() - received);
+            ASSERT_EQ(SocketCode::SUCCESS, ret.code());
+            received += ret.bytes();
+        }
+        ASSERT_EQ(i, reinterpret_cast<EchoResponse*>(response_container.data())->header.response_no);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    trickling.join();
+
+    SocketServerMetrics metrics = server.snapshot();
+    EXPECT_EQ(4u, metrics.accepted_connections);
+    EXPECT_EQ(3u, metrics.timed_out_connections);
+    EXPECT_EQ(3u, metrics.closed_connections);
+
+    // The handler can no longer answer the abandoned request.
+    {
+        std::lock_guard<std::mutex> lock(handler.mtx);
+        ASSERT_EQ(1u, handler.completions.size());
+        EXPECT_EQ(SocketCode::SOCKET_CLOSED, handler.completions[0].complete(nullptr, 0).code());
+    }
+
+    busy_client.close();
+    stalled_client.close();
+    idle_client.close();
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TCPRequestEcho, shouldRunTimers)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    // A long read_timeout: timers added from here wake the server thread.
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 2000, 1000, 100, 8192 };
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    EXPECT_EQ(0u, server.addTimer(10, []() {}));
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+
+    std::atomic<int32_t> fired{ 0 };
+    std::atomic<bool> is_cancelled_fired{ false };
+    std::atomic<bool> is_chained_fired{ false };
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int64_t> elapsed_ms{ 0 };
+
+    EXPECT_NE(0u, server.addTimer(50, [&]() {
+        elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        fired++;
+        // Timers may be added from a timer, on the server thread.
+        server.addTimer(20, [&]() { is_chained_fired = true; });
+    }));
+    auto cancelled = server.addTimer(100, [&]() { is_cancelled_fired = true; });
+    server.cancelTimer(cancelled);
+
+    for (int32_t i = 0; i < 100 && !is_chained_fired; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+    EXPECT_EQ(1, fired.load());
+    EXPECT_GE(elapsed_ms.load(), 50);
+    EXPECT_TRUE(is_chained_fired);
+    EXPECT_FALSE(is_cancelled_fired);
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TCPRequestEcho, shouldWakeForPostAndClose)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    // Neither post() nor close() may wait out a read_timeout this long.
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 2000, 1000, 100, 8192 };
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    EXPECT_EQ(SocketCode::SOCKET_CLOSED, server.post([]() {}).code());
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    // Let the server thread fall asleep in its wait.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<int32_t> order;
+    std::thread::id server_thread;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(SocketCode::SUCCESS, server.post([&, i]() {
+            std::lock_guard<std::mutex> lock(mtx);
+            server_thread = std::this_thread::get_id();
+            order.push_back(i);
+            cv.notify_all();
+        }).code());
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        EXPECT_TRUE(cv.wait_for(lock, std::chrono::milliseconds(1000), [&]() { return order.size() == 3; }));
+        EXPECT_EQ((std::vector<int32_t>{ 0, 1, 2 }), order);
+        EXPECT_NE(std::this_thread::get_id(), server_thread);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    start = std::chrono::steady_clock::now();
+    server.close();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    EXPECT_EQ(SocketCode::SOCKET_CLOSED, server.post([]() {}).code());
+
+    releaseSecuritySocket();
+}
+
+TEST(TCPRequestEcho, shouldWriteAndReadScatteredBuffers)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 1000, 1000, 100, 8192 };
+
+    EchoRequestHandler handler;
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+    int32_t count{ 0 };
+    for (auto* pattern : test_patterns) {
+        EchoRequestHeader request_header{ 0, count++, strlen(pattern), 1 };
+        SocketIOBuffer request[] = {
+            { &request_header, sizeof(EchoRequestHeader) },
+            { nullptr, 0 },
+            { const_cast<char*>(pattern), strlen(pattern) },
+        };
+        auto written = client.writev(request, 3);
+        ASSERT_EQ(SocketCode::SUCCESS, written.code());
+        EXPECT_EQ(static_cast<int32_t>(sizeof(EchoRequestHeader) + strlen(pattern)), written.bytes());
+
+        // The header and the payload land in separate buffers.
+        EchoResponseHeader response_header;
+        std::vector<char> data(sizeof(EchoResponse) - sizeof(EchoResponseHeader));
+        size_t read_size{ 0 };
+        while (read_size < sizeof(EchoResponse))
+        {
+            SocketIOBuffer response[] = {
+                { reinterpret_cast<char*>(&response_header), sizeof(EchoResponseHeader) },
+                { data.data(), data.size() },
+            };
+            // Skip what has already come in.
+            size_t first = read_size < sizeof(EchoResponseHeader) ? 0 : 1;
+            size_t skipped = first == 0 ? read_size : read_size - sizeof(EchoResponseHeader);
+            response[first].data = static_cast<char*>(response[first].data) + skipped;
+            response[first].size -= skipped;
+
+            auto ret = client.readv(response + first, 2 - first);
+            ASSERT_EQ(SocketCode::SUCCESS, ret.code());
+            read_size += ret.bytes();
+        }
+
+        EXPECT_EQ(response_header.response_no, request_header.request_no);
+        EXPECT_EQ(response_header.request_type, request_header.request_type);
+        EXPECT_STREQ(data.data(), pattern);
+    }
+
+    client.close();
+    server.close();
+    releaseSecuritySocket();
+}
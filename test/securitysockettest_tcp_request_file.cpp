@@ -5,6 +5,16 @@
 #include <random>
 #include <utility>
 #include <cstdio>
+#include <atomic>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "securitysockettest_helper.hpp"
 
@@ -120,6 +130,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
         char* output_buffer,
         size_t* output_size
     ) override {
+        (void)input_size;
 
         auto* derived_header = reinterpret_cast<const FileRequestHeader*>(header);
 
@@ -127,7 +138,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
         case FileRequestType::CREATE_HANDLE: {
                 printConcurrent("[Client %d -> Server] : Create Handle \n", derived_header->client_no);
 
-                auto* response = new (output_buffer) FileResponseHeader{ derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)};
+                new (output_buffer) FileResponseHeader{ derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)};
                 *output_size = sizeof(FileResponseHeader);
             }
             break;
@@ -138,7 +149,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
                 auto* open_request_payload = reinterpret_cast<const FileOpenRequestPayload*>(input_buffer);
                 auto fp = fopen(open_request_payload->filename, "wb");
 
-                auto* response = new (output_buffer) FileOpenResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)}, fp };
+                new (output_buffer) FileOpenResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)}, fp };
                 *output_size = sizeof(FileOpenResponse);
             }
             break;
@@ -149,7 +160,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
                 auto* open_request_payload = reinterpret_cast<const FileOpenRequestPayload*>(input_buffer);
                 auto fp = fopen(open_request_payload->filename, "rb");
 
-                auto* response = new (output_buffer) FileOpenResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)}, fp };
+                new (output_buffer) FileOpenResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileOpenResponse)}, fp };
                 *output_size = sizeof(FileOpenResponse);
             }
             break;
@@ -160,7 +171,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
                 auto* close_request_payload = reinterpret_cast<const FileCloseRequestPayload*>(input_buffer);
                 fclose(close_request_payload->fp);
 
-                auto* response = new (output_buffer) FileCloseResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileCloseResponse)} };
+                new (output_buffer) FileCloseResponse{ {derived_header->request_type, derived_header->request_no, sizeof(FileCloseResponse)} };
                 *output_size = sizeof(FileCloseResponse);
             }
             break;
@@ -189,6 +200,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
         const char* input_buffer,
         size_t input_size
     ) override {
+        (void)input_size;
         auto* derived_header = reinterpret_cast<const FileRequestHeader*>(header);
         switch (derived_header->request_type) {
         case FileRequestType::WRITE_FILE:
@@ -197,7 +209,7 @@ struct FileRequestHandler : public Bn3Monkey::SocketRequestHandler
 
                 auto* write_request_payload = reinterpret_cast<const FileWriteRequestPayload*>(input_buffer);
 
-                auto length = fwrite(write_request_payload->data, 1, write_request_payload->length, write_request_payload->fp);
+                fwrite(write_request_payload->data, 1, write_request_payload->length, write_request_payload->fp);
             }
             break;
 
@@ -462,4 +474,166 @@ TEST(TCPRequestFile, runFourClient)
 
     releaseSecuritySocket();
     return;
-}
\ No newline at end of file
+}
+
+struct FileStreamRequest
+{
+    int64_t offset{ 0 };
+    uint64_t size{ 0 };
+    // Streams from a pipe the handler fills from another thread.
+    int32_t use_pipe{ 0 };
+};
+
+struct FileStreamHandler : public Bn3Monkey::SocketRequestHandler
+{
+    std::string filename;
+    std::vector<char> pipe_data;
+    std::vector<std::thread> writers;
+    std::atomic<int32_t> streamed{ 0 };
+
+    ~FileStreamHandler() {
+        for (auto& writer : writers)
+            writer.join();
+    }
+
+    size_t getHeaderSize() override {
+        return sizeof(FileStreamRequest);
+    }
+    size_t getPayloadSize(const char* header) override {
+        (void)header;
+        return 0;
+    }
+    Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+        (void)header;
+        return Bn3Monkey::SocketRequestMode::READ_STREAM;
+    }
+    void onClientConnected(const char* ip, int port) override {
+        printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+    }
+    void onClientDisconnected(const char* ip, int port) override {
+        printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+    }
+    void onProcessed(const char*, const char*, size_t, char*, size_t* output_size) override {
+        *output_size = 0;
+    }
+    void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+
+    bool onFileRequested(
+        const char* header,
+        const char* input_buffer,
+        size_t input_size,
+        char* output_buffer,
+        size_t* output_size,
+        Bn3Monkey::SocketFileRange* file
+    ) override {
+        (void)input_buffer;
+        (void)input_size;
+        auto* request = reinterpret_cast<const FileStreamRequest*>(header);
+
+        // The size goes first, then the server streams the range.
+        memcpy(output_buffer, &request->size, sizeof(request->size));
+        *output_size = sizeof(request->size);
+
+        file->size = request->size;
+        file->close_after = true;
+        if (request->use_pipe)
+        {
+#ifdef _WIN32
+            return false;
+#else
+            int fds[2];
+            if (pipe(fds) != 0)
+                return false;
+            file->fd = fds[0];
+            // Slower than the socket, so the server has to wait for the pipe.
+            writers.emplace_back([this, writer = fds[1], size = request->size]() {
+                for (uint64_t sent = 0; sent < size; )
+                {
+                    size_t chunk = static_cast<size_t>(std::min<uint64_t>(16384, size - sent));
+                    auto ret = write(writer, pipe_data.data() + sent, chunk);
+                    if (ret <= 0)
+                        break;
+                    sent += ret;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                close(writer);
+            });
+#endif
+        }
+        else
+        {
+#ifdef _WIN32
+            file->fd = _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+            file->fd = open(filename.c_str(), O_RDONLY);
+#endif
+            file->offset = request->offset;
+        }
+        streamed++;
+        return true;
+    }
+};
+
+TEST(TCPRequestFile, shouldStreamFileRanges)
+{
+    using namespace Bn3Monkey;
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", 21345, false, 5, 1000, 1000, 100, 8192 };
+
+    FileStreamHandler handler;
+    handler.filename = "testfile_stream.bin";
+    std::vector<char> contents(4 * 1024 * 1024);
+    for (size_t i = 0; i < contents.size(); i++)
+        contents[i] = static_cast<char>((i * 31) ^ (i >> 12));
+    {
+        FILE* fp = fopen(handler.filename.c_str(), "wb");
+        ASSERT_NE(nullptr, fp);
+        fwrite(contents.data(), 1, contents.size(), fp);
+        fclose(fp);
+    }
+    handler.pipe_data.assign(contents.begin(), contents.begin() + 512 * 1024);
+
+    SocketRequestServer server{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient client{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+    std::vector<FileStreamRequest> requests = {
+        { 0, contents.size(), 0 },
+        { 12345, 100000, 0 },
+        { static_cast<int64_t>(contents.size()) - 10, 10, 0 },
+#ifndef _WIN32
+        { 0, handler.pipe_data.size(), 1 },
+#endif
+        // Back to a file behind the pipe.
+        { 4096, 4096, 0 },
+    };
+    for (auto& request : requests)
+    {
+        ASSERT_EQ(SocketCode::SUCCESS, client.write(&request, sizeof(request)).code());
+
+        uint64_t size{ 0 };
+        std::vector<char> response(sizeof(size) + request.size);
+        size_t received{ 0 };
+        while (received < response.size())
+        {
+            auto result = client.read(response.data() + received, response.size() - received);
+            ASSERT_EQ(SocketCode::SUCCESS, result.code());
+            received += result.bytes();
+        }
+        memcpy(&size, response.data(), sizeof(size));
+        EXPECT_EQ(request.size, size);
+        auto* expected = request.use_pipe ? handler.pipe_data.data() : contents.data() + request.offset;
+        EXPECT_TRUE(memcmp(response.data() + sizeof(size), expected, request.size) == 0);
+    }
+    EXPECT_EQ(static_cast<int32_t>(requests.size()), handler.streamed.load());
+
+    client.close();
+    server.close();
+    remove(handler.filename.c_str());
+    releaseSecuritySocket();
+}
@@ -0,0 +1,1002 @@
+#include <gtest/gtest.h>
+
+#include <SecuritySocket.hpp>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#endif
+
+#include "securitysockettest_helper.hpp"
+
+namespace
+{
+    constexpr uint32_t kTLSEchoPort = 21359;
+    constexpr uint32_t kTLSBroadcastPort = 21360;
+    constexpr uint32_t kTLSStallPort = 21361;
+    constexpr uint32_t kTLSHandshakePort = 21362;
+    constexpr uint32_t kTLSKernelPort = 21363;
+    constexpr uint32_t kTLSPoolPort = 21364;
+    constexpr uint32_t kTLSRecordPort = 21365;
+    constexpr uint32_t kTLSMemoryBIOPort = 21366;
+    constexpr uint32_t kTLSFastConnectPort = 21367;
+    constexpr uint32_t kTLSEarlyDataPort = 21368;
+    constexpr uint32_t kTLSGatherPort = 21370;
+    constexpr uint32_t kTLSFilePort = 21371;
+
+    constexpr const char* kCertPath = "securitysockettest_tls_server.crt";
+    constexpr const char* kKeyPath = "securitysockettest_tls_server.key";
+
+    // Self-signed P-256 certificate generated with the openssl CLI, so the test
+    // does not depend on files shipped with the repository.
+    bool generateCertificate()
+    {
+        static int result = std::system(
+            "openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 "
+            "-subj /CN=127.0.0.1 -keyout securitysockettest_tls_server.key "
+            "-out securitysockettest_tls_server.crt"
+#if defined(_WIN32)
+            " > NUL 2>&1"
+#else
+            " > /dev/null 2>&1"
+#endif
+        );
+        return result == 0;
+    }
+
+    Bn3Monkey::SocketTLSServerConfiguration makeServerConfiguration(bool use_kernel_tls = false)
+    {
+        using namespace Bn3Monkey;
+        SocketTLSServerConfiguration configuration{
+            { SocketTLSVersion::TLS1_2, SocketTLSVersion::TLS1_3 },
+            {}, {},
+            kCertPath, kKeyPath
+        };
+        configuration.setKernelTLS(use_kernel_tls);
+        return configuration;
+    }
+
+    std::atomic<int32_t> resumed_handshakes{ 0 };
+    std::atomic<int32_t> full_handshakes{ 0 };
+    std::atomic<int32_t> kernel_tls_reports{ 0 };
+    std::atomic<int32_t> kernel_tls_offloads{ 0 };
+    void countHandshakes(const char* event)
+    {
+        if (strcmp(event, "Handshake done (session resumed)") == 0)
+            resumed_handshakes++;
+        else if (strcmp(event, "Handshake done (full handshake)") == 0)
+            full_handshakes++;
+        else if (strncmp(event, "Kernel TLS", 10) == 0)
+        {
+            kernel_tls_reports++;
+            if (strstr(event, "receive : on"))
+                kernel_tls_offloads++;
+        }
+    }
+
+    Bn3Monkey::SocketTLSClientConfiguration makeClientConfiguration(Bn3Monkey::SocketTLSVersion version, bool resume_session = false, bool use_kernel_tls = false)
+    {
+        using namespace Bn3Monkey;
+        SocketTLSClientConfiguration configuration{ { version } };
+        configuration.setSessionResumption(resume_session);
+        configuration.setKernelTLS(use_kernel_tls);
+        configuration.setOnTLSEvent(countHandshakes);
+        return configuration;
+    }
+
+    struct TLSEchoHeader
+    {
+        uint32_t payload_size{ 0 };
+    };
+
+    struct TLSEchoHandler : public Bn3Monkey::SocketRequestHandler
+    {
+        size_t getHeaderSize() override {
+            return sizeof(TLSEchoHeader);
+        }
+        size_t getPayloadSize(const char* header) override {
+            return reinterpret_cast<const TLSEchoHeader*>(header)->payload_size;
+        }
+        Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+            (void)header;
+            return Bn3Monkey::SocketRequestMode::FAST;
+        }
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+            connected++;
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+        }
+        void onProcessed(
+            const char* header,
+            const char* input_buffer,
+            size_t input_size,
+            char* output_buffer,
+            size_t* output_size
+        ) override {
+            (void)header;
+            memcpy(output_buffer, input_buffer, input_size);
+            *output_size = input_size;
+            processed++;
+        }
+        void onProcessedWithoutResponse(const char*, const char*, size_t) override {}
+
+        std::atomic<int32_t> connected{ 0 };
+        std::atomic<int32_t> processed{ 0 };
+    };
+
+    struct TLSCountingHandler : public Bn3Monkey::SocketBroadcastHandler
+    {
+        void onClientConnected(const char* ip, int port) override {
+            printConcurrent("Client connected (ip : %s port : %d)\n", ip, port);
+            connected++;
+        }
+        void onClientDisconnected(const char* ip, int port) override {
+            printConcurrent("Client disconnected (ip : %s port : %d)\n", ip, port);
+            disconnected++;
+        }
+        std::atomic<int32_t> connected{ 0 };
+        std::atomic<int32_t> disconnected{ 0 };
+    };
+
+    void runTLSEcho(Bn3Monkey::SocketClient& client, const std::string& payload)
+    {
+        using namespace Bn3Monkey;
+
+        TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+        ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+
+        std::string response(payload.size(), '\0');
+        size_t received{ 0 };
+        while (received < response.size())
+        {
+            auto result = client.read(&response[received], response.size() - received);
+            ASSERT_EQ(SocketCode::SUCCESS, result.code());
+            received += result.bytes();
+        }
+        EXPECT_EQ(payload, response);
+    }
+}
+
+#define SKIP_WITHOUT_TLS_SERVER(open_result) \
+    if ((open_result).code() == Bn3Monkey::SocketCode::TLS_CONTEXT_INITIALIZATION_FAIL) \
+        GTEST_SKIP() << "library built without TLS support"
+
+TEST(TLSServer, shouldEchoOverTLS12AndTLS13)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    // TLS 1.3 clients wait read_timeout for post-handshake messages on connect().
+    SocketConfiguration config{ "127.0.0.1", kTLSEchoPort, false, 5, 300, 1000, 100, 8192 };
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 8);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::thread> clients;
+    for (int32_t i = 0; i < 4; i++)
+    {
+        clients.emplace_back([&config, i]() {
+            auto version = i % 2 ? SocketTLSVersion::TLS1_3 : SocketTLSVersion::TLS1_2;
+            SocketClient client{ config, makeClientConfiguration(version) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+            for (int32_t round = 0; round < 10; round++)
+                runTLSEcho(client, "client " + std::to_string(i) + " round " + std::to_string(round));
+            // Larger than one TLS record.
+            runTLSEcho(client, std::string(6000, static_cast<char>('a' + i)));
+            client.close();
+        });
+    }
+    for (auto& client : clients)
+        client.join();
+
+    EXPECT_EQ(4, handler.connected.load());
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldResumeSessions)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSEchoPort, false, 5, 300, 1000, 100, 8192 };
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 4);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    for (auto version : { SocketTLSVersion::TLS1_2, SocketTLSVersion::TLS1_3 })
+    {
+        resumed_handshakes = 0;
+        full_handshakes = 0;
+        for (int32_t i = 0; i < 3; i++)
+        {
+            SocketClient client{ config, makeClientConfiguration(version, true) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+            runTLSEcho(client, "resumption " + std::to_string(i));
+            client.close();
+        }
+        EXPECT_EQ(1, full_handshakes.load());
+        EXPECT_EQ(2, resumed_handshakes.load());
+    }
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldBroadcastOverTLS)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSBroadcastPort, false, 5, 1000, 1000, 100, 8192 };
+
+    TLSCountingHandler handler;
+    SocketBroadcastServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 4);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_2) };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+    ASSERT_EQ(SocketCode::SUCCESS, server.await(3000).code());
+
+    const char message[] = "broadcast over TLS";
+    ASSERT_EQ(SocketCode::SUCCESS, server.write(message, sizeof(message)).code());
+
+    char buffer[sizeof(message)]{ 0 };
+    size_t received{ 0 };
+    while (received < sizeof(buffer))
+    {
+        auto result = client.read(buffer + received, sizeof(buffer) - received);
+        ASSERT_EQ(SocketCode::SUCCESS, result.code());
+        received += result.bytes();
+    }
+    EXPECT_STREQ(message, buffer);
+
+    // close_notify from the client is seen as a disconnect.
+    client.close();
+    EXPECT_EQ(SocketCode::SUCCESS, server.awaitClose(3000).code());
+    EXPECT_EQ(1, handler.disconnected.load());
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldNotBlockOnStalledHandshake)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSStallPort, false, 3, 300, 1000, 100, 8192 };
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 8);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // A plain TCP client that never sends a ClientHello.
+    SocketClient stalled{ config };
+    ASSERT_EQ(SocketCode::SUCCESS, stalled.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, stalled.connect().code());
+
+    auto start = std::chrono::steady_clock::now();
+    SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_2) };
+    ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+    ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+    runTLSEcho(client, "not blocked");
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_LT(elapsed, 500);
+
+    // The stalled handshake is given up after read_timeout * max_retries.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    char dummy[1];
+    EXPECT_NE(SocketCode::SUCCESS, stalled.read(dummy, sizeof(dummy)).code());
+    EXPECT_EQ(1, handler.connected.load());
+
+    client.close();
+    stalled.close();
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldRunHandshakesOnPool)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSPoolPort, false, 3, 300, 1000, 100, 8192 };
+
+    auto tls_config = makeServerConfiguration();
+    tls_config.setHandshakeThreads(2);
+
+    {
+        TLSEchoHandler handler;
+        SocketRequestServer server{ config, tls_config };
+        auto opened = server.open(&handler, 8);
+        SKIP_WITHOUT_TLS_SERVER(opened);
+        ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        // Occupies a pool thread's poll set, not the thread itself.
+        SocketClient stalled{ config };
+        ASSERT_EQ(SocketCode::SUCCESS, stalled.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, stalled.connect().code());
+
+        std::vector<std::thread> clients;
+        for (int32_t i = 0; i < 4; i++)
+        {
+            clients.emplace_back([&config, i]() {
+                auto version = i % 2 ? SocketTLSVersion::TLS1_3 : SocketTLSVersion::TLS1_2;
+                SocketClient client{ config, makeClientConfiguration(version) };
+                ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+                ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+                for (int32_t round = 0; round < 5; round++)
+                    runTLSEcho(client, "pooled client " + std::to_string(i) + " round " + std::to_string(round));
+                client.close();
+            });
+        }
+        for (auto& client : clients)
+            client.join();
+        EXPECT_EQ(4, handler.connected.load());
+
+        // The pool drops the stalled handshake after read_timeout * max_retries.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+        char dummy[1];
+        EXPECT_NE(SocketCode::SUCCESS, stalled.read(dummy, sizeof(dummy)).code());
+        EXPECT_EQ(4, handler.connected.load());
+
+        stalled.close();
+        server.close();
+    }
+
+    {
+        TLSCountingHandler handler;
+        SocketBroadcastServer server{ config, tls_config };
+        ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 4).code());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_2) };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+        ASSERT_EQ(SocketCode::SUCCESS, server.await(3000).code());
+
+        const char message[] = "broadcast after pooled handshake";
+        ASSERT_EQ(SocketCode::SUCCESS, server.write(message, sizeof(message)).code());
+        char buffer[sizeof(message)]{ 0 };
+        size_t received{ 0 };
+        while (received < sizeof(buffer))
+        {
+            auto result = client.read(buffer + received, sizeof(buffer) - received);
+            ASSERT_EQ(SocketCode::SUCCESS, result.code());
+            received += result.bytes();
+        }
+        EXPECT_STREQ(message, buffer);
+
+        client.close();
+        EXPECT_EQ(SocketCode::SUCCESS, server.awaitClose(3000).code());
+        server.close();
+    }
+
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, measureHandshakeThroughput)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSHandshakePort, false, 5, 1000, 1000, 100, 8192 };
+
+    constexpr int32_t kThreads = 8;
+    constexpr int32_t kHandshakes = 10;
+
+    for (uint32_t handshake_threads : { 0u, 2u, 4u })
+    {
+        auto tls_config = makeServerConfiguration();
+        tls_config.setHandshakeThreads(handshake_threads);
+
+        TLSEchoHandler handler;
+        SocketRequestServer server{ config, tls_config };
+        auto opened = server.open(&handler, 32);
+        SKIP_WITHOUT_TLS_SERVER(opened);
+        ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        for (bool resume_session : { false, true })
+        {
+            std::atomic<int32_t> succeeded{ 0 };
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> clients;
+            for (int32_t t = 0; t < kThreads; t++)
+            {
+                clients.emplace_back([&config, &succeeded, resume_session]() {
+                    for (int32_t i = 0; i < kHandshakes; i++)
+                    {
+                        SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_2, resume_session) };
+                        if (client.open().code() == SocketCode::SUCCESS && client.connect().code() == SocketCode::SUCCESS)
+                            succeeded++;
+                        client.close();
+                    }
+                });
+            }
+            for (auto& client : clients)
+                client.join();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+            EXPECT_EQ(kThreads * kHandshakes, succeeded.load());
+            printConcurrent("TLS 1.2 %s handshakes (handshake threads : %u) : %.1f / sec\n",
+                resume_session ? "resumed" : "full",
+                handshake_threads,
+                succeeded.load() * 1000000.0 / static_cast<double>(elapsed));
+        }
+
+        server.close();
+    }
+
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, measureKernelTLSThroughput)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    constexpr size_t kChunkSize = 64 * 1024;
+    constexpr size_t kChunks = 512;
+
+    for (bool use_kernel_tls : { false, true })
+    {
+        SocketConfiguration config{ "127.0.0.1", kTLSKernelPort, false, 5, 1000, 1000, 100, kChunkSize };
+
+        TLSCountingHandler handler;
+        SocketBroadcastServer server{ config, makeServerConfiguration(use_kernel_tls) };
+        auto opened = server.open(&handler, 1);
+        SKIP_WITHOUT_TLS_SERVER(opened);
+        ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        kernel_tls_reports = 0;
+        kernel_tls_offloads = 0;
+        SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_2, false, use_kernel_tls) };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+        ASSERT_EQ(SocketCode::SUCCESS, server.await(3000).code());
+        // Without kernel support OpenSSL falls back, but the attempt is reported.
+        EXPECT_EQ(use_kernel_tls ? 1 : 0, kernel_tls_reports.load());
+
+        std::vector<char> chunk(kChunkSize, 'k');
+        size_t received{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        std::thread reader([&client, &received]() {
+            std::vector<char> buffer(kChunkSize);
+            while (received < kChunkSize * kChunks)
+            {
+                auto result = client.read(buffer.data(), buffer.size());
+                if (result.code() != SocketCode::SUCCESS)
+                    break;
+                received += result.bytes();
+            }
+        });
+        for (size_t i = 0; i < kChunks; i++)
+            ASSERT_EQ(SocketCode::SUCCESS, server.write(chunk.data(), chunk.size()).code());
+        reader.join();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_EQ(kChunkSize * kChunks, received);
+        printConcurrent("TLS 1.2 loopback throughput (kernel TLS %s, client receive offloaded : %s) : %.1f MB/s\n",
+            use_kernel_tls ? "requested" : "off",
+            kernel_tls_offloads.load() ? "yes" : "no",
+            received / static_cast<double>(elapsed));
+
+        client.close();
+        server.close();
+    }
+
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldCoalesceSmallWrites)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSRecordPort, false, 5, 1000, 1000, 100, 8192 };
+
+    auto tls_config = makeServerConfiguration();
+    tls_config.setDynamicRecordSizing(true);
+    tls_config.setReleaseBuffers(true);
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, tls_config };
+    auto opened = server.open(&handler, 4);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    constexpr int32_t kRequests = 2000;
+    const std::string payload = "sixteen bytes!!!";
+
+    for (uint32_t flush_threshold : { 0u, 4096u })
+    {
+        auto client_config = makeClientConfiguration(SocketTLSVersion::TLS1_2);
+        client_config.setWriteCoalescing(flush_threshold);
+        client_config.setDynamicRecordSizing(true);
+        client_config.setReleaseBuffers(true);
+
+        SocketClient client{ config, client_config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+        if (flush_threshold > 0)
+        {
+            // Held until flush().
+            handler.processed = 0;
+            TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            EXPECT_EQ(0, handler.processed.load());
+            ASSERT_EQ(SocketCode::SUCCESS, client.flush().code());
+            std::string response(payload.size(), '\0');
+            size_t received{ 0 };
+            while (received < response.size())
+            {
+                auto result = client.read(&response[received], response.size() - received);
+                ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                received += result.bytes();
+            }
+            EXPECT_EQ(payload, response);
+            EXPECT_EQ(1, handler.processed.load());
+
+            // Larger than the threshold, behind bytes that are still held.
+            runTLSEcho(client, std::string(6000, 'x'));
+        }
+
+        // Pipelined small writes; read() sends whatever is still held.
+        auto start = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < kRequests; i++)
+        {
+            TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+        }
+        std::string responses(payload.size() * kRequests, '\0');
+        size_t received{ 0 };
+        while (received < responses.size())
+        {
+            auto result = client.read(&responses[received], responses.size() - received);
+            ASSERT_EQ(SocketCode::SUCCESS, result.code());
+            received += result.bytes();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        for (int32_t i = 0; i < kRequests; i++)
+            ASSERT_EQ(payload, responses.substr(i * payload.size(), payload.size()));
+
+        printConcurrent("Pipelined small requests (write coalescing : %u bytes) : %.0f / sec\n",
+            flush_threshold, kRequests * 1000000.0 / static_cast<double>(elapsed));
+        client.close();
+    }
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldGatherScatteredWrites)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSGatherPort, false, 5, 300, 1000, 100, 65536 };
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 4);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Small pieces around one larger than a TLS record.
+    std::string prefix = "prefix ";
+    std::string body(20000, 'b');
+    std::string suffix = " suffix";
+    std::string payload = prefix + body + suffix;
+
+    for (uint32_t flush_threshold : { 0u, 4096u })
+    {
+        auto client_config = makeClientConfiguration(SocketTLSVersion::TLS1_3);
+        client_config.setWriteCoalescing(flush_threshold);
+        SocketClient client{ config, client_config };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+
+        for (int32_t round = 0; round < 4; round++)
+        {
+            TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+            SocketIOBuffer request[] = {
+                { &header, sizeof(header) },
+                { &prefix[0], prefix.size() },
+                { &body[0], body.size() },
+                { &suffix[0], suffix.size() },
+            };
+            auto written = client.writev(request, 4);
+            ASSERT_EQ(SocketCode::SUCCESS, written.code());
+            EXPECT_EQ(static_cast<int32_t>(sizeof(header) + payload.size()), written.bytes());
+
+            std::string head(prefix.size(), '\0');
+            std::string rest(payload.size() - prefix.size(), '\0');
+            size_t received{ 0 };
+            while (received < payload.size())
+            {
+                SocketIOBuffer response[] = {
+                    { &head[0], head.size() },
+                    { &rest[0], rest.size() },
+                };
+                size_t first = received < head.size() ? 0 : 1;
+                size_t skipped = first == 0 ? received : received - head.size();
+                response[first].data = static_cast<char*>(response[first].data) + skipped;
+                response[first].size -= skipped;
+
+                auto result = client.readv(response + first, 2 - first);
+                ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                received += result.bytes();
+            }
+            EXPECT_EQ(payload, head + rest);
+        }
+        client.close();
+    }
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+// Answers every request with the whole file the header names the size of.
+struct TLSFileHandler : public TLSEchoHandler
+{
+    const char* filename{ nullptr };
+
+    size_t getPayloadSize(const char* header) override {
+        (void)header;
+        return 0;
+    }
+    Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+        (void)header;
+        return Bn3Monkey::SocketRequestMode::READ_STREAM;
+    }
+    bool onFileRequested(const char* header, const char*, size_t, char*, size_t* output_size, Bn3Monkey::SocketFileRange* file) override {
+        *output_size = 0;
+#ifdef _WIN32
+        file->fd = _open(filename, _O_RDONLY | _O_BINARY);
+#else
+        file->fd = open(filename, O_RDONLY);
+#endif
+        file->size = reinterpret_cast<const TLSEchoHeader*>(header)->payload_size;
+        file->close_after = true;
+        processed++;
+        return true;
+    }
+};
+
+TEST(TLSServer, shouldStreamFiles)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSFilePort, false, 5, 300, 1000, 100, 8192 };
+
+    const char* filename = "securitysockettest_tls_server.bin";
+    std::string contents(1024 * 1024 + 17, '\0');
+    for (size_t i = 0; i < contents.size(); i++)
+        contents[i] = static_cast<char>(i * 7);
+    {
+        FILE* fp = fopen(filename, "wb");
+        ASSERT_NE(nullptr, fp);
+        fwrite(contents.data(), 1, contents.size(), fp);
+        fclose(fp);
+    }
+
+    // SSL_sendfile() where kernel TLS is on; copied through SSL_write() where not.
+    for (bool use_kernel_tls : { false, true })
+    {
+        TLSFileHandler handler;
+        handler.filename = filename;
+        SocketRequestServer server{ config, makeServerConfiguration(use_kernel_tls) };
+        auto opened = server.open(&handler, 4);
+        SKIP_WITHOUT_TLS_SERVER(opened);
+        ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_3, false, use_kernel_tls) };
+        ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+        ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+        for (int32_t round = 0; round < 2; round++)
+        {
+            TLSEchoHeader header{ static_cast<uint32_t>(contents.size()) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+            std::string response(contents.size(), '\0');
+            size_t received{ 0 };
+            while (received < response.size())
+            {
+                auto result = client.read(&response[received], response.size() - received);
+                ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                received += result.bytes();
+            }
+            EXPECT_TRUE(response == contents);
+        }
+        EXPECT_EQ(2, handler.processed.load());
+        client.close();
+        server.close();
+    }
+
+    remove(filename);
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldServeOverMemoryBIO)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSMemoryBIOPort, false, 5, 300, 1000, 100, 262144 };
+    constexpr int32_t kRequests = 2000;
+    const std::string payload = "sixteen bytes!!!";
+
+    for (bool use_memory_bio : { false, true })
+    {
+        auto tls_config = makeServerConfiguration();
+        tls_config.setMemoryBIO(use_memory_bio);
+
+        {
+            TLSEchoHandler handler;
+            SocketRequestServer server{ config, tls_config };
+            auto opened = server.open(&handler, 4);
+            SKIP_WITHOUT_TLS_SERVER(opened);
+            ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            for (auto version : { SocketTLSVersion::TLS1_2, SocketTLSVersion::TLS1_3 })
+            {
+                SocketClient client{ config, makeClientConfiguration(version) };
+                ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+                ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+                runTLSEcho(client, "memory BIO echo");
+                runTLSEcho(client, std::string(6000, 'm'));
+                // More than the memory BIO engine sends from its buffer at once.
+                runTLSEcho(client, std::string(200000, 'w'));
+
+                // One record per write: the server's recv() picks up many at once.
+                auto start = std::chrono::steady_clock::now();
+                for (int32_t i = 0; i < kRequests; i++)
+                {
+                    TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+                    ASSERT_EQ(SocketCode::SUCCESS, client.write(&header, sizeof(header)).code());
+                    ASSERT_EQ(SocketCode::SUCCESS, client.write(payload.data(), payload.size()).code());
+                }
+                std::string responses(payload.size() * kRequests, '\0');
+                size_t received{ 0 };
+                while (received < responses.size())
+                {
+                    auto result = client.read(&responses[received], responses.size() - received);
+                    ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                    received += result.bytes();
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                for (int32_t i = 0; i < kRequests; i++)
+                    ASSERT_EQ(payload, responses.substr(i * payload.size(), payload.size()));
+
+                printConcurrent("%s pipelined small requests (memory BIO : %s) : %.0f / sec\n",
+                    version == SocketTLSVersion::TLS1_2 ? "TLS 1.2" : "TLS 1.3",
+                    use_memory_bio ? "on" : "off",
+                    kRequests * 1000000.0 / static_cast<double>(elapsed));
+                client.close();
+            }
+            server.close();
+        }
+
+        {
+            constexpr size_t kChunkSize = 64 * 1024;
+            constexpr size_t kChunks = 64;
+            SocketConfiguration broadcast_config{ "127.0.0.1", kTLSMemoryBIOPort, false, 5, 1000, 1000, 100, kChunkSize };
+
+            TLSCountingHandler handler;
+            SocketBroadcastServer server{ broadcast_config, tls_config };
+            ASSERT_EQ(SocketCode::SUCCESS, server.open(&handler, 1).code());
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            SocketClient client{ broadcast_config, makeClientConfiguration(SocketTLSVersion::TLS1_2) };
+            ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+            ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+            ASSERT_EQ(SocketCode::SUCCESS, server.await(3000).code());
+
+            std::vector<char> chunk(kChunkSize);
+            for (size_t i = 0; i < chunk.size(); i++)
+                chunk[i] = static_cast<char>(i % 251);
+            size_t received{ 0 };
+            bool is_intact{ true };
+            std::thread reader([&]() {
+                std::vector<char> buffer(kChunkSize);
+                while (received < kChunkSize * kChunks)
+                {
+                    auto result = client.read(buffer.data(), buffer.size());
+                    if (result.code() != SocketCode::SUCCESS)
+                        break;
+                    for (int32_t i = 0; i < result.bytes(); i++)
+                        is_intact &= buffer[i] == chunk[(received + i) % kChunkSize];
+                    received += result.bytes();
+                }
+            });
+            for (size_t i = 0; i < kChunks; i++)
+                ASSERT_EQ(SocketCode::SUCCESS, server.write(chunk.data(), chunk.size()).code());
+            reader.join();
+
+            EXPECT_EQ(kChunkSize * kChunks, received);
+            EXPECT_TRUE(is_intact);
+            client.close();
+            server.close();
+        }
+    }
+
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldFastConnect)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    // The probe would otherwise wait the whole read timeout for a TLS 1.3 alert.
+    SocketConfiguration config{ "127.0.0.1", kTLSFastConnectPort, false, 5, 1000, 1000, 100, 8192 };
+
+    TLSEchoHandler handler;
+    SocketRequestServer server{ config, makeServerConfiguration() };
+    auto opened = server.open(&handler, 4);
+    SKIP_WITHOUT_TLS_SERVER(opened);
+    ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    struct Mode { const char* name; bool fast_connect; uint32_t probe_timeout; };
+    for (auto mode : { Mode{ "probe (read timeout)", false, 0 }, Mode{ "probe (50 ms)", false, 50 }, Mode{ "fast connect", true, 0 } })
+    {
+        for (auto version : { SocketTLSVersion::TLS1_2, SocketTLSVersion::TLS1_3 })
+        {
+            auto tls_config = makeClientConfiguration(version);
+            tls_config.setFastConnect(mode.fast_connect);
+            tls_config.setHandshakeProbeTimeout(mode.probe_timeout);
+
+            SocketClient client{ config, tls_config };
+            ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+            auto start = std::chrono::steady_clock::now();
+            ASSERT_EQ(SocketCode::SUCCESS, client.connect().code());
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+            printConcurrent("%s connect (%s) : %lld ms\n",
+                version == SocketTLSVersion::TLS1_2 ? "TLS 1.2" : "TLS 1.3",
+                mode.name, static_cast<long long>(elapsed));
+            if (mode.fast_connect || mode.probe_timeout > 0 || version == SocketTLSVersion::TLS1_2)
+            {
+                EXPECT_LT(elapsed, 500);
+            }
+
+            runTLSEcho(client, "fast connect echo");
+            client.close();
+        }
+    }
+
+    server.close();
+    releaseSecuritySocket();
+}
+
+TEST(TLSServer, shouldAcceptEarlyData)
+{
+    using namespace Bn3Monkey;
+    if (!generateCertificate())
+        GTEST_SKIP() << "openssl CLI is not available";
+    initializeSecuritySocket();
+
+    SocketConfiguration config{ "127.0.0.1", kTLSEarlyDataPort, false, 5, 300, 1000, 100, 8192 };
+
+    // One request: header and payload in a single buffer.
+    const std::string payload = "idempotent request";
+    std::string request(sizeof(TLSEchoHeader), '\0');
+    TLSEchoHeader header{ static_cast<uint32_t>(payload.size()) };
+    memcpy(&request[0], &header, sizeof(header));
+    request += payload;
+
+    for (uint32_t max_early_data : { 0u, 16384u })
+    {
+        for (bool use_memory_bio : { false, true })
+        {
+            auto tls_config = makeServerConfiguration();
+            tls_config.setMaxEarlyData(max_early_data);
+            tls_config.setMemoryBIO(use_memory_bio);
+
+            TLSEchoHandler handler;
+            SocketRequestServer server{ config, tls_config };
+            auto opened = server.open(&handler, 4);
+            SKIP_WITHOUT_TLS_SERVER(opened);
+            ASSERT_EQ(SocketCode::SUCCESS, opened.code());
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            // The first connection has no session with this server yet.
+            for (int32_t i = 0; i < 3; i++)
+            {
+                SocketClient client{ config, makeClientConfiguration(SocketTLSVersion::TLS1_3, true) };
+                ASSERT_EQ(SocketCode::SUCCESS, client.open().code());
+                auto connected = client.connect(request.data(), request.size());
+                ASSERT_EQ(SocketCode::SUCCESS, connected.code());
+                if (i > 0 && max_early_data > 0)
+                    EXPECT_EQ(static_cast<int32_t>(request.size()), connected.bytes());
+                else
+                    EXPECT_EQ(0, connected.bytes());
+
+                std::string response(payload.size(), '\0');
+                size_t received{ 0 };
+                while (received < response.size())
+                {
+                    auto result = client.read(&response[received], response.size() - received);
+                    ASSERT_EQ(SocketCode::SUCCESS, result.code());
+                    received += result.bytes();
+                }
+                EXPECT_EQ(payload, response);
+
+                // The connection goes on normally once the handshake is over.
+                runTLSEcho(client, "after early data");
+                client.close();
+            }
+            EXPECT_EQ(6, handler.processed.load());
+
+            server.close();
+        }
+    }
+
+    releaseSecuritySocket();
+}
@@ -0,0 +1,889 @@
+#include "securitysocket_loadgen_codec.hpp"
+#include "securitysocket_loadgen_histogram.hpp"
+
+#include <SecuritySocket.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+// securitysocket_loadgen drives a SocketRequestServer or SocketBroadcastServer
+// (or anything speaking the same protocol) with many AsyncSocketClients spread
+// over a few SocketEventLoops, and reports throughput and latency percentiles.
+//
+// - closed loop : every connection sends its next request as soon as the
+//                 previous response has arrived. The measured latencies miss
+//                 the requests a stalled connection did not send meanwhile
+//                 (coordinated omission), so they are also reported corrected
+//                 the way HdrHistogram does it.
+// - open loop   : requests are scheduled at a fixed total rate, whether or not
+//                 earlier ones have been answered, and latency is measured
+//                 from the time each request was scheduled. A server that
+//                 falls behind shows up as growing latency, not as a lower
+//                 request rate.
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct LoadgenOptions
+    {
+        std::string host{ "127.0.0.1" };
+        uint32_t port{ 21500 };
+        std::string uds_path;
+        bool use_tls{ false };
+        std::string tls_version{ "1.3" };
+        std::string cert_path;
+        std::string key_path;
+
+        std::string target{ "request" };
+        std::string mode{ "closed" };
+        std::string codec{ "echo" };
+        uint32_t connections{ 100 };
+        uint32_t threads{ 2 };
+        double rate{ 10000 };
+        double duration{ 10 };
+        double warmup{ 1 };
+        size_t payload_size{ 64 };
+        size_t response_size{ 0 };
+        uint32_t timeout{ 2000 };
+        uint64_t expected_interval_us{ 0 };
+        bool serve{ false };
+        std::string json_path;
+    };
+
+    void printUsage()
+    {
+        std::printf(
+            "usage: securitysocket_loadgen [options]\n"
+            "\n"
+            "target\n"
+            "  --host=IP                 server address (127.0.0.1)\n"
+            "  --port=N                  server port (21500)\n"
+            "  --uds=PATH                connect to a unix domain socket instead\n"
+            "  --tls                     connect with TLS\n"
+            "  --tls-version=1.2|1.3     (1.3)\n"
+            "  --target=request|broadcast\n"
+            "                            request/response, or read what a broadcast server sends (request)\n"
+            "  --serve                   run the server in this process, so the run needs nothing else\n"
+            "  --cert=FILE --key=FILE    certificate of --serve --tls (generated with the openssl CLI if omitted)\n"
+            "\n"
+            "load\n"
+            "  --connections=N           number of clients (100)\n"
+            "  --threads=N               event loop threads driving them (2)\n"
+            "  --mode=closed|open        fixed concurrency or fixed rate (closed)\n"
+            "  --rate=R                  total requests per second of open loop, and messages per second\n"
+            "                            of the --serve broadcast publisher (10000)\n"
+            "  --duration=S              measured seconds (10)\n"
+            "  --warmup=S                seconds run before measuring (1)\n"
+            "  --codec=echo|length|fixed request / response framing (echo)\n"
+            "  --payload=BYTES           request payload, or broadcast message size (64)\n"
+            "  --response=BYTES          response size of the length and fixed codecs (= payload)\n"
+            "  --timeout=MS              connect / read / write timeout (2000)\n"
+            "  --expected-interval-us=N  interval of the closed loop coordinated omission correction\n"
+            "                            (mean service time)\n"
+            "\n"
+            "output\n"
+            "  --json=FILE               also write the report as JSON\n");
+    }
+
+    bool parseOptions(int argc, char** argv, LoadgenOptions& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            std::string name = arg;
+            std::string value;
+            auto separator = arg.find('=');
+            if (separator != std::string::npos)
+            {
+                name = arg.substr(0, separator);
+                value = arg.substr(separator + 1);
+            }
+
+            if (name == "--help" || name == "-h")
+                return false;
+            else if (name == "--host")
+                options.host = value;
+            else if (name == "--port")
+                options.port = static_cast<uint32_t>(std::stoul(value));
+            else if (name == "--uds")
+                options.uds_path = value;
+            else if (name == "--tls")
+                options.use_tls = true;
+            else if (name == "--tls-version")
+                options.tls_version = value;
+            else if (name == "--cert")
+                options.cert_path = value;
+            else if (name == "--key")
+                options.key_path = value;
+            else if (name == "--target")
+                options.target = value;
+            else if (name == "--serve")
+                options.serve = true;
+            else if (name == "--connections")
+                options.connections = static_cast<uint32_t>(std::stoul(value));
+            else if (name == "--threads")
+                options.threads = static_cast<uint32_t>(std::stoul(value));
+            else if (name == "--mode")
+                options.mode = value;
+            else if (name == "--rate")
+                options.rate = std::stod(value);
+            else if (name == "--duration")
+                options.duration = std::stod(value);
+            else if (name == "--warmup")
+                options.warmup = std::stod(value);
+            else if (name == "--codec")
+                options.codec = value;
+            else if (name == "--payload")
+                options.payload_size = static_cast<size_t>(std::stoul(value));
+            else if (name == "--response")
+                options.response_size = static_cast<size_t>(std::stoul(value));
+            else if (name == "--timeout")
+                options.timeout = static_cast<uint32_t>(std::stoul(value));
+            else if (name == "--expected-interval-us")
+                options.expected_interval_us = std::stoull(value);
+            else if (name == "--json")
+                options.json_path = value;
+            else
+            {
+                std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+                return false;
+            }
+        }
+
+        if (options.response_size == 0)
+            options.response_size = options.payload_size;
+        if (options.connections == 0 || options.threads == 0 || options.duration <= 0 || options.rate <= 0)
+        {
+            std::fprintf(stderr, "connections, threads, duration and rate must be positive\n");
+            return false;
+        }
+        if (options.mode != "closed" && options.mode != "open")
+        {
+            std::fprintf(stderr, "unknown mode %s\n", options.mode.c_str());
+            return false;
+        }
+        if (options.target != "request" && options.target != "broadcast")
+        {
+            std::fprintf(stderr, "unknown target %s\n", options.target.c_str());
+            return false;
+        }
+        size_t max_message = Bn3Monkey::SocketConfiguration::MAX_PDU_SIZE - sizeof(uint32_t);
+        if (options.payload_size > max_message || options.response_size > max_message)
+        {
+            std::fprintf(stderr, "payload and response must not exceed %zu bytes\n", max_message);
+            return false;
+        }
+        if (options.target == "broadcast" && options.payload_size < sizeof(uint64_t))
+        {
+            std::fprintf(stderr, "broadcast messages must be at least %zu bytes\n", sizeof(uint64_t));
+            return false;
+        }
+        return true;
+    }
+
+    Bn3Monkey::SocketConfiguration makeConfiguration(const LoadgenOptions& options)
+    {
+        bool is_unix_domain = !options.uds_path.empty();
+        const char* address = is_unix_domain ? options.uds_path.c_str() : options.host.c_str();
+        return Bn3Monkey::SocketConfiguration{ address, options.port, is_unix_domain, 5, options.timeout, options.timeout, 10 };
+    }
+
+    uint64_t toNanoseconds(Clock::duration duration)
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    // Everything one SocketEventLoop thread records. Only that thread touches
+    // the histograms until the loop is closed.
+    struct LoadgenWorker
+    {
+        Bn3Monkey::SocketEventLoop loop;
+        LatencyHistogram response_latency;
+        LatencyHistogram service_latency;
+        std::atomic<uint64_t> completed{ 0 };
+        std::atomic<uint64_t> errors{ 0 };
+    };
+
+    struct LoadgenConnection
+    {
+        LoadgenWorker* worker{ nullptr };
+        std::unique_ptr<Bn3Monkey::AsyncSocketClient> client;
+        std::vector<char> request;
+        std::vector<char> response;
+        size_t received{ 0 };
+        size_t expected{ 0 };
+        bool is_size_known{ false };
+
+        // Open loop: scheduled requests not sent yet. Filled by the pacer.
+        std::mutex mtx;
+        std::deque<Clock::time_point> backlog;
+        bool is_busy{ false };
+        bool is_broken{ false };
+
+        Clock::time_point intended;
+        Clock::time_point sent;
+    };
+
+    class LoadgenRun
+    {
+    public:
+        LoadgenRun(const LoadgenOptions& options, const LoadgenCodec& codec) :
+            _options(options), _codec(codec), _configuration(makeConfiguration(options)),
+            _tls_configuration({ options.tls_version == "1.2" ? Bn3Monkey::SocketTLSVersion::TLS1_2 : Bn3Monkey::SocketTLSVersion::TLS1_3 })
+        {
+            // The TLS 1.3 post-handshake probe would add a read timeout to
+            // every connection that is set up.
+            _tls_configuration.setFastConnect(true);
+        }
+
+        bool connect()
+        {
+            for (uint32_t i = 0; i < _options.threads; i++)
+            {
+                _workers.emplace_back(new LoadgenWorker);
+                auto result = _workers.back()->loop.open();
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                {
+                    std::fprintf(stderr, "cannot open an event loop: %s\n", result.message());
+                    return false;
+                }
+            }
+
+            auto request = _codec.encodeRequest();
+            for (uint32_t i = 0; i < _options.connections; i++)
+            {
+                std::unique_ptr<LoadgenConnection> connection{ new LoadgenConnection };
+                connection->worker = _workers[i % _workers.size()].get();
+                if (_options.use_tls)
+                    connection->client.reset(new Bn3Monkey::AsyncSocketClient(connection->worker->loop, _configuration, _tls_configuration));
+                else
+                    connection->client.reset(new Bn3Monkey::AsyncSocketClient(connection->worker->loop, _configuration));
+                connection->request = request;
+                connection->response.resize(std::max<size_t>(_options.payload_size, _options.response_size) + sizeof(uint32_t));
+                auto result = connection->client->open();
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                {
+                    std::fprintf(stderr, "cannot open client %u: %s\n", i, result.message());
+                    return false;
+                }
+                _connections.push_back(std::move(connection));
+            }
+
+            std::mutex mtx;
+            std::condition_variable cv;
+            uint32_t finished{ 0 };
+            uint32_t failed{ 0 };
+            std::string first_error;
+            for (auto& connection : _connections)
+            {
+                connection->client->connectAsync([&](Bn3Monkey::SocketResult result) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                    {
+                        if (failed++ == 0)
+                            first_error = result.message();
+                    }
+                    finished++;
+                    cv.notify_all();
+                    });
+            }
+
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&]() { return finished == _connections.size(); });
+            if (failed > 0)
+            {
+                std::fprintf(stderr, "%u of %zu clients could not connect (%s)\n", failed, _connections.size(), first_error.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        void run()
+        {
+            _start = Clock::now();
+            _measure_from = _start + toDuration(_options.warmup);
+            _measure_until = _measure_from + toDuration(_options.duration);
+
+            if (_options.target == "broadcast")
+            {
+                for (auto& connection : _connections)
+                    receiveMessage(connection.get());
+            }
+            else if (_options.mode == "closed")
+            {
+                for (auto& connection : _connections)
+                    trySend(connection.get());
+            }
+            else
+            {
+                pace();
+            }
+
+            std::this_thread::sleep_until(_measure_until);
+            _is_stopping = true;
+
+            // Give requests in flight up to one timeout to come back. Broadcast
+            // clients always have a read pending; the publisher stops on time.
+            if (_options.target == "broadcast")
+                return;
+            auto drain_deadline = Clock::now() + std::chrono::milliseconds(_options.timeout);
+            while (Clock::now() < drain_deadline && hasBusyConnection())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        void close()
+        {
+            _is_stopping = true;
+            for (auto& connection : _connections)
+                connection->client->close();
+            for (auto& worker : _workers)
+                worker->loop.close();
+        }
+
+        uint64_t unsent()
+        {
+            uint64_t count{ 0 };
+            for (auto& connection : _connections)
+            {
+                std::lock_guard<std::mutex> lock(connection->mtx);
+                count += connection->backlog.size();
+            }
+            return count;
+        }
+
+        LatencyHistogram responseLatency() const
+        {
+            LatencyHistogram result;
+            for (auto& worker : _workers)
+                result.merge(worker->response_latency);
+            return result;
+        }
+        LatencyHistogram serviceLatency() const
+        {
+            LatencyHistogram result;
+            for (auto& worker : _workers)
+                result.merge(worker->service_latency);
+            return result;
+        }
+        uint64_t completed() const
+        {
+            uint64_t count{ 0 };
+            for (auto& worker : _workers)
+                count += worker->completed.load();
+            return count;
+        }
+        uint64_t errors() const
+        {
+            uint64_t count{ 0 };
+            for (auto& worker : _workers)
+                count += worker->errors.load();
+            return count;
+        }
+
+    private:
+        static Clock::duration toDuration(double seconds)
+        {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        bool hasBusyConnection()
+        {
+            for (auto& connection : _connections)
+            {
+                std::lock_guard<std::mutex> lock(connection->mtx);
+                if (connection->is_busy && !connection->is_broken)
+                    return true;
+            }
+            return false;
+        }
+
+        // Hands out the request schedule t_k = start + k / rate round-robin.
+        // A connection whose previous request is still outstanding keeps the
+        // new one in its backlog; its latency still counts from t_k.
+        void pace()
+        {
+            auto interval = std::chrono::duration<double>(1.0 / _options.rate);
+            uint64_t index{ 0 };
+            while (true)
+            {
+                auto now = Clock::now();
+                if (now >= _measure_until)
+                    break;
+                for (;; index++)
+                {
+                    auto scheduled = _start + std::chrono::duration_cast<Clock::duration>(interval * static_cast<double>(index));
+                    if (scheduled > now)
+                    {
+                        std::this_thread::sleep_until(std::min(scheduled, _measure_until));
+                        break;
+                    }
+                    auto* connection = _connections[index % _connections.size()].get();
+                    {
+                        std::lock_guard<std::mutex> lock(connection->mtx);
+                        connection->backlog.push_back(scheduled);
+                    }
+                    trySend(connection);
+                }
+            }
+        }
+
+        void trySend(LoadgenConnection* connection)
+        {
+            {
+                std::lock_guard<std::mutex> lock(connection->mtx);
+                if (connection->is_busy || connection->is_broken || _is_stopping)
+                    return;
+                if (_options.mode == "open")
+                {
+                    if (connection->backlog.empty())
+                        return;
+                    connection->intended = connection->backlog.front();
+                    connection->backlog.pop_front();
+                }
+                else
+                {
+                    connection->intended = Clock::now();
+                }
+                connection->is_busy = true;
+            }
+
+            connection->client->writeAsync(connection->request.data(), connection->request.size(), [this, connection](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                {
+                    fail(connection);
+                    return;
+                }
+                // Service time starts here, on the loop thread, so it leaves
+                // out how long the loop took to pick the request up.
+                connection->sent = Clock::now();
+                connection->received = 0;
+                connection->is_size_known = _codec.responseHeaderSize() == 0;
+                connection->expected = connection->is_size_known ? _codec.responseSize(nullptr) : _codec.responseHeaderSize();
+                receiveResponse(connection);
+                });
+        }
+
+        void receiveResponse(LoadgenConnection* connection)
+        {
+            if (connection->received == connection->expected)
+            {
+                complete(connection);
+                return;
+            }
+            connection->client->readAsync(connection->response.data() + connection->received, connection->expected - connection->received, [this, connection](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                {
+                    fail(connection);
+                    return;
+                }
+                connection->received += result.bytes();
+                if (!connection->is_size_known && connection->received == connection->expected)
+                {
+                    connection->is_size_known = true;
+                    connection->expected = _codec.responseSize(connection->response.data());
+                    if (connection->expected > connection->response.size())
+                        connection->response.resize(connection->expected);
+                }
+                receiveResponse(connection);
+                });
+        }
+
+        void complete(LoadgenConnection* connection)
+        {
+            auto now = Clock::now();
+            auto* worker = connection->worker;
+            if (connection->intended >= _measure_from && connection->intended < _measure_until)
+            {
+                worker->response_latency.record(toNanoseconds(now - connection->intended));
+                worker->service_latency.record(toNanoseconds(now - connection->sent));
+                worker->completed++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(connection->mtx);
+                connection->is_busy = false;
+            }
+            trySend(connection);
+        }
+
+        // Broadcast target: messages of payload_size bytes whose first 8
+        // bytes are the steady_clock time the --serve publisher scheduled
+        // them at. Only meaningful when the publisher runs in this process.
+        void receiveMessage(LoadgenConnection* connection)
+        {
+            {
+                std::lock_guard<std::mutex> lock(connection->mtx);
+                if (connection->is_broken || _is_stopping)
+                    return;
+                connection->is_busy = true;
+            }
+            connection->received = 0;
+            receiveMessagePart(connection);
+        }
+
+        void receiveMessagePart(LoadgenConnection* connection)
+        {
+            connection->client->readAsync(connection->response.data() + connection->received, _options.payload_size - connection->received, [this, connection](Bn3Monkey::SocketResult result) {
+                if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+                {
+                    fail(connection);
+                    return;
+                }
+                connection->received += result.bytes();
+                if (connection->received < _options.payload_size)
+                {
+                    receiveMessagePart(connection);
+                    return;
+                }
+
+                auto now = Clock::now();
+                if (_options.serve)
+                {
+                    int64_t stamp{ 0 };
+                    ::memcpy(&stamp, connection->response.data(), sizeof(stamp));
+                    auto scheduled = Clock::time_point(Clock::duration(stamp));
+                    if (scheduled >= _measure_from && scheduled < _measure_until)
+                    {
+                        connection->worker->response_latency.record(toNanoseconds(now - scheduled));
+                        connection->worker->completed++;
+                    }
+                }
+                else if (now >= _measure_from && now < _measure_until)
+                {
+                    connection->worker->completed++;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(connection->mtx);
+                    connection->is_busy = false;
+                }
+                receiveMessage(connection);
+                });
+        }
+
+        void fail(LoadgenConnection* connection)
+        {
+            std::lock_guard<std::mutex> lock(connection->mtx);
+            // Closing at the end of the run fails whatever is still pending.
+            if (_is_stopping)
+            {
+                connection->is_busy = false;
+                return;
+            }
+            connection->is_broken = true;
+            connection->worker->errors++;
+        }
+
+        const LoadgenOptions& _options;
+        const LoadgenCodec& _codec;
+        Bn3Monkey::SocketConfiguration _configuration;
+        Bn3Monkey::SocketTLSClientConfiguration _tls_configuration;
+
+        std::vector<std::unique_ptr<LoadgenWorker>> _workers;
+        std::vector<std::unique_ptr<LoadgenConnection>> _connections;
+        std::atomic<bool> _is_stopping{ false };
+        Clock::time_point _start;
+        Clock::time_point _measure_from;
+        Clock::time_point _measure_until;
+    };
+
+    // The servers of --serve.
+    class LoadgenServer
+    {
+    public:
+        LoadgenServer(const LoadgenOptions& options, const LoadgenCodec& codec) :
+            _options(options), _codec(codec), _handler(codec), _configuration(makeConfiguration(options)) {}
+        ~LoadgenServer() { close(); }
+
+        bool open()
+        {
+            if (!_options.uds_path.empty())
+            {
+#if !defined(_WIN32)
+                ::unlink(_options.uds_path.c_str());
+#endif
+            }
+
+            std::unique_ptr<Bn3Monkey::SocketTLSServerConfiguration> tls_configuration;
+            if (_options.use_tls)
+            {
+                std::string cert_path = _options.cert_path;
+                std::string key_path = _options.key_path;
+                if (cert_path.empty() || key_path.empty())
+                {
+                    cert_path = "securitysocket_loadgen.crt";
+                    key_path = "securitysocket_loadgen.key";
+                    std::string command =
+                        "openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 "
+                        "-subj /CN=127.0.0.1 -keyout " + key_path + " -out " + cert_path +
+#if defined(_WIN32)
+                        " > NUL 2>&1";
+#else
+                        " > /dev/null 2>&1";
+#endif
+                    if (std::system(command.c_str()) != 0)
+                    {
+                        std::fprintf(stderr, "--serve --tls needs --cert / --key or the openssl CLI\n");
+                        return false;
+                    }
+                }
+                tls_configuration.reset(new Bn3Monkey::SocketTLSServerConfiguration(
+                    { Bn3Monkey::SocketTLSVersion::TLS1_2, Bn3Monkey::SocketTLSVersion::TLS1_3 },
+                    {}, {},
+                    cert_path.c_str(), key_path.c_str()));
+            }
+
+            Bn3Monkey::SocketResult result;
+            if (_options.target == "request")
+            {
+                if (tls_configuration)
+                    _request_server.reset(new Bn3Monkey::SocketRequestServer(_configuration, *tls_configuration));
+                else
+                    _request_server.reset(new Bn3Monkey::SocketRequestServer(_configuration));
+                result = _request_server->open(&_handler, _options.connections);
+            }
+            else
+            {
+                if (tls_configuration)
+                    _broadcast_server.reset(new Bn3Monkey::SocketBroadcastServer(_configuration, *tls_configuration));
+                else
+                    _broadcast_server.reset(new Bn3Monkey::SocketBroadcastServer(_configuration));
+                result = _broadcast_server->open(&_broadcast_handler, _options.connections);
+            }
+            if (result.code() != Bn3Monkey::SocketCode::SUCCESS)
+            {
+                std::fprintf(stderr, "cannot open the server: %s\n", result.message());
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return true;
+        }
+
+        // Broadcasts payload_size byte messages at --rate per second, each
+        // stamped with the time it was scheduled for.
+        void startPublishing(Clock::time_point until)
+        {
+            if (!_broadcast_server)
+                return;
+            _publisher = std::thread([this, until]() {
+                std::vector<char> message(_options.payload_size, 'x');
+                auto interval = std::chrono::duration<double>(1.0 / _options.rate);
+                auto start = Clock::now();
+                for (uint64_t index = 0;; index++)
+                {
+                    auto scheduled = start + std::chrono::duration_cast<Clock::duration>(interval * static_cast<double>(index));
+                    if (scheduled >= until)
+                        break;
+                    std::this_thread::sleep_until(scheduled);
+                    int64_t stamp = scheduled.time_since_epoch().count();
+                    ::memcpy(message.data(), &stamp, sizeof(stamp));
+                    _broadcast_server->write(message.data(), message.size());
+                }
+                });
+        }
+
+        void close()
+        {
+            if (_publisher.joinable())
+                _publisher.join();
+            if (_request_server)
+                _request_server->close();
+            if (_broadcast_server)
+                _broadcast_server->close();
+            _request_server.reset();
+            _broadcast_server.reset();
+        }
+
+    private:
+        struct SilentBroadcastHandler : public Bn3Monkey::SocketBroadcastHandler
+        {
+            void onClientConnected(const char* ip, int port) override {
+                (void)ip;
+                (void)port;
+            }
+            void onClientDisconnected(const char* ip, int port) override {
+                (void)ip;
+                (void)port;
+            }
+        };
+
+        const LoadgenOptions& _options;
+        const LoadgenCodec& _codec;
+        LoadgenServeHandler _handler;
+        SilentBroadcastHandler _broadcast_handler;
+        Bn3Monkey::SocketConfiguration _configuration;
+        std::unique_ptr<Bn3Monkey::SocketRequestServer> _request_server;
+        std::unique_ptr<Bn3Monkey::SocketBroadcastServer> _broadcast_server;
+        std::thread _publisher;
+    };
+
+    struct LoadgenReportRow
+    {
+        const char* name;
+        LatencyHistogram histogram;
+    };
+
+    const double kPercentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+
+    void printReport(const LoadgenOptions& options, double throughput, uint64_t completed, uint64_t errors, uint64_t unsent, const std::vector<LoadgenReportRow>& rows)
+    {
+        std::printf("\n%s, %u connections on %u threads, %s%s\n",
+            options.target == "broadcast" ? "broadcast" : (options.mode == "open" ? "open loop" : "closed loop"),
+            options.connections, options.threads,
+            options.uds_path.empty() ? "tcp" : "uds",
+            options.use_tls ? (options.tls_version == "1.2" ? " + tls 1.2" : " + tls 1.3") : "");
+        std::printf("%s %llu in %.1f s: %.1f /s, %llu errors, %llu unsent\n",
+            options.target == "broadcast" ? "messages" : "requests",
+            static_cast<unsigned long long>(completed), options.duration, throughput,
+            static_cast<unsigned long long>(errors), static_cast<unsigned long long>(unsent));
+
+        std::printf("\n%-12s %10s %10s %10s %10s %10s %10s %10s\n", "latency(us)", "p50", "p90", "p99", "p99.9", "p99.99", "max", "mean");
+        for (auto& row : rows)
+        {
+            std::printf("%-12s", row.name);
+            for (double percentile : kPercentiles)
+                std::printf(" %10.1f", static_cast<double>(row.histogram.percentile(percentile)) / 1000.0);
+            std::printf(" %10.1f %10.1f\n", static_cast<double>(row.histogram.max()) / 1000.0, row.histogram.mean() / 1000.0);
+        }
+    }
+
+    bool writeJsonReport(const LoadgenOptions& options, double throughput, uint64_t completed, uint64_t errors, uint64_t unsent, const std::vector<LoadgenReportRow>& rows)
+    {
+        FILE* file = std::fopen(options.json_path.c_str(), "w");
+        if (file == nullptr)
+            return false;
+        std::fprintf(file, "{\n");
+        std::fprintf(file, "  \"target\": \"%s\",\n  \"mode\": \"%s\",\n  \"codec\": \"%s\",\n", options.target.c_str(), options.mode.c_str(), options.codec.c_str());
+        std::fprintf(file, "  \"connections\": %u,\n  \"threads\": %u,\n  \"tls\": %s,\n  \"uds\": %s,\n",
+            options.connections, options.threads, options.use_tls ? "true" : "false", options.uds_path.empty() ? "false" : "true");
+        std::fprintf(file, "  \"payload\": %zu,\n  \"response\": %zu,\n  \"duration_s\": %g,\n", options.payload_size, options.response_size, options.duration);
+        std::fprintf(file, "  \"completed\": %llu,\n  \"errors\": %llu,\n  \"unsent\": %llu,\n  \"throughput\": %.3f,\n",
+            static_cast<unsigned long long>(completed), static_cast<unsigned long long>(errors), static_cast<unsigned long long>(unsent), throughput);
+        std::fprintf(file, "  \"latency_ns\": {\n");
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            auto& histogram = rows[i].histogram;
+            std::fprintf(file, "    \"%s\": { \"count\": %llu", rows[i].name, static_cast<unsigned long long>(histogram.count()));
+            std::fprintf(file, ", \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p99.9\": %llu, \"p99.99\": %llu",
+                static_cast<unsigned long long>(histogram.percentile(50.0)),
+                static_cast<unsigned long long>(histogram.percentile(90.0)),
+                static_cast<unsigned long long>(histogram.percentile(99.0)),
+                static_cast<unsigned long long>(histogram.percentile(99.9)),
+                static_cast<unsigned long long>(histogram.percentile(99.99)));
+            std::fprintf(file, ", \"max\": %llu, \"mean\": %.1f }%s\n",
+                static_cast<unsigned long long>(histogram.max()), histogram.mean(), i + 1 < rows.size() ? "," : "");
+        }
+        std::fprintf(file, "  }\n}\n");
+        std::fclose(file);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    LoadgenOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+    auto codec = createLoadgenCodec(options.codec, options.payload_size, options.response_size);
+    if (!codec)
+    {
+        std::fprintf(stderr, "unknown codec %s\n", options.codec.c_str());
+        printUsage();
+        return 1;
+    }
+
+#if !defined(_WIN32)
+    // OpenSSL writes close_notify with plain send(); a peer that already
+    // dropped the connection must not kill the run.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    Bn3Monkey::initializeSecuritySocket();
+
+    int exit_code{ 0 };
+    {
+        std::unique_ptr<LoadgenServer> server;
+        if (options.serve)
+        {
+            server.reset(new LoadgenServer(options, *codec));
+            if (!server->open())
+                exit_code = 1;
+        }
+
+        LoadgenRun run{ options, *codec };
+        if (exit_code == 0 && !run.connect())
+            exit_code = 1;
+
+        if (exit_code == 0)
+        {
+            if (server)
+            {
+                auto until = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup + options.duration));
+                server->startPublishing(until);
+            }
+            run.run();
+        }
+        run.close();
+        if (server)
+            server->close();
+
+        if (exit_code == 0)
+        {
+            uint64_t completed = run.completed();
+            uint64_t errors = run.errors();
+            uint64_t unsent = run.unsent();
+            double throughput = static_cast<double>(completed) / options.duration;
+
+            std::vector<LoadgenReportRow> rows;
+            if (options.target == "broadcast")
+            {
+                if (options.serve)
+                    rows.push_back({ "delivery", run.responseLatency() });
+            }
+            else if (options.mode == "open")
+            {
+                rows.push_back({ "response", run.responseLatency() });
+                rows.push_back({ "service", run.serviceLatency() });
+            }
+            else
+            {
+                auto service = run.serviceLatency();
+                uint64_t expected_interval = options.expected_interval_us * 1000;
+                if (expected_interval == 0)
+                    expected_interval = static_cast<uint64_t>(service.mean());
+                rows.push_back({ "service", service });
+                rows.push_back({ "corrected", service.corrected(expected_interval) });
+            }
+
+            printReport(options, throughput, completed, errors, unsent, rows);
+            if (!options.json_path.empty() && !writeJsonReport(options, throughput, completed, errors, unsent, rows))
+            {
+                std::fprintf(stderr, "cannot write %s\n", options.json_path.c_str());
+                exit_code = 1;
+            }
+            if (errors > 0)
+                exit_code = 2;
+        }
+    }
+
+    Bn3Monkey::releaseSecuritySocket();
+    return exit_code;
+}
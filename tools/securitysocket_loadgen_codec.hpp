@@ -0,0 +1,200 @@
+#if !defined(__SECURITY_SOCKET_LOADGEN_CODEC__)
+#define __SECURITY_SOCKET_LOADGEN_CODEC__
+
+#include <SecuritySocket.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How the load generator frames a request and finds the end of its response.
+// The server side is only used by --serve, so a run can go without a service
+// of your own; against a real service pick the codec that matches its
+// protocol.
+struct LoadgenCodec
+{
+    virtual ~LoadgenCodec() = default;
+
+    // A whole request carrying the configured payload.
+    virtual std::vector<char> encodeRequest() const = 0;
+    // Bytes to read before the response size is known; 0 when it is known
+    // up front.
+    virtual size_t responseHeaderSize() const = 0;
+    // Size of the whole response, header included. `header` holds
+    // responseHeaderSize() bytes (nullptr when that is 0).
+    virtual size_t responseSize(const char* header) const = 0;
+
+    // SocketRequestHandler side of the same protocol.
+    virtual size_t requestHeaderSize() const = 0;
+    virtual size_t requestPayloadSize(const char* header) const = 0;
+    virtual void encodeResponse(const char* header, const char* payload, size_t payload_size, char* output, size_t* output_size) const = 0;
+};
+
+// echo   : uint32 payload size + payload -> the payload.
+// length : uint32 payload size + payload -> uint32 response size + response.
+// fixed  : payload bytes                 -> response bytes. Both sizes are fixed.
+// uint32 fields are in host byte order, like the examples in the readme.
+class LoadgenEchoCodec : public LoadgenCodec
+{
+public:
+    explicit LoadgenEchoCodec(size_t payload_size) : _payload_size(payload_size) {}
+
+    std::vector<char> encodeRequest() const override {
+        std::vector<char> request(sizeof(uint32_t) + _payload_size, 'x');
+        uint32_t size = static_cast<uint32_t>(_payload_size);
+        ::memcpy(request.data(), &size, sizeof(size));
+        return request;
+    }
+    size_t responseHeaderSize() const override { return 0; }
+    size_t responseSize(const char* header) const override {
+        (void)header;
+        return _payload_size;
+    }
+
+    size_t requestHeaderSize() const override { return sizeof(uint32_t); }
+    size_t requestPayloadSize(const char* header) const override {
+        uint32_t size{ 0 };
+        ::memcpy(&size, header, sizeof(size));
+        return size;
+    }
+    void encodeResponse(const char* header, const char* payload, size_t payload_size, char* output, size_t* output_size) const override {
+        (void)header;
+        ::memcpy(output, payload, payload_size);
+        *output_size = payload_size;
+    }
+
+private:
+    size_t _payload_size;
+};
+
+class LoadgenLengthCodec : public LoadgenCodec
+{
+public:
+    LoadgenLengthCodec(size_t payload_size, size_t response_size) : _payload_size(payload_size), _response_size(response_size) {}
+
+    std::vector<char> encodeRequest() const override {
+        std::vector<char> request(sizeof(uint32_t) + _payload_size, 'x');
+        uint32_t size = static_cast<uint32_t>(_payload_size);
+        ::memcpy(request.data(), &size, sizeof(size));
+        return request;
+    }
+    size_t responseHeaderSize() const override { return sizeof(uint32_t); }
+    size_t responseSize(const char* header) const override {
+        uint32_t size{ 0 };
+        ::memcpy(&size, header, sizeof(size));
+        return sizeof(uint32_t) + size;
+    }
+
+    size_t requestHeaderSize() const override { return sizeof(uint32_t); }
+    size_t requestPayloadSize(const char* header) const override {
+        uint32_t size{ 0 };
+        ::memcpy(&size, header, sizeof(size));
+        return size;
+    }
+    void encodeResponse(const char* header, const char* payload, size_t payload_size, char* output, size_t* output_size) const override {
+        (void)header;
+        (void)payload;
+        (void)payload_size;
+        uint32_t size = static_cast<uint32_t>(_response_size);
+        ::memcpy(output, &size, sizeof(size));
+        ::memset(output + sizeof(size), 'y', _response_size);
+        *output_size = sizeof(size) + _response_size;
+    }
+
+private:
+    size_t _payload_size;
+    size_t _response_size;
+};
+
+class LoadgenFixedCodec : public LoadgenCodec
+{
+public:
+    LoadgenFixedCodec(size_t payload_size, size_t response_size) : _payload_size(payload_size), _response_size(response_size) {}
+
+    std::vector<char> encodeRequest() const override {
+        return std::vector<char>(_payload_size, 'x');
+    }
+    size_t responseHeaderSize() const override { return 0; }
+    size_t responseSize(const char* header) const override {
+        (void)header;
+        return _response_size;
+    }
+
+    // The whole request is the "header"; there is no payload to size.
+    size_t requestHeaderSize() const override { return _payload_size; }
+    size_t requestPayloadSize(const char* header) const override {
+        (void)header;
+        return 0;
+    }
+    void encodeResponse(const char* header, const char* payload, size_t payload_size, char* output, size_t* output_size) const override {
+        (void)header;
+        (void)payload;
+        (void)payload_size;
+        ::memset(output, 'y', _response_size);
+        *output_size = _response_size;
+    }
+
+private:
+    size_t _payload_size;
+    size_t _response_size;
+};
+
+// nullptr for an unknown name.
+inline std::unique_ptr<LoadgenCodec> createLoadgenCodec(const std::string& name, size_t payload_size, size_t response_size)
+{
+    if (name == "echo")
+        return std::unique_ptr<LoadgenCodec>(new LoadgenEchoCodec(payload_size));
+    if (name == "length")
+        return std::unique_ptr<LoadgenCodec>(new LoadgenLengthCodec(payload_size, response_size));
+    if (name == "fixed")
+        return std::unique_ptr<LoadgenCodec>(new LoadgenFixedCodec(payload_size, response_size));
+    return nullptr;
+}
+
+// Request handler of --serve, answering in the codec's protocol.
+struct LoadgenServeHandler : public Bn3Monkey::SocketRequestHandler
+{
+    explicit LoadgenServeHandler(const LoadgenCodec& codec) : _codec(codec) {}
+
+    size_t getHeaderSize() override {
+        return _codec.requestHeaderSize();
+    }
+    size_t getPayloadSize(const char* header) override {
+        return _codec.requestPayloadSize(header);
+    }
+    Bn3Monkey::SocketRequestMode onModeClassified(const char* header) override {
+        (void)header;
+        return Bn3Monkey::SocketRequestMode::FAST;
+    }
+    void onClientConnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+    }
+    void onClientDisconnected(const char* ip, int port) override {
+        (void)ip;
+        (void)port;
+    }
+    void onProcessed(
+        const char* header,
+        const char* input_buffer,
+        size_t input_size,
+        char* output_buffer,
+        size_t* output_size) override {
+        _codec.encodeResponse(header, input_buffer, input_size, output_buffer, output_size);
+    }
+    void onProcessedWithoutResponse(
+        const char* header,
+        const char* input_buffer,
+        size_t input_size) override {
+        (void)header;
+        (void)input_buffer;
+        (void)input_size;
+    }
+
+private:
+    const LoadgenCodec& _codec;
+};
+
+#endif // __SECURITY_SOCKET_LOADGEN_CODEC__
@@ -0,0 +1,145 @@
+#if !defined(__SECURITY_SOCKET_LOADGEN_HISTOGRAM__)
+#define __SECURITY_SOCKET_LOADGEN_HISTOGRAM__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Log-linear latency histogram in nanoseconds, in the spirit of HdrHistogram.
+// Each power of two is split into SUB_BUCKETS / 2 linear buckets, so a
+// recorded value is off by less than 2 / SUB_BUCKETS (about 1.6%) at any
+// magnitude.
+// Recording is a few integer operations and never allocates.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() : _counts(BUCKETS, 0) {}
+
+    void record(uint64_t value, uint64_t count = 1)
+    {
+        _counts[indexOf(value)] += count;
+        _total += count;
+        _sum += static_cast<double>(value) * static_cast<double>(count);
+        _max = std::max(_max, value);
+        _min = std::min(_min, value);
+    }
+
+    // HdrHistogram's correction for coordinated omission. A closed-loop
+    // client that waited `value` did not send the requests it would have sent
+    // every `expected_interval` meanwhile; those would have waited
+    // value - expected_interval, value - 2 * expected_interval, ...
+    void recordCorrected(uint64_t value, uint64_t expected_interval, uint64_t count = 1)
+    {
+        record(value, count);
+        if (expected_interval == 0)
+            return;
+        for (uint64_t missed = value; missed > expected_interval; )
+        {
+            missed -= expected_interval;
+            record(missed, count);
+        }
+    }
+
+    // A copy with recordCorrected() applied to every value recorded so far.
+    LatencyHistogram corrected(uint64_t expected_interval) const
+    {
+        LatencyHistogram result;
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            if (_counts[i] > 0)
+                result.recordCorrected(valueOf(i), expected_interval, _counts[i]);
+        }
+        return result;
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < BUCKETS; i++)
+            _counts[i] += other._counts[i];
+        _total += other._total;
+        _sum += other._sum;
+        _max = std::max(_max, other._max);
+        _min = std::min(_min, other._min);
+    }
+
+    void reset()
+    {
+        std::fill(_counts.begin(), _counts.end(), 0);
+        _total = 0;
+        _sum = 0;
+        _max = 0;
+        _min = UINT64_MAX;
+    }
+
+    // Smallest recorded value that at least `percentile` % of the values do
+    // not exceed.
+    uint64_t percentile(double percentile) const
+    {
+        if (_total == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(_total) + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, _total));
+        uint64_t seen{ 0 };
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            seen += _counts[i];
+            if (seen >= rank)
+                return std::min(valueOf(i), _max);
+        }
+        return _max;
+    }
+
+    inline uint64_t count() const { return _total; }
+    inline uint64_t max() const { return _max; }
+    inline uint64_t min() const { return _total ? _min : 0; }
+    inline double mean() const { return _total ? _sum / static_cast<double>(_total) : 0.0; }
+
+private:
+    static constexpr uint32_t SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    // Values up to 2^48 ns (about 3 days).
+    static constexpr uint32_t MAGNITUDES = 48 - SUB_BUCKET_BITS + 1;
+    static constexpr size_t BUCKETS = static_cast<size_t>(MAGNITUDES * SUB_BUCKETS);
+
+    static uint32_t bitLength(uint64_t value)
+    {
+        uint32_t length{ 0 };
+        while (value)
+        {
+            value >>= 1;
+            length++;
+        }
+        return length;
+    }
+
+    // Values below SUB_BUCKETS are exact; above, the magnitude picks a row
+    // and the top SUB_BUCKET_BITS bits the bucket within it.
+    static size_t indexOf(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return static_cast<size_t>(value);
+        uint32_t shift = bitLength(value) - SUB_BUCKET_BITS;
+        size_t index = static_cast<size_t>(shift * SUB_BUCKETS + (value >> shift));
+        return std::min(index, BUCKETS - 1);
+    }
+
+    // Upper bound of the bucket, so percentiles never under-report.
+    static uint64_t valueOf(size_t index)
+    {
+        if (index < SUB_BUCKETS)
+            return index;
+        uint32_t shift = static_cast<uint32_t>(index / SUB_BUCKETS);
+        uint64_t sub_bucket = index % SUB_BUCKETS;
+        // Rows past the first only use sub-buckets SUB_BUCKETS / 2 and up,
+        // since the top bit of the value is always set there.
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> _counts;
+    uint64_t _total{ 0 };
+    double _sum{ 0 };
+    uint64_t _max{ 0 };
+    uint64_t _min{ UINT64_MAX };
+};
+
+#endif // __SECURITY_SOCKET_LOADGEN_HISTOGRAM__